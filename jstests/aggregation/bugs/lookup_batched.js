@@ -0,0 +1,127 @@
+// Tests that $lookup produces the same results when the matches for several input documents are
+// resolved by a single batched query against the foreign collection, with and without an index on
+// the foreign field.
+
+(function() {
+    "use strict";
+
+    var local = db.lookup_batched_local;
+    var foreign = db.lookup_batched_foreign;
+    local.drop();
+    foreign.drop();
+
+    // Used to sort result documents. All _ids must be primitives.
+    function compareId(a, b) {
+        if (a._id < b._id) {
+            return -1;
+        }
+        if (a._id > b._id) {
+            return 1;
+        }
+        return 0;
+    }
+
+    function setBatchSizes(batchSize) {
+        assert.commandWorked(db.adminCommand({
+            setParameter: 1,
+            internalDocumentSourceLookUpIndexedBatchSize: batchSize,
+            internalDocumentSourceLookUpHashJoinBatchSize: batchSize
+        }));
+    }
+
+    var localDocs = [
+        {_id: 0, a: 1},
+        {_id: 1, a: NumberLong(1)},
+        {_id: 2, a: 2},
+        {_id: 3, a: "x"},
+        {_id: 4, a: null},
+        {_id: 5},
+        {_id: 6, a: [1, 2]},
+        {_id: 7, a: /x/},
+        {_id: 8, a: 3},
+        {_id: 9, a: {c: 1}},
+        {_id: 10, a: 2.0},
+    ];
+    var foreignDocs = [
+        {_id: 0, b: 1},
+        {_id: 1, b: 1.0},
+        {_id: 2, b: [2, 2, 3]},
+        {_id: 3, b: "x"},
+        {_id: 4, b: null},
+        {_id: 5},
+        {_id: 6, b: [1, 2]},
+        {_id: 7, b: /x/},
+        {_id: 8, b: {c: 1}},
+        {_id: 9, b: [{c: 1}]},
+    ];
+    assert.writeOK(local.insert(localDocs));
+    assert.writeOK(foreign.insert(foreignDocs));
+
+    var lookup = {$lookup: {from: foreign.getName(), localField: "a", foreignField: "b", as: "m"}};
+    var unwind = {$unwind: {path: "$m", preserveNullAndEmptyArrays: true}};
+
+    function runPipelines() {
+        var joined = local.aggregate([lookup]).toArray().sort(compareId);
+        joined.forEach(function(doc) {
+            doc.m.sort(compareId);
+        });
+        var unwound = local.aggregate([lookup, unwind, {$sort: {_id: 1, "m._id": 1}}]).toArray();
+        return {joined: joined, unwound: unwound};
+    }
+
+    // A batch size of one resolves every input document with its own query.
+    setBatchSizes(1);
+    var expected = runPipelines();
+
+    assert.eq([{_id: 0, b: 1}, {_id: 1, b: 1.0}, {_id: 6, b: [1, 2]}], expected.joined[0].m);
+    assert.eq([{_id: 2, b: [2, 2, 3]}, {_id: 6, b: [1, 2]}], expected.joined[2].m);
+    assert.eq([{_id: 8, b: {c: 1}}, {_id: 9, b: [{c: 1}]}], expected.joined[9].m);
+
+    [2, 3, 100].forEach(function(batchSize) {
+        setBatchSizes(batchSize);
+        assert.eq(expected, runPipelines(), "batch size " + batchSize + " without an index");
+    });
+
+    assert.commandWorked(foreign.ensureIndex({b: 1}));
+    [2, 3, 100].forEach(function(batchSize) {
+        setBatchSizes(batchSize);
+        assert.eq(expected, runPipelines(), "batch size " + batchSize + " with an index");
+    });
+
+    // Explain reports the strategy chosen for the foreign collection.
+    var explain = local.aggregate([lookup], {explain: true});
+    assert.eq("batchedIndexLookup", explain.stages[1].$lookup.strategy, tojson(explain));
+    assert.commandWorked(foreign.dropIndex({b: 1}));
+    explain = local.aggregate([lookup], {explain: true});
+    assert.eq("batchedHashJoin", explain.stages[1].$lookup.strategy, tojson(explain));
+
+    // A batch is closed once its keys reach the query byte limit.
+    setBatchSizes(100);
+    assert.commandWorked(db.adminCommand(
+        {setParameter: 1, internalDocumentSourceLookUpBatchMaxQueryBytes: 1}));
+    assert.eq(expected, runPipelines(), "query byte limit of 1");
+    assert.commandWorked(db.adminCommand(
+        {setParameter: 1, internalDocumentSourceLookUpBatchMaxQueryBytes: 1024 * 1024}));
+
+    // Keys which together are larger than the BSON size limit are split across batches.
+    local.drop();
+    foreign.drop();
+    var bigKey = new Array(1024 * 1024).join("k");
+    var numBigKeys = 20;
+    for (var i = 0; i < numBigKeys; i++) {
+        assert.writeOK(local.insert({_id: i, a: i + bigKey}));
+    }
+    assert.writeOK(foreign.insert({_id: 0, b: "3" + bigKey}));
+    setBatchSizes(1000);
+    var bigResults = local.aggregate([lookup, {$project: {_id: 1, n: {$size: "$m"}}}]).toArray();
+    assert.eq(numBigKeys, bigResults.length);
+    bigResults.forEach(function(doc) {
+        assert.eq(doc._id === 3 ? 1 : 0, doc.n, tojson(doc));
+    });
+
+    assert.commandWorked(db.adminCommand({
+        setParameter: 1,
+        internalDocumentSourceLookUpIndexedBatchSize: 100,
+        internalDocumentSourceLookUpHashJoinBatchSize: 1000
+    }));
+}());
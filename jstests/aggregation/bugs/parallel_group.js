@@ -0,0 +1,62 @@
+// Tests that a $group over a collection scan produces the same results when the scan is divided
+// between several workers whose partial groups are merged.
+
+(function() {
+    "use strict";
+
+    var coll = db.parallel_group;
+    coll.drop();
+
+    var bulk = coll.initializeUnorderedBulkOp();
+    for (var i = 0; i < 20000; i++) {
+        bulk.insert({_id: i, k: i % 37, v: i, pad: new Array(100).join("x")});
+    }
+    assert.writeOK(bulk.execute());
+
+    function setDegree(degree) {
+        assert.commandWorked(
+            db.adminCommand({setParameter: 1, internalAggregationMaxDegreeOfParallelism: degree}));
+    }
+
+    var pipelines = [
+        [{$group: {_id: "$k", count: {$sum: 1}, total: {$sum: "$v"}, max: {$max: "$v"}}}],
+        [
+          {$match: {v: {$gte: 1000}}},
+          {$project: {k: 1, v: 1}},
+          {$group: {_id: "$k", avg: {$avg: "$v"}, first: {$min: "$v"}}},
+          {$sort: {_id: 1}}
+        ],
+        [{$group: {_id: null, count: {$sum: 1}}}],
+    ];
+
+    function runAll() {
+        return pipelines.map(function(pipeline) {
+            return coll.aggregate(pipeline).toArray().sort(function(a, b) {
+                return a._id < b._id ? -1 : (a._id > b._id ? 1 : 0);
+            });
+        });
+    }
+
+    setDegree(1);
+    var expected = runAll();
+    assert.eq(37, expected[0].length);
+    assert.eq([{_id: null, count: 20000}], expected[2]);
+
+    setDegree(4);
+    assert.eq(expected, runAll());
+
+    // Only storage engines which can divide a collection between several cursors run the
+    // pipeline in parallel.
+    var scan = db.runCommand({parallelCollectionScan: coll.getName(), numCursors: 4});
+    assert.commandWorked(scan);
+    var explain = coll.aggregate(pipelines[0], {explain: true});
+    if (scan.cursors.length > 1) {
+        assert.eq(Math.min(4, scan.cursors.length),
+                  explain.stages[0].$parallelCursor.degreeOfParallelism,
+                  tojson(explain));
+    } else {
+        assert(explain.stages[0].hasOwnProperty("$cursor"), tojson(explain));
+    }
+
+    setDegree(1);
+}());
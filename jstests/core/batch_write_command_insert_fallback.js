@@ -0,0 +1,51 @@
+// Tests that a batch of inserts which is written in one storage transaction reports the same
+// results as inserting its documents one at a time, when some of the documents fail to insert.
+
+(function() {
+    "use strict";
+
+    var coll = db.batch_write_command_insert_fallback;
+    coll.drop();
+    assert.commandWorked(coll.ensureIndex({a: 1}, {unique: true}));
+
+    var docs = [];
+    for (var i = 0; i < 100; i++) {
+        docs.push({_id: i, a: i});
+    }
+
+    // Duplicates of documents earlier in the same batch.
+    docs[40] = {_id: 1000, a: 5};
+    docs[70] = {_id: 1001, a: 6};
+
+    // An ordered batch stops at the first error, keeping the documents inserted before it.
+    var res = db.runCommand({insert: coll.getName(), documents: docs, ordered: true});
+    assert.commandWorked(res);
+    assert.eq(40, res.n, tojson(res));
+    assert.eq(1, res.writeErrors.length, tojson(res));
+    assert.eq(40, res.writeErrors[0].index, tojson(res));
+    assert.eq(ErrorCodes.DuplicateKey, res.writeErrors[0].code, tojson(res));
+    assert.eq(40, coll.count());
+
+    // An unordered batch inserts every other document.
+    assert.writeOK(coll.remove({}));
+    res = db.runCommand({insert: coll.getName(), documents: docs, ordered: false});
+    assert.commandWorked(res);
+    assert.eq(98, res.n, tojson(res));
+    assert.eq(2, res.writeErrors.length, tojson(res));
+    assert.eq(40, res.writeErrors[0].index, tojson(res));
+    assert.eq(70, res.writeErrors[1].index, tojson(res));
+    assert.eq(98, coll.count());
+    assert.eq(null, coll.findOne({_id: 1000}));
+
+    // A batch without errors inserts every document.
+    assert.writeOK(coll.remove({}));
+    docs = [];
+    for (var i = 0; i < 1000; i++) {
+        docs.push({_id: i, a: i});
+    }
+    res = db.runCommand({insert: coll.getName(), documents: docs, ordered: true});
+    assert.commandWorked(res);
+    assert.eq(1000, res.n, tojson(res));
+    assert(!res.hasOwnProperty("writeErrors"), tojson(res));
+    assert.eq(1000, coll.count());
+}());
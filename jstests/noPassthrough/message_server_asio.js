@@ -0,0 +1,61 @@
+// Tests that mongod serves requests when connections are handled by a pool of workers rather than
+// one thread per connection, including when every worker is blocked.
+(function() {
+    "use strict";
+
+    var conn = MongoRunner.runMongod({
+        setParameter: {
+            messageServerMode: "asio",
+            messageServerIOThreads: 1,
+            messageServerWorkerThreads: 2,
+            messageServerWorkerStallMillis: 100
+        }
+    });
+    assert.neq(null, conn, "mongod failed to start with messageServerMode 'asio'");
+
+    var metrics = conn.getDB("admin").serverStatus().metrics.network.messageServer;
+    assert.eq(2, metrics.workers, tojson(metrics));
+    assert.eq(1, metrics.inFlight, tojson(metrics));
+
+    // More connections than workers, each with several requests.
+    var conns = [];
+    for (var i = 0; i < 10; i++) {
+        conns.push(new Mongo(conn.host));
+    }
+    conns.forEach(function(c, i) {
+        var coll = c.getDB("test").message_server_asio;
+        for (var j = 0; j < 10; j++) {
+            assert.writeOK(coll.insert({conn: i, n: j}));
+        }
+    });
+    conns.forEach(function(c, i) {
+        assert.eq(10, c.getDB("test").message_server_asio.find({conn: i}).itcount());
+    });
+
+    // Block both workers. Requests from other connections must still be served by extra workers.
+    var sleepers = [];
+    for (var i = 0; i < 2; i++) {
+        sleepers.push(startParallelShell(
+            "assert.commandWorked(db.adminCommand({sleep: 1, secs: 5, lock: 'none'}));",
+            conn.port));
+    }
+    assert.soon(function() {
+        var inprog = conn.getDB("admin").currentOp().inprog.filter(function(op) {
+            var cmd = op.command || op.query;
+            return cmd && cmd.sleep;
+        });
+        return inprog.length === 2;
+    });
+    assert.eq(100, conn.getDB("test").message_server_asio.count());
+    metrics = conn.getDB("admin").serverStatus().metrics.network.messageServer;
+    assert.gt(metrics.workers, 2, tojson(metrics));
+
+    sleepers.forEach(function(join) {
+        join();
+    });
+    conns.forEach(function(c) {
+        c.getDB("admin").runCommand({ping: 1});
+    });
+
+    MongoRunner.stopMongod(conn);
+}());
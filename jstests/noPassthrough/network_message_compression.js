@@ -0,0 +1,63 @@
+// Tests that replica set members which enable wire protocol compression negotiate it with each
+// other, and that a member which doesn't still replicates from them uncompressed.
+(function() {
+    "use strict";
+
+    function compressionStats(conn) {
+        return conn.getDB("admin").serverStatus().network.compression;
+    }
+
+    var rst = new ReplSetTest({
+        nodes: [
+            {setParameter: {networkMessageCompressors: "snappy,zlib"}},
+            {setParameter: {networkMessageCompressors: "snappy,zlib"}},
+            {setParameter: {networkMessageCompressors: "disabled"}},
+        ]
+    });
+    rst.startSet();
+    var nodes = rst.nodeList();
+    rst.initiate({
+        _id: rst.name,
+        members: [
+            {_id: 0, host: nodes[0]},
+            {_id: 1, host: nodes[1], priority: 0},
+            {_id: 2, host: nodes[2], priority: 0},
+        ]
+    });
+
+    var primary = rst.getPrimary();
+    var coll = primary.getDB("test").network_message_compression;
+    var bulk = coll.initializeUnorderedBulkOp();
+    for (var i = 0; i < 1000; i++) {
+        bulk.insert({_id: i, pad: new Array(256).join("x")});
+    }
+    assert.writeOK(bulk.execute({w: 3}));
+
+    rst.getSecondaries().forEach(function(secondary) {
+        assert.eq(1000, secondary.getDB("test").network_message_compression.count());
+    });
+
+    // The shell doesn't enable compression, so it gets uncompressed replies.
+    var stats = compressionStats(primary);
+    assert(stats.hasOwnProperty("snappy"), tojson(stats));
+    assert(stats.hasOwnProperty("zlib"), tojson(stats));
+
+    // The first secondary talks to the primary with snappy, the first compressor both offer.
+    stats = compressionStats(rst.nodes[1]);
+    assert.gt(stats.snappy.compressor.bytesIn, 0, tojson(stats));
+    assert.gt(stats.snappy.decompressor.bytesOut, 0, tojson(stats));
+    assert.eq(0, stats.zlib.decompressor.bytesIn, tojson(stats));
+
+    stats = compressionStats(primary);
+    assert.gt(stats.snappy.compressor.bytesIn, 0, tojson(stats));
+
+    // The other secondary doesn't offer compression, so nothing it sends or receives is.
+    stats = compressionStats(rst.nodes[2]);
+    assert.eq(0, stats.snappy.compressor.bytesIn, tojson(stats));
+    assert.eq(0, stats.snappy.decompressor.bytesIn, tojson(stats));
+
+    // Startup fails if an unknown compressor is named.
+    assert.eq(null, MongoRunner.runMongod({setParameter: {networkMessageCompressors: "lz4"}}));
+
+    rst.stopSet();
+}());
@@ -0,0 +1,66 @@
+// Tests that the resources used by an operation are reported in system.profile, currentOp and the
+// serverStatus operation metrics.
+
+(function() {
+    "use strict";
+
+    var coll = db.op_resource_usage;
+    coll.drop();
+
+    var isWiredTiger = (db.serverStatus().storageEngine.name === "wiredTiger");
+
+    db.setProfilingLevel(0);
+    db.system.profile.drop();
+
+    var metricsBefore = db.serverStatus().metrics.operation;
+
+    db.setProfilingLevel(2);
+
+    var doc = {a: 1, pad: new Array(1024).join("x")};
+    assert.writeOK(coll.insert(doc));
+    assert.eq(1, coll.find({a: 1}).comment("op_resource_usage").itcount());
+
+    db.setProfilingLevel(0);
+
+    var insertEntry = db.system.profile.findOne({op: "insert", ns: coll.getFullName()});
+    assert.neq(null, insertEntry);
+    var findEntry = db.system.profile.findOne({"query.comment": "op_resource_usage"});
+    assert.neq(null, findEntry);
+
+    [insertEntry, findEntry].forEach(function(entry) {
+        assert(entry.hasOwnProperty("lockWaitMicros"), tojson(entry));
+        assert(entry.hasOwnProperty("ticketWaitMicros"), tojson(entry));
+        assert.gte(entry.ticketWaitMicros, 0, tojson(entry));
+        if (entry.hasOwnProperty("cpuNanos")) {
+            assert.gte(entry.cpuNanos, 0, tojson(entry));
+        }
+    });
+
+    if (isWiredTiger) {
+        assert.gte(insertEntry.storageBytesWritten, Object.bsonsize(doc), tojson(insertEntry));
+        assert.gte(findEntry.storageBytesRead, Object.bsonsize(doc), tojson(findEntry));
+        assert.eq(0, findEntry.storageBytesWritten, tojson(findEntry));
+
+        var metricsAfter = db.serverStatus().metrics.operation;
+        assert.gte(metricsAfter.storageBytesRead - metricsBefore.storageBytesRead,
+                   Object.bsonsize(doc),
+                   tojson(metricsAfter));
+        assert.gte(metricsAfter.storageBytesWritten - metricsBefore.storageBytesWritten,
+                   Object.bsonsize(doc),
+                   tojson(metricsAfter));
+    }
+
+    // The currentOp command reports the resources used so far by each active operation, including
+    // its own.
+    var inprog = db.currentOp().inprog;
+    var active = inprog.filter(function(op) {
+        return op.active;
+    });
+    assert.gt(active.length, 0, tojson(inprog));
+    active.forEach(function(op) {
+        assert(op.hasOwnProperty("lockWaitMicros"), tojson(op));
+        assert(op.hasOwnProperty("ticketWaitMicros"), tojson(op));
+    });
+
+    db.system.profile.drop();
+}());
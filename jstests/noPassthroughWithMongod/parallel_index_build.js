@@ -0,0 +1,72 @@
+// Tests that foreground index builds which generate and sort their keys on several threads produce
+// the same indexes as serial builds, and that errors from the key generation threads fail the
+// build.
+
+(function() {
+    "use strict";
+
+    var coll = db.parallel_index_build;
+    coll.drop();
+
+    function setParallelism(n) {
+        assert.commandWorked(
+            db.adminCommand({setParameter: 1, internalIndexBuildMaxDegreeOfParallelism: n}));
+    }
+
+    var bulk = coll.initializeUnorderedBulkOp();
+    for (var i = 0; i < 20000; i++) {
+        bulk.insert({
+            _id: i,
+            a: i % 97,
+            b: "str" + (i % 13),
+            c: [i % 7, (i + 1) % 7],
+            d: (i % 2 === 0) ? i : null,
+            pad: new Array(64).join("x")
+        });
+    }
+    assert.writeOK(bulk.execute());
+
+    var specs = [
+        {key: {a: 1}, name: "a_1"},
+        {key: {b: -1, a: 1}, name: "b_-1_a_1"},
+        {key: {c: 1}, name: "c_1"},
+        {key: {d: 1}, name: "d_1", partialFilterExpression: {d: {$gt: 100}}},
+        {key: {_id: 1, a: -1}, name: "_id_1_a_-1", unique: true},
+    ];
+
+    // Returns the contents of each index, in index order.
+    function dumpIndexes() {
+        return specs.map(function(spec) {
+            var query = spec.partialFilterExpression || {};
+            return coll.find(query, {_id: 1}).hint(spec.name).toArray();
+        });
+    }
+
+    setParallelism(1);
+    assert.commandWorked(db.runCommand({createIndexes: coll.getName(), indexes: specs}));
+    var expected = dumpIndexes();
+    assert.eq(20000 * 2, coll.find().hint("c_1").itcount());
+
+    assert.commandWorked(coll.dropIndexes());
+
+    setParallelism(4);
+    assert.commandWorked(db.runCommand({createIndexes: coll.getName(), indexes: specs}));
+    assert.eq(expected, dumpIndexes());
+    assert(coll.validate(true).valid);
+
+    // A unique index violation is found when the threads' keys are merged.
+    assert.writeOK(coll.insert({_id: 20000, a: 1, e: 5}));
+    assert.writeOK(coll.insert({_id: 20001, a: 2, e: 5}));
+    assert.commandFailedWithCode(
+        db.runCommand(
+            {createIndexes: coll.getName(), indexes: [{key: {e: 1}, name: "e_1", unique: true}]}),
+        ErrorCodes.DuplicateKey);
+
+    // An error generating keys on one of the threads fails the build.
+    assert.writeOK(coll.insert({_id: 20002, x: [1, 2], y: [1, 2]}));
+    assert.commandFailed(db.runCommand(
+        {createIndexes: coll.getName(), indexes: [{key: {x: 1, y: 1}, name: "x_1_y_1"}]}));
+    assert.eq(6, coll.getIndexes().length);
+
+    setParallelism(1);
+}());
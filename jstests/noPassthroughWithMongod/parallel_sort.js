@@ -0,0 +1,58 @@
+// Tests that a $sort which sorts its input on several threads returns the same results, in the same
+// order, as one which sorts on the pipeline's thread.
+
+(function() {
+    "use strict";
+
+    var coll = db.parallel_sort;
+    coll.drop();
+
+    function setParallelism(n) {
+        assert.commandWorked(db.adminCommand(
+            {setParameter: 1, internalDocumentSourceSortMaxDegreeOfParallelism: n}));
+    }
+
+    var bulk = coll.initializeUnorderedBulkOp();
+    for (var i = 0; i < 20000; i++) {
+        bulk.insert({
+            _id: i,
+            a: i % 97,
+            b: "str" + (i % 13),
+            c: {d: (i * 7) % 101},
+            e: (i % 5 === 0) ? null : i % 17,
+            pad: new Array(64).join("x")
+        });
+    }
+    assert.writeOK(bulk.execute());
+
+    // Sort keys with many ties, so that the order of equal documents is checked as well. Each
+    // pipeline starts with an $unwind of a scalar field, which passes every document through, so
+    // that the $sort is not absorbed into the query.
+    var pipelines = [
+        [{$sort: {a: 1}}],
+        [{$sort: {b: -1, a: 1}}],
+        [{$sort: {"c.d": 1}}, {$project: {_id: 1, a: 1}}],
+        [{$sort: {e: 1}}, {$group: {_id: "$e", ids: {$push: "$_id"}}}, {$sort: {_id: 1}}],
+        [{$sort: {a: -1, _id: 1}}, {$limit: 50}],
+        [{$sort: {b: 1}}, {$skip: 100}, {$project: {b: 1, c: 1}}],
+    ].map(function(pipeline) {
+        return [{$unwind: "$b"}].concat(pipeline);
+    });
+
+    function runAll(options) {
+        return pipelines.map(function(pipeline) {
+            return coll.aggregate(pipeline, options).toArray();
+        });
+    }
+
+    setParallelism(1);
+    var expected = runAll({});
+    var expectedDiskUse = runAll({allowDiskUse: true});
+
+    setParallelism(4);
+    assert.eq(expected, runAll({}));
+    assert.eq(expectedDiskUse, runAll({allowDiskUse: true}));
+    assert.eq(expected, expectedDiskUse);
+
+    setParallelism(1);
+}());
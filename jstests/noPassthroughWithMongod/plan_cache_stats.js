@@ -0,0 +1,52 @@
+// Tests the plan cache counters reported by collStats and serverStatus, and the works history
+// reported by planCacheListPlans.
+
+(function() {
+    "use strict";
+
+    var coll = db.plan_cache_stats;
+    coll.drop();
+
+    for (var i = 0; i < 100; i++) {
+        assert.writeOK(coll.insert({a: i, b: i % 10}));
+    }
+    assert.commandWorked(coll.ensureIndex({a: 1}));
+    assert.commandWorked(coll.ensureIndex({b: 1}));
+
+    function planCacheStats() {
+        var res = coll.stats();
+        assert.commandWorked(res);
+        return res.planCache;
+    }
+
+    var globalBefore = db.serverStatus().metrics.query.planCache;
+    assert.eq({entries: 0, hits: 0, misses: 0, evictions: 0, replans: 0}, planCacheStats());
+
+    // The first execution misses and caches a plan. The others hit.
+    var numExecutions = 5;
+    for (var i = 0; i < numExecutions; i++) {
+        assert.eq(1, coll.find({a: 5, b: 5}).itcount());
+    }
+
+    var stats = planCacheStats();
+    assert.eq(1, stats.entries, tojson(stats));
+    assert.eq(1, stats.misses, tojson(stats));
+    assert.eq(numExecutions - 1, stats.hits, tojson(stats));
+
+    var globalAfter = db.serverStatus().metrics.query.planCache;
+    assert.gte(globalAfter.hits - globalBefore.hits, numExecutions - 1, tojson(globalAfter));
+    assert.gte(globalAfter.misses - globalBefore.misses, 1, tojson(globalAfter));
+    assert(globalAfter.hasOwnProperty("evictions"), tojson(globalAfter));
+    assert(globalAfter.hasOwnProperty("replans"), tojson(globalAfter));
+
+    // Each run of the cached plan records the works it took during its trial period.
+    var res = coll.runCommand("planCacheListPlans", {query: {a: 5, b: 5}});
+    assert.commandWorked(res);
+    var feedback = res.plans[0].feedback;
+    assert.eq(numExecutions - 1, feedback.nfeedback, tojson(feedback));
+    assert.gt(feedback.works, 0, tojson(feedback));
+    feedback.scores.forEach(function(score) {
+        assert.gt(score.works, 0, tojson(feedback));
+        assert.eq(1, score.advanced, tojson(feedback));
+    });
+}());
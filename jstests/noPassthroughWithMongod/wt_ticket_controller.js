@@ -0,0 +1,64 @@
+// Tests that the WiredTiger ticket controller can be enabled at runtime and reports its activity in
+// serverStatus.
+(function() {
+    "use strict";
+
+    var status = db.serverStatus();
+    if (status.storageEngine.name !== "wiredTiger") {
+        jsTest.log("skipping test since the storage engine isn't WiredTiger");
+        return;
+    }
+
+    var controller = status.wiredTiger.concurrentTransactions.controller;
+    assert.eq(false, controller.enabled, tojson(controller));
+    ["read", "write"].forEach(function(kind) {
+        assert(controller[kind].hasOwnProperty("increases"), tojson(controller));
+        assert(controller[kind].hasOwnProperty("decreases"), tojson(controller));
+        assert(controller[kind].hasOwnProperty("queuedAcquisitions"), tojson(controller));
+    });
+
+    var originalWriteTickets = status.wiredTiger.concurrentTransactions.write.totalTickets;
+    var originalReadTickets = status.wiredTiger.concurrentTransactions.read.totalTickets;
+
+    function setParameter(params) {
+        params.setParameter = 1;
+        assert.commandWorked(db.adminCommand(params));
+    }
+
+    setParameter({
+        wiredTigerTicketControllerIntervalMillis: 100,
+        wiredTigerTicketControllerMinTickets: 8,
+        wiredTigerTicketControllerMaxTickets: 64,
+        // Force cache pressure so that the controller shrinks both holders to the floor.
+        wiredTigerTicketControllerCacheUsedHighPct: 0,
+        wiredTigerTicketControllerEnabled: true
+    });
+
+    assert.soon(function() {
+        var txns = db.serverStatus().wiredTiger.concurrentTransactions;
+        return txns.write.totalTickets === 8 && txns.read.totalTickets === 8;
+    }, "the ticket controller didn't shrink the ticket holders to the floor");
+
+    controller = db.serverStatus().wiredTiger.concurrentTransactions.controller;
+    assert.eq(true, controller.enabled, tojson(controller));
+    assert.gt(controller.write.decreases, 0, tojson(controller));
+    assert.eq("cachePressure", controller.write.lastResizeReason, tojson(controller));
+
+    // Once disabled, the ticket counts are only changed by hand. Wait for the controller to finish
+    // the interval it may be in.
+    setParameter({wiredTigerTicketControllerEnabled: false});
+    sleep(500);
+    setParameter({
+        wiredTigerTicketControllerCacheUsedHighPct: 95,
+        wiredTigerTicketControllerIntervalMillis: 1000,
+        wiredTigerTicketControllerMinTickets: 16,
+        wiredTigerTicketControllerMaxTickets: 512
+    });
+    setParameter({
+        wiredTigerConcurrentWriteTransactions: originalWriteTickets,
+        wiredTigerConcurrentReadTransactions: originalReadTickets
+    });
+    var txns = db.serverStatus().wiredTiger.concurrentTransactions;
+    assert.eq(originalWriteTickets, txns.write.totalTickets, tojson(txns));
+    assert.eq(originalReadTickets, txns.read.totalTickets, tojson(txns));
+}());
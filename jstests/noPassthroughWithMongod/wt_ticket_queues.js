@@ -0,0 +1,26 @@
+// Tests that serverStatus reports the per-class queues of operations waiting for WiredTiger read
+// and write tickets.
+(function() {
+    "use strict";
+
+    var status = db.serverStatus();
+    if (status.storageEngine.name !== "wiredTiger") {
+        jsTest.log("skipping test since the storage engine isn't WiredTiger");
+        return;
+    }
+
+    var classes = ["pointRead", "scan", "write", "internal", "admin"];
+    var buckets = ["lt100us", "lt1ms", "lt10ms", "lt100ms", "lt1s", "ge1s"];
+
+    ["read", "write"].forEach(function(kind) {
+        var queues = status.wiredTiger.concurrentTransactions[kind].queues;
+        assert.eq(classes, Object.keys(queues), tojson(queues));
+        classes.forEach(function(queueClass) {
+            var queue = queues[queueClass];
+            assert.gte(queue.queued, 0, tojson(queue));
+            assert.gte(queue.waits, 0, tojson(queue));
+            assert.gte(queue.waitMicros, 0, tojson(queue));
+            assert.eq(buckets, Object.keys(queue.waitHistogram), tojson(queue));
+        });
+    });
+}());
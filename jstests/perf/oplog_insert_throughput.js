@@ -0,0 +1,63 @@
+/**
+ * Measures the rate at which a primary writes oplog entries for inserts from several threads,
+ * both for single document inserts spread over several collections and for batched inserts.
+ * Prints the number of oplog entries written per second for each case.
+ */
+(function() {
+    "use strict";
+
+    var rst = new ReplSetTest({nodes: 1});
+    rst.startSet();
+    rst.initiate();
+
+    var primary = rst.getPrimary();
+    var testDB = primary.getDB("oplog_insert_throughput");
+    var oplog = primary.getDB("local").oplog.rs;
+    var seconds = 10;
+
+    function insertOps(numCollections, batchSize) {
+        var doc = {x: {"#RAND_INT": [0, 1000000]}, pad: new Array(100).join("x")};
+        var docs = [];
+        for (var i = 0; i < batchSize; i++) {
+            docs.push(doc);
+        }
+
+        var ops = [];
+        for (var i = 0; i < numCollections; i++) {
+            ops.push({
+                op: "insert",
+                ns: testDB.getName() + ".coll" + i,
+                doc: (batchSize > 1) ? docs : doc,
+                writeCmd: true
+            });
+        }
+        return ops;
+    }
+
+    function measure(threads, numCollections, batchSize) {
+        assert.commandWorked(testDB.dropDatabase());
+        var before = oplog.find().sort({$natural: -1}).limit(1).next().ts;
+
+        var start = new Date();
+        benchRun({
+            ops: insertOps(numCollections, batchSize),
+            parallel: threads,
+            seconds: seconds,
+            host: primary.host
+        });
+        var elapsedSecs = (new Date() - start) / 1000;
+
+        var entries = oplog.find({ts: {$gt: before}, op: "i"}).itcount();
+        print("oplog insert throughput: threads: " + threads + ", collections: " + numCollections +
+              ", batch size: " + batchSize + ", entries/sec: " +
+              Math.round(entries / elapsedSecs));
+    }
+
+    [1, 4, 16].forEach(function(threads) {
+        measure(threads, 1, 1);
+        measure(threads, 8, 1);
+        measure(threads, 1, 100);
+    });
+
+    rst.stopSet();
+}());
@@ -0,0 +1,79 @@
+// Tests that secondaries apply updates and deletes which target a single _id, including ones which
+// grow, shrink or replace documents and ones which change indexed fields, to the same result as the
+// primary.
+
+(function() {
+    "use strict";
+
+    var rst = new ReplSetTest({name: "apply_updates_deletes_by_id", nodes: 2});
+    rst.startSet();
+    rst.initiate();
+
+    var primary = rst.getPrimary();
+    var secondary = rst.getSecondary();
+    secondary.setSlaveOk();
+    var coll = primary.getDB("test").apply_by_id;
+    var secondaryColl = secondary.getDB("test").apply_by_id;
+
+    assert.commandWorked(coll.ensureIndex({a: 1}));
+    var before = secondary.getDB("test").serverStatus().metrics.repl.apply;
+
+    var bulk = coll.initializeOrderedBulkOp();
+    for (var i = 0; i < 100; i++) {
+        bulk.insert({_id: i, a: i, b: "x", c: [1, 2, 3]});
+    }
+    assert.writeOK(bulk.execute({w: 2}));
+
+    bulk = coll.initializeOrderedBulkOp();
+    for (var i = 0; i < 100; i++) {
+        switch (i % 6) {
+            case 0:
+                // Same size, unindexed field.
+                bulk.find({_id: i}).updateOne({$inc: {c: 1}});
+                break;
+            case 1:
+                // Indexed field.
+                bulk.find({_id: i}).updateOne({$set: {a: -i}});
+                break;
+            case 2:
+                // Grows the document.
+                bulk.find({_id: i}).updateOne({$set: {b: new Array(256).join("y")}, $push: {c: 4}});
+                break;
+            case 3:
+                // Shrinks the document.
+                bulk.find({_id: i}).updateOne({$unset: {b: 1, c: 1}});
+                break;
+            case 4:
+                bulk.find({_id: i}).replaceOne({z: i});
+                break;
+            case 5:
+                bulk.find({_id: i}).removeOne();
+                break;
+        }
+    }
+    assert.writeOK(bulk.execute({w: 2}));
+
+    assert.eq(coll.find().sort({_id: 1}).toArray(), secondaryColl.find().sort({_id: 1}).toArray());
+    assert.eq(coll.find({}, {_id: 0, a: 1}).hint({a: 1}).toArray(),
+              secondaryColl.find({}, {_id: 0, a: 1}).hint({a: 1}).toArray());
+
+    var after = secondary.getDB("test").serverStatus().metrics.repl.apply;
+    assert.gt(after.idUpdates, before.idUpdates, tojson(after));
+    assert.gt(after.idDeletes, before.idDeletes, tojson(after));
+
+    // applyOps on the primary keeps going through the general update and delete path.
+    var primaryBefore = primary.getDB("test").serverStatus().metrics.repl.apply;
+    assert.commandWorked(primary.getDB("test").runCommand({
+        applyOps: [
+            {op: "u", ns: coll.getFullName(), o2: {_id: 0}, o: {$set: {b: "z"}}},
+            {op: "d", ns: coll.getFullName(), o: {_id: 6}}
+        ]
+    }));
+    assert.eq("z", coll.findOne({_id: 0}).b);
+    assert.eq(null, coll.findOne({_id: 6}));
+    var primaryAfter = primary.getDB("test").serverStatus().metrics.repl.apply;
+    assert.eq(primaryBefore.idUpdates, primaryAfter.idUpdates, tojson(primaryAfter));
+    assert.eq(primaryBefore.idDeletes, primaryAfter.idDeletes, tojson(primaryAfter));
+
+    rst.stopSet();
+}());
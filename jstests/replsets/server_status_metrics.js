@@ -19,6 +19,11 @@ function testSecondaryMetrics(secondary, opCount, offset) {
     assert(ss.metrics.repl.buffer.count >= 0, "buffer count missing");
     assert(ss.metrics.repl.buffer.sizeBytes >= 0, "size (bytes)] missing");
     assert(ss.metrics.repl.buffer.maxSizeBytes >= 0, "maxSize (bytes) missing");
+    assert(ss.metrics.repl.buffer.fillRatio >= 0, "fill ratio missing");
+    assert(ss.metrics.repl.buffer.fillRatio <= 1, "fill ratio above 1");
+    assert(ss.metrics.repl.buffer.bytesPerSecond >= 0, "bytes per second missing");
+    assert(ss.metrics.repl.buffer.fetchStalls.num >= 0, "fetch stalls num missing");
+    assert(ss.metrics.repl.buffer.fetchStalls.totalMillis >= 0, "fetch stalls time missing");
 
     assert(ss.metrics.repl.preload.docs.num >= 0, "preload.docs num  missing");
     assert(ss.metrics.repl.preload.docs.totalMillis  >= 0, "preload.docs time missing");
@@ -28,6 +33,12 @@ function testSecondaryMetrics(secondary, opCount, offset) {
     assert(ss.metrics.repl.apply.batches.num > 0, "no batches");
     assert(ss.metrics.repl.apply.batches.totalMillis >= 0, "missing batch time");
     assert.eq(ss.metrics.repl.apply.ops, opCount + offset, "wrong number of applied ops");
+
+    assert(ss.metrics.repl.apply.pipeline.depth >= 0, "pipeline depth missing");
+    assert(ss.metrics.repl.apply.barrierWait.num > 0, "no barrier waits");
+    assert(ss.metrics.repl.apply.barrierWait.totalMillis >= 0, "missing barrier wait time");
+    assert(Array.isArray(ss.metrics.repl.apply.writerIdleMillis), "writer idle time missing");
+    assert.gt(ss.metrics.repl.apply.writerIdleMillis.length, 0, "no writers");
 }
 
 var rt = new ReplSetTest( { name : "server_status_metrics" , nodes: 2, oplogSize: 100 } );
@@ -0,0 +1,54 @@
+// Tests that sharded queries return the same results with and without mongos prefetching the
+// shards' next batches, and that the prefetch counters are reported by serverStatus.
+
+(function() {
+    "use strict";
+
+    var st = new ShardingTest({shards: 2, mongos: 1});
+
+    var mongos = st.s0;
+    var admin = mongos.getDB("admin");
+    var coll = mongos.getCollection("foo.bar");
+
+    assert.commandWorked(admin.runCommand({enableSharding: coll.getDB() + ""}));
+    st.ensurePrimaryShard(coll.getDB() + "", "shard0000");
+    assert.commandWorked(admin.runCommand({shardCollection: coll + "", key: {_id: 1}}));
+    assert.commandWorked(admin.runCommand({split: coll + "", middle: {_id: 0}}));
+    assert.commandWorked(
+        admin.runCommand({moveChunk: coll + "", find: {_id: 0}, to: "shard0001"}));
+
+    var bulk = coll.initializeUnorderedBulkOp();
+    for (var i = -1000; i < 1000; i++) {
+        bulk.insert({_id: i, pad: new Array(256).join("x")});
+    }
+    assert.writeOK(bulk.execute());
+
+    function setPrefetch(enabled) {
+        assert.commandWorked(
+            admin.runCommand({setParameter: 1, internalQueryMongosPrefetchResults: enabled}));
+    }
+
+    function runQueries() {
+        return {
+            sorted: coll.find({}, {_id: 1}).sort({_id: 1}).batchSize(50).toArray(),
+            unsorted: coll.find({}, {_id: 1}).batchSize(50).itcount()
+        };
+    }
+
+    setPrefetch(false);
+    var expected = runQueries();
+    assert.eq(2000, expected.sorted.length);
+    assert.eq(2000, expected.unsorted);
+
+    setPrefetch(true);
+    assert.eq(expected, runQueries());
+
+    var stats = mongos.getDB("admin").serverStatus().metrics.cursor.prefetch;
+    ["requests", "hits", "stalls", "stallMicros"].forEach(function(field) {
+        assert(stats.hasOwnProperty(field), tojson(stats));
+        assert.gte(stats[field], 0, tojson(stats));
+    });
+    assert.gt(stats.stalls, 0, tojson(stats));
+
+    st.stop();
+}());
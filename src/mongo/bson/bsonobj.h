@@ -185,6 +185,18 @@ public:
     /** @return a new full (and owned) copy of the object. */
     BSONObj copy() const;
 
+    /** @return the buffer owning this object's data; null if the object is not owned. */
+    const SharedBuffer& sharedBuffer() const {
+        return _ownedBuffer;
+    }
+
+    /** Makes this object owned by sharing 'buffer', which must contain this object's data.
+        Used to hand out subobjects of a large owned object without copying each of them.
+    */
+    void shareOwnershipWith(const SharedBuffer& buffer) {
+        _ownedBuffer = buffer;
+    }
+
     /** Readable representation of a BSON object in an extended JSON-style notation.
         This is an abbreviated representation which might be used for logging.
     */
@@ -130,7 +130,15 @@ Status parseCursorResponse(const BSONObj& obj,
                                         << "'" << kCursorFieldName << "." << batchFieldName
                                         << "' field: " << obj);
         }
-        batchData->documents.push_back(itemElement.Obj().getOwned());
+        // The documents are views into 'obj', so the reply is held by the documents as long as
+        // any of them is in use, rather than each document being copied out of it.
+        BSONObj document = itemElement.Obj();
+        if (obj.isOwned()) {
+            document.shareOwnershipWith(obj.sharedBuffer());
+        } else {
+            document = document.getOwned();
+        }
+        batchData->documents.push_back(std::move(document));
     }
 
     return Status::OK();
@@ -244,7 +252,8 @@ void Fetcher::_callback(const RemoteCommandCallbackArgs& rcbd, const char* batch
         return;
     }
 
-    const BSONObj& queryResponseObj = rcbd.response.getValue().data;
+    // Copy the reply out of the network message once so that the documents can share it.
+    const BSONObj queryResponseObj = rcbd.response.getValue().data.getOwned();
     Status status = getStatusFromCommandResult(queryResponseObj);
     if (!status.isOK()) {
         _work(StatusWith<Fetcher::QueryResponse>(status), nullptr, nullptr);
@@ -435,6 +435,25 @@ TEST_F(FetcherTest, FetchOneDocument) {
     ASSERT_EQUALS(doc, documents.front());
 }
 
+TEST_F(FetcherTest, FetchedDocumentsShareReplyBuffer) {
+    ASSERT_OK(fetcher->schedule());
+    const BSONObj doc1 = BSON("_id" << 1);
+    const BSONObj doc2 = BSON("_id" << 2);
+    processNetworkResponse(
+        BSON("cursor" << BSON("id" << 0LL << "ns"
+                                   << "db.coll"
+                                   << "firstBatch" << BSON_ARRAY(doc1 << doc2)) << "ok" << 1));
+    ASSERT_OK(status);
+    ASSERT_EQUALS(2U, documents.size());
+    ASSERT_EQUALS(doc1, documents[0]);
+    ASSERT_EQUALS(doc2, documents[1]);
+
+    // Both documents point into the same owned copy of the reply.
+    ASSERT_TRUE(documents[0].isOwned());
+    ASSERT_TRUE(documents[1].isOwned());
+    ASSERT_EQUALS(documents[0].sharedBuffer().get(), documents[1].sharedBuffer().get());
+}
+
 TEST_F(FetcherTest, SetNextActionToContinueWhenNextBatchIsNotAvailable) {
     ASSERT_OK(fetcher->schedule());
     const BSONObj doc = BSON("_id" << 1);
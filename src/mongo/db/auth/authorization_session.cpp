@@ -499,6 +499,17 @@ bool AuthorizationSession::isAuthenticatedAsUserWithRole(const RoleName& roleNam
     return false;
 }
 
+bool AuthorizationSession::isAuthenticatedAsInternalUser() {
+    for (UserSet::iterator it = _authenticatedUsers.begin(); it != _authenticatedUsers.end();
+         ++it) {
+        if ((*it)->getActionsForResource(ResourcePattern::forClusterResource())
+                .contains(ActionType::internal)) {
+            return true;
+        }
+    }
+    return false;
+}
+
 void AuthorizationSession::_refreshUserInfoAsNeeded(OperationContext* txn) {
     AuthorizationManager& authMan = getAuthorizationManager();
     UserSet::iterator it = _authenticatedUsers.begin();
@@ -201,6 +201,11 @@ public:
     // NOTE: this does not refresh any of the users even if they are marked as invalid.
     bool isAuthenticatedAsUserWithRole(const RoleName& roleName);
 
+    // Returns true if any of the authenticated users on this session may perform internal
+    // actions on the cluster, as the members of a replica set or sharded cluster do.
+    // NOTE: this does not refresh any of the users even if they are marked as invalid.
+    bool isAuthenticatedAsInternalUser();
+
     // Returns true if this session is authorized for the given Privilege.
     //
     // Contains all the authorization logic including handling things like the localhost
@@ -35,6 +35,7 @@
 #include "mongo/db/catalog/collection_info_cache.h"
 
 #include "mongo/db/catalog/collection.h"
+#include "mongo/db/commands/server_status_metric.h"
 #include "mongo/db/concurrency/d_concurrency.h"
 #include "mongo/db/fts/fts_spec.h"
 #include "mongo/db/index/index_descriptor.h"
@@ -48,6 +49,17 @@
 
 namespace mongo {
 
+namespace {
+ServerStatusMetricField<Counter64> displayPlanCacheHits("query.planCache.hits",
+                                                        &PlanCache::getGlobalStats().hits);
+ServerStatusMetricField<Counter64> displayPlanCacheMisses("query.planCache.misses",
+                                                          &PlanCache::getGlobalStats().misses);
+ServerStatusMetricField<Counter64> displayPlanCacheEvictions(
+    "query.planCache.evictions", &PlanCache::getGlobalStats().evictions);
+ServerStatusMetricField<Counter64> displayPlanCacheReplans("query.planCache.replans",
+                                                           &PlanCache::getGlobalStats().replans);
+}  // namespace
+
 CollectionInfoCache::CollectionInfoCache(Collection* collection)
     : _collection(collection),
       _keysComputed(false),
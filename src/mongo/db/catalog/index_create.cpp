@@ -34,6 +34,7 @@
 
 #include "mongo/db/catalog/index_create.h"
 
+#include <deque>
 
 #include "mongo/base/error_codes.h"
 #include "mongo/client/dbclientinterface.h"
@@ -48,7 +49,10 @@
 #include "mongo/db/query/internal_plans.h"
 #include "mongo/db/repl/replication_coordinator_global.h"
 #include "mongo/db/operation_context.h"
+#include "mongo/db/server_parameters.h"
+#include "mongo/stdx/condition_variable.h"
 #include "mongo/stdx/mutex.h"
+#include "mongo/stdx/thread.h"
 #include "mongo/util/log.h"
 #include "mongo/util/processinfo.h"
 #include "mongo/util/progress_meter.h"
@@ -59,6 +63,22 @@ using std::unique_ptr;
 using std::string;
 using std::endl;
 
+// Number of threads which generate and sort the keys of a foreground index build. Background
+// builds and builds with a value of 1 generate the keys on the thread that scans the collection.
+MONGO_EXPORT_SERVER_PARAMETER(internalIndexBuildMaxDegreeOfParallelism, int, 1);
+
+namespace {
+// The memory each index's keys may use before they are spilled to disk. Shared between the key
+// generation threads of a parallel build.
+const size_t kMaxIndexBuildMemoryUsageBytes = 100 * 1024 * 1024;
+
+// Documents are handed to the key generation threads in batches of about this many bytes.
+const size_t kKeyGenerationBatchBytes = 1024 * 1024;
+
+// Number of batches per key generation thread that the collection scan may get ahead by.
+const size_t kQueuedBatchesPerThread = 2;
+}  // namespace
+
 /**
  * On rollback sets MultiIndexBlock::_needToCleanup to true.
  */
@@ -93,6 +113,161 @@ private:
     MultiIndexBlock* const _indexer;
 };
 
+/**
+ * Generates the keys of documents for every index being built and sorts them, using several
+ * threads. Thread 't' inserts into the BulkBuilder of each index numbered 't', where 0 is
+ * IndexToBuild::bulk and the others are IndexToBuild::extraBulks, so no BulkBuilder is shared.
+ *
+ * The threads do not use an OperationContext, so they neither lock nor touch storage other than
+ * the sorters' spill files.
+ */
+class MultiIndexBlock::ParallelKeyGenerator {
+    MONGO_DISALLOW_COPYING(ParallelKeyGenerator);
+
+public:
+    using Batch = std::vector<std::pair<BSONObj, RecordId>>;
+
+    ParallelKeyGenerator(std::vector<IndexToBuild>* indexes, size_t numThreads)
+        : _indexes(indexes), _maxQueuedBatches(numThreads * kQueuedBatchesPerThread) {
+        for (size_t t = 0; t < numThreads; ++t) {
+            _threads.emplace_back(&ParallelKeyGenerator::_run, this, t);
+        }
+    }
+
+    ~ParallelKeyGenerator() {
+        {
+            stdx::lock_guard<stdx::mutex> lk(_mutex);
+            _aborted = true;
+            _batchQueued.notify_all();
+            _batchTaken.notify_all();
+        }
+        for (auto&& thread : _threads) {
+            thread.join();
+        }
+    }
+
+    /**
+     * Queues 'batch' for the next free thread, waiting while too many batches are queued.
+     * Returns the first error encountered by any thread.
+     */
+    Status push(Batch batch) {
+        stdx::unique_lock<stdx::mutex> lk(_mutex);
+        _batchTaken.wait(lk, [&] { return _aborted || _queue.size() < _maxQueuedBatches; });
+        if (_aborted) {
+            return _error;
+        }
+        _queue.push_back(std::move(batch));
+        _batchQueued.notify_one();
+        return Status::OK();
+    }
+
+    /**
+     * Tells the threads that no more batches will be pushed. Once they have processed the queued
+     * batches, each sorts the keys it generated.
+     */
+    void noMoreBatches() {
+        stdx::lock_guard<stdx::mutex> lk(_mutex);
+        _noMoreBatches = true;
+        _batchQueued.notify_all();
+    }
+
+    /**
+     * Waits up to 'timeout' for the threads to finish. Returns the number which have finished.
+     */
+    size_t waitForThreads(Milliseconds timeout) {
+        stdx::unique_lock<stdx::mutex> lk(_mutex);
+        _threadFinished.wait_for(lk, timeout, [&] { return _numFinished == _threads.size(); });
+        return _numFinished;
+    }
+
+    size_t numThreads() const {
+        return _threads.size();
+    }
+
+    /**
+     * Returns the first error encountered by any thread.
+     */
+    Status getStatus() {
+        stdx::lock_guard<stdx::mutex> lk(_mutex);
+        return _error;
+    }
+
+private:
+    IndexAccessMethod::BulkBuilder* _bulkFor(IndexToBuild& index, size_t threadIndex) {
+        return threadIndex == 0 ? index.bulk.get() : index.extraBulks[threadIndex - 1].get();
+    }
+
+    bool _isAborted() {
+        stdx::lock_guard<stdx::mutex> lk(_mutex);
+        return _aborted;
+    }
+
+    void _run(size_t threadIndex) {
+        try {
+            while (true) {
+                Batch batch;
+                {
+                    stdx::unique_lock<stdx::mutex> lk(_mutex);
+                    _batchQueued.wait(
+                        lk, [&] { return _aborted || _noMoreBatches || !_queue.empty(); });
+                    if (_aborted || _queue.empty()) {
+                        break;
+                    }
+                    batch = std::move(_queue.front());
+                    _queue.pop_front();
+                    _batchTaken.notify_one();
+                }
+
+                for (auto&& doc : batch) {
+                    for (auto&& index : *_indexes) {
+                        if (index.filterExpression &&
+                            !index.filterExpression->matchesBSON(doc.first)) {
+                            continue;
+                        }
+                        // BulkBuilder::insert() does not use the OperationContext.
+                        uassertStatusOK(_bulkFor(index, threadIndex)
+                                            ->insert(nullptr, doc.first, doc.second,
+                                                     index.options, nullptr));
+                    }
+                }
+            }
+
+            if (!_isAborted()) {
+                for (auto&& index : *_indexes) {
+                    _bulkFor(index, threadIndex)->sortKeys();
+                }
+            }
+        } catch (const DBException& ex) {
+            stdx::lock_guard<stdx::mutex> lk(_mutex);
+            if (_error.isOK()) {
+                _error = ex.toStatus();
+            }
+            _aborted = true;
+            _batchTaken.notify_all();
+            _batchQueued.notify_all();
+        }
+
+        stdx::lock_guard<stdx::mutex> lk(_mutex);
+        ++_numFinished;
+        _threadFinished.notify_all();
+    }
+
+    std::vector<IndexToBuild>* const _indexes;
+    const size_t _maxQueuedBatches;
+
+    stdx::mutex _mutex;
+    stdx::condition_variable _batchQueued;
+    stdx::condition_variable _batchTaken;
+    stdx::condition_variable _threadFinished;
+    std::deque<Batch> _queue;
+    bool _noMoreBatches = false;
+    bool _aborted = false;
+    size_t _numFinished = 0;
+    Status _error = Status::OK();
+
+    std::vector<stdx::thread> _threads;
+};
+
 MultiIndexBlock::MultiIndexBlock(OperationContext* txn, Collection* collection)
     : _collection(collection),
       _txn(txn),
@@ -217,6 +392,11 @@ Status MultiIndexBlock::init(const std::vector<BSONObj>& indexSpecs) {
 }
 
 Status MultiIndexBlock::insertAllDocumentsInCollection(std::set<RecordId>* dupsOut) {
+    const int maxDegreeOfParallelism = internalIndexBuildMaxDegreeOfParallelism;
+    if (!_buildInBackground && maxDegreeOfParallelism > 1 && !_indexes.empty()) {
+        return _insertAllDocumentsInParallel(maxDegreeOfParallelism, dupsOut);
+    }
+
     const char* curopMessage = _buildInBackground ? "Index Build (background)" : "Index Build";
     const auto numRecords = _collection->numRecords(_txn);
     stdx::unique_lock<Client> lk(*_txn->getClient());
@@ -304,6 +484,117 @@ Status MultiIndexBlock::insertAllDocumentsInCollection(std::set<RecordId>* dupsO
     return Status::OK();
 }
 
+Status MultiIndexBlock::_insertAllDocumentsInParallel(size_t numThreads,
+                                                      std::set<RecordId>* dupsOut) {
+    invariant(!_buildInBackground);
+
+    // Each thread needs its own BulkBuilder for every index. Split the memory budget of each
+    // index between them. Nothing has been inserted into the BulkBuilders made by init() yet.
+    const size_t maxMemoryUsageBytes = kMaxIndexBuildMemoryUsageBytes / numThreads;
+    for (auto&& index : _indexes) {
+        invariant(index.bulk);
+        index.bulk = index.real->initiateBulk(maxMemoryUsageBytes);
+        index.extraBulks.clear();
+        for (size_t t = 1; t < numThreads; ++t) {
+            index.extraBulks.push_back(index.real->initiateBulk(maxMemoryUsageBytes));
+        }
+    }
+
+    const char* curopMessage = "Index Build: (1/3) scanning collection and generating keys";
+    const auto numRecords = _collection->numRecords(_txn);
+    stdx::unique_lock<Client> lk(*_txn->getClient());
+    ProgressMeterHolder progress(*_txn->setMessage_inlock(curopMessage, curopMessage, numRecords));
+    lk.unlock();
+
+    log() << "\t generating index keys using " << numThreads << " threads";
+
+    Timer t;
+    unsigned long long n = 0;
+
+    {
+        ParallelKeyGenerator generator(&_indexes, numThreads);
+
+        unique_ptr<PlanExecutor> exec(InternalPlanner::collectionScan(
+            _txn, _collection->ns().ns(), _collection, PlanExecutor::WRITE_CONFLICT_RETRY_ONLY));
+
+        ParallelKeyGenerator::Batch batch;
+        size_t batchBytes = 0;
+
+        Snapshotted<BSONObj> objToIndex;
+        RecordId loc;
+        PlanExecutor::ExecState state;
+        while (PlanExecutor::ADVANCED == (state = exec->getNextSnapshotted(&objToIndex, &loc))) {
+            if (_allowInterruption)
+                _txn->checkForInterrupt();
+
+            // The documents outlive the scan's position, so they must be owned.
+            batchBytes += objToIndex.value().objsize();
+            batch.emplace_back(objToIndex.value().getOwned(), loc);
+
+            progress->setTotalWhileRunning(_collection->numRecords(_txn));
+            progress->hit();
+            n++;
+
+            if (batchBytes >= kKeyGenerationBatchBytes) {
+                Status status = generator.push(std::move(batch));
+                if (!status.isOK())
+                    return status;
+                batch.clear();
+                batchBytes = 0;
+            }
+        }
+
+        uassert(28550,
+                "Unable to complete index build due to collection scan failure: " +
+                    WorkingSetCommon::toStatusString(objToIndex.value()),
+                state == PlanExecutor::IS_EOF);
+
+        if (!batch.empty()) {
+            Status status = generator.push(std::move(batch));
+            if (!status.isOK())
+                return status;
+        }
+        generator.noMoreBatches();
+
+        progress->finished();
+        LOG(1) << "\t scanned " << n << " records in " << t.millis() << "ms";
+
+        // Wait for the threads to generate the remaining keys and sort them.
+        lk.lock();
+        ProgressMeterHolder sortProgress(
+            *_txn->setMessage_inlock("Index Build: (1/3) sorting keys",
+                                     "Index: (1/3) Key Generation Threads Finished",
+                                     numThreads));
+        lk.unlock();
+
+        size_t numFinished = 0;
+        while (numFinished < generator.numThreads()) {
+            const size_t nowFinished = generator.waitForThreads(Milliseconds(100));
+            sortProgress->hit(nowFinished - numFinished);
+            numFinished = nowFinished;
+
+            if (_allowInterruption)
+                _txn->checkForInterrupt();
+        }
+        sortProgress->finished();
+
+        Status status = generator.getStatus();
+        if (!status.isOK())
+            return status;
+    }
+
+    LOG(1) << "\t generated and sorted keys in " << t.millis() << "ms";
+
+    Status ret = doneInserting(dupsOut);
+    if (!ret.isOK())
+        return ret;
+
+    log() << "build index done.  scanned " << n << " total records. " << t.seconds() << " secs"
+          << endl;
+
+    return Status::OK();
+}
+
 Status MultiIndexBlock::insert(const BSONObj& doc, const RecordId& loc) {
     for (size_t i = 0; i < _indexes.size(); i++) {
         if (_indexes[i].filterExpression && !_indexes[i].filterExpression->matchesBSON(doc)) {
@@ -330,8 +621,15 @@ Status MultiIndexBlock::doneInserting(std::set<RecordId>* dupsOut) {
             continue;
         LOG(1) << "\t bulk commit starting for index: "
                << _indexes[i].block->getEntry()->descriptor()->indexName();
+        std::vector<std::unique_ptr<IndexAccessMethod::BulkBuilder>> bulks;
+        bulks.push_back(std::move(_indexes[i].bulk));
+        for (auto&& extraBulk : _indexes[i].extraBulks) {
+            bulks.push_back(std::move(extraBulk));
+        }
+        _indexes[i].extraBulks.clear();
+
         Status status = _indexes[i].real->commitBulk(_txn,
-                                                     std::move(_indexes[i].bulk),
+                                                     std::move(bulks),
                                                      _allowInterruption,
                                                      _indexes[i].options.dupsAllowed,
                                                      dupsOut);
@@ -190,6 +190,7 @@ public:
 private:
     class SetNeedToCleanupOnRollback;
     class CleanupIndexesVectorOnRollback;
+    class ParallelKeyGenerator;
 
     struct IndexToBuild {
 #if defined(_MSC_VER) && _MSC_VER < 1900  // MVSC++ <= 2013 can't generate default move operations
@@ -198,6 +199,7 @@ private:
             : block(std::move(other.block)),
               real(std::move(other.real)),
               bulk(std::move(other.bulk)),
+              extraBulks(std::move(other.extraBulks)),
               options(std::move(other.options)),
               filterExpression(std::move(other.filterExpression)) {}
 
@@ -206,6 +208,7 @@ private:
             real = std::move(other.real);
             filterExpression = std::move(other.filterExpression);
             bulk = std::move(other.bulk);
+            extraBulks = std::move(other.extraBulks);
             options = std::move(other.options);
             return *this;
         }
@@ -217,9 +220,19 @@ private:
         const MatchExpression* filterExpression;  // might be NULL, owned elsewhere
         std::unique_ptr<IndexAccessMethod::BulkBuilder> bulk;
 
+        // Filled by the key generation threads other than the first when the keys are generated
+        // in parallel. Committed together with 'bulk'.
+        std::vector<std::unique_ptr<IndexAccessMethod::BulkBuilder>> extraBulks;
+
         InsertDeleteOptions options;
     };
 
+    /**
+     * Implements insertAllDocumentsInCollection() for foreground builds by scanning the
+     * collection on this thread and generating and sorting the keys on 'numThreads' others.
+     */
+    Status _insertAllDocumentsInParallel(size_t numThreads, std::set<RecordId>* dupsOut);
+
     std::vector<IndexToBuild> _indexes;
 
     std::unique_ptr<BackgroundOperation> _backgroundOperation;
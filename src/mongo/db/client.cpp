@@ -47,6 +47,7 @@
 #include "mongo/util/concurrency/thread_name.h"
 #include "mongo/util/exit.h"
 #include "mongo/util/mongoutils/str.h"
+#include "mongo/util/net/abstract_message_port.h"
 
 namespace mongo {
 
@@ -91,6 +92,17 @@ void Client::destroy() {
     currentClient.reset(nullptr);
 }
 
+ServiceContext::UniqueClient Client::releaseCurrent() {
+    invariant(haveClient());
+    return std::move(*currentClient.get());
+}
+
+void Client::setCurrent(ServiceContext::UniqueClient client) {
+    invariant(!haveClient());
+    invariant(client);
+    *currentClient.getMake() = std::move(client);
+}
+
 namespace {
 int64_t generateSeed(const std::string& desc) {
     size_t seed = 0;
@@ -121,6 +133,10 @@ void Client::reportState(BSONObjBuilder& builder) {
     if (hasRemote()) {
         builder.append("client", getRemote().toString());
     }
+
+    if (AbstractMessagingPort* messagingPort = port()) {
+        messagingPort->compressorManager().reportState(&builder);
+    }
 }
 
 ServiceContext::UniqueOperationContext Client::makeOperationContext() {
@@ -90,6 +90,20 @@ public:
      */
     static void destroy();
 
+    /**
+     * Detaches the Client object stored in TLS for the current thread and returns it, leaving the
+     * current thread without a Client. The current thread must have a Client.
+     *
+     * Used by servers which process the requests of one connection on several threads.
+     */
+    static ServiceContext::UniqueClient releaseCurrent();
+
+    /**
+     * Makes 'client', which was previously detached with releaseCurrent(), the Client of the
+     * current thread. The current thread must not have a Client.
+     */
+    static void setCurrent(ServiceContext::UniqueClient client);
+
     std::string clientAddress(bool includePort = false) const;
     const std::string& desc() const {
         return _desc;
@@ -43,6 +43,7 @@
 #include "mongo/db/query/explain.h"
 #include "mongo/rpc/reply_builder_interface.h"
 #include "mongo/rpc/request_interface.h"
+#include "mongo/util/concurrency/ticketholder.h"
 #include "mongo/util/string_map.h"
 
 namespace mongo {
@@ -253,6 +254,16 @@ public:
         return LogicalOp::opCommand;
     }
 
+    /**
+     * Returns the queue in which this command waits for a storage engine ticket when too many
+     * operations are running. Commands which read or write documents override this, and the
+     * others wait with the administrative commands.
+     */
+    virtual TicketQueueClass getTicketQueueClass(const std::string& dbname,
+                                                 const BSONObj& cmdObj) const {
+        return TicketQueueClass::kAdmin;
+    }
+
     /** @param webUI expose the command in the web ui as localhost:28017/<name>
         @param oldName an optional old, deprecated name for the command
     */
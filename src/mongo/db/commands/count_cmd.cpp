@@ -57,6 +57,10 @@ public:
     virtual bool isWriteCommandForConfigServer() const {
         return false;
     }
+    virtual TicketQueueClass getTicketQueueClass(const std::string& dbname,
+                                                 const BSONObj& cmdObj) const {
+        return TicketQueueClass::kScan;
+    }
     CmdCount() : Command("count") {}
     virtual bool slaveOk() const {
         // ok on --slave setups
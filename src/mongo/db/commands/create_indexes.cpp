@@ -67,6 +67,10 @@ public:
     virtual bool isWriteCommandForConfigServer() const {
         return false;
     }
+    virtual TicketQueueClass getTicketQueueClass(const std::string& dbname,
+                                                 const BSONObj& cmdObj) const {
+        return TicketQueueClass::kScan;
+    }
     virtual bool slaveOk() const {
         return false;
     }  // TODO: this could be made true...
@@ -45,6 +45,7 @@
 #include "mongo/db/namespace_string.h"
 #include "mongo/db/operation_context.h"
 #include "mongo/db/stats/fill_locker_info.h"
+#include "mongo/db/storage/recovery_unit.h"
 #include "mongo/util/log.h"
 
 namespace mongo {
@@ -140,6 +141,18 @@ public:
                 Locker::LockerInfo lockerInfo;
                 opCtx->lockState()->getLockerInfo(&lockerInfo);
                 fillLockerInfo(lockerInfo, infoBuilder);
+
+                // Resources used so far
+                infoBuilder.append(
+                    "lockWaitMicros",
+                    static_cast<long long>(lockerInfo.stats.getCombinedWaitTimeMicros()));
+                infoBuilder.append(
+                    "ticketWaitMicros",
+                    static_cast<long long>(opCtx->lockState()->getTicketWaitMicros()));
+                if (const RecoveryUnit* recoveryUnit = opCtx->recoveryUnit()) {
+                    infoBuilder.append("storageBytesRead", recoveryUnit->getBytesRead());
+                    infoBuilder.append("storageBytesWritten", recoveryUnit->getBytesWritten());
+                }
             }
 
             infoBuilder.done();
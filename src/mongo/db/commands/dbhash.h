@@ -49,6 +49,10 @@ public:
     virtual bool isWriteCommandForConfigServer() const {
         return false;
     }
+    virtual TicketQueueClass getTicketQueueClass(const std::string& dbname,
+                                                 const BSONObj& cmdObj) const {
+        return TicketQueueClass::kScan;
+    }
     virtual void addRequiredPrivileges(const std::string& dbname,
                                        const BSONObj& cmdObj,
                                        std::vector<Privilege>* out);
@@ -78,6 +78,10 @@ public:
     virtual bool isWriteCommandForConfigServer() const {
         return false;
     }
+    virtual TicketQueueClass getTicketQueueClass(const std::string& dbname,
+                                                 const BSONObj& cmdObj) const {
+        return TicketQueueClass::kScan;
+    }
     bool supportsReadConcern() const final {
         return true;
     }
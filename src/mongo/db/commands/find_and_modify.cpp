@@ -218,6 +218,10 @@ public:
     bool isWriteCommandForConfigServer() const override {
         return true;
     }
+    TicketQueueClass getTicketQueueClass(const std::string& dbname,
+                                         const BSONObj& cmdObj) const override {
+        return TicketQueueClass::kWrite;
+    }
     void addRequiredPrivileges(const std::string& dbname,
                                const BSONObj& cmdObj,
                                std::vector<Privilege>* out) override {
@@ -44,6 +44,7 @@
 #include "mongo/db/service_context.h"
 #include "mongo/db/matcher/extensions_callback_real.h"
 #include "mongo/db/repl/replication_coordinator.h"
+#include "mongo/db/query/canonical_query.h"
 #include "mongo/db/query/cursor_response.h"
 #include "mongo/db/query/explain.h"
 #include "mongo/db/query/find.h"
@@ -77,6 +78,22 @@ public:
         return false;
     }
 
+    TicketQueueClass getTicketQueueClass(const std::string& dbname,
+                                         const BSONObj& cmdObj) const override {
+        // Secondaries replicate by querying the oplog.
+        if (NamespaceString(parseNs(dbname, cmdObj)).isOplog()) {
+            return TicketQueueClass::kInternal;
+        }
+
+        BSONElement filter = cmdObj["filter"];
+        BSONElement limit = cmdObj["limit"];
+        if ((filter.type() == Object && CanonicalQuery::isSimpleIdQuery(filter.Obj())) ||
+            (limit.isNumber() && limit.numberLong() == 1)) {
+            return TicketQueueClass::kPointRead;
+        }
+        return TicketQueueClass::kScan;
+    }
+
     bool slaveOk() const override {
         return false;
     }
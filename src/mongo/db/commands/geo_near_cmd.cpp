@@ -66,6 +66,10 @@ public:
     virtual bool isWriteCommandForConfigServer() const {
         return false;
     }
+    virtual TicketQueueClass getTicketQueueClass(const std::string& dbname,
+                                                 const BSONObj& cmdObj) const {
+        return TicketQueueClass::kScan;
+    }
     bool slaveOk() const {
         return true;
     }
@@ -83,6 +83,15 @@ public:
         return false;
     }
 
+    TicketQueueClass getTicketQueueClass(const std::string& dbname,
+                                         const BSONObj& cmdObj) const override {
+        // Secondaries replicate by tailing the oplog.
+        if (NamespaceString(parseNs(dbname, cmdObj)).isOplog()) {
+            return TicketQueueClass::kInternal;
+        }
+        return TicketQueueClass::kScan;
+    }
+
     bool slaveOk() const override {
         return true;
     }
@@ -427,8 +427,14 @@ Status PlanCacheListPlans::list(OperationContext* txn,
             for (size_t i = 0; i < entry->feedback.size(); ++i) {
                 BSONObjBuilder scoreBob(scoresBob.subobjStart());
                 scoreBob.append("score", entry->feedback[i]->score);
+                scoreBob.appendNumber("works", static_cast<long long>(entry->feedback[i]->works));
+                scoreBob.appendNumber("advanced",
+                                      static_cast<long long>(entry->feedback[i]->advanced));
             }
             scoresBob.doneFast();
+            feedbackBob.appendNumber("works", static_cast<long long>(entry->works));
+            feedbackBob.appendNumber("replansToSamePlan",
+                                     static_cast<long long>(entry->numReplansToSamePlan));
         }
         feedbackBob.doneFast();
 
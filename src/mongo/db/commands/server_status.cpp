@@ -50,6 +50,7 @@
 #include "mongo/util/log.h"
 #include "mongo/util/net/hostname_canonicalization_worker.h"
 #include "mongo/util/net/listen.h"
+#include "mongo/util/net/message_compressor.h"
 #include "mongo/util/net/ssl_manager.h"
 #include "mongo/util/processinfo.h"
 #include "mongo/util/ramlog.h"
@@ -282,6 +283,10 @@ public:
     BSONObj generateSection(OperationContext* txn, const BSONElement& configElement) const {
         BSONObjBuilder b;
         networkCounter.append(b);
+
+        BSONObjBuilder compression(b.subobjStart("compression"));
+        MessageCompressorRegistry::get().appendStats(&compression);
+        compression.doneFast();
         return b.obj();
     }
 
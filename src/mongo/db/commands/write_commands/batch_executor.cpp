@@ -751,9 +751,13 @@ static void normalizeInserts(const BatchedCommandRequest& request,
     }
 }
 
+static bool insertBatch(WriteBatchExecutor::ExecInsertsState* state,
+                        size_t startIndex,
+                        size_t endIndex);
 static void insertOne(WriteBatchExecutor::ExecInsertsState* state, WriteOpResult* result);
 
-// Loops over the specified subset of the batch, processes one document at a time.
+// Inserts the specified subset of the batch together if it can, and otherwise loops over it,
+// processing one document at a time.
 // Returns a true to discontinue the insert, or false if not.
 bool WriteBatchExecutor::insertMany(WriteBatchExecutor::ExecInsertsState* state,
                                     size_t startIndex,
@@ -761,6 +765,24 @@ bool WriteBatchExecutor::insertMany(WriteBatchExecutor::ExecInsertsState* state,
                                     CurOp* currentOp,
                                     std::vector<WriteErrorDetail*>* errors,
                                     bool ordered) {
+    if (endIndex - startIndex > 1 && insertBatch(state, startIndex, endIndex)) {
+        {
+            stdx::lock_guard<Client> lk(*_txn->getClient());
+            BatchItemRef lastInsertItem(state->request, endIndex - 1);
+            currentOp->setQuery_inlock(lastInsertItem.getDocument());
+            currentOp->debug().query = lastInsertItem.getDocument();
+        }
+
+        for (state->currIndex = startIndex; state->currIndex < endIndex; ++state->currIndex) {
+            _opCounters->gotInsert();
+            _le->recordInsert(1);
+        }
+
+        _stats->numInserted += endIndex - startIndex;
+        currentOp->debug().ninserted += endIndex - startIndex;
+        return false;
+    }
+
     for (state->currIndex = startIndex; state->currIndex < endIndex; ++state->currIndex) {
         WriteOpResult result;
         BatchItemRef currInsertItem(state->request, state->currIndex);
@@ -841,8 +863,9 @@ void WriteBatchExecutor::execInserts(const BatchedCommandRequest& request,
             chunkBytes = 0;
 
             if (state.hasLock()) {
-                // insertOne acquires the locks, but does not release them on non-error cases,
-                // so we release them here. insertOne() reacquires them via lockAndCheck().
+                // insertBatch and insertOne acquire the locks, but do not release them on
+                // non-error cases, so we release them here. They reacquire them via
+                // lockAndCheck().
                 state.unlock();
                 // This releases any storage engine held locks/snapshots.
                 _txn->recoveryUnit()->abandonSnapshot();
@@ -1002,6 +1025,68 @@ void WriteBatchExecutor::ExecInsertsState::unlock() {
     _dbLock.reset();
 }
 
+/**
+ * Inserts the documents [startIndex, endIndex) of the batch in a single WriteUnitOfWork, so that
+ * they share one storage transaction and their oplog entries are written together.
+ *
+ * Returns true if every document was inserted. Otherwise none were, and the caller should insert
+ * them one at a time, which retries write conflicts and reports each error against its document.
+ */
+static bool insertBatch(WriteBatchExecutor::ExecInsertsState* state,
+                        size_t startIndex,
+                        size_t endIndex) {
+    OperationContext* txn = state->txn;
+    invariant(!txn->lockState()->inAWriteUnitOfWork());
+
+    if (state->request->isInsertIndexRequest() || endIndex > state->normalizedInserts.size()) {
+        return false;
+    }
+
+    vector<BSONObj> docs;
+    docs.reserve(endIndex - startIndex);
+    for (size_t i = startIndex; i < endIndex; ++i) {
+        const StatusWith<BSONObj>& normalizedInsert(state->normalizedInserts[i]);
+        if (!normalizedInsert.isOK()) {
+            return false;
+        }
+
+        docs.push_back(normalizedInsert.getValue().isEmpty()
+                           ? state->request->getInsertRequest()->getDocumentsAt(i)
+                           : normalizedInsert.getValue());
+    }
+
+    try {
+        WriteOpResult result;
+        if (!state->lockAndCheck(&result)) {
+            return false;
+        }
+
+        Collection* collection = state->getCollection();
+        dassert(txn->lockState()->isCollectionLockedForMode(collection->ns().ns(), MODE_IX));
+
+        // Indexed capped collections only take inserts one at a time.
+        if (collection->isCapped() && collection->getIndexCatalog()->haveAnyIndexes()) {
+            return false;
+        }
+
+        WriteUnitOfWork wunit(txn);
+        Status status = collection->insertDocuments(txn, docs.begin(), docs.end(), true);
+        if (status.isOK()) {
+            wunit.commit();
+            return true;
+        }
+    } catch (const WriteConflictException&) {
+        CurOp::get(txn)->debug().writeConflicts++;
+    } catch (const DBException& ex) {
+        Status status(ex.toStatus());
+        if (ErrorCodes::isInterruption(status.code()))
+            throw;
+    }
+
+    txn->recoveryUnit()->abandonSnapshot();
+    return false;
+}
+
 static void insertOne(WriteBatchExecutor::ExecInsertsState* state, WriteOpResult* result) {
     // we have to be top level so we can retry
     OperationContext* txn = state->txn;
@@ -84,7 +84,8 @@ private:
                      std::vector<WriteErrorDetail*>* errors);
 
     /**
-     * Inserts a subset of an insert batch.
+     * Inserts a subset of an insert batch, in one storage transaction if none of its documents
+     * fail to insert, and one document at a time otherwise.
      * Returns a true to discontinue the insert, or false if not.
      */
     bool insertMany(WriteBatchExecutor::ExecInsertsState* state,
@@ -95,6 +95,11 @@ bool WriteCmd::isWriteCommandForConfigServer() const {
     return false;
 }
 
+TicketQueueClass WriteCmd::getTicketQueueClass(const std::string& dbname,
+                                               const BSONObj& cmdObj) const {
+    return TicketQueueClass::kWrite;
+}
+
 Status WriteCmd::checkAuthForCommand(ClientBasic* client,
                                      const std::string& dbname,
                                      const BSONObj& cmdObj) {
@@ -65,6 +65,9 @@ private:
 
     virtual bool isWriteCommandForConfigServer() const;
 
+    virtual TicketQueueClass getTicketQueueClass(const std::string& dbname,
+                                                 const BSONObj& cmdObj) const;
+
     virtual Status checkAuthForCommand(ClientBasic* client,
                                        const std::string& dbname,
                                        const BSONObj& cmdObj);
@@ -71,6 +71,17 @@ static const int LockConflictsTable[] = {
 // Mask of modes
 const uint64_t intentModes = (1 << MODE_IS) | (1 << MODE_IX);
 
+// Layout of FastPathLockHead::counts: the number of IS requests in the low 32 bits, the number of
+// IX requests in the next 31 bits and the top bit set while the fast path is closed.
+const uint64_t fastPathISUnit = 1;
+const uint64_t fastPathIXUnit = 1ULL << 32;
+const uint64_t fastPathClosedBit = 1ULL << 63;
+const uint64_t fastPathISMask = fastPathIXUnit - 1;
+const uint64_t fastPathIXMask = (fastPathClosedBit - 1) & ~fastPathISMask;
+
+// How many fast path locks are tried when looking for the one of a resource
+const unsigned fastPathProbes = 8;
+
 // Ensure we do not add new modes without updating the conflicts table
 static_assert((sizeof(LockConflictsTable) / sizeof(LockConflictsTable[0])) == LockModesCount,
               "(sizeof(LockConflictsTable) / sizeof(LockConflictsTable[0])) == LockModesCount");
@@ -127,6 +138,89 @@ static_assert((sizeof(LockRequestStatusNames) / sizeof(LockRequestStatusNames[0]
 }  // namespace
 
 
+/**
+ * The FastPathLockHead counts the requests granted in intent modes on a global or database
+ * resource, which are not on the resource's LockHead. Every operation locks these resources in
+ * intent modes, so granting such a request with a single atomic operation avoids the partition
+ * and bucket mutexes, which otherwise show up at high operation rates on many cores.
+ *
+ * A request in a conflicting mode first closes the fast path under the LockHead's bucket mutex,
+ * which sends new intent requests to the LockHead, where they queue behind it. It then waits for
+ * the counted requests as for any other granted requests, because their modes are part of the
+ * LockHead's granted modes. A request released after the fast path was closed re-checks the
+ * LockHead's queues. The fast path opens again once the LockHead has no granted or pending
+ * requests in conflicting modes.
+ *
+ * Once assigned to a resource, a FastPathLockHead stays assigned to it for the lifetime of the
+ * lock manager. Thread-safe.
+ */
+struct FastPathLockHead {
+    static uint64_t unit(LockMode mode) {
+        return mode == MODE_IS ? fastPathISUnit : fastPathIXUnit;
+    }
+
+    /**
+     * Counts a request in the given intent mode, unless the fast path is closed.
+     */
+    bool tryAcquire(LockMode mode) {
+        uint64_t current = counts.load();
+        while (!(current & fastPathClosedBit)) {
+            const uint64_t previous = counts.compareAndSwap(current, current + unit(mode));
+            if (previous == current) {
+                return true;
+            }
+            current = previous;
+        }
+        return false;
+    }
+
+    /**
+     * Stops counting a request in the given mode. Returns true if the fast path was closed, in
+     * which case a conflicting request may have been waiting for this one.
+     */
+    bool release(LockMode mode) {
+        return (counts.fetchAndSubtract(unit(mode)) & fastPathClosedBit) != 0;
+    }
+
+    /**
+     * Opens or closes the fast path. Must be called under the LockHead's bucket mutex.
+     */
+    void setClosed(bool closed) {
+        uint64_t current = counts.load();
+        while (true) {
+            const uint64_t desired =
+                closed ? (current | fastPathClosedBit) : (current & ~fastPathClosedBit);
+            if (desired == current) {
+                return;
+            }
+            const uint64_t previous = counts.compareAndSwap(current, desired);
+            if (previous == current) {
+                return;
+            }
+            current = previous;
+        }
+    }
+
+    /**
+     * Bit-mask of the modes of the counted requests.
+     */
+    uint32_t grantedModes() const {
+        const uint64_t current = counts.load();
+        return ((current & fastPathISMask) ? modeMask(MODE_IS) : 0) |
+            ((current & fastPathIXMask) ? modeMask(MODE_IX) : 0);
+    }
+
+    // The resource to which this lock is assigned, valid once 'assignedResource' is non-zero.
+    ResourceId resourceId;
+
+    // The hash of 'resourceId', or zero while this lock isn't assigned.
+    AtomicUInt64 assignedResource;
+
+    // The counts of granted requests and the closed bit, laid out as described at the top.
+    AtomicUInt64 counts;
+};
+
+
 /**
  * There is one of these objects for each resource that has a lock request. Empty objects
  * (i.e. LockHead with no requests) are allowed to exist on the lock manager's hash table.
@@ -154,6 +248,15 @@ struct LockHead {
 
         conversionsCount = 0;
         compatibleFirstCount = 0;
+
+        fastPathLock = NULL;
+    }
+
+    /**
+     * Bit-mask of the granted modes, including those of the requests on the fast path.
+     */
+    uint32_t grantedModesWithFastPath() const {
+        return fastPathLock ? (grantedModes | fastPathLock->grantedModes()) : grantedModes;
     }
 
     /**
@@ -203,7 +306,7 @@ struct LockHead {
 
         // New lock request. Queue after all granted modes and after any already requested
         // conflicting modes.
-        if (conflicts(mode, grantedModes) ||
+        if (conflicts(mode, grantedModesWithFastPath()) ||
             (!compatibleFirstCount && conflicts(mode, conflictModes))) {
             request->status = LockRequest::STATUS_WAITING;
 
@@ -331,6 +434,10 @@ struct LockHead {
     // be switched to compatible-first. As long as this value is > 0, the policy will stay
     // compatible-first.
     uint32_t compatibleFirstCount;
+
+    // The fast path lock of this resource, if it may have requests on the fast path. Set by the
+    // first conflicting request, which must close the fast path.
+    FastPathLockHead* fastPathLock;
 };
 
 /**
@@ -420,9 +527,14 @@ const unsigned LockManager::_numLockBuckets(128);
 // The exact value doesn't appear very important, but should be power of two
 const unsigned LockManager::_numPartitions = 32;
 
+// Enough for the global resource and the databases of most deployments. The intent requests on
+// resources without a fast path lock use the partitions.
+const unsigned LockManager::_numFastPathLocks = 256;
+
 LockManager::LockManager() {
     _lockBuckets = new LockBucket[_numLockBuckets];
     _partitions = new Partition[_numPartitions];
+    _fastPathLocks = new FastPathLockHead[_numFastPathLocks];
 }
 
 LockManager::~LockManager() {
@@ -435,6 +547,7 @@ LockManager::~LockManager() {
 
     delete[] _lockBuckets;
     delete[] _partitions;
+    delete[] _fastPathLocks;
 }
 
 LockResult LockManager::lock(ResourceId resId, LockRequest* request, LockMode mode) {
@@ -442,6 +555,23 @@ LockResult LockManager::lock(ResourceId resId, LockRequest* request, LockMode mo
     invariant(request->status == LockRequest::STATUS_NEW);
 
     request->partitioned = (mode == MODE_IX || mode == MODE_IS);
+    request->fastPathLock = NULL;
+
+    // Fast path for intent locks on the global and database resources. Compatible-first
+    // requests must be counted on the LockHead.
+    if (request->partitioned && request->fastPath && !request->compatibleFirst) {
+        FastPathLockHead* fastPathLock = _getFastPathLock(resId);
+        if (fastPathLock && fastPathLock->tryAcquire(mode)) {
+            request->mode = mode;
+            request->lock = NULL;
+            request->partitionedLock = NULL;
+            request->fastPathLock = fastPathLock;
+            request->partitioned = false;
+            request->recursiveCount = 1;
+            request->status = LockRequest::STATUS_GRANTED;
+            return LOCK_OK;
+        }
+    }
 
     // For intent modes, try the PartitionedLockHead
     if (request->partitioned) {
@@ -466,6 +596,16 @@ LockResult LockManager::lock(ResourceId resId, LockRequest* request, LockMode mo
 
     LockHead* lock = bucket->findOrInsert(resId);
 
+    // A conflicting request closes the fast path, so that its granted modes stop growing
+    if (!request->partitioned) {
+        if (!lock->fastPathLock) {
+            lock->fastPathLock = _getFastPathLock(resId);
+        }
+        if (lock->fastPathLock) {
+            lock->fastPathLock->setClosed(true);
+        }
+    }
+
     // Start a partitioned lock if possible
     if (request->partitioned && !(lock->grantedModes & (~intentModes)) && !lock->conflictModes) {
         Partition* partition = _getPartition(request);
@@ -512,15 +652,30 @@ LockResult LockManager::convert(ResourceId resId, LockRequest* request, LockMode
     LockBucket* bucket = _getBucket(resId);
     stdx::lock_guard<SimpleMutex> scopedLock(bucket->mutex);
 
-    LockBucket::Map::iterator it = bucket->data.find(resId);
-    invariant(it != bucket->data.end());
-
-    LockHead* const lock = it->second;
+    LockHead* lock;
+    if (request->fastPathLock) {
+        // Requests on the fast path may not have a LockHead yet
+        lock = bucket->findOrInsert(resId);
+        _moveFastPathRequest(lock, request);
+    } else {
+        LockBucket::Map::iterator it = bucket->data.find(resId);
+        invariant(it != bucket->data.end());
+        lock = it->second;
+    }
 
     if (lock->partitioned()) {
         lock->migratePartitionedLockHeads();
     }
 
+    if (!(modeMask(newMode) & intentModes)) {
+        if (!lock->fastPathLock) {
+            lock->fastPathLock = _getFastPathLock(resId);
+        }
+        if (lock->fastPathLock) {
+            lock->fastPathLock->setClosed(true);
+        }
+    }
+
     // Construct granted mask without our current mode, so that it is not counted as
     // conflicting
     uint32_t grantedModesWithoutCurrentRequest = 0;
@@ -535,6 +690,10 @@ LockResult LockManager::convert(ResourceId resId, LockRequest* request, LockMode
         }
     }
 
+    if (lock->fastPathLock) {
+        grantedModesWithoutCurrentRequest |= lock->fastPathLock->grantedModes();
+    }
+
     // This check favours conversion requests over pending requests. For example:
     //
     // T1 requests lock L in IS
@@ -572,6 +731,25 @@ bool LockManager::unlock(LockRequest* request) {
         return false;
     }
 
+    if (request->fastPathLock) {
+        invariant(request->status == LockRequest::STATUS_GRANTED);
+        FastPathLockHead* fastPathLock = request->fastPathLock;
+        request->fastPathLock = NULL;
+
+        if (fastPathLock->release(request->mode)) {
+            // A conflicting request closed the fast path and may be waiting for this one. The
+            // LockHead may be gone if that request has since been granted and released.
+            LockBucket* bucket = _getBucket(fastPathLock->resourceId);
+            stdx::lock_guard<SimpleMutex> scopedLock(bucket->mutex);
+
+            LockBucket::Map::iterator it = bucket->data.find(fastPathLock->resourceId);
+            if (it != bucket->data.end()) {
+                _onLockModeChanged(it->second, true);
+            }
+        }
+        return true;
+    }
+
     if (request->partitioned) {
         // Unlocking a lock that was acquired as partitioned. The lock request may since have
         // moved to the lock head, but there is no safe way to find out without synchronizing
@@ -672,7 +850,8 @@ void LockManager::cleanupUnusedLocks() {
             if (lock->partitioned()) {
                 lock->migratePartitionedLockHeads();
             }
-            if (lock->grantedModes == 0) {
+            // A request may be waiting only for requests on the fast path
+            if (lock->grantedModes == 0 && lock->conflictModes == 0) {
                 invariant(lock->grantedModes == 0);
                 invariant(lock->grantedList._front == NULL);
                 invariant(lock->grantedList._back == NULL);
@@ -723,6 +902,10 @@ void LockManager::_onLockModeChanged(LockHead* lock, bool checkConflictQueue) {
                 }
             }
 
+            if (lock->fastPathLock) {
+                grantedModesWithoutCurrentRequest |= lock->fastPathLock->grantedModes();
+            }
+
             if (!conflicts(iter->convertMode, grantedModesWithoutCurrentRequest)) {
                 lock->conversionsCount--;
                 lock->decGrantedModeCount(iter->mode);
@@ -761,7 +944,7 @@ void LockManager::_onLockModeChanged(LockHead* lock, bool checkConflictQueue) {
         // the granted queue.
         iterNext = iter->next;
 
-        if (conflicts(iter->mode, lock->grantedModes)) {
+        if (conflicts(iter->mode, lock->grantedModesWithFastPath())) {
             // If iter doesn't have a previous pointer, this means that it is at the front of the
             // queue. If we continue scanning the queue beyond this point, we will starve it by
             // granting more and more requests.
@@ -793,6 +976,12 @@ void LockManager::_onLockModeChanged(LockHead* lock, bool checkConflictQueue) {
         }
     }
 
+    // Intent requests can use the fast path again once no conflicting request is granted or
+    // pending.
+    if (lock->fastPathLock && !(lock->grantedModes & ~intentModes) && !lock->conflictModes) {
+        lock->fastPathLock->setClosed(false);
+    }
+
     // This is a convenient place to check that the state of the two request queues is in sync
     // with the bitmask on the modes.
     dassert((lock->grantedModes == 0) ^ (lock->grantedList._front != NULL));
@@ -807,6 +996,51 @@ LockManager::Partition* LockManager::_getPartition(LockRequest* request) const {
     return &_partitions[request->locker->getId() % _numPartitions];
 }
 
+FastPathLockHead* LockManager::_getFastPathLock(ResourceId resId) {
+    const ResourceType resType = resId.getType();
+    if (resType != RESOURCE_GLOBAL && resType != RESOURCE_DATABASE) {
+        return NULL;
+    }
+
+    // A resource is assigned the first free lock on its probe sequence and locks are never
+    // unassigned, so later lookups find it on the same sequence without any locking. The hash
+    // of a global or database resource is never zero, because of its type bits.
+    const uint64_t hash = resId;
+    for (unsigned i = 0; i < fastPathProbes; i++) {
+        FastPathLockHead* fastPathLock = &_fastPathLocks[(hash + i) % _numFastPathLocks];
+        uint64_t assigned = fastPathLock->assignedResource.load();
+        if (assigned == 0) {
+            stdx::lock_guard<SimpleMutex> scopedLock(_fastPathMutex);
+            assigned = fastPathLock->assignedResource.load();
+            if (assigned == 0) {
+                fastPathLock->resourceId = resId;
+                fastPathLock->assignedResource.store(hash);
+                return fastPathLock;
+            }
+        }
+        if (assigned == hash) {
+            return fastPathLock;
+        }
+    }
+
+    return NULL;
+}
+
+void LockManager::_moveFastPathRequest(LockHead* lock, LockRequest* request) {
+    invariant(request->status == LockRequest::STATUS_GRANTED);
+    FastPathLockHead* fastPathLock = request->fastPathLock;
+
+    lock->fastPathLock = fastPathLock;
+    lock->grantedList.push_back(request);
+    lock->incGrantedModeCount(request->mode);
+    request->lock = lock;
+    request->fastPathLock = NULL;
+
+    // The request is counted on the LockHead before it leaves the fast path, so nothing which
+    // waits for it gets granted in between.
+    fastPathLock->release(request->mode);
+}
+
 void LockManager::dump() const {
     log() << "Dumping LockManager @ " << static_cast<const void*>(this) << '\n';
 
@@ -1093,6 +1327,8 @@ void LockRequest::initNew(Locker* locker, LockGrantNotification* notify) {
     next = NULL;
     status = STATUS_NEW;
     partitioned = false;
+    fastPath = false;
+    fastPathLock = NULL;
     mode = MODE_NONE;
     convertMode = MODE_NONE;
 }
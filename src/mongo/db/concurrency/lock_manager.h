@@ -160,6 +160,18 @@ private:
      */
     Partition* _getPartition(LockRequest* request) const;
 
+    /**
+     * Retrieves the FastPathLockHead which counts the fast path requests on the particular
+     * global or database resource, assigning one to the resource if needed. Returns NULL if the
+     * resource cannot use the fast path or all fast path locks are taken.
+     */
+    FastPathLockHead* _getFastPathLock(ResourceId resId);
+
+    /**
+     * Moves a granted request from the fast path onto the given lock, which must be locked.
+     */
+    void _moveFastPathRequest(LockHead* lock, LockRequest* request);
+
     /**
      * Prints the contents of a bucket to the log.
      */
@@ -183,6 +195,12 @@ private:
 
     static const unsigned _numPartitions;
     Partition* _partitions;
+
+    static const unsigned _numFastPathLocks;
+    FastPathLockHead* _fastPathLocks;
+
+    // Serializes assigning fast path locks to resources. Looking one up doesn't need it.
+    SimpleMutex _fastPathMutex;
 };
 
 
@@ -40,6 +40,7 @@ namespace mongo {
 
 class Locker;
 
+struct FastPathLockHead;
 struct LockHead;
 struct PartitionedLockHead;
 
@@ -366,6 +367,12 @@ struct LockRequest {
     // each other, at the cost of extra overhead for conflicting modes.
     bool partitioned;
 
+    // When set, a request in an intent mode on a global or database resource may be granted by
+    // just counting it, without putting it on the resource's LockHead. Such requests are not
+    // visible to the DeadlockDetector, so lockers which rely on deadlock detection must not set
+    // this. Default is FALSE.
+    bool fastPath;
+
     // How many times has LockManager::lock been called for this request. Locks are released
     // when their recursive count drops to zero.
     unsigned recursiveCount;
@@ -386,6 +393,11 @@ struct LockRequest {
     // only transition from 'partitionedLock' to 'lock', never the other way around.
     PartitionedLockHead* partitionedLock;
 
+    // Pointer to the fast path lock which counts this request, or null if the request is on a
+    // LockHead or PartitionedLockHead. A request can only transition from 'fastPathLock' to
+    // 'lock', through a conversion.
+    FastPathLockHead* fastPathLock;
+
     // The reason intrusive linked list is used instead of the std::list class is to allow
     // for entries to be removed from the middle of the list in O(1) time, if they are known
     // instead of having to search for them and we cannot persist iterators, because the list
@@ -855,4 +855,115 @@ TEST(LockManager, Fairness) {
     ASSERT(lockMgr.unlock(&requestIX1));
 }
 
+TEST(LockManager, FastPathConflictWaitsForCountedRequests) {
+    LockManager lockMgr;
+    const ResourceId resId(RESOURCE_DATABASE, std::string("TestDB"));
+
+    // Intent locks on the fast path are granted without a LockHead
+    MMAPV1LockerImpl lockerIS;
+    LockRequestCombo requestIS(&lockerIS);
+    requestIS.fastPath = true;
+    ASSERT(LOCK_OK == lockMgr.lock(resId, &requestIS, MODE_IS));
+
+    MMAPV1LockerImpl lockerIX;
+    LockRequestCombo requestIX(&lockerIX);
+    requestIX.fastPath = true;
+    ASSERT(LOCK_OK == lockMgr.lock(resId, &requestIX, MODE_IX));
+
+    // An S request waits for the IX request, but not for the IS request
+    MMAPV1LockerImpl lockerS;
+    LockRequestCombo requestS(&lockerS);
+    ASSERT(LOCK_WAITING == lockMgr.lock(resId, &requestS, MODE_S));
+
+    // The fast path is now closed, so new intent requests queue behind the S request
+    MMAPV1LockerImpl lockerIX1;
+    LockRequestCombo requestIX1(&lockerIX1);
+    requestIX1.fastPath = true;
+    ASSERT(LOCK_WAITING == lockMgr.lock(resId, &requestIX1, MODE_IX));
+
+    ASSERT(lockMgr.unlock(&requestIS));
+    ASSERT_EQ(0, requestS.numNotifies);
+
+    ASSERT(lockMgr.unlock(&requestIX));
+    ASSERT_EQ(LOCK_OK, requestS.lastResult);
+    ASSERT_EQ(1, requestS.numNotifies);
+    ASSERT_EQ(0, requestIX1.numNotifies);
+
+    ASSERT(lockMgr.unlock(&requestS));
+    ASSERT_EQ(LOCK_OK, requestIX1.lastResult);
+    ASSERT_EQ(1, requestIX1.numNotifies);
+
+    // With no conflicting request left, the fast path is open again and an X request waits for
+    // the intent requests granted on it
+    MMAPV1LockerImpl lockerIS1;
+    LockRequestCombo requestIS1(&lockerIS1);
+    requestIS1.fastPath = true;
+    ASSERT(LOCK_OK == lockMgr.lock(resId, &requestIS1, MODE_IS));
+
+    MMAPV1LockerImpl lockerX;
+    LockRequestCombo requestX(&lockerX);
+    ASSERT(LOCK_WAITING == lockMgr.lock(resId, &requestX, MODE_X));
+
+    ASSERT(lockMgr.unlock(&requestIX1));
+    ASSERT_EQ(0, requestX.numNotifies);
+    ASSERT(lockMgr.unlock(&requestIS1));
+    ASSERT_EQ(LOCK_OK, requestX.lastResult);
+
+    ASSERT(lockMgr.unlock(&requestX));
+}
+
+TEST(LockManager, FastPathConversion) {
+    LockManager lockMgr;
+    const ResourceId resId(RESOURCE_GLOBAL, ResourceId::SINGLETON_GLOBAL);
+
+    MMAPV1LockerImpl locker1;
+    LockRequestCombo request1(&locker1);
+    request1.fastPath = true;
+    ASSERT(LOCK_OK == lockMgr.lock(resId, &request1, MODE_IX));
+
+    MMAPV1LockerImpl locker2;
+    LockRequestCombo request2(&locker2);
+    request2.fastPath = true;
+    ASSERT(LOCK_OK == lockMgr.lock(resId, &request2, MODE_IS));
+
+    // The conversion moves the request to the LockHead and waits for the other fast path request
+    ASSERT(LOCK_WAITING == lockMgr.convert(resId, &request1, MODE_X));
+    ASSERT_EQ(0, request1.numNotifies);
+
+    ASSERT(lockMgr.unlock(&request2));
+    ASSERT_EQ(LOCK_OK, request1.lastResult);
+    ASSERT_EQ(1, request1.numNotifies);
+    ASSERT_EQ(MODE_X, request1.mode);
+
+    // The conversion counts as a second reference
+    ASSERT(!lockMgr.unlock(&request1));
+    ASSERT(lockMgr.unlock(&request1));
+}
+
+TEST(LockManager, FastPathNotUsedForCompatibleFirst) {
+    LockManager lockMgr;
+    const ResourceId resId(RESOURCE_GLOBAL, ResourceId::SINGLETON_GLOBAL);
+
+    MMAPV1LockerImpl locker1;
+    LockRequestCombo request1(&locker1);
+    request1.fastPath = true;
+    request1.compatibleFirst = true;
+    ASSERT(LOCK_OK == lockMgr.lock(resId, &request1, MODE_IS));
+    ASSERT(request1.fastPathLock == NULL);
+
+    MMAPV1LockerImpl lockerX;
+    LockRequestCombo requestX(&lockerX);
+    ASSERT(LOCK_WAITING == lockMgr.lock(resId, &requestX, MODE_X));
+
+    // The compatible-first policy still lets an S request through
+    MMAPV1LockerImpl lockerS;
+    LockRequestCombo requestS(&lockerS);
+    ASSERT(LOCK_OK == lockMgr.lock(resId, &requestS, MODE_S));
+
+    ASSERT(lockMgr.unlock(&requestS));
+    ASSERT(lockMgr.unlock(&request1));
+    ASSERT_EQ(LOCK_OK, requestX.lastResult);
+    ASSERT(lockMgr.unlock(&requestX));
+}
+
 }  // namespace mongo
@@ -193,6 +193,11 @@ void LockerImpl<IsForMMAPV1>::assertEmptyAndReset() {
 
     // Reset the locking statistics so the object can be reused
     _stats.reset();
+    _ticketWaitMicros.store(0);
+
+    // The Locker outlives the operation, so the next one must not queue for tickets under this
+    // operation's class before it has been classified.
+    _ticketQueueClass = TicketQueueClass::kInternal;
 }
 
 template <bool IsForMMAPV1>
@@ -306,7 +311,13 @@ LockResult LockerImpl<IsForMMAPV1>::lockGlobalBegin(LockMode mode) {
         auto holder = ticketHolders[mode];
         if (holder) {
             _clientState.store(reader ? kQueuedReader : kQueuedWriter);
-            holder->waitForTicket();
+            // Queue behind any callers already waiting, rather than take a ticket they were
+            // released for.
+            if (holder->hasQueuedWaiters() || !holder->tryAcquire()) {
+                const uint64_t startOfWaitTime = curTimeMicros64();
+                holder->waitForTicket(_ticketQueueClass);
+                _ticketWaitMicros.fetchAndAdd(curTimeMicros64() - startOfWaitTime);
+            }
         }
         _clientState.store(reader ? kActiveReader : kActiveWriter);
         _modeForTicket = mode;
@@ -654,6 +665,10 @@ LockResult LockerImpl<IsForMMAPV1>::lockBegin(ResourceId resId, LockMode mode) {
         LockRequestsMap::Iterator itNew = _requests.insert(resId);
         itNew->initNew(this, &_notify);
 
+        // The MMAP V1 flush lock relies on deadlock detection, which can't see the requests
+        // granted on the lock manager's fast path.
+        itNew->fastPath = !IsForMMAPV1;
+
         request = itNew.objAddr();
     } else {
         request = it.objAddr();
@@ -95,6 +95,14 @@ public:
 
     virtual ClientState getClientState() const;
 
+    virtual uint64_t getTicketWaitMicros() const {
+        return _ticketWaitMicros.load();
+    }
+
+    virtual void setTicketQueueClass(TicketQueueClass queueClass) {
+        _ticketQueueClass = queueClass;
+    }
+
     virtual LockerId getId() const {
         return _id;
     }
@@ -219,6 +227,12 @@ private:
     // Mode for which the Locker acquired a ticket, or MODE_NONE if no ticket was acquired.
     LockMode _modeForTicket = MODE_NONE;
 
+    // Total time spent waiting for tickets. Reported per operation alongside the lock stats, and
+    // read by currentOp from other threads.
+    AtomicUInt64 _ticketWaitMicros{0};
+
+    TicketQueueClass _ticketQueueClass = TicketQueueClass::kInternal;
+
     // Indicates whether the client is active reader/writer or is queued.
     AtomicWord<ClientState> _clientState{kInactive};
 
@@ -146,6 +146,23 @@ void LockStats<CounterType>::reset() {
     }
 }
 
+template <typename CounterType>
+int64_t LockStats<CounterType>::getCombinedWaitTimeMicros() const {
+    int64_t total = 0;
+    for (int i = 0; i < ResourceTypesCount; i++) {
+        for (int mode = 0; mode < LockModesCount; mode++) {
+            total += CounterOps::get(_stats[i].modeStats[mode].combinedWaitTimeMicros);
+        }
+    }
+
+    // The oplog stats are kept apart from those of the other collections, so count them too.
+    for (int mode = 0; mode < LockModesCount; mode++) {
+        total += CounterOps::get(_oplogStats.modeStats[mode].combinedWaitTimeMicros);
+    }
+
+    return total;
+}
+
 
 // Ensures that there are instances compiled for LockStats for AtomicInt64 and int64_t
 template class LockStats<int64_t>;
@@ -33,6 +33,7 @@
 
 #include "mongo/db/concurrency/lock_manager.h"
 #include "mongo/db/concurrency/lock_stats.h"
+#include "mongo/util/concurrency/ticketholder.h"
 
 namespace mongo {
 
@@ -68,6 +69,18 @@ public:
      */
     virtual ClientState getClientState() const = 0;
 
+    /**
+     * Returns the total time this locker has spent blocked waiting for a ticket to acquire the
+     * global lock. Tickets throttle the number of operations concurrently in the storage engine.
+     */
+    virtual uint64_t getTicketWaitMicros() const = 0;
+
+    /**
+     * Sets the queue in which this locker waits when no ticket is available to acquire the
+     * global lock. Lockers wait in the kInternal queue unless told otherwise.
+     */
+    virtual void setTicketQueueClass(TicketQueueClass queueClass) = 0;
+
     virtual LockerId getId() const = 0;
 
     /**
@@ -288,7 +301,8 @@ public:
     virtual bool isReadLocked() const = 0;
 
     /**
-     * Asserts that the Locker is effectively not in use and resets the locking statistics.
+     * Asserts that the Locker is effectively not in use and resets the locking statistics and
+     * the ticket queue class.
      * This means, there should be no locks on it, no WUOW, etc, so it would be safe to call
      * the destructor or reuse the Locker.
      */
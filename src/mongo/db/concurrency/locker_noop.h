@@ -45,6 +45,12 @@ public:
         invariant(false);
     }
 
+    virtual uint64_t getTicketWaitMicros() const {
+        return 0;
+    }
+
+    virtual void setTicketQueueClass(TicketQueueClass queueClass) {}
+
     virtual LockerId getId() const {
         invariant(false);
     }
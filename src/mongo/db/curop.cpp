@@ -32,14 +32,19 @@
 
 #include "mongo/db/curop.h"
 
+#include <ctime>
+
 #include "mongo/base/disallow_copying.h"
 #include "mongo/bson/mutable/document.h"
 #include "mongo/db/client.h"
 #include "mongo/db/commands.h"
 #include "mongo/db/commands/server_status_metric.h"
+#include "mongo/db/concurrency/locker.h"
 #include "mongo/db/cursor_id.h"
 #include "mongo/db/json.h"
+#include "mongo/db/operation_context.h"
 #include "mongo/db/query/getmore_request.h"
+#include "mongo/db/storage/recovery_unit.h"
 #include "mongo/util/fail_point_service.h"
 #include "mongo/util/log.h"
 
@@ -137,6 +142,31 @@ BSONObj upconvertGetMoreEntry(const NamespaceString& nss, CursorId cursorId, int
                           ).toBSON();
 }
 
+/**
+ * Returns the CPU time consumed by the calling thread, or -1 if the platform can't report it.
+ */
+long long threadCpuNanos() {
+#if defined(_WIN32)
+    FILETIME creationTime, exitTime, kernelTime, userTime;
+    if (!GetThreadTimes(GetCurrentThread(), &creationTime, &exitTime, &kernelTime, &userTime)) {
+        return -1;
+    }
+    // FILETIMEs count 100 nanosecond intervals.
+    const auto toNanos = [](const FILETIME& t) {
+        return ((static_cast<long long>(t.dwHighDateTime) << 32) | t.dwLowDateTime) * 100;
+    };
+    return toNanos(kernelTime) + toNanos(userTime);
+#elif defined(CLOCK_THREAD_CPUTIME_ID)
+    timespec ts;
+    if (clock_gettime(CLOCK_THREAD_CPUTIME_ID, &ts) != 0) {
+        return -1;
+    }
+    return static_cast<long long>(ts.tv_sec) * 1000 * 1000 * 1000 + ts.tv_nsec;
+#else
+    return -1;
+#endif
+}
+
 }  // namespace
 
 /**
@@ -287,6 +317,7 @@ void CurOp::setNS_inlock(StringData ns) {
 void CurOp::ensureStarted() {
     if (_start == 0) {
         _start = curTimeMicros64();
+        _startCpuNanos = threadCpuNanos();
 
         // If ensureStarted() is invoked after setMaxTimeMicros(), then time limit tracking will
         // start here.  This is because time limit tracking can only commence after the
@@ -297,6 +328,15 @@ void CurOp::ensureStarted() {
     }
 }
 
+void CurOp::done() {
+    _end = curTimeMicros64();
+
+    const long long cpuNanos = threadCpuNanos();
+    if (_startCpuNanos >= 0 && cpuNanos >= _startCpuNanos) {
+        _debug.cpuNanos = cpuNanos - _startCpuNanos;
+    }
+}
+
 void CurOp::enter_inlock(const char* ns, int dbProfileLevel) {
     ensureStarted();
     _ns = ns;
@@ -526,6 +566,11 @@ string OpDebug::report(const CurOp& curop, const SingleThreadedLockStats& lockSt
     OPDEBUG_TOSTRING_HELP_BOOL(cursorExhausted);
     OPDEBUG_TOSTRING_HELP(keyUpdates);
     OPDEBUG_TOSTRING_HELP(writeConflicts);
+    OPDEBUG_TOSTRING_HELP(cpuNanos);
+    OPDEBUG_TOSTRING_HELP(storageBytesRead);
+    OPDEBUG_TOSTRING_HELP(storageBytesWritten);
+    OPDEBUG_TOSTRING_HELP(ticketWaitMicros);
+    s << " lockWaitMicros:" << lockStats.getCombinedWaitTimeMicros();
 
     if (!exceptionInfo.empty()) {
         s << " exception: " << exceptionInfo.msg;
@@ -645,6 +690,11 @@ void OpDebug::append(const CurOp& curop,
     OPDEBUG_APPEND_BOOL(cursorExhausted);
     OPDEBUG_APPEND_NUMBER(keyUpdates);
     OPDEBUG_APPEND_NUMBER(writeConflicts);
+    OPDEBUG_APPEND_NUMBER(cpuNanos);
+    OPDEBUG_APPEND_NUMBER(storageBytesRead);
+    OPDEBUG_APPEND_NUMBER(storageBytesWritten);
+    OPDEBUG_APPEND_NUMBER(ticketWaitMicros);
+    b.appendNumber("lockWaitMicros", static_cast<long long>(lockStats.getCombinedWaitTimeMicros()));
     b.appendNumber("numYield", curop.numYields());
 
     {
@@ -666,4 +716,12 @@ void OpDebug::append(const CurOp& curop,
     execStats.append(b, "execStats");
 }
 
+void OpDebug::recordResourceUsage(OperationContext* txn) {
+    if (RecoveryUnit* recoveryUnit = txn->recoveryUnit()) {
+        storageBytesRead = recoveryUnit->getBytesRead();
+        storageBytesWritten = recoveryUnit->getBytesWritten();
+    }
+    ticketWaitMicros = static_cast<long long>(txn->lockState()->getTicketWaitMicros());
+}
+
 }  // namespace mongo
@@ -141,6 +141,12 @@ public:
                 const SingleThreadedLockStats& lockStats,
                 BSONObjBuilder& builder) const;
 
+    /**
+     * Fills in the storage and ticket fields above from the totals accumulated by "txn"'s
+     * RecoveryUnit and Locker. Called once the operation has completed.
+     */
+    void recordResourceUsage(OperationContext* txn);
+
     // -------------------
 
     // basic options
@@ -189,6 +195,12 @@ public:
     int keyUpdates{0};
     long long writeConflicts{0};
 
+    // resource usage, see CurOp::done() and recordResourceUsage()
+    long long cpuNanos{-1};  // CPU time of the executing thread, -1 if the platform can't tell
+    long long storageBytesRead{-1};
+    long long storageBytesWritten{-1};
+    long long ticketWaitMicros{-1};
+
     // New Query Framework debugging/profiling info
     // TODO: should this really be an opaque BSONObj?  Not sure.
     CachedBSONObj<4096> execStats;
@@ -380,9 +392,10 @@ public:
         ensureStarted();
         return _start;
     }
-    void done() {
-        _end = curTimeMicros64();
-    }
+    /**
+     * Marks the operation as done and records the CPU time its thread has spent on it.
+     */
+    void done();
 
     long long totalTimeMicros() {
         massert(12601, "CurOp not marked done yet", _end);
@@ -498,6 +511,7 @@ private:
     Command* _command{nullptr};
     long long _start{0};
     long long _end{0};
+    long long _startCpuNanos{-1};  // thread CPU time when the operation started
 
     // _networkOp represents the network-level op code: OP_QUERY, OP_GET_MORE, OP_COMMAND, etc.
     NetworkOp _networkOp{opInvalid};  // only set this through setNetworkOp_inlock() to keep synced
@@ -60,6 +60,19 @@ ServerStatusMetricField<Counter64> displayFastMod("operation.fastmod", &fastmodC
 ServerStatusMetricField<Counter64> displayWriteConflicts("operation.writeConflicts",
                                                          &writeConflictsCounter);
 
+Counter64 cpuNanosCounter;
+Counter64 storageBytesReadCounter;
+Counter64 storageBytesWrittenCounter;
+Counter64 ticketWaitMicrosCounter;
+
+ServerStatusMetricField<Counter64> displayCpuNanos("operation.cpuNanos", &cpuNanosCounter);
+ServerStatusMetricField<Counter64> displayStorageBytesRead("operation.storageBytesRead",
+                                                           &storageBytesReadCounter);
+ServerStatusMetricField<Counter64> displayStorageBytesWritten("operation.storageBytesWritten",
+                                                              &storageBytesWrittenCounter);
+ServerStatusMetricField<Counter64> displayTicketWaitMicros("operation.ticketWaitMicros",
+                                                           &ticketWaitMicrosCounter);
+
 }  // namespace
 
 void recordCurOpMetrics(OperationContext* opCtx) {
@@ -85,6 +98,15 @@ void recordCurOpMetrics(OperationContext* opCtx) {
         fastmodCounter.increment();
     if (debug.writeConflicts)
         writeConflictsCounter.increment(debug.writeConflicts);
+
+    if (debug.cpuNanos > 0)
+        cpuNanosCounter.increment(debug.cpuNanos);
+    if (debug.storageBytesRead > 0)
+        storageBytesReadCounter.increment(debug.storageBytesRead);
+    if (debug.storageBytesWritten > 0)
+        storageBytesWrittenCounter.increment(debug.storageBytesWritten);
+    if (debug.ticketWaitMicros > 0)
+        ticketWaitMicrosCounter.increment(debug.ticketWaitMicros);
 }
 
 }  // namespace mongo
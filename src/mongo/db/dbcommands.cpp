@@ -77,6 +77,7 @@
 #include "mongo/db/ops/insert.h"
 #include "mongo/db/query/get_executor.h"
 #include "mongo/db/query/internal_plans.h"
+#include "mongo/db/query/plan_cache.h"
 #include "mongo/db/query/query_planner.h"
 #include "mongo/db/repair_database.h"
 #include "mongo/db/repl/optime.h"
@@ -726,6 +727,10 @@ public:
     virtual bool isWriteCommandForConfigServer() const {
         return false;
     }
+    virtual TicketQueueClass getTicketQueueClass(const std::string& dbname,
+                                                 const BSONObj& cmdObj) const {
+        return TicketQueueClass::kScan;
+    }
     virtual void help(stringstream& help) const {
         help << "determine data size for a set of data in a certain range"
                 "\nexample: { dataSize:\"blog.posts\", keyPattern:{x:1}, min:{x:10}, max:{x:55} }"
@@ -869,6 +874,10 @@ public:
     virtual bool isWriteCommandForConfigServer() const {
         return false;
     }
+    virtual TicketQueueClass getTicketQueueClass(const std::string& dbname,
+                                                 const BSONObj& cmdObj) const {
+        return TicketQueueClass::kScan;
+    }
     virtual void help(stringstream& help) const {
         help
             << "{ collStats:\"blog.posts\" , scale : 1 } scale divides sizes e.g. for KB use 1024\n"
@@ -964,6 +973,13 @@ public:
         result.appendNumber("totalIndexSize", indexSize / scale);
         result.append("indexSizes", indexSizes.obj());
 
+        {
+            PlanCache* planCache = collection->infoCache()->getPlanCache();
+            BSONObjBuilder planCacheBob(result.subobjStart("planCache"));
+            planCacheBob.appendNumber("entries", static_cast<long long>(planCache->size()));
+            planCache->getStats().appendTo(&planCacheBob);
+        }
+
         return true;
     }
 
@@ -1015,6 +1031,10 @@ public:
     virtual bool isWriteCommandForConfigServer() const {
         return false;
     }
+    virtual TicketQueueClass getTicketQueueClass(const std::string& dbname,
+                                                 const BSONObj& cmdObj) const {
+        return TicketQueueClass::kScan;
+    }
     virtual void help(stringstream& help) const {
         help << "Get stats on a database. Not instantaneous. Slower for databases with large "
                 ".ns files.\n"
@@ -1239,6 +1259,16 @@ void Command::execCommand(OperationContext* txn,
         uassertStatusOK(
             _checkAuthorization(command, txn->getClient(), dbname, request.getCommandArgs()));
 
+        // Commands run through DBDirectClient share the lock state of the operation that issued
+        // them, which has already been classified.
+        if (!txn->getClient()->isInDirectClient()) {
+            TicketQueueClass queueClass =
+                AuthorizationSession::get(txn->getClient())->isAuthenticatedAsInternalUser()
+                ? TicketQueueClass::kInternal
+                : command->getTicketQueueClass(dbname, request.getCommandArgs());
+            txn->lockState()->setTicketQueueClass(queueClass);
+        }
+
         repl::ReplicationCoordinator* replCoord =
             repl::ReplicationCoordinator::get(txn->getClient()->getServiceContext());
         const bool iAmPrimary = replCoord->canAcceptWritesForDatabase(dbname);
@@ -104,13 +104,13 @@ Status CachedPlanStage::pickBestPlan(PlanYieldPolicy* yieldPolicy) {
             if (_results.size() >= numResults) {
                 // Once a plan returns enough results, stop working. Update cache with stats
                 // from this run and return.
-                updatePlanCache();
+                updatePlanCache(i + 1);
                 return Status::OK();
             }
         } else if (PlanStage::IS_EOF == state) {
             // Cached plan hit EOF quickly enough. No need to replan. Update cache with stats
             // from this run and return.
-            updatePlanCache();
+            updatePlanCache(i + 1);
             return Status::OK();
         } else if (PlanStage::NEED_YIELD == state) {
             if (id == WorkingSet::INVALID_ID) {
@@ -168,6 +168,8 @@ Status CachedPlanStage::pickBestPlan(PlanYieldPolicy* yieldPolicy) {
            << _canonicalQuery->toStringShort()
            << " plan summary before replan: " << Explain::getPlanSummary(child().get());
 
+    _collection->infoCache()->getPlanCache()->notifyOfReplan();
+
     const bool shouldCache = true;
     return replan(yieldPolicy, shouldCache);
 }
@@ -247,7 +249,7 @@ Status CachedPlanStage::replan(PlanYieldPolicy* yieldPolicy, bool shouldCache) {
 
     // Many solutions. Create a MultiPlanStage to pick the best, update the cache,
     // and so on. The working set will be shared by all candidate plans.
-    auto cachingMode = shouldCache ? MultiPlanStage::CachingMode::AlwaysCache
+    auto cachingMode = shouldCache ? MultiPlanStage::CachingMode::AlwaysCacheReplanned
                                    : MultiPlanStage::CachingMode::NeverCache;
     _children.emplace_back(
         new MultiPlanStage(getOpCtx(), _collection, _canonicalQuery, cachingMode));
@@ -324,10 +326,12 @@ const SpecificStats* CachedPlanStage::getSpecificStats() const {
     return &_specificStats;
 }
 
-void CachedPlanStage::updatePlanCache() {
+void CachedPlanStage::updatePlanCache(size_t trialWorks) {
     std::unique_ptr<PlanCacheEntryFeedback> feedback = stdx::make_unique<PlanCacheEntryFeedback>();
     feedback->stats = getStats();
     feedback->score = PlanRanker::scoreTree(feedback->stats.get());
+    feedback->works = trialWorks;
+    feedback->advanced = _results.size();
 
     PlanCache* cache = _collection->infoCache()->getPlanCache();
     Status fbs = cache->feedback(*_canonicalQuery, feedback.release());
@@ -89,12 +89,13 @@ public:
 
 private:
     /**
-     * Passes stats from the trial period run of the cached plan to the plan cache.
+     * Passes stats from the trial period run of the cached plan, which took 'trialWorks' work
+     * cycles, to the plan cache.
      *
      * If the plan cache entry is deleted before we get a chance to update it, then this
      * is a no-op.
      */
-    void updatePlanCache();
+    void updatePlanCache(size_t trialWorks);
 
     /**
      * Uses the QueryPlanner and the MultiPlanStage to re-generate candidate plans for this
@@ -256,7 +256,8 @@ Status MultiPlanStage::pickBestPlan(PlanYieldPolicy* yieldPolicy) {
     // write to the plan cache.
     //
     // TODO: We can remove this if we introduce replanning logic to the SubplanStage.
-    bool canCache = (_cachingMode == CachingMode::AlwaysCache);
+    bool canCache = (_cachingMode == CachingMode::AlwaysCache ||
+                     _cachingMode == CachingMode::AlwaysCacheReplanned);
     if (_cachingMode == CachingMode::SometimesCache) {
         // In "sometimes cache" mode, we cache unless we hit one of the special cases below.
         canCache = true;
@@ -322,7 +323,9 @@ Status MultiPlanStage::pickBestPlan(PlanYieldPolicy* yieldPolicy) {
         }
 
         if (validSolutions) {
-            _collection->infoCache()->getPlanCache()->add(*_query, solutions, ranking.release());
+            const bool replanned = (_cachingMode == CachingMode::AlwaysCacheReplanned);
+            _collection->infoCache()->getPlanCache()->add(
+                *_query, solutions, ranking.release(), replanned);
         }
     }
 
@@ -59,6 +59,10 @@ public:
         // previously existing cache entry for the query shape.
         AlwaysCache,
 
+        // Like AlwaysCache, for a query which is being replanned because its cached plan exceeded
+        // its works during the trial period. See PlanCache::add().
+        AlwaysCacheReplanned,
+
         // Write a cache entry for the query shape *unless* we encounter one of the following edge
         // cases:
         //  - Two or more plans tied for the win.
@@ -30,7 +30,6 @@
 
 #include "mongo/db/ftdc/compressor.h"
 
-#include "mongo/base/data_builder.h"
 #include "mongo/db/ftdc/config.h"
 #include "mongo/db/ftdc/util.h"
 #include "mongo/db/ftdc/varint.h"
@@ -123,11 +122,6 @@ StatusWith<std::tuple<ConstDataRange, Date_t>> FTDCCompressor::getCompressedSamp
     _uncompressedChunkBuffer.appendNum(static_cast<std::uint32_t>(_deltaCount));
 
     if (_metricsCount != 0 && _deltaCount != 0) {
-        // On average, we do not need all 10 bytes for every sample, worst case, we grow the buffer
-        DataBuilder db(_metricsCount * _deltaCount * FTDCVarInt::kMaxSizeBytes64 / 2);
-
-        std::uint32_t zeroesCount = 0;
-
         // For each set of samples for a particular metric,
         // we think of it is simple array of 64-bit integers we try to compress into a byte array.
         // This is done in three steps for each metric
@@ -141,9 +135,23 @@ StatusWith<std::tuple<ConstDataRange, Date_t>> FTDCCompressor::getCompressedSamp
         //
         // These byte arrays are added to a buffer which is then concatenated with other chunks and
         // compressed with ZLIB.
+        //
+        // The deltas are encoded straight into the uncompressed buffer. Room is made up front for
+        // every delta to take the largest VarInt, which also covers the RLE pairs since a pair
+        // stands for at least one delta, and the unused space is trimmed afterwards.
+        const int startLength = _uncompressedChunkBuffer.len();
+        char* const begin = _uncompressedChunkBuffer.grow(
+            static_cast<int>(_metricsCount * _deltaCount * FTDCVarInt::kMaxSizeBytes64));
+        char* out = begin;
+
+        std::uint32_t zeroesCount = 0;
+
+        // Runs of zeros are carried over from one metric into the next.
         for (std::uint32_t i = 0; i < _metricsCount; i++) {
+            const std::uint64_t* column = &_deltas[getArrayOffset(_maxDeltas, 0, i)];
+
             for (std::uint32_t j = 0; j < _deltaCount; j++) {
-                std::uint64_t delta = _deltas[getArrayOffset(_maxDeltas, j, i)];
+                const std::uint64_t delta = column[j];
 
                 if (delta == 0) {
                     ++zeroesCount;
@@ -152,44 +160,22 @@ StatusWith<std::tuple<ConstDataRange, Date_t>> FTDCCompressor::getCompressedSamp
 
                 // If we have a non-zero sample, then write out all the accumulated zero samples.
                 if (zeroesCount > 0) {
-                    auto s1 = db.writeAndAdvance(FTDCVarInt(0));
-                    if (!s1.isOK()) {
-                        return s1;
-                    }
-
-                    auto s2 = db.writeAndAdvance(FTDCVarInt(zeroesCount - 1));
-                    if (!s2.isOK()) {
-                        return s2;
-                    }
-
+                    out = FTDCVarInt::encodeUnchecked(out, 0);
+                    out = FTDCVarInt::encodeUnchecked(out, zeroesCount - 1);
                     zeroesCount = 0;
                 }
 
-                auto s3 = db.writeAndAdvance(FTDCVarInt(delta));
-                if (!s3.isOK()) {
-                    return s3;
-                }
+                out = FTDCVarInt::encodeUnchecked(out, delta);
             }
+        }
 
-            // If we are on the last metric, and the previous loop ended in a zero, write out the
-            // RLE
-            // pair of zero information.
-            if ((i == (_metricsCount - 1)) && zeroesCount) {
-                auto s1 = db.writeAndAdvance(FTDCVarInt(0));
-                if (!s1.isOK()) {
-                    return s1;
-                }
-
-                auto s2 = db.writeAndAdvance(FTDCVarInt(zeroesCount - 1));
-                if (!s2.isOK()) {
-                    return s2;
-                }
-            }
+        // If the last metric ended in a zero, write out the RLE pair of zero information.
+        if (zeroesCount > 0) {
+            out = FTDCVarInt::encodeUnchecked(out, 0);
+            out = FTDCVarInt::encodeUnchecked(out, zeroesCount - 1);
         }
 
-        // Append the entire compacted metric chunk into the uncompressed buffer
-        ConstDataRange cdr = db.getCursor();
-        _uncompressedChunkBuffer.appendBuf(cdr.data(), cdr.length());
+        _uncompressedChunkBuffer.setlen(startLength + static_cast<int>(out - begin));
     }
 
     auto swDest = _compressor.compress(
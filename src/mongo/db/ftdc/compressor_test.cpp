@@ -394,6 +394,28 @@ TEST(FTDCCompressor, TestFull) {
     }
 }
 
+// Test runs of zeros which span several metrics, and deltas which wrap around
+TEST(FTDCCompressor, TestZeroRunsAcrossMetrics) {
+    TestTie c;
+
+    auto st = c.addSample(BSON("a" << 1 << "b" << 2 << "c" << 3 << "d" << 4));
+    ASSERT_HAS_SPACE(st);
+
+    for (int i = 0; i < 10; i++) {
+        // Only 'a' changes, and it goes down.
+        st = c.addSample(BSON("a" << -i << "b" << 2 << "c" << 3 << "d" << 4));
+        ASSERT_HAS_SPACE(st);
+    }
+
+    // A single change on the last metric ends the zero run which began in 'b'.
+    st = c.addSample(BSON("a" << -9 << "b" << 2 << "c" << 3 << "d" << 5));
+    ASSERT_HAS_SPACE(st);
+
+    // The chunk ends in a run of zeros.
+    st = c.addSample(BSON("a" << -9 << "b" << 2 << "c" << 3 << "d" << 5));
+    ASSERT_HAS_SPACE(st);
+}
+
 template <typename T>
 BSONObj generateSample(std::random_device& rd, T generator, size_t count) {
     BSONObjBuilder builder;
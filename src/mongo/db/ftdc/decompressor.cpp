@@ -30,6 +30,8 @@
 
 #include "mongo/db/ftdc/decompressor.h"
 
+#include <algorithm>
+
 #include "mongo/base/data_range_cursor.h"
 #include "mongo/base/data_type_validated.h"
 #include "mongo/db/ftdc/compressor.h"
@@ -122,50 +124,45 @@ StatusWith<std::vector<BSONObj>> FTDCDecompressor::uncompress(ConstDataRange buf
     }
 
     // Read the samples
-    std::vector<std::uint64_t> deltas(metricsCount * sampleCount);
-
-    // decompress the deltas
-    std::uint64_t zeroesCount = 0;
-
-    auto cdrc = ConstDataRangeCursor(cdc);
-
-    for (std::uint32_t i = 0; i < metricsCount; i++) {
-        for (std::uint32_t j = 0; j < sampleCount; j++) {
-            if (zeroesCount) {
-                deltas[FTDCCompressor::getArrayOffset(sampleCount, j, i)] = 0;
-                zeroesCount--;
-                continue;
-            }
-
-            auto swDelta = cdrc.readAndAdvance<FTDCVarInt>();
-
-            if (!swDelta.isOK()) {
-                return swDelta.getStatus();
-            }
-
-            if (swDelta.getValue() == 0) {
-                auto swZero = cdrc.readAndAdvance<FTDCVarInt>();
-
-                if (!swZero.isOK()) {
-                    return swDelta.getStatus();
-                }
+    const std::size_t deltasCount = static_cast<std::size_t>(metricsCount) * sampleCount;
+    std::vector<std::uint64_t> deltas(deltasCount);
+
+    // Decompress the deltas. They are stored one metric after another, which is the order of
+    // 'deltas', so they are decoded straight into it.
+    const char* ptr = cdc.data();
+    const char* const end = ptr + cdc.length();
+
+    for (std::size_t pos = 0; pos < deltasCount;) {
+        std::uint64_t delta;
+        ptr = FTDCVarInt::decode(ptr, end, &delta);
+        if (!ptr) {
+            return Status(ErrorCodes::Overflow, "Metrics chunk has truncated or corrupt deltas");
+        }
 
-                zeroesCount = swZero.getValue();
-            }
+        if (delta != 0) {
+            deltas[pos++] = delta;
+            continue;
+        }
 
-            deltas[FTDCCompressor::getArrayOffset(sampleCount, j, i)] = swDelta.getValue();
+        std::uint64_t zeroesCount;
+        ptr = FTDCVarInt::decode(ptr, end, &zeroesCount);
+        if (!ptr) {
+            return Status(ErrorCodes::Overflow, "Metrics chunk has truncated or corrupt deltas");
         }
-    }
 
-    // Inflate the deltas
-    for (std::uint32_t i = 0; i < metricsCount; i++) {
-        deltas[FTDCCompressor::getArrayOffset(sampleCount, 0, i)] += metrics[i];
+        // The pair stands for zeroesCount + 1 zeros. The vector is already zeroed, so just skip
+        // them.
+        pos += std::min<std::uint64_t>(zeroesCount, deltasCount - pos - 1) + 1;
     }
 
+    // Inflate the deltas, a running sum down each metric starting from the reference document.
     for (std::uint32_t i = 0; i < metricsCount; i++) {
-        for (std::uint32_t j = 1; j < sampleCount; j++) {
-            deltas[FTDCCompressor::getArrayOffset(sampleCount, j, i)] +=
-                deltas[FTDCCompressor::getArrayOffset(sampleCount, j - 1, i)];
+        std::uint64_t* column = &deltas[FTDCCompressor::getArrayOffset(sampleCount, 0, i)];
+        std::uint64_t value = metrics[i];
+
+        for (std::uint32_t j = 0; j < sampleCount; j++) {
+            value += column[j];
+            column[j] = value;
         }
     }
 
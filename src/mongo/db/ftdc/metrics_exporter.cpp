@@ -0,0 +1,257 @@
+/*    Copyright 2016 10gen Inc.
+ *
+ *    This program is free software: you can redistribute it and/or  modify
+ *    it under the terms of the GNU Affero General Public License, version 3,
+ *    as published by the Free Software Foundation.
+ *
+ *    This program is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *    GNU Affero General Public License for more details.
+ *
+ *    You should have received a copy of the GNU Affero General Public License
+ *    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ *    As a special exception, the copyright holders give permission to link the
+ *    code of portions of this program with the OpenSSL library under certain
+ *    conditions as described in each individual source file and distribute
+ *    linked combinations including the program with the OpenSSL library. You
+ *    must comply with the GNU Affero General Public License in all respects
+ *    for all of the code used other than as permitted herein. If you modify
+ *    file(s) with this exception, you may extend this exception to your
+ *    version of the file(s), but you are not obligated to do so. If you do not
+ *    wish to do so, delete this exception statement from your version. If you
+ *    delete this exception statement from all source files in the program,
+ *    then also delete it in the license file.
+ */
+
+
+#include "mongo/platform/basic.h"
+
+#include "mongo/db/ftdc/metrics_exporter.h"
+
+#include <algorithm>
+#include <boost/filesystem.hpp>
+#include <iomanip>
+#include <ostream>
+
+#include "mongo/db/ftdc/constants.h"
+#include "mongo/db/ftdc/file_reader.h"
+#include "mongo/db/ftdc/util.h"
+#include "mongo/util/mongoutils/str.h"
+
+namespace mongo {
+
+namespace {
+
+/**
+ * Returns true if 'element' holds a value which FTDC records as a metric.
+ */
+bool isMetric(const BSONElement& element) {
+    switch (element.type()) {
+        case NumberDouble:
+        case NumberInt:
+        case NumberLong:
+        case Bool:
+        case Date:
+        case bsonTimestamp:
+            return true;
+        default:
+            return false;
+    }
+}
+
+/**
+ * Appends the dotted paths of the metrics in 'obj' to 'paths', in document order.
+ */
+void collectMetricPaths(const BSONObj& obj,
+                        const std::string& prefix,
+                        std::vector<std::string>* paths) {
+    for (const auto& element : obj) {
+        std::string path = prefix + element.fieldName();
+
+        if (element.type() == Object || element.type() == Array) {
+            collectMetricPaths(element.Obj(), path + ".", paths);
+        } else if (isMetric(element)) {
+            paths->push_back(std::move(path));
+        }
+    }
+}
+
+/**
+ * Writes the value of a metric as a number. Dates are written as milliseconds since the epoch,
+ * and timestamps as their seconds.
+ */
+void writeValue(std::ostream& out, const BSONElement& element) {
+    switch (element.type()) {
+        case NumberDouble:
+            out << std::setprecision(15) << element.Double();
+            break;
+        case Bool:
+            out << (element.Bool() ? 1 : 0);
+            break;
+        case Date:
+            out << element.Date().toMillisSinceEpoch();
+            break;
+        case bsonTimestamp:
+            out << element.timestamp().getSecs();
+            break;
+        default:
+            out << element.numberLong();
+            break;
+    }
+}
+
+/**
+ * Writes 'field' as a CSV field, quoting it if needed.
+ */
+void writeCSVField(std::ostream& out, const std::string& field) {
+    if (field.find_first_of(",\"\n") == std::string::npos) {
+        out << field;
+        return;
+    }
+
+    out << '"';
+    for (char c : field) {
+        if (c == '"') {
+            out << '"';
+        }
+        out << c;
+    }
+    out << '"';
+}
+
+}  // namespace
+
+FTDCMetricsExporter::FTDCMetricsExporter(Options options, std::ostream& out)
+    : _options(std::move(options)), _out(out), _columns(_options.metrics) {}
+
+std::vector<boost::filesystem::path> FTDCMetricsExporter::listFiles(
+    const boost::filesystem::path& dir) {
+    std::vector<boost::filesystem::path> files;
+    bool hasInterimFile = false;
+
+    boost::filesystem::directory_iterator di(dir);
+    for (; di != boost::filesystem::directory_iterator(); di++) {
+        std::string name = di->path().filename().generic_string();
+
+        if (name == kFTDCInterimFile) {
+            hasInterimFile = true;
+        } else if (name.compare(0, strlen(kFTDCArchiveFile), kFTDCArchiveFile) == 0) {
+            files.push_back(di->path());
+        }
+    }
+
+    // Archive file names end with the time they were created, so they sort in the order they were
+    // written.
+    std::sort(files.begin(), files.end());
+
+    if (hasInterimFile) {
+        files.push_back(dir / kFTDCInterimFile);
+    }
+
+    return files;
+}
+
+Status FTDCMetricsExporter::exportFile(const boost::filesystem::path& file) {
+    FTDCFileReader reader;
+
+    Status s = reader.open(file);
+    if (!s.isOK()) {
+        return s;
+    }
+
+    while (true) {
+        auto swHasNext = reader.hasNext();
+        if (!swHasNext.isOK()) {
+            return swHasNext.getStatus();
+        }
+
+        if (!swHasNext.getValue()) {
+            return Status::OK();
+        }
+
+        auto next = reader.next();
+        if (std::get<0>(next) != FTDCBSONUtil::FTDCType::kMetricChunk) {
+            continue;
+        }
+
+        // A chunk's id is the time of its first sample, so there is nothing left to export once a
+        // chunk starts after the end of the range.
+        const Date_t chunkDate = std::get<2>(next);
+        if (chunkDate >= _options.end) {
+            return Status::OK();
+        }
+
+        const BSONObj& sample = std::get<1>(next);
+
+        BSONElement startElement = sample[kFTDCCollectStartField];
+        const Date_t sampleDate = startElement.type() == Date ? startElement.Date() : chunkDate;
+        if (sampleDate < _options.start || sampleDate >= _options.end) {
+            continue;
+        }
+
+        _writeSample(sample, sampleDate);
+    }
+}
+
+void FTDCMetricsExporter::_writeHeader() {
+    _wroteHeader = true;
+
+    if (_options.format != Format::kCSV) {
+        return;
+    }
+
+    _out << kFTDCCollectStartField;
+    for (const auto& column : _columns) {
+        _out << ',';
+        writeCSVField(_out, column);
+    }
+    _out << '\n';
+}
+
+void FTDCMetricsExporter::_writeSample(const BSONObj& sample, Date_t date) {
+    if (!_wroteHeader) {
+        if (_columns.empty()) {
+            collectMetricPaths(sample, "", &_columns);
+
+            // The collection time is always the first column.
+            _columns.erase(
+                std::remove(_columns.begin(), _columns.end(), kFTDCCollectStartField),
+                _columns.end());
+        }
+
+        _writeHeader();
+    }
+
+    if (_options.format == Format::kCSV) {
+        _out << dateToISOStringUTC(date);
+
+        for (const auto& column : _columns) {
+            _out << ',';
+
+            // Metrics missing from this sample are left empty.
+            BSONElement element = sample.getFieldDotted(column);
+            if (isMetric(element)) {
+                writeValue(_out, element);
+            }
+        }
+    } else {
+        _out << "{\"" << kFTDCCollectStartField << "\":\"" << dateToISOStringUTC(date) << '"';
+
+        for (const auto& column : _columns) {
+            BSONElement element = sample.getFieldDotted(column);
+            if (isMetric(element)) {
+                _out << ",\"" << escape(column) << "\":";
+                writeValue(_out, element);
+            }
+        }
+
+        _out << '}';
+    }
+
+    _out << '\n';
+    ++_samplesExported;
+}
+
+}  // namespace mongo
@@ -0,0 +1,111 @@
+/*    Copyright 2016 10gen Inc.
+ *
+ *    This program is free software: you can redistribute it and/or  modify
+ *    it under the terms of the GNU Affero General Public License, version 3,
+ *    as published by the Free Software Foundation.
+ *
+ *    This program is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *    GNU Affero General Public License for more details.
+ *
+ *    You should have received a copy of the GNU Affero General Public License
+ *    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ *    As a special exception, the copyright holders give permission to link the
+ *    code of portions of this program with the OpenSSL library under certain
+ *    conditions as described in each individual source file and distribute
+ *    linked combinations including the program with the OpenSSL library. You
+ *    must comply with the GNU Affero General Public License in all respects
+ *    for all of the code used other than as permitted herein. If you modify
+ *    file(s) with this exception, you may extend this exception to your
+ *    version of the file(s), but you are not obligated to do so. If you do not
+ *    wish to do so, delete this exception statement from your version. If you
+ *    delete this exception statement from all source files in the program,
+ *    then also delete it in the license file.
+ */
+
+
+#pragma once
+
+#include <boost/filesystem/path.hpp>
+#include <iosfwd>
+#include <string>
+#include <vector>
+
+#include "mongo/base/disallow_copying.h"
+#include "mongo/base/status.h"
+#include "mongo/db/jsobj.h"
+#include "mongo/util/time_support.h"
+
+namespace mongo {
+
+/**
+ * Writes selected metrics from FTDC files out as CSV or JSON, one row per sample, for analysis
+ * with other tools.
+ *
+ * Files must be exported in the order they were written.
+ */
+class FTDCMetricsExporter {
+    MONGO_DISALLOW_COPYING(FTDCMetricsExporter);
+
+public:
+    enum class Format {
+        // A header row naming the columns, then one comma separated row per sample.
+        kCSV,
+
+        // One JSON object per line per sample.
+        kJSON,
+    };
+
+    struct Options {
+        Format format{Format::kCSV};
+
+        // Dotted paths of the metrics to export, e.g. "serverStatus.opcounters.insert". If empty,
+        // every metric in the first sample exported is used.
+        std::vector<std::string> metrics;
+
+        // Only samples collected in [start, end) are exported.
+        Date_t start;
+        Date_t end{Date_t::max()};
+    };
+
+    FTDCMetricsExporter(Options options, std::ostream& out);
+
+    /**
+     * Exports the samples in an archive or interim file.
+     */
+    Status exportFile(const boost::filesystem::path& file);
+
+    /**
+     * Returns the FTDC files in a diagnostic data directory in the order they were written, i.e.
+     * the archive files followed by the interim file.
+     */
+    static std::vector<boost::filesystem::path> listFiles(const boost::filesystem::path& dir);
+
+    /**
+     * Returns the number of samples written out so far.
+     */
+    long long samplesExported() const {
+        return _samplesExported;
+    }
+
+private:
+    void _writeHeader();
+
+    void _writeSample(const BSONObj& sample, Date_t date);
+
+private:
+    const Options _options;
+
+    std::ostream& _out;
+
+    // The metrics being exported, fixed by the first sample if none were specified.
+    std::vector<std::string> _columns;
+
+    bool _wroteHeader{false};
+
+    long long _samplesExported{0};
+};
+
+}  // namespace mongo
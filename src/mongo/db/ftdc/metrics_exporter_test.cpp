@@ -0,0 +1,134 @@
+/*    Copyright 2016 10gen Inc.
+ *
+ *    This program is free software: you can redistribute it and/or  modify
+ *    it under the terms of the GNU Affero General Public License, version 3,
+ *    as published by the Free Software Foundation.
+ *
+ *    This program is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *    GNU Affero General Public License for more details.
+ *
+ *    You should have received a copy of the GNU Affero General Public License
+ *    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ *    As a special exception, the copyright holders give permission to link the
+ *    code of portions of this program with the OpenSSL library under certain
+ *    conditions as described in each individual source file and distribute
+ *    linked combinations including the program with the OpenSSL library. You
+ *    must comply with the GNU Affero General Public License in all respects
+ *    for all of the code used other than as permitted herein. If you modify
+ *    file(s) with this exception, you may extend this exception to your
+ *    version of the file(s), but you are not obligated to do so. If you do not
+ *    wish to do so, delete this exception statement from your version. If you
+ *    delete this exception statement from all source files in the program,
+ *    then also delete it in the license file.
+ */
+
+
+#include "mongo/platform/basic.h"
+
+#include <boost/filesystem.hpp>
+#include <fstream>
+#include <sstream>
+
+#include "mongo/bson/bsonobjbuilder.h"
+#include "mongo/db/ftdc/config.h"
+#include "mongo/db/ftdc/file_writer.h"
+#include "mongo/db/ftdc/metrics_exporter.h"
+#include "mongo/db/jsobj.h"
+#include "mongo/unittest/temp_dir.h"
+#include "mongo/unittest/unittest.h"
+
+namespace mongo {
+
+namespace {
+
+// Writes an archive file with a sample every second for 'count' seconds.
+void writeTestFile(const boost::filesystem::path& p, int count) {
+    FTDCConfig config;
+    FTDCFileWriter writer(&config);
+
+    ASSERT_OK(writer.open(p));
+    ASSERT_OK(writer.writeMetadata(BSON("host"
+                                        << "test"),
+                                   Date_t()));
+
+    for (int i = 0; i < count; i++) {
+        Date_t date = Date_t::fromMillisSinceEpoch(i * 1000);
+        ASSERT_OK(writer.writeSample(BSON("start" << date << "ss"
+                                                  << BSON("a" << i << "b"
+                                                              << BSON("c" << i * 2.0 << "up"
+                                                                          << true))
+                                                  << "end" << date),
+                                     date));
+    }
+
+    ASSERT_OK(writer.close());
+}
+
+}  // namespace
+
+TEST(FTDCMetricsExporterTest, CSVForSelectedMetricsAndRange) {
+    unittest::TempDir tempdir("metrics_exporter_test");
+    boost::filesystem::path p(tempdir.path());
+    p /= "metrics.2016-01-01T00-00-00Z-00000";
+    writeTestFile(p, 10);
+
+    FTDCMetricsExporter::Options options;
+    options.metrics = {"ss.a", "ss.b.c", "ss.missing"};
+    options.start = Date_t::fromMillisSinceEpoch(2000);
+    options.end = Date_t::fromMillisSinceEpoch(4000);
+
+    std::ostringstream out;
+    FTDCMetricsExporter exporter(options, out);
+    ASSERT_OK(exporter.exportFile(p));
+
+    ASSERT_EQUALS(2, exporter.samplesExported());
+    ASSERT_EQUALS(
+        "start,ss.a,ss.b.c,ss.missing\n"
+        "1970-01-01T00:00:02.000Z,2,4,\n"
+        "1970-01-01T00:00:03.000Z,3,6,\n",
+        out.str());
+}
+
+TEST(FTDCMetricsExporterTest, JSONForAllMetrics) {
+    unittest::TempDir tempdir("metrics_exporter_test");
+    boost::filesystem::path p(tempdir.path());
+    p /= "metrics.2016-01-01T00-00-00Z-00000";
+    writeTestFile(p, 2);
+
+    FTDCMetricsExporter::Options options;
+    options.format = FTDCMetricsExporter::Format::kJSON;
+
+    std::ostringstream out;
+    FTDCMetricsExporter exporter(options, out);
+    ASSERT_OK(exporter.exportFile(p));
+
+    ASSERT_EQUALS(
+        "{\"start\":\"1970-01-01T00:00:00.000Z\",\"ss.a\":0,\"ss.b.c\":0,\"ss.b.up\":1,"
+        "\"end\":0}\n"
+        "{\"start\":\"1970-01-01T00:00:01.000Z\",\"ss.a\":1,\"ss.b.c\":2,\"ss.b.up\":1,"
+        "\"end\":1000}\n",
+        out.str());
+}
+
+TEST(FTDCMetricsExporterTest, ListFilesInWriteOrder) {
+    unittest::TempDir tempdir("metrics_exporter_test");
+    boost::filesystem::path dir(tempdir.path());
+
+    for (auto name : {"metrics.interim",
+                      "metrics.2016-01-02T00-00-00Z-00000",
+                      "metrics.2016-01-01T00-00-00Z-00000",
+                      "other"}) {
+        std::ofstream file((dir / name).string());
+    }
+
+    auto files = FTDCMetricsExporter::listFiles(dir);
+    ASSERT_EQUALS(3U, files.size());
+    ASSERT_EQUALS("metrics.2016-01-01T00-00-00Z-00000", files[0].filename().string());
+    ASSERT_EQUALS("metrics.2016-01-02T00-00-00Z-00000", files[1].filename().string());
+    ASSERT_EQUALS("metrics.interim", files[2].filename().string());
+}
+
+}  // namespace mongo
@@ -0,0 +1,145 @@
+/*    Copyright 2016 10gen Inc.
+ *
+ *    This program is free software: you can redistribute it and/or  modify
+ *    it under the terms of the GNU Affero General Public License, version 3,
+ *    as published by the Free Software Foundation.
+ *
+ *    This program is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *    GNU Affero General Public License for more details.
+ *
+ *    You should have received a copy of the GNU Affero General Public License
+ *    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ *    As a special exception, the copyright holders give permission to link the
+ *    code of portions of this program with the OpenSSL library under certain
+ *    conditions as described in each individual source file and distribute
+ *    linked combinations including the program with the OpenSSL library. You
+ *    must comply with the GNU Affero General Public License in all respects
+ *    for all of the code used other than as permitted herein. If you modify
+ *    file(s) with this exception, you may extend this exception to your
+ *    version of the file(s), but you are not obligated to do so. If you do not
+ *    wish to do so, delete this exception statement from your version. If you
+ *    delete this exception statement from all source files in the program,
+ *    then also delete it in the license file.
+ */
+
+
+/**
+ * mongoftdc exports metrics from the full time diagnostic data capture files written by mongod
+ * (the files in the diagnostic.data directory) as CSV or JSON.
+ *
+ *   mongoftdc [--json] [--metric <path>]... [--start <date>] [--end <date>] <path>...
+ */
+
+#include "mongo/platform/basic.h"
+
+#include <boost/filesystem.hpp>
+#include <iostream>
+#include <string>
+#include <vector>
+
+#include "mongo/base/initializer.h"
+#include "mongo/db/ftdc/metrics_exporter.h"
+#include "mongo/util/exit_code.h"
+#include "mongo/util/quick_exit.h"
+#include "mongo/util/text.h"
+#include "mongo/util/time_support.h"
+
+namespace mongo {
+namespace {
+
+void printUsage(std::ostream& out) {
+    out << "usage: mongoftdc [options] <diagnostic.data directory or metrics file>...\n"
+           "\n"
+           "Writes one row per sample to stdout.\n"
+           "\n"
+           "options:\n"
+           "  --json            write a JSON object per sample instead of CSV\n"
+           "  --metric <path>   dotted path of a metric to export, e.g.\n"
+           "                    serverStatus.opcounters.insert. May be repeated. By default\n"
+           "                    every metric in the first sample exported is used.\n"
+           "  --start <date>    only export samples collected at or after this ISO-8601 date\n"
+           "  --end <date>      only export samples collected before this ISO-8601 date\n";
+}
+
+int ftdcMain(int argc, char** argv, char** envp) {
+    runGlobalInitializersOrDie(argc, argv, envp);
+
+    FTDCMetricsExporter::Options options;
+    std::vector<boost::filesystem::path> paths;
+
+    for (int i = 1; i < argc; i++) {
+        const std::string arg = argv[i];
+        const bool hasValue = i + 1 < argc;
+
+        if (arg == "--help" || arg == "-h") {
+            printUsage(std::cout);
+            return EXIT_CLEAN;
+        } else if (arg == "--json") {
+            options.format = FTDCMetricsExporter::Format::kJSON;
+        } else if (arg == "--metric" && hasValue) {
+            options.metrics.push_back(argv[++i]);
+        } else if ((arg == "--start" || arg == "--end") && hasValue) {
+            auto swDate = dateFromISOString(argv[++i]);
+            if (!swDate.isOK()) {
+                std::cerr << "invalid date for " << arg << ": " << swDate.getStatus() << std::endl;
+                return EXIT_BADOPTIONS;
+            }
+            (arg == "--start" ? options.start : options.end) = swDate.getValue();
+        } else if (arg.compare(0, 2, "--") == 0) {
+            std::cerr << "unknown or incomplete option " << arg << std::endl;
+            printUsage(std::cerr);
+            return EXIT_BADOPTIONS;
+        } else {
+            paths.emplace_back(arg);
+        }
+    }
+
+    if (paths.empty()) {
+        printUsage(std::cerr);
+        return EXIT_BADOPTIONS;
+    }
+
+    FTDCMetricsExporter exporter(options, std::cout);
+
+    for (const auto& path : paths) {
+        std::vector<boost::filesystem::path> files;
+        if (boost::filesystem::is_directory(path)) {
+            files = FTDCMetricsExporter::listFiles(path);
+        } else {
+            files.push_back(path);
+        }
+
+        for (const auto& file : files) {
+            Status s = exporter.exportFile(file);
+            if (!s.isOK()) {
+                std::cerr << "failed to read " << file.generic_string() << ": " << s << std::endl;
+                return EXIT_FAILURE;
+            }
+        }
+    }
+
+    std::cout.flush();
+    return EXIT_CLEAN;
+}
+
+}  // namespace
+}  // namespace mongo
+
+#if defined(_WIN32)
+// In Windows, wmain() is an alternate entry point for main(), and receives the same parameters
+// as main() but encoded in Windows Unicode (UTF-16). The WindowsCommandLine object converts them
+// to UTF-8 for ftdcMain().
+int wmain(int argc, wchar_t* argvW[], wchar_t* envpW[]) {
+    mongo::WindowsCommandLine wcl(argc, argvW, envpW);
+    int exitCode = mongo::ftdcMain(argc, wcl.argv(), wcl.envp());
+    mongo::quickExit(exitCode);
+}
+#else
+int main(int argc, char* argv[], char** envp) {
+    int exitCode = mongo::ftdcMain(argc, argv, envp);
+    mongo::quickExit(exitCode);
+}
+#endif
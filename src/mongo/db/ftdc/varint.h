@@ -52,11 +52,43 @@ struct FTDCVarInt {
     FTDCVarInt() = default;
     FTDCVarInt(std::uint64_t t) : _value(t) {}
 
+    /**
+     * Encodes 'value' at 'ptr' and returns the position after it. 'ptr' must have room for
+     * kMaxSizeBytes64 bytes as the space is not checked.
+     */
+    static char* encodeUnchecked(char* ptr, std::uint64_t value) {
+        // Most deltas are small, so avoid the call for values which fit in a single byte.
+        if (value < 0x80) {
+            *ptr = static_cast<char>(value);
+            return ptr + 1;
+        }
+
+        return _encodeMultiByte(ptr, value);
+    }
+
+    /**
+     * Decodes the value at 'ptr' into '*value' and returns the position after it. 'end' should be
+     * the byte after the end of the buffer.
+     *
+     * Returns nullptr if the data is truncated or badly encoded.
+     */
+    static const char* decode(const char* ptr, const char* end, std::uint64_t* value) {
+        if (ptr < end && static_cast<unsigned char>(*ptr) < 0x80) {
+            *value = static_cast<unsigned char>(*ptr);
+            return ptr + 1;
+        }
+
+        return _decodeMultiByte(ptr, end, value);
+    }
+
     operator std::uint64_t() const {
         return _value;
     }
 
 private:
+    static char* _encodeMultiByte(char* ptr, std::uint64_t value);
+    static const char* _decodeMultiByte(const char* ptr, const char* end, std::uint64_t* value);
+
     std::uint64_t _value{0};
 };
 
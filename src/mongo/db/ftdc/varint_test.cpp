@@ -28,6 +28,10 @@
 
 #include "mongo/platform/basic.h"
 
+#include <cstring>
+#include <limits>
+#include <vector>
+
 #include "mongo/base/data_builder.h"
 #include "mongo/base/data_type_validated.h"
 #include "mongo/base/init.h"
@@ -85,4 +89,29 @@ TEST(FTDCVarIntTest, TestDataBuilder) {
     };
 }
 
+// Test the unchecked encoder and decoder produce the same bytes as the DataType handler
+TEST(FTDCVarIntTest, TestUncheckedMatchesDataType) {
+    std::vector<std::uint64_t> values = {0, 1, 0x7f, 0x80, 0x3fff, 0x4000, 1ULL << 62};
+    values.push_back(std::numeric_limits<std::uint64_t>::max());
+
+    for (auto value : values) {
+        char expected[FTDCVarInt::kMaxSizeBytes64];
+        size_t expectedLength;
+        ASSERT_OK(DataType::store(
+            FTDCVarInt(value), expected, sizeof(expected), &expectedLength, 0));
+
+        char actual[FTDCVarInt::kMaxSizeBytes64];
+        char* actualEnd = FTDCVarInt::encodeUnchecked(actual, value);
+        ASSERT_EQUALS(expectedLength, static_cast<size_t>(actualEnd - actual));
+        ASSERT_EQUALS(0, memcmp(expected, actual, expectedLength));
+
+        std::uint64_t decoded;
+        ASSERT_TRUE(FTDCVarInt::decode(actual, actualEnd, &decoded) == actualEnd);
+        ASSERT_EQUALS(value, decoded);
+
+        // A value cut short is reported as corrupt.
+        ASSERT_TRUE(FTDCVarInt::decode(actual, actualEnd - 1, &decoded) == nullptr);
+    }
+}
+
 }  // namespace mongo
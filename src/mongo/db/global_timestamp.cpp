@@ -46,10 +46,16 @@ Timestamp getLastSetTimestamp() {
 }
 
 Timestamp getNextGlobalTimestamp() {
+    return getNextGlobalTimestamps(1);
+}
+
+Timestamp getNextGlobalTimestamps(unsigned count) {
+    invariant(count > 0);
     const unsigned now = Date_t::now().toMillisSinceEpoch() / 1000;
 
-    // Optimistic approach: just increment the timestamp, assuming the seconds still match.
-    auto next = globalTimestamp.addAndFetch(1);
+    // Optimistic approach: just increment the timestamp, assuming the seconds still match. The
+    // reserved Timestamps end at 'next'.
+    auto next = globalTimestamp.addAndFetch(count);
     unsigned globalSecs = Timestamp(next).getSecs();
 
     // Fail if time is not moving forward for 2**31 calls to getNextGlobalTimestamp.
@@ -62,20 +68,21 @@ Timestamp getNextGlobalTimestamp() {
     //  While the seconds need to be updated, try to do it.
     while (globalSecs < now) {
         const auto expected = next;
-        const auto desired = Timestamp(now, 1).asULL();
+        const auto desired = Timestamp(now, count).asULL();
 
         // If the compareAndSwap was not successful, assume someone else updated the seconds.
         auto actual = globalTimestamp.compareAndSwap(expected, desired);
         if (actual == expected) {
             next = desired;
         } else {
-            next = globalTimestamp.addAndFetch(1);
+            next = globalTimestamp.addAndFetch(count);
         }
 
         // Either way, the seconds should no longer be less than now, but repeat if we raced.
         globalSecs = Timestamp(next).getSecs();
     }
 
-    return Timestamp(next);
+    // The increment of 'next' is at least 'count', so the first Timestamp has the same seconds.
+    return Timestamp(next - (count - 1));
 }
 }  // namespace mongo
@@ -42,4 +42,10 @@ Timestamp getLastSetTimestamp();
  * Generates a new and unique Timestamp.
  */
 Timestamp getNextGlobalTimestamp();
+
+/**
+ * Generates 'count' new and unique Timestamps, which have the same seconds and consecutive
+ * increments, and returns the first of them.
+ */
+Timestamp getNextGlobalTimestamps(unsigned count);
 }
@@ -55,6 +55,12 @@ using std::vector;
 
 MONGO_EXPORT_SERVER_PARAMETER(failIndexKeyTooLong, bool, true);
 
+namespace {
+// The memory a BulkBuilder may use for keys before it spills them to disk, unless its creator
+// asks for a different limit.
+const size_t kDefaultMaxBulkMemoryUsageBytes = 100 * 1024 * 1024;
+}  // namespace
+
 //
 // Comparison for external sorter interface
 //
@@ -324,16 +330,23 @@ Status IndexAccessMethod::update(OperationContext* txn,
 }
 
 std::unique_ptr<IndexAccessMethod::BulkBuilder> IndexAccessMethod::initiateBulk() {
-    return std::unique_ptr<BulkBuilder>(new BulkBuilder(this, _descriptor));
+    return initiateBulk(kDefaultMaxBulkMemoryUsageBytes);
+}
+
+std::unique_ptr<IndexAccessMethod::BulkBuilder> IndexAccessMethod::initiateBulk(
+    size_t maxMemoryUsageBytes) {
+    return std::unique_ptr<BulkBuilder>(new BulkBuilder(this, _descriptor, maxMemoryUsageBytes));
 }
 
 IndexAccessMethod::BulkBuilder::BulkBuilder(const IndexAccessMethod* index,
-                                            const IndexDescriptor* descriptor)
+                                            const IndexDescriptor* descriptor,
+                                            size_t maxMemoryUsageBytes)
     : _sorter(Sorter::make(
           SortOptions()
               .TempDir(storageGlobalParams.dbpath + "/_tmp")
               .ExtSortAllowed()
-              .MaxMemoryUsageBytes(100 * 1024 * 1024),
+              .SpillInBackground()
+              .MaxMemoryUsageBytes(maxMemoryUsageBytes),
           BtreeExternalSortComparison(descriptor->keyPattern(), descriptor->version()))),
       _real(index) {}
 
@@ -359,20 +372,54 @@ Status IndexAccessMethod::BulkBuilder::insert(OperationContext* txn,
     return Status::OK();
 }
 
+void IndexAccessMethod::BulkBuilder::sortKeys() {
+    if (!_sorted) {
+        _sorted.reset(_sorter->done());
+    }
+}
 
 Status IndexAccessMethod::commitBulk(OperationContext* txn,
                                      std::unique_ptr<BulkBuilder> bulk,
                                      bool mayInterrupt,
                                      bool dupsAllowed,
                                      set<RecordId>* dupsToDrop) {
+    std::vector<std::unique_ptr<BulkBuilder>> bulks;
+    bulks.push_back(std::move(bulk));
+    return commitBulk(txn, std::move(bulks), mayInterrupt, dupsAllowed, dupsToDrop);
+}
+
+Status IndexAccessMethod::commitBulk(OperationContext* txn,
+                                     std::vector<std::unique_ptr<BulkBuilder>> bulks,
+                                     bool mayInterrupt,
+                                     bool dupsAllowed,
+                                     set<RecordId>* dupsToDrop) {
+    invariant(!bulks.empty());
     Timer timer;
 
-    std::unique_ptr<BulkBuilder::Sorter::Iterator> i(bulk->_sorter->done());
+    std::vector<std::shared_ptr<BulkBuilder::Sorter::Iterator>> sortedRuns;
+    int64_t keysInserted = 0;
+    bool isMultiKey = false;
+    for (auto&& bulk : bulks) {
+        bulk->sortKeys();
+        sortedRuns.push_back(bulk->_sorted);
+        keysInserted += bulk->_keysInserted;
+        isMultiKey = isMultiKey || bulk->_isMultiKey;
+    }
+
+    // Every run is sorted by (key, RecordId), so merging them yields the same order as a single
+    // BulkBuilder holding all of the keys.
+    std::shared_ptr<BulkBuilder::Sorter::Iterator> i = sortedRuns.front();
+    if (sortedRuns.size() > 1) {
+        i.reset(BulkBuilder::Sorter::Iterator::merge(
+            sortedRuns,
+            SortOptions(),
+            BtreeExternalSortComparison(_descriptor->keyPattern(), _descriptor->version())));
+    }
 
     stdx::unique_lock<Client> lk(*txn->getClient());
     ProgressMeterHolder pm(*txn->setMessage_inlock("Index Bulk Build: (2/3) btree bottom up",
                                                    "Index: (2/3) BTree Bottom Up Progress",
-                                                   bulk->_keysInserted,
+                                                   keysInserted,
                                                    10));
     lk.unlock();
 
@@ -381,7 +428,7 @@ Status IndexAccessMethod::commitBulk(OperationContext* txn,
     MONGO_WRITE_CONFLICT_RETRY_LOOP_BEGIN {
         WriteUnitOfWork wunit(txn);
 
-        if (bulk->_isMultiKey) {
+        if (isMultiKey) {
             _btreeState->setMultikey(txn);
         }
 
@@ -30,6 +30,7 @@
 
 #include <atomic>
 #include <memory>
+#include <vector>
 
 #include "mongo/base/disallow_copying.h"
 #include "mongo/db/index/index_descriptor.h"
@@ -200,14 +201,24 @@ public:
                       const InsertDeleteOptions& options,
                       int64_t* numInserted);
 
+        /**
+         * Sorts the keys inserted so far. No more keys may be inserted afterwards. commitBulk()
+         * does this if it has not already been done, but it may be called earlier from another
+         * thread so that several BulkBuilders for the same index sort their keys concurrently.
+         */
+        void sortKeys();
+
     private:
         friend class IndexAccessMethod;
 
         using Sorter = mongo::Sorter<BSONObj, RecordId>;
 
-        BulkBuilder(const IndexAccessMethod* index, const IndexDescriptor* descriptor);
+        BulkBuilder(const IndexAccessMethod* index,
+                    const IndexDescriptor* descriptor,
+                    size_t maxMemoryUsageBytes);
 
         std::unique_ptr<Sorter> _sorter;
+        std::shared_ptr<Sorter::Iterator> _sorted;  // Set by sortKeys().
         const IndexAccessMethod* _real;
         int64_t _keysInserted = 0;
         bool _isMultiKey = false;
@@ -222,6 +233,12 @@ public:
      */
     std::unique_ptr<BulkBuilder> initiateBulk();
 
+    /**
+     * Same as above, but the BulkBuilder spills its keys to disk once they use more than
+     * 'maxMemoryUsageBytes'.
+     */
+    std::unique_ptr<BulkBuilder> initiateBulk(size_t maxMemoryUsageBytes);
+
     /**
      * Call this when you are ready to finish your bulk work.
      * Pass in the BulkBuilder returned from initiateBulk.
@@ -237,6 +254,16 @@ public:
                       bool dupsAllowed,
                       std::set<RecordId>* dups);
 
+    /**
+     * Same as above, but merges the keys of several BulkBuilders for this index, each of which
+     * holds the keys for a disjoint set of documents.
+     */
+    Status commitBulk(OperationContext* txn,
+                      std::vector<std::unique_ptr<BulkBuilder>> bulks,
+                      bool mayInterrupt,
+                      bool dupsAllowed,
+                      std::set<RecordId>* dups);
+
     /**
      * Fills 'keys' with the keys that should be generated for 'obj' on this index.
      */
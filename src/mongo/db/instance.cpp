@@ -30,6 +30,7 @@
 
 #include "mongo/platform/basic.h"
 
+#include <cstdlib>
 #include <fstream>
 #include <memory>
 
@@ -74,6 +75,7 @@
 #include "mongo/db/ops/update_driver.h"
 #include "mongo/db/ops/update_lifecycle_impl.h"
 #include "mongo/db/ops/update_request.h"
+#include "mongo/db/query/canonical_query.h"
 #include "mongo/db/query/find.h"
 #include "mongo/db/query/get_executor.h"
 #include "mongo/db/repl/oplog.h"
@@ -408,6 +410,44 @@ static void receivedQuery(OperationContext* txn,
     dbResponse.responseTo = responseTo;
 }
 
+// Returns the class in which a legacy (non-command) operation waits for a storage engine ticket.
+static TicketQueueClass legacyOpTicketQueueClass(Client& c,
+                                                 NetworkOp op,
+                                                 const NamespaceString& nss,
+                                                 Message& m) {
+    if (AuthorizationSession::get(c)->isAuthenticatedAsInternalUser()) {
+        return TicketQueueClass::kInternal;
+    }
+
+    switch (op) {
+        case dbQuery: {
+            if (nss.isOplog()) {
+                return TicketQueueClass::kInternal;
+            }
+            DbMessage d(m);
+            QueryMessage q(d);
+            BSONObj filter = q.query;
+            if (filter["$query"].isABSONObj()) {
+                filter = filter["$query"].Obj();
+            } else if (filter["query"].isABSONObj()) {
+                filter = filter["query"].Obj();
+            }
+            if (std::abs(q.ntoreturn) == 1 || CanonicalQuery::isSimpleIdQuery(filter)) {
+                return TicketQueueClass::kPointRead;
+            }
+            return TicketQueueClass::kScan;
+        }
+        case dbGetMore:
+            return nss.isOplog() ? TicketQueueClass::kInternal : TicketQueueClass::kScan;
+        case dbInsert:
+        case dbUpdate:
+        case dbDelete:
+            return TicketQueueClass::kWrite;
+        default:
+            return TicketQueueClass::kAdmin;
+    }
+}
+
 // Mongod on win32 defines a value for this function. In all other executables it is NULL.
 void (*reportEventToSystem)(const char* msg) = 0;
 
@@ -501,6 +541,11 @@ void assembleResponse(OperationContext* txn,
             break;
     }
 
+    // Commands are classified once their Command is known, in Command::execCommand.
+    if (!c.isInDirectClient() && !isCommand) {
+        txn->lockState()->setTicketQueueClass(legacyOpTicketQueueClass(c, op, nsString, m));
+    }
+
     CurOp& currentOp = *CurOp::get(txn);
     {
         stdx::lock_guard<Client> lk(*txn->getClient());
@@ -592,6 +637,7 @@ void assembleResponse(OperationContext* txn,
     currentOp.ensureStarted();
     currentOp.done();
     debug.executionTime = currentOp.totalTimeMillis();
+    debug.recordResourceUsage(txn);
 
     logThreshold += currentOp.getExpectedLatencyMs();
 
@@ -99,14 +99,26 @@ RecoveryUnit* OperationContextImpl::recoveryUnit() const {
 }
 
 RecoveryUnit* OperationContextImpl::releaseRecoveryUnit() {
+    // currentOp reads the resource usage of the RecoveryUnit under the Client lock.
+    stdx::lock_guard<Client> lk(*getClient());
     return _recovery.release();
 }
 
 OperationContext::RecoveryUnitState OperationContextImpl::setRecoveryUnit(RecoveryUnit* unit,
                                                                           RecoveryUnitState state) {
-    _recovery.reset(unit);
-    RecoveryUnitState oldState = _ruState;
-    _ruState = state;
+    std::unique_ptr<RecoveryUnit> oldUnit;
+    RecoveryUnitState oldState;
+    {
+        stdx::lock_guard<Client> lk(*getClient());
+        oldUnit.reset(_recovery.release());
+        _recovery.reset(unit);
+        oldState = _ruState;
+        _ruState = state;
+    }
+
+    // Destroying the old unit may roll back or close a storage engine session, which should not
+    // happen under the Client lock.
+    oldUnit.reset();
     return oldState;
 }
 
@@ -32,6 +32,7 @@
 
 #include <boost/optional.hpp>
 #include <boost/intrusive_ptr.hpp>
+#include <atomic>
 #include <deque>
 #include <list>
 #include <string>
@@ -407,6 +408,74 @@ private:
     std::shared_ptr<PlanExecutor> _exec;  // PipelineProxyStage holds a weak_ptr to this.
 };
 
+/**
+ * Runs the leading stages of a pipeline on several worker threads, each over a disjoint part of a
+ * collection scan, and returns the documents they produce. The worker pipeline is the shard half
+ * of the pipeline as split by Pipeline::splitForSharded(), and the rest of the pipeline merges
+ * the workers' partial results just as it would merge the results from several shards.
+ *
+ * Workers are started on the first call to getNext(), so explaining the pipeline does not run
+ * them. Each worker has its own Client and OperationContext, and outlives this source if needed:
+ * dispose() kills the workers' operations but does not wait for them to finish.
+ */
+class DocumentSourceParallelCursor final : public DocumentSource {
+public:
+    // virtuals from DocumentSource
+    ~DocumentSourceParallelCursor() final;
+    boost::optional<Document> getNext() final;
+    const char* getSourceName() const final;
+    Value serialize(bool explain = false) const final;
+    bool isValidInitialSource() const final {
+        return true;
+    }
+    void dispose() final;
+
+    /**
+     * Creates a source which runs the pipeline described by 'workerPipeline', an aggregate command
+     * object, once over each PlanExecutor in 'execs'. The executors must have had their state
+     * saved and be detached from their OperationContext.
+     */
+    static boost::intrusive_ptr<DocumentSourceParallelCursor> create(
+        const NamespaceString& nss,
+        const BSONObj& workerPipeline,
+        std::vector<std::unique_ptr<PlanExecutor>> execs,
+        const boost::intrusive_ptr<ExpressionContext>& pExpCtx);
+
+private:
+    struct SharedState;
+
+    DocumentSourceParallelCursor(const NamespaceString& nss,
+                                 const BSONObj& workerPipeline,
+                                 std::vector<std::unique_ptr<PlanExecutor>> execs,
+                                 const boost::intrusive_ptr<ExpressionContext>& pExpCtx);
+
+    /**
+     * Body of a worker thread. Runs 'workerPipeline' over 'exec' and pushes its results onto the
+     * queue in 'state'.
+     */
+    static void runWorker(std::shared_ptr<SharedState> state,
+                          size_t workerIndex,
+                          NamespaceString nss,
+                          BSONObj workerPipeline,
+                          std::string tempDir,
+                          std::unique_ptr<PlanExecutor> exec);
+
+    void startWorkers();
+
+    const NamespaceString _nss;
+    const BSONObj _workerPipeline;
+    const size_t _numWorkers;
+
+    // Handed over to the worker threads when they are started.
+    std::vector<std::unique_ptr<PlanExecutor>> _execs;
+    bool _started = false;
+
+    std::shared_ptr<SharedState> _state;
+};
+
+// Number of bytes of group keys and accumulator state $group may hold in memory before it fails
+// or, if allowed, spills groups to disk.
+extern std::atomic<int> internalDocumentSourceGroupMaxMemoryBytes;  // NOLINT
 
 class DocumentSourceGroup final : public DocumentSource, public SplittableDocumentSource {
 public:
@@ -463,11 +532,79 @@ public:
 private:
     explicit DocumentSourceGroup(const boost::intrusive_ptr<ExpressionContext>& pExpCtx);
 
-    /// Spill groups map to disk and returns an iterator to the file.
-    std::shared_ptr<Sorter<Value, Value>::Iterator> spill();
+    typedef std::vector<boost::intrusive_ptr<Accumulator>> Accumulators;
+    typedef std::unordered_map<Value, Accumulators, Value::Hash> GroupsMap;
+
+    /**
+     * A subset of the groups, selected by the hash of their _id. Groups that did not fit in
+     * memory were written to 'spilledRuns' in the order they were spilled. If there are no
+     * spilled runs, 'groups' holds the final state of every group in the partition.
+     *
+     * A spilled run only opens its file while it is being read, so the runs of all partitions
+     * waiting to be re-aggregated do not hold file descriptors.
+     */
+    struct Partition {
+        GroupsMap groups;
+        long long memoryUsageBytes = 0;
+        std::vector<std::shared_ptr<Sorter<Value, Value>::Iterator>> spilledRuns;
+
+        // Depth of the aggregation pass that created this partition.
+        int depth = 0;
+    };
+
+    /**
+     * The state of one hash aggregation pass, either over the input documents or over the
+     * spilled runs of a partition from the previous pass. All groups live in 'groups' until the
+     * memory limit is first exceeded; from then on they are split into 'partitions', which are
+     * spilled individually, largest first, whenever the limit is exceeded again.
+     */
+    struct AggregationPass {
+        explicit AggregationPass(int depth) : depth(depth) {}
+
+        const int depth;
+        GroupsMap groups;
+        long long memoryUsageBytes = 0;
+        std::vector<Partition> partitions;
+        int numSpills = 0;
+    };
+
+    /// Spills 'groups' to disk in no particular order and returns an iterator to the file.
+    std::shared_ptr<Sorter<Value, Value>::Iterator> spill(const GroupsMap& groups);
+
+    /**
+     * Returns the group for 'id' in 'pass', creating it if necessary. Sets 'partitionOut' to the
+     * partition holding the group, or nullptr if 'pass' is not partitioned yet.
+     */
+    Accumulators& findOrCreateGroup(AggregationPass* pass,
+                                    const Value& id,
+                                    bool* inserted,
+                                    Partition** partitionOut);
 
-    // Only used by spill. Would be function-local if that were legal in C++03.
-    class SpillSTLComparator;
+    /**
+     * Splits the groups of 'pass' into partitions if that has not happened yet, then spills the
+     * largest partitions until at most half of the memory limit is in use.
+     */
+    void spillPartitions(AggregationPass* pass);
+    void spillPartition(AggregationPass* pass, Partition* partition);
+
+    /**
+     * Merges a group's spilled partial state into 'pass'.
+     */
+    void processSpilledGroup(AggregationPass* pass, const Value& id, const Value& state);
+
+    /**
+     * Queues the partitions produced by 'pass' for output. Partitions that spilled have their
+     * in-memory remainder spilled too, and are re-aggregated by a later pass.
+     */
+    void finishPass(AggregationPass* pass);
+
+    /**
+     * Loads the next queued partition into 'groups', re-aggregating its spilled runs if needed.
+     */
+    void loadNextPartition();
+
+    size_t partitionFor(const Value& id, int depth) const;
+    long long groupMemUsage(const Value& id, const Accumulators& accums) const;
 
     /*
       Before returning anything, this source must fetch everything from
@@ -495,8 +632,6 @@ private:
     Value expandId(const Value& val);
 
 
-    typedef std::vector<boost::intrusive_ptr<Accumulator>> Accumulators;
-    typedef std::unordered_map<Value, Accumulators, Value::Hash> GroupsMap;
     GroupsMap groups;
 
     /*
@@ -519,21 +654,17 @@ private:
     Document makeDocument(const Value& id, const Accumulators& accums, bool mergeableOutput);
 
     bool _doingMerge;
-    bool _spilled;
     const bool _extSortAllowed;
-    const int _maxMemoryUsageBytes;
+    const long long _maxMemoryUsageBytes;
     std::unique_ptr<Variables> _variables;
     std::vector<std::string> _idFieldNames;  // used when id is a document
     std::vector<boost::intrusive_ptr<Expression>> _idExpressions;
 
-    // only used when !_spilled
+    // Iterates over the groups currently being returned.
     GroupsMap::iterator groupsIterator;
 
-    // only used when _spilled
-    std::unique_ptr<Sorter<Value, Value>::Iterator> _sorterIterator;
-    std::pair<Value, Value> _firstPartOfNextGroup;
-    Value _currentId;
-    Accumulators _currentAccumulators;
+    // Partitions waiting to be loaded into 'groups' for output.
+    std::deque<Partition> _pendingPartitions;
 };
 
 /**
@@ -970,6 +1101,9 @@ private:
     long long count;
 };
 
+// Number of threads on which a $sort extracts the sort keys of its input and sorts them.
+extern std::atomic<int> internalDocumentSourceSortMaxDegreeOfParallelism;  // NOLINT
+
 class DocumentSourceSort final : public DocumentSource, public SplittableDocumentSource {
 public:
     // virtuals from DocumentSource
@@ -1055,6 +1189,12 @@ public:
         return limitSrc;
     }
 
+    /**
+     * Tells the sort stage which fields the stages after it use. When they do not need the whole
+     * document, a parallel sort holds only those fields and the ones it sorts by.
+     */
+    void setOutputDependencies(const DepsTracker& deps);
+
 private:
     explicit DocumentSourceSort(const boost::intrusive_ptr<ExpressionContext>& pExpCtx);
 
@@ -1076,6 +1216,15 @@ private:
     // This is used to merge pre-sorted results from a DocumentSourceMergeCursors.
     class IteratorFromCursor;
 
+    // Extracts the sort keys of the input and sorts them on several threads.
+    class ParallelLoader;
+
+    /// Sorts the input on 'numThreads' threads and merges their output.
+    void populateInParallel(size_t numThreads);
+
+    /// Returns the fields of 'doc' named in _heldFields, and its metadata, as BSON.
+    BSONObj extractHeldFields(const Document& doc) const;
+
     /* these two parallel each other */
     typedef std::vector<boost::intrusive_ptr<Expression>> SortKey;
     SortKey vSortKey;
@@ -1115,6 +1264,12 @@ private:
 
     bool _done;
     bool _mergingPresorted;
+
+    // The top-level fields that the stages after this one use or that this one sorts by, in no
+    // particular order. Only meaningful if _holdAllFields is false.
+    std::vector<std::string> _heldFields;
+    bool _holdAllFields = true;
+
     std::unique_ptr<MySorter> _sorter;
     std::unique_ptr<MySorter::Iterator> _output;
 };
@@ -1349,8 +1504,41 @@ private:
         invariant(false);
     }
 
+    /**
+     * How matches in the foreign collection are found for a batch of input documents. With an
+     * index on the foreign field each batch is resolved by one indexed $in query; otherwise each
+     * batch is resolved by a single collection scan whose results are hashed by the foreign field.
+     */
+    enum class Strategy { kUnknown, kIndexedBatch, kHashJoinBatch };
+
+    static const char* strategyName(Strategy strategy);
+
     boost::optional<Document> unwindResult();
     BSONObj queryForInput(const Document& input) const;
+    Value localKeyForInput(const Document& input) const;
+
+    /**
+     * Returns the next input document, reading and resolving a new batch of input documents when
+     * the current one is exhausted. Returns boost::none when the source is exhausted.
+     */
+    boost::optional<Document> nextInput();
+
+    /**
+     * Picks the batching strategy based on the indexes of the foreign collection.
+     */
+    Strategy pickStrategy() const;
+
+    /**
+     * Fills '_inputBatch' from the source and looks up the foreign documents matching all of the
+     * distinct batchable local keys with a single query, populating '_batchMatches'.
+     */
+    void loadInputBatch();
+
+    /**
+     * Returns the foreign documents matching 'input' if they were resolved as part of the current
+     * batch, or nullptr if 'input' must be looked up with its own query.
+     */
+    const std::vector<BSONObj>* batchedMatchesForInput(const Document& input) const;
 
     NamespaceString _fromNs;
     FieldPath _as;
@@ -1363,5 +1551,19 @@ private:
     std::unique_ptr<DBClientCursor> _cursor;
     long long _cursorIndex = 0;
     boost::optional<Document> _input;
+
+    // Batched execution state. '_batchMatches' maps each distinct local key of the documents in
+    // '_inputBatch' to the foreign documents it matched. When '_handlingUnwind' is set and the
+    // current input was resolved by its batch, '_unwindMatches' points into '_batchMatches'.
+    Strategy _strategy = Strategy::kUnknown;
+    std::deque<Document> _inputBatch;
+    std::unordered_map<Value, std::vector<BSONObj>, Value::Hash> _batchMatches;
+    const std::vector<BSONObj>* _unwindMatches = nullptr;
+
+    // Execution statistics reported by explain.
+    long long _numBatches = 0;
+    long long _numKeysProbed = 0;
+    long long _numBatchesAbandoned = 0;
+    long long _numSingleQueries = 0;
 };
 }
@@ -36,6 +36,7 @@
 #include "mongo/db/pipeline/expression.h"
 #include "mongo/db/pipeline/expression_context.h"
 #include "mongo/db/pipeline/value.h"
+#include "mongo/db/server_parameters.h"
 
 namespace mongo {
 
@@ -44,6 +45,19 @@ using std::shared_ptr;
 using std::pair;
 using std::vector;
 
+MONGO_EXPORT_SERVER_PARAMETER(internalDocumentSourceGroupMaxMemoryBytes, int, 100 * 1024 * 1024);
+
+namespace {
+// Number of partitions the groups of an aggregation pass are split into once they exceed the
+// memory limit.
+const size_t kNumPartitions = 16;
+
+// Spilled partitions are re-aggregated by further passes, each of which splits the groups again
+// using a different hash. A partition that still does not fit in memory after this many passes is
+// dominated by a few very large groups, so the last pass keeps it in memory regardless.
+const int kMaxPassDepth = 4;
+}  // namespace
+
 REGISTER_DOCUMENT_SOURCE(group, DocumentSourceGroup::createFromBson);
 
 const char* DocumentSourceGroup::getSourceName() const {
@@ -56,68 +70,27 @@ boost::optional<Document> DocumentSourceGroup::getNext() {
     if (!populated)
         populate();
 
-    if (_spilled) {
-        if (!_sorterIterator)
-            return boost::none;
-
-        const size_t numAccumulators = vpAccumulatorFactory.size();
-        for (size_t i = 0; i < numAccumulators; i++) {
-            _currentAccumulators[i]->reset();  // prep accumulators for a new group
-        }
-
-        _currentId = _firstPartOfNextGroup.first;
-        while (_currentId == _firstPartOfNextGroup.first) {
-            // Inside of this loop, _firstPartOfNextGroup is the current data being processed.
-            // At loop exit, it is the first value to be processed in the next group.
-
-            switch (numAccumulators) {  // mirrors switch in spill()
-                case 0:                 // no Accumulators so no Values
-                    break;
-
-                case 1:  // single accumulators serialize as a single Value
-                    _currentAccumulators[0]->process(_firstPartOfNextGroup.second,
-                                                     /*merging=*/true);
-                    break;
-
-                default: {  // multiple accumulators serialize as an array
-                    const vector<Value>& accumulatorStates =
-                        _firstPartOfNextGroup.second.getArray();
-                    for (size_t i = 0; i < numAccumulators; i++) {
-                        _currentAccumulators[i]->process(accumulatorStates[i],
-                                                         /*merging=*/true);
-                    }
-                    break;
-                }
-            }
-
-            if (!_sorterIterator->more()) {
-                dispose();
-                break;
-            }
-
-            _firstPartOfNextGroup = _sorterIterator->next();
-        }
+    // Spilled partitions are re-aggregated one at a time, once the groups of the previous
+    // partition have all been returned.
+    while (groupsIterator == groups.end() && !_pendingPartitions.empty()) {
+        loadNextPartition();
+    }
 
-        return makeDocument(_currentId, _currentAccumulators, pExpCtx->inShard);
+    if (groupsIterator == groups.end())
+        return boost::none;
 
-    } else {
-        if (groups.empty())
-            return boost::none;
+    Document out = makeDocument(groupsIterator->first, groupsIterator->second, pExpCtx->inShard);
 
-        Document out =
-            makeDocument(groupsIterator->first, groupsIterator->second, pExpCtx->inShard);
+    if (++groupsIterator == groups.end() && _pendingPartitions.empty())
+        dispose();
 
-        if (++groupsIterator == groups.end())
-            dispose();
-
-        return out;
-    }
+    return out;
 }
 
 void DocumentSourceGroup::dispose() {
     // free our resources
     GroupsMap().swap(groups);
-    _sorterIterator.reset();
+    _pendingPartitions.clear();
 
     // make us look done
     groupsIterator = groups.end();
@@ -201,9 +174,8 @@ DocumentSourceGroup::DocumentSourceGroup(const intrusive_ptr<ExpressionContext>&
     : DocumentSource(pExpCtx),
       populated(false),
       _doingMerge(false),
-      _spilled(false),
       _extSortAllowed(pExpCtx->extSortAllowed && !pExpCtx->inRouter),
-      _maxMemoryUsageBytes(100 * 1024 * 1024) {}
+      _maxMemoryUsageBytes(internalDocumentSourceGroupMaxMemoryBytes.load()) {}
 
 void DocumentSourceGroup::addAccumulator(const std::string& fieldName,
                                          Accumulator::Factory accumulatorFactory,
@@ -295,33 +267,20 @@ intrusive_ptr<DocumentSource> DocumentSourceGroup::createFromBson(
     return pGroup;
 }
 
-namespace {
-class SorterComparator {
-public:
-    typedef pair<Value, Value> Data;
-    int operator()(const Data& lhs, const Data& rhs) const {
-        return Value::compare(lhs.first, rhs.first);
-    }
-};
-}
-
 void DocumentSourceGroup::populate() {
     const size_t numAccumulators = vpAccumulatorFactory.size();
     dassert(numAccumulators == vpExpression.size());
 
-    // pushed to on spill()
-    vector<shared_ptr<Sorter<Value, Value>::Iterator>> sortedFiles;
-    int memoryUsageBytes = 0;
+    AggregationPass pass(0);
 
     // This loop consumes all input from pSource and buckets it based on pIdExpression.
     while (boost::optional<Document> input = pSource->getNext()) {
-        if (memoryUsageBytes > _maxMemoryUsageBytes) {
+        if (pass.memoryUsageBytes > _maxMemoryUsageBytes) {
             uassert(16945,
                     "Exceeded memory limit for $group, but didn't allow external sort."
                     " Pass allowDiskUse:true to opt in.",
                     _extSortAllowed);
-            sortedFiles.push_back(spill());
-            memoryUsageBytes = 0;
+            spillPartitions(&pass);
         }
 
         _variables->setRoot(*input);
@@ -337,32 +296,27 @@ void DocumentSourceGroup::populate() {
           Look for the _id value in the map; if it's not there, add a
           new entry with a blank accumulator.
         */
-        const size_t oldSize = groups.size();
-        vector<intrusive_ptr<Accumulator>>& group = groups[id];
-        const bool inserted = groups.size() != oldSize;
+        bool inserted;
+        Partition* partition;
+        Accumulators& group = findOrCreateGroup(&pass, id, &inserted, &partition);
 
-        if (inserted) {
-            memoryUsageBytes += id.getApproximateSize();
-
-            // Add the accumulators
-            group.reserve(numAccumulators);
-            for (size_t i = 0; i < numAccumulators; i++) {
-                group.push_back(vpAccumulatorFactory[i]());
-            }
-        } else {
-            for (size_t i = 0; i < numAccumulators; i++) {
-                // subtract old mem usage. New usage added back after processing.
-                memoryUsageBytes -= group[i]->memUsageForSorter();
-            }
+        // subtract old mem usage. New usage added back after processing.
+        long long memoryUsageDelta = 0;
+        for (size_t i = 0; i < numAccumulators; i++) {
+            memoryUsageDelta -= group[i]->memUsageForSorter();
         }
 
         /* tickle all the accumulators for the group we found */
         dassert(numAccumulators == group.size());
         for (size_t i = 0; i < numAccumulators; i++) {
             group[i]->process(vpExpression[i]->evaluate(_variables.get()), _doingMerge);
-            memoryUsageBytes += group[i]->memUsageForSorter();
+            memoryUsageDelta += group[i]->memUsageForSorter();
         }
 
+        pass.memoryUsageBytes += memoryUsageDelta;
+        if (partition)
+            partition->memoryUsageBytes += memoryUsageDelta;
+
         // We are done with the ROOT document so release it.
         _variables->clearRoot();
 
@@ -374,86 +328,248 @@ void DocumentSourceGroup::populate() {
                 &&
                 !_extSortAllowed  // don't change behavior when testing external sort
                 &&
-                sortedFiles.size() < 20  // don't open too many FDs
+                pass.numSpills < 20  // don't open too many FDs
                 ) {
-                sortedFiles.push_back(spill());
+                spillPartitions(&pass);
             }
         }
     }
 
-    // These blocks do any final steps necessary to prepare to output results.
-    if (!sortedFiles.empty()) {
-        _spilled = true;
-        if (!groups.empty()) {
-            sortedFiles.push_back(spill());
-        }
+    finishPass(&pass);
+
+    if (!_pendingPartitions.empty()) {
+        loadNextPartition();
+    } else {
+        groupsIterator = groups.begin();
+    }
+
+    populated = true;
+}
 
-        // We won't be using groups again so free its memory.
-        GroupsMap().swap(groups);
+size_t DocumentSourceGroup::partitionFor(const Value& id, int depth) const {
+    // Each pass hashes with its own seed, so that the groups of a partition from the previous
+    // pass are spread over all of the partitions of the next one.
+    size_t seed = 0x9e3779b9 + depth;
+    id.hash_combine(seed);
+    return seed % kNumPartitions;
+}
+
+long long DocumentSourceGroup::groupMemUsage(const Value& id, const Accumulators& accums) const {
+    long long memoryUsageBytes = id.getApproximateSize();
+    for (auto&& accum : accums) {
+        memoryUsageBytes += accum->memUsageForSorter();
+    }
+    return memoryUsageBytes;
+}
+
+DocumentSourceGroup::Accumulators& DocumentSourceGroup::findOrCreateGroup(
+    AggregationPass* pass, const Value& id, bool* inserted, Partition** partitionOut) {
+    Partition* partition = nullptr;
+    GroupsMap* map = &pass->groups;
+    if (!pass->partitions.empty()) {
+        partition = &pass->partitions[partitionFor(id, pass->depth)];
+        map = &partition->groups;
+    }
+    *partitionOut = partition;
+
+    const size_t oldSize = map->size();
+    Accumulators& group = (*map)[id];
+    *inserted = map->size() != oldSize;
 
-        _sorterIterator.reset(
-            Sorter<Value, Value>::Iterator::merge(sortedFiles, SortOptions(), SorterComparator()));
+    if (*inserted) {
+        const long long idSize = id.getApproximateSize();
+        pass->memoryUsageBytes += idSize;
+        if (partition)
+            partition->memoryUsageBytes += idSize;
 
-        // prepare current to accumulate data
-        _currentAccumulators.reserve(numAccumulators);
+        // Add the accumulators
+        const size_t numAccumulators = vpAccumulatorFactory.size();
+        group.reserve(numAccumulators);
         for (size_t i = 0; i < numAccumulators; i++) {
-            _currentAccumulators.push_back(vpAccumulatorFactory[i]());
+            group.push_back(vpAccumulatorFactory[i]());
         }
+    }
 
-        verify(_sorterIterator->more());  // we put data in, we should get something out.
-        _firstPartOfNextGroup = _sorterIterator->next();
-    } else {
-        // start the group iterator
-        groupsIterator = groups.begin();
+    return group;
+}
+
+void DocumentSourceGroup::spillPartitions(AggregationPass* pass) {
+    if (pass->partitions.empty()) {
+        pass->partitions.resize(kNumPartitions);
+        for (auto&& partition : pass->partitions) {
+            partition.depth = pass->depth;
+        }
+
+        for (auto&& group : pass->groups) {
+            Partition& partition = pass->partitions[partitionFor(group.first, pass->depth)];
+            partition.memoryUsageBytes += groupMemUsage(group.first, group.second);
+            partition.groups.emplace(group.first, std::move(group.second));
+        }
+        GroupsMap().swap(pass->groups);
     }
 
-    populated = true;
+    // Spilling down to half of the limit, rather than just below it, leaves room for the groups
+    // that are kept in memory to keep absorbing input before the next spill.
+    do {
+        Partition* largest = &pass->partitions[0];
+        for (auto&& partition : pass->partitions) {
+            if (partition.memoryUsageBytes > largest->memoryUsageBytes)
+                largest = &partition;
+        }
+        if (largest->groups.empty())
+            break;
+
+        spillPartition(pass, largest);
+    } while (pass->memoryUsageBytes > _maxMemoryUsageBytes / 2);
 }
 
-class DocumentSourceGroup::SpillSTLComparator {
-public:
-    bool operator()(const GroupsMap::value_type* lhs, const GroupsMap::value_type* rhs) const {
-        return Value::compare(lhs->first, rhs->first) < 0;
+void DocumentSourceGroup::spillPartition(AggregationPass* pass, Partition* partition) {
+    partition->spilledRuns.push_back(spill(partition->groups));
+    GroupsMap().swap(partition->groups);
+    pass->memoryUsageBytes -= partition->memoryUsageBytes;
+    partition->memoryUsageBytes = 0;
+    pass->numSpills++;
+}
+
+void DocumentSourceGroup::processSpilledGroup(AggregationPass* pass,
+                                              const Value& id,
+                                              const Value& state) {
+    const size_t numAccumulators = vpAccumulatorFactory.size();
+
+    bool inserted;
+    Partition* partition;
+    Accumulators& group = findOrCreateGroup(pass, id, &inserted, &partition);
+
+    long long memoryUsageDelta = 0;
+    for (size_t i = 0; i < numAccumulators; i++) {
+        memoryUsageDelta -= group[i]->memUsageForSorter();
+    }
+
+    switch (numAccumulators) {  // mirrors switch in spill()
+        case 0:                 // no Accumulators so no Values
+            break;
+
+        case 1:  // single accumulators serialize as a single Value
+            group[0]->process(state, /*merging=*/true);
+            break;
+
+        default: {  // multiple accumulators serialize as an array
+            const vector<Value>& accumulatorStates = state.getArray();
+            for (size_t i = 0; i < numAccumulators; i++) {
+                group[i]->process(accumulatorStates[i], /*merging=*/true);
+            }
+            break;
+        }
     }
-};
 
-shared_ptr<Sorter<Value, Value>::Iterator> DocumentSourceGroup::spill() {
-    vector<const GroupsMap::value_type*> ptrs;  // using pointers to speed sorting
-    ptrs.reserve(groups.size());
-    for (GroupsMap::const_iterator it = groups.begin(), end = groups.end(); it != end; ++it) {
-        ptrs.push_back(&*it);
+    for (size_t i = 0; i < numAccumulators; i++) {
+        memoryUsageDelta += group[i]->memUsageForSorter();
     }
 
-    stable_sort(ptrs.begin(), ptrs.end(), SpillSTLComparator());
+    pass->memoryUsageBytes += memoryUsageDelta;
+    if (partition)
+        partition->memoryUsageBytes += memoryUsageDelta;
+}
+
+void DocumentSourceGroup::finishPass(AggregationPass* pass) {
+    if (pass->partitions.empty()) {
+        if (!pass->groups.empty()) {
+            Partition partition;
+            partition.groups = std::move(pass->groups);
+            partition.depth = pass->depth;
+            _pendingPartitions.push_back(std::move(partition));
+        }
+        return;
+    }
 
+    for (auto&& partition : pass->partitions) {
+        // The in-memory groups of a spilled partition hold the most recent input, so they are
+        // spilled last to keep the runs in input order for accumulators like $first and $push.
+        if (!partition.spilledRuns.empty() && !partition.groups.empty()) {
+            spillPartition(pass, &partition);
+        }
+
+        if (partition.spilledRuns.empty() && partition.groups.empty())
+            continue;
+
+        _pendingPartitions.push_back(std::move(partition));
+    }
+    pass->partitions.clear();
+}
+
+void DocumentSourceGroup::loadNextPartition() {
+    invariant(!_pendingPartitions.empty());
+
+    Partition partition = std::move(_pendingPartitions.front());
+    _pendingPartitions.pop_front();
+
+    GroupsMap().swap(groups);
+
+    if (partition.spilledRuns.empty()) {
+        // The partition was never spilled, so its groups are already complete.
+        groups = std::move(partition.groups);
+        groupsIterator = groups.begin();
+        return;
+    }
+
+    // Re-aggregate the spilled runs in the order they were written.
+    AggregationPass pass(partition.depth + 1);
+    for (auto&& run : partition.spilledRuns) {
+        while (run->more()) {
+            if (pass.memoryUsageBytes > _maxMemoryUsageBytes && pass.depth < kMaxPassDepth) {
+                spillPartitions(&pass);
+            }
+
+            pair<Value, Value> spilledGroup = run->next();
+            processSpilledGroup(&pass, spilledGroup.first, spilledGroup.second);
+        }
+        run.reset();  // delete the file as soon as it has been read.
+    }
+
+    if (pass.partitions.empty()) {
+        // Everything fit in memory, so there is nothing left to re-aggregate.
+        groups = std::move(pass.groups);
+    } else {
+        // The partitions of this pass are output before the remaining partitions of the previous
+        // one. Their order does not matter, but this limits the number of spill files on disk.
+        std::deque<Partition> remaining;
+        remaining.swap(_pendingPartitions);
+        finishPass(&pass);
+        for (auto&& pending : remaining) {
+            _pendingPartitions.push_back(std::move(pending));
+        }
+    }
+
+    groupsIterator = groups.begin();
+}
+
+shared_ptr<Sorter<Value, Value>::Iterator> DocumentSourceGroup::spill(const GroupsMap& groups) {
     SortedFileWriter<Value, Value> writer(SortOptions().TempDir(pExpCtx->tempDir));
-    switch (vpAccumulatorFactory.size()) {  // same as ptrs[i]->second.size() for all i.
+    switch (vpAccumulatorFactory.size()) {  // same as it->second.size() for all groups.
         case 0:                             // no values, essentially a distinct
-            for (size_t i = 0; i < ptrs.size(); i++) {
-                writer.addAlreadySorted(ptrs[i]->first, Value());
+            for (auto&& group : groups) {
+                writer.addAlreadySorted(group.first, Value());
             }
             break;
 
         case 1:  // just one value, use optimized serialization as single Value
-            for (size_t i = 0; i < ptrs.size(); i++) {
-                writer.addAlreadySorted(ptrs[i]->first,
-                                        ptrs[i]->second[0]->getValue(/*toBeMerged=*/true));
+            for (auto&& group : groups) {
+                writer.addAlreadySorted(group.first,
+                                        group.second[0]->getValue(/*toBeMerged=*/true));
             }
             break;
 
         default:  // multiple values, serialize as array-typed Value
-            for (size_t i = 0; i < ptrs.size(); i++) {
+            for (auto&& group : groups) {
                 vector<Value> accums;
-                for (size_t j = 0; j < ptrs[i]->second.size(); j++) {
-                    accums.push_back(ptrs[i]->second[j]->getValue(/*toBeMerged=*/true));
+                for (size_t j = 0; j < group.second.size(); j++) {
+                    accums.push_back(group.second[j]->getValue(/*toBeMerged=*/true));
                 }
-                writer.addAlreadySorted(ptrs[i]->first, Value(std::move(accums)));
+                writer.addAlreadySorted(group.first, Value(std::move(accums)));
             }
             break;
     }
 
-    groups.clear();
-
     return shared_ptr<Sorter<Value, Value>::Iterator>(writer.done());
 }
 
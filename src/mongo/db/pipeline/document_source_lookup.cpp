@@ -36,12 +36,45 @@
 #include "mongo/db/pipeline/expression.h"
 #include "mongo/db/pipeline/expression_context.h"
 #include "mongo/db/pipeline/value.h"
+#include "mongo/db/server_parameters.h"
 #include "mongo/stdx/memory.h"
 
 namespace mongo {
 
 using boost::intrusive_ptr;
 
+// Number of input documents whose matches are resolved by a single query against the foreign
+// collection when it has an index on the foreign field.
+MONGO_EXPORT_SERVER_PARAMETER(internalDocumentSourceLookUpIndexedBatchSize, int, 100);
+
+// Number of input documents whose matches are resolved by a single query against the foreign
+// collection when that query must scan the whole collection. Larger batches amortize each scan.
+MONGO_EXPORT_SERVER_PARAMETER(internalDocumentSourceLookUpHashJoinBatchSize, int, 1000);
+
+// Maximum number of bytes of foreign documents held in memory to resolve one batch. Batches that
+// would exceed this are abandoned and their input documents are looked up one at a time.
+MONGO_EXPORT_SERVER_PARAMETER(internalDocumentSourceLookUpBatchMaxBytes,
+                              int,
+                              32 * 1024 * 1024);
+
+// Maximum number of bytes of distinct local keys sent in the query for one batch. A batch is closed
+// once its keys reach this size, which keeps the query well under the BSON size limit.
+MONGO_EXPORT_SERVER_PARAMETER(internalDocumentSourceLookUpBatchMaxQueryBytes, int, 1024 * 1024);
+
+namespace {
+
+/**
+ * Returns true if the matches for 'key' can be resolved as part of a batched $in query. Null
+ * keys also match foreign documents that lack the foreign field, array keys match both the whole
+ * array and its elements, and regular expressions compare as literals under $eq but as patterns
+ * under $in, so these keys are looked up with their own $eq query instead.
+ */
+bool isBatchableKey(const Value& key) {
+    return !key.nullish() && key.getType() != Array && key.getType() != RegEx;
+}
+
+}  // namespace
+
 DocumentSourceLookUp::DocumentSourceLookUp(NamespaceString fromNs,
                                            std::string as,
                                            std::string localField,
@@ -69,22 +102,38 @@ boost::optional<Document> DocumentSourceLookUp::getNext() {
         return unwindResult();
     }
 
-    boost::optional<Document> input = pSource->getNext();
+    boost::optional<Document> input = nextInput();
     if (!input)
         return {};
-    BSONObj query = queryForInput(*input);
-    std::unique_ptr<DBClientCursor> cursor = _mongod->directClient()->query(_fromNs.ns(), query);
 
     std::vector<Value> results;
     int objsize = 0;
-    while (cursor->more()) {
-        BSONObj result = cursor->nextSafe();
-        objsize += result.objsize();
-        uassert(4568,
-                str::stream() << "Total size of documents in " << _fromNs.coll() << " matching "
-                              << query << " exceeds maximum document size",
-                objsize <= BSONObjMaxInternalSize);
-        results.push_back(Value(result));
+    if (const std::vector<BSONObj>* matches = batchedMatchesForInput(*input)) {
+        results.reserve(matches->size());
+        for (auto&& result : *matches) {
+            objsize += result.objsize();
+            uassert(4568,
+                    str::stream() << "Total size of documents in " << _fromNs.coll()
+                                  << " matching " << queryForInput(*input)
+                                  << " exceeds maximum document size",
+                    objsize <= BSONObjMaxInternalSize);
+            results.push_back(Value(result));
+        }
+    } else {
+        BSONObj query = queryForInput(*input);
+        _numSingleQueries++;
+        std::unique_ptr<DBClientCursor> cursor =
+            _mongod->directClient()->query(_fromNs.ns(), query);
+
+        while (cursor->more()) {
+            BSONObj result = cursor->nextSafe();
+            objsize += result.objsize();
+            uassert(4568,
+                    str::stream() << "Total size of documents in " << _fromNs.coll()
+                                  << " matching " << query << " exceeds maximum document size",
+                    objsize <= BSONObjMaxInternalSize);
+            results.push_back(Value(result));
+        }
     }
 
     MutableDocument output(std::move(*input));
@@ -92,6 +141,133 @@ boost::optional<Document> DocumentSourceLookUp::getNext() {
     return output.freeze();
 }
 
+boost::optional<Document> DocumentSourceLookUp::nextInput() {
+    if (_inputBatch.empty()) {
+        loadInputBatch();
+        if (_inputBatch.empty())
+            return {};
+    }
+
+    boost::optional<Document> input(std::move(_inputBatch.front()));
+    _inputBatch.pop_front();
+    return input;
+}
+
+const char* DocumentSourceLookUp::strategyName(Strategy strategy) {
+    switch (strategy) {
+        case Strategy::kUnknown:
+            return "unknown";
+        case Strategy::kIndexedBatch:
+            return "batchedIndexLookup";
+        case Strategy::kHashJoinBatch:
+            return "batchedHashJoin";
+    }
+    MONGO_UNREACHABLE;
+}
+
+DocumentSourceLookUp::Strategy DocumentSourceLookUp::pickStrategy() const {
+    // Any btree or hashed index led by the foreign field can answer an $in on that field.
+    for (auto&& indexStats : _mongod->getIndexStats(pExpCtx->opCtx, _fromNs)) {
+        BSONElement firstKeyField = indexStats.second.indexKey.firstElement();
+        if (firstKeyField.fieldNameStringData() != _foreignFieldFieldName)
+            continue;
+        if (firstKeyField.isNumber() ||
+            (firstKeyField.type() == String && firstKeyField.valueStringData() == "hashed")) {
+            return Strategy::kIndexedBatch;
+        }
+    }
+    return Strategy::kHashJoinBatch;
+}
+
+void DocumentSourceLookUp::loadInputBatch() {
+    invariant(_inputBatch.empty());
+    _unwindMatches = nullptr;
+    _batchMatches.clear();
+
+    if (_strategy == Strategy::kUnknown) {
+        _strategy = pickStrategy();
+    }
+
+    const size_t batchSize = std::max(1,
+                                      _strategy == Strategy::kIndexedBatch
+                                          ? internalDocumentSourceLookUpIndexedBatchSize.load()
+                                          : internalDocumentSourceLookUpHashJoinBatchSize.load());
+
+    const int maxQueryBytes = internalDocumentSourceLookUpBatchMaxQueryBytes.load();
+
+    // { _foreignFieldFieldName : { "$in" : [ <distinct local keys> ] } }
+    BSONObjBuilder query;
+    BSONObjBuilder subObj(query.subobjStart(_foreignFieldFieldName));
+    BSONArrayBuilder inArray(subObj.subarrayStart("$in"));
+
+    ValueSet keys;
+    while (_inputBatch.size() < batchSize && inArray.len() < maxQueryBytes) {
+        boost::optional<Document> input = pSource->getNext();
+        if (!input)
+            break;
+
+        Value key = localKeyForInput(*input);
+        if (isBatchableKey(key)) {
+            auto inserted = keys.insert(std::move(key));
+            if (inserted.second) {
+                inserted.first->addToBsonArray(&inArray);
+            }
+        }
+        _inputBatch.push_back(std::move(*input));
+    }
+    inArray.doneFast();
+    subObj.doneFast();
+
+    if (keys.empty())
+        return;
+
+    _numBatches++;
+    _numKeysProbed += keys.size();
+
+    // Every probed key gets an entry, so that inputs whose key matched nothing are not looked up
+    // again with their own query.
+    for (auto&& key : keys) {
+        _batchMatches[key];
+    }
+
+    long long batchBytes = 0;
+    std::unique_ptr<DBClientCursor> cursor =
+        _mongod->directClient()->query(_fromNs.ns(), query.obj());
+    while (cursor->more()) {
+        BSONObj result = cursor->nextSafe().getOwned();
+
+        batchBytes += result.objsize();
+        if (batchBytes > internalDocumentSourceLookUpBatchMaxBytes.load()) {
+            // Fall back to one query per input document, which does not need to hold the
+            // matches for the whole batch in memory.
+            _batchMatches.clear();
+            _numBatchesAbandoned++;
+            return;
+        }
+
+        // Hash the foreign document under each probed key it matched. A document is only added
+        // once per key, even if the key appears several times in an array.
+        BSONElementSet foreignValues;
+        result.getFieldsDotted(_foreignFieldFieldName, foreignValues);
+        ValueSet matchedKeys;
+        for (auto&& elem : foreignValues) {
+            Value foreignValue(elem);
+            if (keys.count(foreignValue)) {
+                matchedKeys.insert(std::move(foreignValue));
+            }
+        }
+        for (auto&& key : matchedKeys) {
+            _batchMatches[key].push_back(result);
+        }
+    }
+}
+
+const std::vector<BSONObj>* DocumentSourceLookUp::batchedMatchesForInput(
+    const Document& input) const {
+    auto it = _batchMatches.find(localKeyForInput(input));
+    return it == _batchMatches.end() ? nullptr : &it->second;
+}
+
 Pipeline::SourceContainer::iterator DocumentSourceLookUp::optimizeAt(
     Pipeline::SourceContainer::iterator itr, Pipeline::SourceContainer* container) {
     invariant(*itr == this);
@@ -111,19 +287,25 @@ Pipeline::SourceContainer::iterator DocumentSourceLookUp::optimizeAt(
 
 void DocumentSourceLookUp::dispose() {
     _cursor.reset();
+    _unwindMatches = nullptr;
+    _batchMatches.clear();
+    _inputBatch.clear();
     pSource->dispose();
 }
 
-BSONObj DocumentSourceLookUp::queryForInput(const Document& input) const {
+Value DocumentSourceLookUp::localKeyForInput(const Document& input) const {
     Value localFieldVal = input.getNestedField(_localField);
     if (localFieldVal.missing()) {
         localFieldVal = Value(BSONNULL);
     }
+    return localFieldVal;
+}
 
+BSONObj DocumentSourceLookUp::queryForInput(const Document& input) const {
     // { _foreignFieldFiedlName : { "$eq" : localFieldValue } }
     BSONObjBuilder query;
     BSONObjBuilder subObj(query.subobjStart(_foreignFieldFieldName));
-    subObj << "$eq" << localFieldVal;
+    subObj << "$eq" << localKeyForInput(input);
     subObj.doneFast();
     return query.obj();
 }
@@ -131,18 +313,33 @@ BSONObj DocumentSourceLookUp::queryForInput(const Document& input) const {
 boost::optional<Document> DocumentSourceLookUp::unwindResult() {
     const boost::optional<FieldPath> indexPath(_unwindSrc->indexPath());
 
+    // Matches for the current input come either from its batch or from a cursor of its own.
+    auto hasMoreMatches = [this] {
+        if (_unwindMatches) {
+            return _cursorIndex < static_cast<long long>(_unwindMatches->size());
+        }
+        return _cursor && _cursor->more();
+    };
+
     // Loop until we get a document that has at least one match.
     // Note we may return early from this loop if our source stage is exhausted or if the unwind
     // source was asked to return empty arrays and we get a document without a match.
-    while (!_cursor || !_cursor->more()) {
-        _input = pSource->getNext();
+    while (!hasMoreMatches()) {
+        _unwindMatches = nullptr;
+        _cursor.reset();
+
+        _input = nextInput();
         if (!_input)
             return {};
 
-        _cursor = _mongod->directClient()->query(_fromNs.ns(), queryForInput(*_input));
+        _unwindMatches = batchedMatchesForInput(*_input);
+        if (!_unwindMatches) {
+            _numSingleQueries++;
+            _cursor = _mongod->directClient()->query(_fromNs.ns(), queryForInput(*_input));
+        }
         _cursorIndex = 0;
 
-        if (_unwindSrc->preserveNullAndEmptyArrays() && !_cursor->more()) {
+        if (_unwindSrc->preserveNullAndEmptyArrays() && !hasMoreMatches()) {
             // There were no results for this cursor, but the $unwind was asked to preserve empty
             // arrays, so we should return a document without the array.
             MutableDocument output(std::move(*_input));
@@ -155,18 +352,25 @@ boost::optional<Document> DocumentSourceLookUp::unwindResult() {
             return output.freeze();
         }
     }
-    invariant(_cursor->more() && bool(_input));
-    auto nextVal = Value(_cursor->nextSafe());
+    invariant(hasMoreMatches() && bool(_input));
+
+    Value nextVal;
+    if (_unwindMatches) {
+        nextVal = Value((*_unwindMatches)[_cursorIndex]);
+    } else {
+        nextVal = Value(_cursor->nextSafe());
+    }
 
     // Move input document into output if this is the last or only result, otherwise perform a copy.
-    MutableDocument output(_cursor->more() ? *_input : std::move(*_input));
+    _cursorIndex++;
+    const bool isLastMatch = !hasMoreMatches();
+    MutableDocument output(isLastMatch ? std::move(*_input) : *_input);
     output.setNestedField(_as, nextVal);
 
     if (indexPath) {
-        output.setNestedField(*indexPath, Value(_cursorIndex));
+        output.setNestedField(*indexPath, Value(_cursorIndex - 1));
     }
 
-    _cursorIndex++;
     return output.freeze();
 }
 
@@ -182,6 +386,17 @@ void DocumentSourceLookUp::serializeToArray(std::vector<Value>& array, bool expl
                       << _unwindSrc->preserveNullAndEmptyArrays() << "includeArrayIndex"
                       << (indexPath ? Value((*indexPath).getPath(false)) : Value())));
     }
+    if (explain) {
+        Strategy strategy = _strategy;
+        if (strategy == Strategy::kUnknown && _mongod) {
+            strategy = pickStrategy();
+        }
+        output[getSourceName()]["strategy"] = Value(strategyName(strategy));
+        output[getSourceName()]["batches"] = Value(_numBatches);
+        output[getSourceName()]["keysProbed"] = Value(_numKeysProbed);
+        output[getSourceName()]["batchesAbandoned"] = Value(_numBatchesAbandoned);
+        output[getSourceName()]["singleQueries"] = Value(_numSingleQueries);
+    }
     array.push_back(Value(output.freeze()));
     if (_handlingUnwind && !explain) {
         _unwindSrc->serializeToArray(array);
@@ -0,0 +1,308 @@
+/**
+ * Copyright (C) 2016 MongoDB Inc.
+ *
+ * This program is free software: you can redistribute it and/or  modify
+ * it under the terms of the GNU Affero General Public License, version 3,
+ * as published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Affero General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ * As a special exception, the copyright holders give permission to link the
+ * code of portions of this program with the OpenSSL library under certain
+ * conditions as described in each individual source file and distribute
+ * linked combinations including the program with the OpenSSL library. You
+ * must comply with the GNU Affero General Public License in all respects for
+ * all of the code used other than as permitted herein. If you modify file(s)
+ * with this exception, you may extend this exception to your version of the
+ * file(s), but you are not obligated to do so. If you do not wish to do so,
+ * delete this exception statement from your version. If you delete this
+ * exception statement from all source files in the program, then also delete
+ * it in the license file.
+ */
+
+#define MONGO_LOG_DEFAULT_COMPONENT ::mongo::logger::LogComponent::kQuery
+
+#include "mongo/platform/basic.h"
+
+#include "mongo/db/pipeline/document_source.h"
+
+#include <deque>
+
+#include "mongo/db/client.h"
+#include "mongo/db/concurrency/d_concurrency.h"
+#include "mongo/db/operation_context.h"
+#include "mongo/db/pipeline/pipeline.h"
+#include "mongo/db/query/plan_executor.h"
+#include "mongo/db/service_context.h"
+#include "mongo/stdx/condition_variable.h"
+#include "mongo/stdx/mutex.h"
+#include "mongo/stdx/thread.h"
+#include "mongo/util/log.h"
+#include "mongo/util/timer.h"
+
+namespace mongo {
+
+using boost::intrusive_ptr;
+using std::string;
+using std::unique_ptr;
+using std::vector;
+
+namespace {
+// Maximum number of bytes of results the workers may buffer before they wait for the consumer.
+const size_t kMaxBufferedBytes = 16 * 1024 * 1024;
+}  // namespace
+
+struct DocumentSourceParallelCursor::SharedState {
+    struct WorkerStats {
+        long long docsReturned = 0;
+        long long millis = 0;
+        bool done = false;
+    };
+
+    explicit SharedState(size_t numWorkers)
+        : numRunning(numWorkers), opIds(numWorkers, 0), stats(numWorkers) {}
+
+    stdx::mutex mutex;
+
+    // Signalled when a worker pushes a result or finishes.
+    stdx::condition_variable produced;
+
+    // Signalled when the consumer pops results or the source is disposed.
+    stdx::condition_variable consumed;
+
+    std::deque<BSONObj> buffer;
+    size_t bufferedBytes = 0;
+
+    size_t numRunning;
+    bool aborted = false;
+
+    // The first error reported by any worker.
+    Status error = Status::OK();
+
+    // The id of each worker's operation while it is running, zero otherwise.
+    vector<unsigned int> opIds;
+    vector<WorkerStats> stats;
+};
+
+DocumentSourceParallelCursor::DocumentSourceParallelCursor(
+    const NamespaceString& nss,
+    const BSONObj& workerPipeline,
+    vector<unique_ptr<PlanExecutor>> execs,
+    const intrusive_ptr<ExpressionContext>& pExpCtx)
+    : DocumentSource(pExpCtx),
+      _nss(nss),
+      _workerPipeline(workerPipeline.getOwned()),
+      _numWorkers(execs.size()),
+      _execs(std::move(execs)),
+      _state(std::make_shared<SharedState>(_numWorkers)) {}
+
+intrusive_ptr<DocumentSourceParallelCursor> DocumentSourceParallelCursor::create(
+    const NamespaceString& nss,
+    const BSONObj& workerPipeline,
+    vector<unique_ptr<PlanExecutor>> execs,
+    const intrusive_ptr<ExpressionContext>& pExpCtx) {
+    invariant(!execs.empty());
+    return new DocumentSourceParallelCursor(nss, workerPipeline, std::move(execs), pExpCtx);
+}
+
+DocumentSourceParallelCursor::~DocumentSourceParallelCursor() {
+    dispose();
+}
+
+const char* DocumentSourceParallelCursor::getSourceName() const {
+    return "$parallelCursor";
+}
+
+void DocumentSourceParallelCursor::startWorkers() {
+    invariant(!_started);
+    _started = true;
+
+    for (size_t i = 0; i < _execs.size(); ++i) {
+        // The thread is detached, so it holds its own reference to everything it uses.
+        stdx::thread worker(&DocumentSourceParallelCursor::runWorker,
+                            _state,
+                            i,
+                            _nss,
+                            _workerPipeline,
+                            pExpCtx->tempDir,
+                            std::move(_execs[i]));
+        worker.detach();
+    }
+    _execs.clear();
+}
+
+void DocumentSourceParallelCursor::runWorker(std::shared_ptr<SharedState> state,
+                                             size_t workerIndex,
+                                             NamespaceString nss,
+                                             BSONObj workerPipeline,
+                                             string tempDir,
+                                             unique_ptr<PlanExecutor> exec) {
+    Client::initThread("aggParallelWorker");
+    auto txn = cc().makeOperationContext();
+
+    Timer timer;
+    long long docsReturned = 0;
+    Status status = Status::OK();
+    intrusive_ptr<Pipeline> pipeline;
+
+    try {
+        {
+            stdx::lock_guard<stdx::mutex> lk(state->mutex);
+            state->opIds[workerIndex] = txn->getOpID();
+            if (state->aborted) {
+                txn->markKilled();
+            }
+        }
+
+        exec->reattachToOperationContext(txn.get());
+
+        intrusive_ptr<ExpressionContext> expCtx = new ExpressionContext(txn.get(), nss);
+        expCtx->tempDir = std::move(tempDir);
+
+        string errmsg;
+        pipeline = Pipeline::parseCommand(errmsg, workerPipeline, expCtx);
+        uassert(ErrorCodes::BadValue, errmsg, pipeline);
+
+        const DepsTracker deps = pipeline->getDependencies(BSONObj());
+        auto cursorSource =
+            DocumentSourceCursor::create(nss.ns(), std::shared_ptr<PlanExecutor>(exec.release()),
+                                         expCtx);
+        cursorSource->setProjection(deps.toProjection(), deps.toParsedDeps());
+        pipeline->addInitialSource(cursorSource);
+        pipeline->stitch();
+
+        DocumentSource* output = pipeline->output();
+        while (boost::optional<Document> next = output->getNext()) {
+            BSONObj obj = next->toBson();
+
+            stdx::unique_lock<stdx::mutex> lk(state->mutex);
+            state->consumed.wait(lk, [&] {
+                return state->aborted || state->bufferedBytes < kMaxBufferedBytes;
+            });
+            if (state->aborted) {
+                break;
+            }
+
+            state->bufferedBytes += obj.objsize();
+            state->buffer.push_back(std::move(obj));
+            ++docsReturned;
+            state->produced.notify_one();
+        }
+    } catch (const DBException& ex) {
+        status = ex.toStatus();
+    }
+
+    // Destroying the pipeline destroys its PlanExecutor, which must be deregistered from the
+    // collection's CursorManager under a lock.
+    try {
+        Lock::DBLock dbLock(txn->lockState(), nss.db(), MODE_IS);
+        Lock::CollectionLock collLock(txn->lockState(), nss.ns(), MODE_IS);
+        if (pipeline) {
+            pipeline->output()->dispose();
+        }
+        pipeline.reset();
+        exec.reset();
+    } catch (const DBException& ex) {
+        warning() << "failed to clean up aggregation worker for " << nss.ns() << ": " << ex;
+    }
+
+    stdx::lock_guard<stdx::mutex> lk(state->mutex);
+    if (!status.isOK() && !state->aborted) {
+        LOG(1) << "aggregation worker " << workerIndex << " for " << nss.ns()
+               << " failed: " << status;
+        if (state->error.isOK()) {
+            state->error = status;
+        }
+    }
+    state->opIds[workerIndex] = 0;
+    state->stats[workerIndex].docsReturned = docsReturned;
+    state->stats[workerIndex].millis = timer.millis();
+    state->stats[workerIndex].done = true;
+    --state->numRunning;
+    state->produced.notify_one();
+}
+
+boost::optional<Document> DocumentSourceParallelCursor::getNext() {
+    pExpCtx->checkForInterrupt();
+
+    if (!_started) {
+        startWorkers();
+    }
+
+    BSONObj obj;
+    {
+        stdx::unique_lock<stdx::mutex> lk(_state->mutex);
+        while (_state->buffer.empty() && _state->numRunning > 0 && _state->error.isOK()) {
+            // Wake up periodically so that the aggregation can still be interrupted.
+            _state->produced.wait_for(lk, Milliseconds(100));
+            if (_state->buffer.empty()) {
+                lk.unlock();
+                pExpCtx->opCtx->checkForInterrupt();
+                lk.lock();
+            }
+        }
+
+        uassertStatusOK(_state->error);
+
+        if (_state->buffer.empty()) {
+            invariant(_state->numRunning == 0);
+            return boost::none;
+        }
+
+        obj = std::move(_state->buffer.front());
+        _state->buffer.pop_front();
+        _state->bufferedBytes -= obj.objsize();
+        _state->consumed.notify_one();
+    }
+
+    return Document(obj);
+}
+
+void DocumentSourceParallelCursor::dispose() {
+    {
+        stdx::lock_guard<stdx::mutex> lk(_state->mutex);
+        if (!_state->aborted) {
+            _state->aborted = true;
+            for (auto opId : _state->opIds) {
+                if (opId) {
+                    getGlobalServiceContext()->killOperation(opId);
+                }
+            }
+        }
+        _state->buffer.clear();
+        _state->bufferedBytes = 0;
+        _state->consumed.notify_all();
+    }
+
+    // Executors which were never handed to a worker are destroyed here.
+    _execs.clear();
+}
+
+Value DocumentSourceParallelCursor::serialize(bool explain) const {
+    // We never parse a $parallelCursor, so we only serialize for explain.
+    if (!explain)
+        return Value();
+
+    MutableDocument out;
+    out["degreeOfParallelism"] = Value(static_cast<long long>(_numWorkers));
+    out["workerPipeline"] = Value(_workerPipeline["pipeline"]);
+
+    if (_started) {
+        vector<Value> workers;
+        stdx::lock_guard<stdx::mutex> lk(_state->mutex);
+        for (auto&& stats : _state->stats) {
+            workers.push_back(Value(DOC("nReturned" << stats.docsReturned << "executionTimeMillis"
+                                                    << stats.millis << "done" << stats.done)));
+        }
+        out["workers"] = Value(workers);
+    }
+
+    return Value(DOC(getSourceName() << out.freezeToValue()));
+}
+}  // namespace mongo
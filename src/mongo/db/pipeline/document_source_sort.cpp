@@ -30,12 +30,18 @@
 
 #include "mongo/db/pipeline/document_source.h"
 
+#include <algorithm>
+#include <deque>
 
 #include "mongo/db/jsobj.h"
 #include "mongo/db/pipeline/document.h"
 #include "mongo/db/pipeline/expression.h"
 #include "mongo/db/pipeline/expression_context.h"
 #include "mongo/db/pipeline/value.h"
+#include "mongo/db/server_parameters.h"
+#include "mongo/stdx/condition_variable.h"
+#include "mongo/stdx/mutex.h"
+#include "mongo/stdx/thread.h"
 
 namespace mongo {
 
@@ -45,6 +51,287 @@ using std::make_pair;
 using std::string;
 using std::vector;
 
+// A $sort that is not merging presorted input and is not running in mongos hands its input to this
+// many threads, which extract the sort keys and sort. With a value of 1 the stage sorts on the
+// pipeline's thread.
+MONGO_EXPORT_SERVER_PARAMETER(internalDocumentSourceSortMaxDegreeOfParallelism, int, 1);
+
+namespace {
+// The memory the sorted documents may use before they are spilled to disk. Shared between the
+// threads of a parallel sort.
+const size_t kMaxSortMemoryUsageBytes = 100 * 1024 * 1024;
+
+// Documents are handed to the sorting threads in batches of about this many bytes.
+const size_t kSortBatchBytes = 1024 * 1024;
+
+// Number of batches per sorting thread that the pipeline may get ahead by.
+const size_t kQueuedBatchesPerThread = 2;
+
+/**
+ * A document sorted by a parallel $sort, tagged with its position in the input so that the runs
+ * sorted on different threads merge back into the order a stable sort would give. When the stages
+ * after the $sort only use some of its fields, the document is held as BSON containing just those
+ * fields, which is much smaller than a Document.
+ */
+class SequencedDocument {
+public:
+    SequencedDocument() = default;
+    SequencedDocument(long long seq, Document doc) : _seq(seq), _doc(std::move(doc)) {}
+    SequencedDocument(long long seq, BSONObj held)
+        : _seq(seq), _held(std::move(held)), _isHeldAsBson(true) {}
+
+    long long getSeq() const {
+        return _seq;
+    }
+
+    Document toDocument() const {
+        return _isHeldAsBson ? Document::fromBsonWithMetaData(_held) : _doc;
+    }
+
+    // For Sorter
+    struct SorterDeserializeSettings {};  // unused
+    void serializeForSorter(BufBuilder& buf) const {
+        buf.appendNum(_seq);
+        buf.appendNum(char(_isHeldAsBson));
+        if (_isHeldAsBson) {
+            _held.serializeForSorter(buf);
+        } else {
+            _doc.serializeForSorter(buf);
+        }
+    }
+    static SequencedDocument deserializeForSorter(BufReader& buf,
+                                                  const SorterDeserializeSettings&) {
+        const long long seq = buf.read<long long>();
+        if (buf.read<char>()) {
+            BSONObj held = BSONObj::deserializeForSorter(buf, BSONObj::SorterDeserializeSettings());
+            return SequencedDocument(seq, held.getOwned());
+        }
+        return SequencedDocument(
+            seq, Document::deserializeForSorter(buf, Document::SorterDeserializeSettings()));
+    }
+    int memUsageForSorter() const {
+        return sizeof(SequencedDocument) +
+            (_isHeldAsBson ? _held.objsize() : _doc.memUsageForSorter() - sizeof(Document));
+    }
+    SequencedDocument getOwned() const {
+        return _isHeldAsBson ? SequencedDocument(_seq, _held.getOwned())
+                             : SequencedDocument(_seq, _doc.getOwned());
+    }
+
+private:
+    long long _seq = 0;
+    Document _doc;
+    BSONObj _held;
+    bool _isHeldAsBson = false;
+};
+}  // namespace
+
+/**
+ * Extracts the sort keys of batches of documents and sorts them, using several threads. Each
+ * thread has its own Sorter with an equal share of the stage's memory, so each may spill runs to
+ * disk independently. Once the input is exhausted the threads' sorted output is merged, lazily,
+ * into a single stream.
+ *
+ * The threads do not use an OperationContext and only touch the sorters' spill files.
+ */
+class DocumentSourceSort::ParallelLoader {
+    MONGO_DISALLOW_COPYING(ParallelLoader);
+
+public:
+    using Batch = std::vector<std::pair<long long, Document>>;
+
+    ParallelLoader(const DocumentSourceSort& source, size_t numThreads)
+        : _source(source), _maxQueuedBatches(numThreads * kQueuedBatchesPerThread) {
+        SortOptions opts = _source.makeSortOptions();
+        opts.maxMemoryUsageBytes /= numThreads;
+        for (size_t t = 0; t < numThreads; ++t) {
+            _sorters.emplace_back(ThreadSorter::make(opts, Comparator(_source)));
+        }
+        _output.resize(numThreads);
+        for (size_t t = 0; t < numThreads; ++t) {
+            _threads.emplace_back(&ParallelLoader::_run, this, t);
+        }
+    }
+
+    ~ParallelLoader() {
+        {
+            stdx::lock_guard<stdx::mutex> lk(_mutex);
+            _aborted = true;
+            _batchQueued.notify_all();
+            _batchTaken.notify_all();
+        }
+        for (auto&& thread : _threads) {
+            thread.join();
+        }
+    }
+
+    /**
+     * Queues 'batch' for the next free thread, waiting while too many batches are queued.
+     * Returns the first error encountered by any thread.
+     */
+    Status push(Batch batch) {
+        stdx::unique_lock<stdx::mutex> lk(_mutex);
+        _batchTaken.wait(lk, [&] { return _aborted || _queue.size() < _maxQueuedBatches; });
+        if (_aborted) {
+            return _error;
+        }
+        _queue.push_back(std::move(batch));
+        _batchQueued.notify_one();
+        return Status::OK();
+    }
+
+    /**
+     * Tells the threads that no more batches will be pushed. Once they have processed the queued
+     * batches, each finishes sorting its documents.
+     */
+    void noMoreBatches() {
+        stdx::lock_guard<stdx::mutex> lk(_mutex);
+        _noMoreBatches = true;
+        _batchQueued.notify_all();
+    }
+
+    /**
+     * Waits up to 'timeout' for the threads to finish. Returns true if they all have.
+     */
+    bool waitForThreads(Milliseconds timeout) {
+        stdx::unique_lock<stdx::mutex> lk(_mutex);
+        return _threadFinished.wait_for(
+            lk, timeout, [&] { return _numFinished == _threads.size(); });
+    }
+
+    /**
+     * Returns the first error encountered by any thread.
+     */
+    Status getStatus() {
+        stdx::lock_guard<stdx::mutex> lk(_mutex);
+        return _error;
+    }
+
+    /**
+     * Returns an iterator merging the sorted output of every thread. May only be called once all
+     * threads have finished without error.
+     */
+    MySorter::Iterator* done();
+
+private:
+    typedef Sorter<Value, SequencedDocument> ThreadSorter;
+
+    // Orders documents with equal sort keys by their position in the input.
+    class Comparator {
+    public:
+        explicit Comparator(const DocumentSourceSort& source) : _source(source) {}
+        int operator()(const ThreadSorter::Data& lhs, const ThreadSorter::Data& rhs) const {
+            if (int cmp = _source.compare(lhs.first, rhs.first)) {
+                return cmp;
+            }
+            const long long lhsSeq = lhs.second.getSeq();
+            const long long rhsSeq = rhs.second.getSeq();
+            return lhsSeq < rhsSeq ? -1 : lhsSeq > rhsSeq ? 1 : 0;
+        }
+
+    private:
+        const DocumentSourceSort& _source;
+    };
+
+    // Presents the merged output as the stage's own Documents.
+    class OutputIterator : public MySorter::Iterator {
+    public:
+        explicit OutputIterator(unique_ptr<ThreadSorter::Iterator> merged)
+            : _merged(std::move(merged)) {}
+
+        bool more() {
+            return _merged->more();
+        }
+        Data next() {
+            ThreadSorter::Data next = _merged->next();
+            return make_pair(std::move(next.first), next.second.toDocument());
+        }
+
+    private:
+        unique_ptr<ThreadSorter::Iterator> _merged;
+    };
+
+    bool _isAborted() {
+        stdx::lock_guard<stdx::mutex> lk(_mutex);
+        return _aborted;
+    }
+
+    void _run(size_t threadIndex) {
+        ThreadSorter* sorter = _sorters[threadIndex].get();
+        try {
+            while (true) {
+                Batch batch;
+                {
+                    stdx::unique_lock<stdx::mutex> lk(_mutex);
+                    _batchQueued.wait(
+                        lk, [&] { return _aborted || _noMoreBatches || !_queue.empty(); });
+                    if (_aborted || _queue.empty()) {
+                        break;
+                    }
+                    batch = std::move(_queue.front());
+                    _queue.pop_front();
+                    _batchTaken.notify_one();
+                }
+
+                for (auto&& doc : batch) {
+                    Value key = _source.extractKey(doc.second);
+                    if (_source._holdAllFields) {
+                        sorter->add(key, SequencedDocument(doc.first, std::move(doc.second)));
+                    } else {
+                        sorter->add(key,
+                                    SequencedDocument(doc.first,
+                                                      _source.extractHeldFields(doc.second)));
+                    }
+                }
+            }
+
+            if (!_isAborted()) {
+                _output[threadIndex].reset(sorter->done());
+            }
+        } catch (const DBException& ex) {
+            stdx::lock_guard<stdx::mutex> lk(_mutex);
+            if (_error.isOK()) {
+                _error = ex.toStatus();
+            }
+            _aborted = true;
+            _batchTaken.notify_all();
+            _batchQueued.notify_all();
+        }
+
+        stdx::lock_guard<stdx::mutex> lk(_mutex);
+        ++_numFinished;
+        _threadFinished.notify_all();
+    }
+
+    const DocumentSourceSort& _source;
+    const size_t _maxQueuedBatches;
+
+    // Thread 't' adds to _sorters[t] and leaves its sorted output in _output[t].
+    vector<unique_ptr<ThreadSorter>> _sorters;
+    vector<std::shared_ptr<ThreadSorter::Iterator>> _output;
+
+    stdx::mutex _mutex;
+    stdx::condition_variable _batchQueued;
+    stdx::condition_variable _batchTaken;
+    stdx::condition_variable _threadFinished;
+    std::deque<Batch> _queue;
+    bool _noMoreBatches = false;
+    bool _aborted = false;
+    size_t _numFinished = 0;
+    Status _error = Status::OK();
+
+    vector<stdx::thread> _threads;
+};
+
+DocumentSourceSort::MySorter::Iterator* DocumentSourceSort::ParallelLoader::done() {
+    invariant(_numFinished == _threads.size() && _error.isOK());
+    unique_ptr<ThreadSorter::Iterator> merged(
+        ThreadSorter::Iterator::merge(_output, _source.makeSortOptions(), Comparator(_source)));
+    _output.clear();
+    _sorters.clear();
+    return new OutputIterator(std::move(merged));
+}
+
 DocumentSourceSort::DocumentSourceSort(const intrusive_ptr<ExpressionContext>& pExpCtx)
     : DocumentSource(pExpCtx), populated(false), _mergingPresorted(false) {}
 
@@ -227,10 +514,11 @@ SortOptions DocumentSourceSort::makeSortOptions() const {
     if (limitSrc)
         opts.limit = limitSrc->getLimit();
 
-    opts.maxMemoryUsageBytes = 100 * 1024 * 1024;
+    opts.maxMemoryUsageBytes = kMaxSortMemoryUsageBytes;
     if (pExpCtx->extSortAllowed && !pExpCtx->inRouter) {
         opts.extSortAllowed = true;
         opts.tempDir = pExpCtx->tempDir;
+        opts.spillInBackground = true;
     }
 
     return opts;
@@ -244,6 +532,9 @@ void DocumentSourceSort::populate() {
         } else {
             msgasserted(17196, "can only mergePresorted from MergeCursors");
         }
+    } else if (internalDocumentSourceSortMaxDegreeOfParallelism.load() > 1 &&
+               !pExpCtx->inRouter) {
+        populateInParallel(internalDocumentSourceSortMaxDegreeOfParallelism.load());
     } else {
         while (boost::optional<Document> next = pSource->getNext()) {
             loadDocument(std::move(*next));
@@ -252,6 +543,75 @@ void DocumentSourceSort::populate() {
     }
 }
 
+void DocumentSourceSort::populateInParallel(size_t numThreads) {
+    invariant(!populated);
+    ParallelLoader loader(*this, numThreads);
+
+    ParallelLoader::Batch batch;
+    size_t batchBytes = 0;
+    long long seq = 0;
+    while (boost::optional<Document> next = pSource->getNext()) {
+        batchBytes += next->getApproximateSize();
+        batch.emplace_back(seq++, std::move(*next));
+
+        if (batchBytes >= kSortBatchBytes) {
+            uassertStatusOK(loader.push(std::move(batch)));
+            batch.clear();
+            batchBytes = 0;
+        }
+    }
+
+    if (!batch.empty()) {
+        uassertStatusOK(loader.push(std::move(batch)));
+    }
+    loader.noMoreBatches();
+
+    // Wake up periodically so that the aggregation can still be interrupted.
+    while (!loader.waitForThreads(Milliseconds(100))) {
+        pExpCtx->checkForInterrupt();
+    }
+    uassertStatusOK(loader.getStatus());
+
+    _output.reset(loader.done());
+    populated = true;
+}
+
+void DocumentSourceSort::setOutputDependencies(const DepsTracker& deps) {
+    DepsTracker held = deps;
+    getDependencies(&held);
+
+    _heldFields.clear();
+    _holdAllFields = held.needWholeDocument;
+    if (_holdAllFields) {
+        return;
+    }
+
+    for (auto&& path : held.fields) {
+        const string field = path.substr(0, path.find('.'));
+        if (std::find(_heldFields.begin(), _heldFields.end(), field) == _heldFields.end()) {
+            _heldFields.push_back(field);
+        }
+    }
+}
+
+BSONObj DocumentSourceSort::extractHeldFields(const Document& doc) const {
+    // Keep the fields in their original order, since later stages may depend on it.
+    BSONObjBuilder bb;
+    FieldIterator it(doc);
+    while (it.more()) {
+        auto field = it.next();
+        if (std::find(_heldFields.begin(), _heldFields.end(), field.first) != _heldFields.end()) {
+            field.second.addToBsonObj(&bb, field.first);
+        }
+    }
+
+    if (doc.hasTextScore())
+        bb.append(Document::metaFieldTextScore, doc.getTextScore());
+    if (doc.hasRandMetaField())
+        bb.append(Document::metaFieldRandVal, doc.getRandMetaField());
+    return bb.obj();
+}
+
 void DocumentSourceSort::loadDocument(const Document& doc) {
     invariant(!populated);
     if (!_sorter) {
@@ -40,6 +40,7 @@
 #include "mongo/db/storage/storage_options.h"
 #include "mongo/dbtests/dbtests.h"
 #include "mongo/unittest/temp_dir.h"
+#include "mongo/util/scopeguard.h"
 
 namespace mongo {
 bool isMongos() {
@@ -359,13 +360,14 @@ public:
     Base() : _tempDir("DocumentSourceGroupTest") {}
 
 protected:
-    void createGroup(const BSONObj& spec, bool inShard = false) {
+    void createGroup(const BSONObj& spec, bool inShard = false, bool extSortAllowed = false) {
         BSONObj namedSpec = BSON("$group" << spec);
         BSONElement specElement = namedSpec.firstElement();
 
         intrusive_ptr<ExpressionContext> expressionContext =
             new ExpressionContext(_opCtx.get(), NamespaceString(ns));
         expressionContext->inShard = inShard;
+        expressionContext->extSortAllowed = extSortAllowed;
         // Won't spill to disk properly if it needs to.
         expressionContext->tempDir = _tempDir.path();
 
@@ -945,6 +947,85 @@ public:
     }
 };
 
+/**
+ * Groups that exceed the memory limit are spilled by partition and re-aggregated, preserving
+ * the input order for order-sensitive accumulators.
+ */
+class SpillPartitions : public Base {
+public:
+    void run() {
+        const int oldMaxMemoryBytes = internalDocumentSourceGroupMaxMemoryBytes.load();
+        ON_BLOCK_EXIT([&] { internalDocumentSourceGroupMaxMemoryBytes.store(oldMaxMemoryBytes); });
+        internalDocumentSourceGroupMaxMemoryBytes.store(maxMemoryBytes());
+
+        createGroup(fromjson("{_id:'$k',sum:{$sum:'$v'},first:{$first:'$v'},list:{$push:'$v'}}"),
+                    false,
+                    true);
+
+        const int numGroups = 300;
+        const int numDocs = 3000;
+        std::deque<Document> inputs;
+        for (int i = 0; i < numDocs; ++i) {
+            inputs.push_back(DOC("k" << (i * 7) % numGroups << "v" << i));
+        }
+        auto source = DocumentSourceMock::create(std::move(inputs));
+        group()->setSource(source.get());
+
+        std::set<int> seenIds;
+        while (boost::optional<Document> next = group()->getNext()) {
+            const int id = next->getField("_id").getInt();
+            ASSERT(seenIds.insert(id).second);
+
+            // Input i belongs to group (i * 7) % numGroups, so group 'id' receives the inputs
+            // firstInput, firstInput + numGroups, ..., in that order.
+            const int firstInput = (id * 43) % numGroups;  // 7 * 43 == 1 (mod 300)
+            int expectedSum = 0;
+            std::vector<Value> expectedList;
+            for (int v = firstInput; v < numDocs; v += numGroups) {
+                expectedSum += v;
+                expectedList.push_back(Value(v));
+            }
+            ASSERT_EQUALS(expectedSum, next->getField("sum").getInt());
+            ASSERT_EQUALS(firstInput, next->getField("first").getInt());
+            ASSERT_EQUALS(Value(expectedList), next->getField("list"));
+        }
+        ASSERT_EQUALS(static_cast<size_t>(numGroups), seenIds.size());
+        assertExhausted(group());
+    }
+
+protected:
+    virtual int maxMemoryBytes() {
+        // Holds a few dozen groups, so the partitions spill but each fits in memory on reload.
+        return 16 * 1024;
+    }
+};
+
+/** A partition that does not fit in memory when reloaded is split again. */
+class SpillPartitionsRecursively : public SpillPartitions {
+    int maxMemoryBytes() {
+        return 2 * 1024;
+    }
+};
+
+/** Exceeding the memory limit without allowDiskUse is an error. */
+class MemoryLimitWithoutDiskUse : public Base {
+public:
+    void run() {
+        const int oldMaxMemoryBytes = internalDocumentSourceGroupMaxMemoryBytes.load();
+        ON_BLOCK_EXIT([&] { internalDocumentSourceGroupMaxMemoryBytes.store(oldMaxMemoryBytes); });
+        internalDocumentSourceGroupMaxMemoryBytes.store(1024);
+
+        createGroup(fromjson("{_id:'$k',list:{$push:'$v'}}"));
+        std::deque<Document> inputs;
+        for (int i = 0; i < 1000; ++i) {
+            inputs.push_back(DOC("k" << i << "v" << i));
+        }
+        auto source = DocumentSourceMock::create(std::move(inputs));
+        group()->setSource(source.get());
+        ASSERT_THROWS_CODE(group()->getNext(), UserException, 16945);
+    }
+};
+
 }  // namespace DocumentSourceGroup
 
 namespace DocumentSourceProject {
@@ -1846,6 +1927,127 @@ public:
     }
 };
 
+/** Base class for sorts on several threads. */
+class ParallelBase : public Base {
+public:
+    void run() {
+        const int oldParallelism = internalDocumentSourceSortMaxDegreeOfParallelism.load();
+        ON_BLOCK_EXIT(
+            [&] { internalDocumentSourceSortMaxDegreeOfParallelism.store(oldParallelism); });
+        internalDocumentSourceSortMaxDegreeOfParallelism.store(4);
+        runParallel();
+    }
+
+protected:
+    virtual void runParallel() = 0;
+
+    /** Sorts 'numDocs' documents by {a: 1}, where 'a' has only a few distinct values. */
+    vector<Document> sortDocs(int numDocs) {
+        std::deque<Document> inputs;
+        for (int i = 0; i < numDocs; ++i) {
+            inputs.push_back(DOC("_id" << i << "a" << (i * 7) % 13 << "b" << i % 3 << "c"
+                                       << string(100, 'x')));
+        }
+        auto source = DocumentSourceMock::create(std::move(inputs));
+        sort()->setSource(source.get());
+
+        vector<Document> output;
+        while (boost::optional<Document> next = sort()->getNext()) {
+            output.push_back(*next);
+        }
+        assertExhausted();
+        return output;
+    }
+};
+
+/** Documents with equal sort keys are returned in their input order. */
+class ParallelSortIsStable : public ParallelBase {
+    void runParallel() {
+        createSort(BSON("a" << 1));
+        const int numDocs = 50000;
+        vector<Document> output = sortDocs(numDocs);
+        ASSERT_EQUALS(numDocs, static_cast<int>(output.size()));
+        for (size_t i = 1; i < output.size(); ++i) {
+            const int prevA = output[i - 1]["a"].getInt();
+            const int a = output[i]["a"].getInt();
+            ASSERT_LESS_THAN_OR_EQUALS(prevA, a);
+            if (prevA == a) {
+                ASSERT_LESS_THAN(output[i - 1]["_id"].getInt(), output[i]["_id"].getInt());
+            }
+        }
+        ASSERT_EQUALS(string(100, 'x'), output[0]["c"].getString());
+    }
+};
+
+/** Each thread keeps only the top k documents, and the merge returns the overall top k. */
+class ParallelSortWithLimit : public ParallelBase {
+    void runParallel() {
+        createSort(BSON("a" << -1 << "_id" << 1));
+        Pipeline::SourceContainer container;
+        container.push_back(sort());
+        container.push_back(mongo::DocumentSourceLimit::create(ctx(), 10));
+        sort()->optimizeAt(container.begin(), &container);
+        ASSERT_EQUALS(10, sort()->getLimit());
+
+        vector<Document> output = sortDocs(50000);
+        ASSERT_EQUALS(10U, output.size());
+        for (size_t i = 0; i < output.size(); ++i) {
+            ASSERT_EQUALS(12, output[i]["a"].getInt());
+            ASSERT_EQUALS(11 + 13 * static_cast<int>(i), output[i]["_id"].getInt());
+        }
+    }
+};
+
+/** Only the fields used after the sort, and the sort key fields, are held. */
+class ParallelSortHoldsUsedFields : public ParallelBase {
+    void runParallel() {
+        createSort(BSON("a" << 1));
+        DepsTracker deps;
+        deps.fields.insert("b.x");
+        sort()->setOutputDependencies(deps);
+
+        vector<Document> output = sortDocs(100);
+        ASSERT_EQUALS(100U, output.size());
+        for (auto&& doc : output) {
+            ASSERT_EQUALS(2U, doc.size());
+            FieldIterator it(doc);
+            ASSERT_EQUALS("a", it.next().first);
+            ASSERT_EQUALS("b", it.next().first);
+        }
+
+        // A stage which needs the whole document turns the projection off again.
+        DepsTracker wholeDocument;
+        wholeDocument.needWholeDocument = true;
+        createSort(BSON("a" << 1));
+        sort()->setOutputDependencies(wholeDocument);
+        ASSERT_EQUALS(4U, sortDocs(10)[0].size());
+    }
+};
+
+/** The metadata of the held documents is preserved. */
+class ParallelSortHoldsMetadata : public ParallelBase {
+    void runParallel() {
+        createSort(BSON("$computed0" << metaTextScore));
+        sort()->setOutputDependencies(DepsTracker());
+
+        std::deque<Document> inputs;
+        for (int i = 0; i < 10; ++i) {
+            MutableDocument doc(DOC("_id" << i << "a" << i));
+            doc.setTextScore(i);
+            inputs.push_back(doc.freeze());
+        }
+        auto source = DocumentSourceMock::create(std::move(inputs));
+        sort()->setSource(source.get());
+
+        double expectedScore = 9;
+        while (boost::optional<Document> next = sort()->getNext()) {
+            ASSERT_EQUALS(0U, next->size());
+            ASSERT_EQUALS(expectedScore--, next->getTextScore());
+        }
+        ASSERT_EQUALS(-1, expectedScore);
+    }
+};
+
 }  // namespace DocumentSourceSort
 
 namespace DocumentSourceUnwind {
@@ -2798,6 +3000,9 @@ public:
         add<DocumentSourceGroup::UndefinedAccumulatorValue>();
         add<DocumentSourceGroup::RouterMerger>();
         add<DocumentSourceGroup::Dependencies>();
+        add<DocumentSourceGroup::SpillPartitions>();
+        add<DocumentSourceGroup::SpillPartitionsRecursively>();
+        add<DocumentSourceGroup::MemoryLimitWithoutDiskUse>();
         add<DocumentSourceGroup::StringConstantIdAndAccumulatorExpressions>();
         add<DocumentSourceGroup::ArrayConstantAccumulatorExpression>();
 
@@ -2831,6 +3036,10 @@ public:
         add<DocumentSourceSort::MissingObjectWithinArray>();
         add<DocumentSourceSort::ExtractArrayValues>();
         add<DocumentSourceSort::Dependencies>();
+        add<DocumentSourceSort::ParallelSortIsStable>();
+        add<DocumentSourceSort::ParallelSortWithLimit>();
+        add<DocumentSourceSort::ParallelSortHoldsUsedFields>();
+        add<DocumentSourceSort::ParallelSortHoldsMetadata>();
 
         add<DocumentSourceUnwind::Empty>();
         add<DocumentSourceUnwind::EmptyArray>();
@@ -195,6 +195,42 @@ void Pipeline::optimizePipeline() {
         }
     }
     sources.swap(optimizedSources);
+
+    Optimizations::Local::limitFieldsHeldBySorts(this);
+}
+
+void Pipeline::Optimizations::Local::limitFieldsHeldBySorts(Pipeline* pipeline) {
+    for (auto itr = pipeline->sources.begin(); itr != pipeline->sources.end(); ++itr) {
+        auto sort = dynamic_cast<DocumentSourceSort*>(itr->get());
+        if (!sort) {
+            continue;
+        }
+
+        // Metadata is always held, so only the fields matter.
+        DepsTracker deps;
+        bool knowAllFields = false;
+        for (auto next = std::next(itr); next != pipeline->sources.end(); ++next) {
+            DepsTracker localDeps;
+            DocumentSource::GetDepsReturn status = (*next)->getDependencies(&localDeps);
+            if (status == DocumentSource::NOT_SUPPORTED) {
+                break;
+            }
+
+            deps.fields.insert(localDeps.fields.begin(), localDeps.fields.end());
+            if (localDeps.needWholeDocument)
+                deps.needWholeDocument = true;
+
+            if (status & DocumentSource::EXHAUSTIVE_FIELDS) {
+                knowAllFields = true;
+                break;
+            }
+        }
+
+        if (!knowAllFields)
+            deps.needWholeDocument = true;
+
+        sort->setOutputDependencies(deps);
+    }
 }
 
 Status Pipeline::checkAuthForCommand(ClientBasic* client,
@@ -32,6 +32,7 @@
 
 #include "mongo/db/pipeline/pipeline_d.h"
 
+#include "mongo/base/checked_cast.h"
 #include "mongo/client/dbclientinterface.h"
 #include "mongo/db/catalog/collection.h"
 #include "mongo/db/catalog/database.h"
@@ -50,6 +51,7 @@
 #include "mongo/db/pipeline/pipeline.h"
 #include "mongo/db/query/get_executor.h"
 #include "mongo/db/query/query_planner.h"
+#include "mongo/db/server_parameters.h"
 #include "mongo/db/service_context.h"
 #include "mongo/db/storage/record_store.h"
 #include "mongo/db/storage/sorted_data_interface.h"
@@ -66,6 +68,10 @@ using std::shared_ptr;
 using std::string;
 using std::unique_ptr;
 
+// Maximum number of threads which may run the leading stages of a pipeline over a collection scan.
+// A value of 1 disables parallel execution.
+MONGO_EXPORT_SERVER_PARAMETER(internalAggregationMaxDegreeOfParallelism, int, 1);
+
 namespace {
 class MongodImplementation final : public DocumentSourceNeedsMongod::MongodInterface {
 public:
@@ -209,6 +215,28 @@ StatusWith<std::unique_ptr<PlanExecutor>> attemptToGetExecutor(
     return getExecutor(
         txn, collection, std::move(cq.getValue()), PlanExecutor::YIELD_AUTO, plannerOpts);
 }
+
+/**
+ * Returns true if 'sources' starts with any number of non-text $match and $project stages
+ * followed by a $group, which is the shape of pipeline that benefits from being split across
+ * several workers and merged.
+ */
+bool hasParallelizablePrefix(const Pipeline::SourceContainer& sources) {
+    for (auto&& source : sources) {
+        if (auto match = dynamic_cast<DocumentSourceMatch*>(source.get())) {
+            if (match->isTextQuery()) {
+                return false;
+            }
+            continue;
+        }
+        if (dynamic_cast<DocumentSourceProject*>(source.get())) {
+            continue;
+        }
+        return dynamic_cast<DocumentSourceGroup*>(source.get()) != nullptr;
+    }
+    return false;
+}
+
 }  // namespace
 
 shared_ptr<PlanExecutor> PipelineD::prepareCursorSource(
@@ -261,6 +289,10 @@ shared_ptr<PlanExecutor> PipelineD::prepareCursorSource(
         }
     }
 
+    if (collection && addParallelCursorSource(txn, collection, nss, pPipeline, pExpCtx)) {
+        return std::shared_ptr<PlanExecutor>();  // the workers have their own cursors
+    }
+
     // Look for an initial match. This works whether we got an initial query or not.
     // If not, it results in a "{}" query, which will be what we want in that case.
     const BSONObj queryObj = pPipeline->getInitialQuery();
@@ -405,6 +437,81 @@ std::shared_ptr<PlanExecutor> PipelineD::prepareExecutor(
         txn, collection, expCtx, queryObj, *projectionObj, *sortObj, plannerOpts));
 }
 
+bool PipelineD::addParallelCursorSource(OperationContext* txn,
+                                        Collection* collection,
+                                        const NamespaceString& nss,
+                                        const intrusive_ptr<Pipeline>& pipeline,
+                                        const intrusive_ptr<ExpressionContext>& expCtx) {
+    const int maxDegree = internalAggregationMaxDegreeOfParallelism;
+    if (maxDegree <= 1 || expCtx->inShard || !hasParallelizablePrefix(pipeline->sources)) {
+        return false;
+    }
+
+    // Workers read without the shard filter, and each one reads from its own snapshot.
+    if (ShardingState::get(txn)->needCollectionMetadata(txn, nss.ns()) ||
+        txn->recoveryUnit()->isReadingFromMajorityCommittedSnapshot()) {
+        return false;
+    }
+
+    // Only a collection scan can be divided between the workers. If the query system would use an
+    // index, let it.
+    {
+        auto swExec = attemptToGetExecutor(txn,
+                                           collection,
+                                           expCtx,
+                                           pipeline->getInitialQuery(),
+                                           BSONObj(),
+                                           BSONObj(),
+                                           QueryPlannerParams::DEFAULT);
+        if (!swExec.isOK() || swExec.getValue()->getRootStage()->stageType() != STAGE_COLLSCAN) {
+            return false;
+        }
+    }
+
+    auto iterators = collection->getManyCursors(txn);
+    if (iterators.size() < 2) {
+        return false;
+    }
+
+    const size_t numWorkers = std::min(iterators.size(), static_cast<size_t>(maxDegree));
+    std::vector<unique_ptr<PlanExecutor>> execs;
+    for (size_t i = 0; i < numWorkers; ++i) {
+        auto ws = stdx::make_unique<WorkingSet>();
+        auto mis = stdx::make_unique<MultiIteratorStage>(txn, ws.get(), collection);
+
+        // The executors stay registered with the collection's CursorManager so that each worker
+        // is notified of invalidations while it is yielded.
+        auto statusWithPlanExecutor = PlanExecutor::make(
+            txn, std::move(ws), std::move(mis), collection, PlanExecutor::YIELD_AUTO);
+        invariant(statusWithPlanExecutor.isOK());
+        execs.push_back(std::move(statusWithPlanExecutor.getValue()));
+    }
+
+    for (size_t i = 0; i < iterators.size(); ++i) {
+        auto& exec = execs[i % execs.size()];
+        checked_cast<MultiIteratorStage*>(exec->getRootStage())
+            ->addIterator(std::move(iterators[i]));
+    }
+
+    for (auto&& exec : execs) {
+        exec->saveState();
+        exec->detachFromOperationContext();
+    }
+
+    // Each worker runs the shard half of the pipeline, which produces partial results just as a
+    // shard would, and this pipeline becomes the merger.
+    intrusive_ptr<Pipeline> workerPipeline = pipeline->splitForSharded();
+    MutableDocument workerSpec(workerPipeline->serialize());
+    workerSpec.remove(Pipeline::explainName);
+    workerSpec[Pipeline::fromRouterName] = Value(true);
+
+    LOG(1) << "running aggregation on " << nss.ns() << " with " << numWorkers << " workers";
+
+    pipeline->addInitialSource(DocumentSourceParallelCursor::create(
+        nss, workerSpec.freeze().toBson(), std::move(execs), expCtx));
+    return true;
+}
+
 shared_ptr<PlanExecutor> PipelineD::addCursorSource(const intrusive_ptr<Pipeline>& pipeline,
                                                     const intrusive_ptr<ExpressionContext>& expCtx,
                                                     shared_ptr<PlanExecutor> exec,
@@ -108,6 +108,18 @@ private:
         BSONObj* sortObj,
         BSONObj* projectionObj);
 
+    /**
+     * Attempts to run the leading stages of 'pipeline' in parallel over disjoint parts of a scan of
+     * 'collection'. On success, the stages which run on the workers are replaced by a
+     * DocumentSourceParallelCursor and true is returned. Returns false, leaving 'pipeline'
+     * untouched, if the pipeline or collection is not eligible.
+     */
+    static bool addParallelCursorSource(OperationContext* txn,
+                                        Collection* collection,
+                                        const NamespaceString& nss,
+                                        const boost::intrusive_ptr<Pipeline>& pipeline,
+                                        const boost::intrusive_ptr<ExpressionContext>& expCtx);
+
     /**
      * Creates a DocumentSourceCursor from the given PlanExecutor and adds it to the front of the
      * Pipeline.
@@ -36,6 +36,20 @@
 #include "mongo/db/pipeline/pipeline.h"
 
 namespace mongo {
+/**
+ * This class holds optimizations applied to a single Pipeline.
+ *
+ * Each function takes the Pipeline as an in/out parameter.
+ */
+class Pipeline::Optimizations::Local {
+public:
+    /**
+     * Tells each $sort which fields the stages after it use, so that it can avoid holding the
+     * other fields of the documents it sorts. Must be called once the stages are final.
+     */
+    static void limitFieldsHeldBySorts(Pipeline* pipeline);
+};
+
 /**
  * This class holds optimizations applied to a shard Pipeline and a merger Pipeline.
  *
@@ -49,6 +49,9 @@
 namespace mongo {
 namespace {
 
+// Counts summed across all plan caches.
+PlanCacheStats globalPlanCacheStats;
+
 // Delimiters for cache key encoding.
 const char kEncodeDiscriminatorsBegin = '<';
 const char kEncodeDiscriminatorsEnd = '>';
@@ -312,7 +315,7 @@ CachedSolution::CachedSolution(const PlanCacheKey& key, const PlanCacheEntry& en
       query(entry.query.getOwned()),
       sort(entry.sort.getOwned()),
       projection(entry.projection.getOwned()),
-      decisionWorks(entry.decision->stats[0]->common.works) {
+      decisionWorks(entry.works) {
     // CachedSolution should not having any references into
     // cache entry. All relevant data should be cloned/copied.
     for (size_t i = 0; i < entry.plannerData.size(); ++i) {
@@ -336,7 +339,7 @@ CachedSolution::~CachedSolution() {
 
 PlanCacheEntry::PlanCacheEntry(const std::vector<QuerySolution*>& solutions,
                                PlanRankingDecision* why)
-    : plannerData(solutions.size()), decision(why) {
+    : plannerData(solutions.size()), decision(why), works(why->stats[0]->common.works) {
     invariant(why);
 
     // The caller of this constructor is responsible for ensuring
@@ -378,8 +381,12 @@ PlanCacheEntry* PlanCacheEntry::clone() const {
         PlanCacheEntryFeedback* fb = new PlanCacheEntryFeedback();
         fb->stats.reset(feedback[i]->stats->clone());
         fb->score = feedback[i]->score;
+        fb->works = feedback[i]->works;
+        fb->advanced = feedback[i]->advanced;
         entry->feedback.push_back(fb);
     }
+    entry->works = works;
+    entry->numReplansToSamePlan = numReplansToSamePlan;
     return entry;
 }
 
@@ -389,6 +396,17 @@ std::string PlanCacheEntry::toString() const {
                          << ";solutions: " << plannerData.size() << ")";
 }
 
+//
+// PlanCacheStats
+//
+
+void PlanCacheStats::appendTo(BSONObjBuilder* builder) const {
+    builder->appendNumber("hits", hits.get());
+    builder->appendNumber("misses", misses.get());
+    builder->appendNumber("evictions", evictions.get());
+    builder->appendNumber("replans", replans.get());
+}
+
 std::string CachedSolution::toString() const {
     return str::stream() << "key: " << key << '\n';
 }
@@ -616,7 +634,8 @@ void PlanCache::encodeKeyForProj(const BSONObj& projObj, StringBuilder* keyBuild
 
 Status PlanCache::add(const CanonicalQuery& query,
                       const std::vector<QuerySolution*>& solns,
-                      PlanRankingDecision* why) {
+                      PlanRankingDecision* why,
+                      bool replanned) {
     invariant(why);
 
     if (solns.empty()) {
@@ -652,10 +671,28 @@ Status PlanCache::add(const CanonicalQuery& query,
     }
     entry->projection = projBuilder.obj();
 
+    const PlanCacheKey key = computeKey(query);
+
     stdx::lock_guard<stdx::mutex> cacheLock(_cacheMutex);
-    std::unique_ptr<PlanCacheEntry> evictedEntry = _cache.add(computeKey(query), entry);
+
+    // If replanning picked the plan which is already cached, the cached plan's works were too
+    // low for this query shape. Raise them so that it is not replanned as readily next time.
+    PlanCacheEntry* oldEntry;
+    if (replanned && _cache.get(key, &oldEntry).isOK() &&
+        oldEntry->plannerData[0]->toString() == entry->plannerData[0]->toString()) {
+        const size_t grownWorks =
+            static_cast<size_t>(oldEntry->works * internalQueryCacheWorksGrowthCoefficient);
+        entry->works = std::max(entry->works, grownWorks);
+        entry->numReplansToSamePlan = oldEntry->numReplansToSamePlan + 1;
+        LOG(1) << _ns << ": replanning chose the cached plan again, raising its works from "
+               << oldEntry->works << " to " << entry->works << " for " << entry->toString();
+    }
+
+    std::unique_ptr<PlanCacheEntry> evictedEntry = _cache.add(key, entry);
 
     if (NULL != evictedEntry.get()) {
+        _stats.evictions.increment();
+        globalPlanCacheStats.evictions.increment();
         LOG(1) << _ns << ": plan cache maximum size exceeded - "
                << "removed least recently used entry " << evictedEntry->toString();
     }
@@ -671,10 +708,14 @@ Status PlanCache::get(const CanonicalQuery& query, CachedSolution** crOut) const
     PlanCacheEntry* entry;
     Status cacheStatus = _cache.get(key, &entry);
     if (!cacheStatus.isOK()) {
+        _stats.misses.increment();
+        globalPlanCacheStats.misses.increment();
         return cacheStatus;
     }
     invariant(entry);
 
+    _stats.hits.increment();
+    globalPlanCacheStats.hits.increment();
     *crOut = new CachedSolution(key, *entry);
 
     return Status::OK();
@@ -695,8 +736,13 @@ Status PlanCache::feedback(const CanonicalQuery& cq, PlanCacheEntryFeedback* fee
     }
     invariant(entry);
 
-    // We store up to a constant number of feedback entries.
-    if (entry->feedback.size() < size_t(internalQueryCacheFeedbacksStored)) {
+    // We store up to a constant number of the most recent feedback entries.
+    const size_t maxFeedbacks = std::max(internalQueryCacheFeedbacksStored.load(), 0);
+    while (!entry->feedback.empty() && entry->feedback.size() >= maxFeedbacks) {
+        delete entry->feedback.front();
+        entry->feedback.erase(entry->feedback.begin());
+    }
+    if (maxFeedbacks > 0) {
         entry->feedback.push_back(autoFeedback.release());
     }
 
@@ -765,4 +811,13 @@ void PlanCache::notifyOfIndexEntries(const std::vector<IndexEntry>& indexEntries
     _indexabilityState.updateDiscriminators(indexEntries);
 }
 
+void PlanCache::notifyOfReplan() {
+    _stats.replans.increment();
+    globalPlanCacheStats.replans.increment();
+}
+
+const PlanCacheStats& PlanCache::getGlobalStats() {
+    return globalPlanCacheStats;
+}
+
 }  // namespace mongo
@@ -31,6 +31,7 @@
 #include <set>
 #include <boost/optional/optional.hpp>
 
+#include "mongo/base/counter.h"
 #include "mongo/db/exec/plan_stats.h"
 #include "mongo/db/query/canonical_query.h"
 #include "mongo/db/query/index_tag.h"
@@ -60,6 +61,32 @@ struct PlanCacheEntryFeedback {
     // The "goodness" score produced by the plan ranker
     // corresponding to 'stats'.
     double score;
+
+    // The work cycles the cached plan took during its trial period, and the number of results it
+    // produced in them.
+    size_t works = 0;
+    size_t advanced = 0;
+};
+
+/**
+ * Counts how a plan cache is used. Each PlanCache keeps its own counts, and the totals across all
+ * plan caches are reported by serverStatus.
+ */
+struct PlanCacheStats {
+    // Lookups of cacheable queries which found a cached plan.
+    Counter64 hits;
+
+    // Lookups of cacheable queries which found no cached plan.
+    Counter64 misses;
+
+    // Entries removed because the cache was full.
+    Counter64 evictions;
+
+    // Cached plans which needed more works than allowed during their trial period, so that the
+    // query was planned again.
+    Counter64 replans;
+
+    void appendTo(BSONObjBuilder* builder) const;
 };
 
 // TODO: Replace with opaque type.
@@ -197,8 +224,8 @@ public:
     BSONObj sort;
     BSONObj projection;
 
-    // The number of work cycles taken to decide on a winning plan when the plan was first
-    // cached.
+    // The number of work cycles the cached plan is expected to need during its trial period.
+    // See PlanCacheEntry::works.
     size_t decisionWorks;
 };
 
@@ -254,9 +281,18 @@ public:
     // the other plans lost.
     std::unique_ptr<PlanRankingDecision> decision;
 
-    // Annotations from cached runs.  The CachedPlanStage provides these stats about its
-    // runs when they complete.
+    // Annotations from the most recent cached runs.  The CachedPlanStage provides these stats
+    // about its runs when they complete.
     std::vector<PlanCacheEntryFeedback*> feedback;
+
+    // The number of work cycles the cached plan may take during its trial period, multiplied by
+    // internalQueryCacheEvictionRatio, before the query is replanned. Starts as the works the
+    // plan took to win plan selection. Grows each time replanning picks the same plan again, so
+    // that a plan whose cost varies with its parameters is not replanned on every execution.
+    size_t works = 0;
+
+    // The number of times this entry was replaced by replanning which picked the same plan.
+    size_t numReplansToSamePlan = 0;
 };
 
 /**
@@ -294,12 +330,17 @@ public:
      *
      * Takes ownership of 'why'.
      *
+     * 'replanned' is true when the solutions come from replanning a query whose cached plan
+     * exceeded its works during its trial period. If replanning picked the plan which was
+     * already cached, the new entry's works are grown by internalQueryCacheWorksGrowthCoefficient.
+     *
      * If the mapping was added successfully, returns Status::OK().
      * If the mapping already existed or some other error occurred, returns another Status.
      */
     Status add(const CanonicalQuery& query,
                const std::vector<QuerySolution*>& solns,
-               PlanRankingDecision* why);
+               PlanRankingDecision* why,
+               bool replanned = false);
 
     /**
      * Look up the cached data access for the provided 'query'.  Used by the query planner
@@ -388,6 +429,24 @@ public:
      */
     void notifyOfIndexEntries(const std::vector<IndexEntry>& indexEntries);
 
+    /**
+     * Called by the CachedPlanStage when a cached plan exceeds its works during its trial period
+     * and the query is replanned.
+     */
+    void notifyOfReplan();
+
+    /**
+     * Returns the counters for this cache.
+     */
+    const PlanCacheStats& getStats() const {
+        return _stats;
+    }
+
+    /**
+     * Returns the counters summed across all plan caches.
+     */
+    static const PlanCacheStats& getGlobalStats();
+
 private:
     void encodeKeyForMatch(const MatchExpression* tree, StringBuilder* keyBuilder) const;
     void encodeKeyForSort(const BSONObj& sortObj, StringBuilder* keyBuilder) const;
@@ -411,6 +470,9 @@ private:
     // Concurrent access is synchronized by the collection lock.  Multiple concurrent readers
     // are allowed.
     PlanCacheIndexabilityState _indexabilityState;
+
+    // Counted by the const get() as well, hence mutable. The counters are atomic.
+    mutable PlanCacheStats _stats;
 };
 
 }  // namespace mongo
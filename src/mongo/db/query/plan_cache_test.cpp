@@ -195,10 +195,11 @@ struct GenerateQuerySolution {
 /**
  * Utility function to create a PlanRankingDecision
  */
-PlanRankingDecision* createDecision(size_t numPlans) {
+PlanRankingDecision* createDecision(size_t numPlans, size_t works = 0) {
     unique_ptr<PlanRankingDecision> why(new PlanRankingDecision());
     for (size_t i = 0; i < numPlans; ++i) {
         CommonStats common("COLLSCAN");
+        common.works = works;
         unique_ptr<PlanStageStats> stats(new PlanStageStats(common, STAGE_COLLSCAN));
         stats->specific.reset(new CollectionScanStats());
         why->stats.mutableVector().push_back(stats.release());
@@ -403,6 +404,74 @@ TEST(PlanCacheTest, AddValidSolution) {
     ASSERT_EQUALS(planCache.size(), 1U);
 }
 
+TEST(PlanCacheTest, GetCountsHitsAndMisses) {
+    PlanCache planCache;
+    unique_ptr<CanonicalQuery> cq(canonicalize("{a: 1}"));
+    QuerySolution qs;
+    qs.cacheData.reset(new SolutionCacheData());
+    qs.cacheData->tree.reset(new PlanCacheIndexTree());
+    std::vector<QuerySolution*> solns;
+    solns.push_back(&qs);
+
+    CachedSolution* rawCS;
+    ASSERT_NOT_OK(planCache.get(*cq, &rawCS));
+    ASSERT_OK(planCache.add(*cq, solns, createDecision(1U, 40)));
+    ASSERT_OK(planCache.get(*cq, &rawCS));
+    unique_ptr<CachedSolution> cs(rawCS);
+    ASSERT_EQUALS(cs->decisionWorks, 40U);
+
+    planCache.notifyOfReplan();
+
+    ASSERT_EQUALS(planCache.getStats().hits.get(), 1);
+    ASSERT_EQUALS(planCache.getStats().misses.get(), 1);
+    ASSERT_EQUALS(planCache.getStats().evictions.get(), 0);
+    ASSERT_EQUALS(planCache.getStats().replans.get(), 1);
+}
+
+// When replanning picks the plan which is already cached, the works the plan is measured against
+// grow, so that it is not replanned as readily. A different plan starts over from its own works.
+TEST(PlanCacheTest, WorksGrowWhenReplanningPicksCachedPlan) {
+    PlanCache planCache;
+    unique_ptr<CanonicalQuery> cq(canonicalize("{a: 1}"));
+    QuerySolution qs;
+    qs.cacheData.reset(new SolutionCacheData());
+    qs.cacheData->tree.reset(new PlanCacheIndexTree());
+    std::vector<QuerySolution*> solns;
+    solns.push_back(&qs);
+
+    ASSERT_OK(planCache.add(*cq, solns, createDecision(1U, 100)));
+
+    // Another thread which planned the same query shape and lost the race to cache it does not
+    // grow the works.
+    ASSERT_OK(planCache.add(*cq, solns, createDecision(1U, 100)));
+    PlanCacheEntry* rawEntry;
+    ASSERT_OK(planCache.getEntry(*cq, &rawEntry));
+    unique_ptr<PlanCacheEntry> entry(rawEntry);
+    ASSERT_EQUALS(entry->works, 100U);
+    ASSERT_EQUALS(entry->numReplansToSamePlan, 0U);
+
+    const bool replanned = true;
+    ASSERT_OK(planCache.add(*cq, solns, createDecision(1U, 50), replanned));
+
+    ASSERT_OK(planCache.getEntry(*cq, &rawEntry));
+    entry.reset(rawEntry);
+    ASSERT_EQUALS(entry->works,
+                  static_cast<size_t>(100 * internalQueryCacheWorksGrowthCoefficient));
+    ASSERT_EQUALS(entry->numReplansToSamePlan, 1U);
+
+    QuerySolution collScan;
+    collScan.cacheData.reset(new SolutionCacheData());
+    collScan.cacheData->solnType = SolutionCacheData::COLLSCAN_SOLN;
+    std::vector<QuerySolution*> collScanSolns;
+    collScanSolns.push_back(&collScan);
+
+    ASSERT_OK(planCache.add(*cq, collScanSolns, createDecision(1U, 50), replanned));
+    ASSERT_OK(planCache.getEntry(*cq, &rawEntry));
+    entry.reset(rawEntry);
+    ASSERT_EQUALS(entry->works, 50U);
+    ASSERT_EQUALS(entry->numReplansToSamePlan, 0U);
+}
+
 /**
  * Each test in the CachePlanSelectionTest suite goes through
  * the following flow:
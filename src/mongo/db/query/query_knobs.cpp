@@ -29,6 +29,7 @@
 #include "mongo/db/query/query_knobs.h"
 #include "mongo/db/server_options.h"
 #include "mongo/db/server_parameters.h"
+#include "mongo/util/mongoutils/str.h"
 
 namespace mongo {
 
@@ -44,6 +45,31 @@ MONGO_EXPORT_SERVER_PARAMETER(internalQueryCacheFeedbacksStored, int, 20);
 
 MONGO_EXPORT_SERVER_PARAMETER(internalQueryCacheEvictionRatio, double, 10.0);
 
+AtomicDouble internalQueryCacheWorksGrowthCoefficient(2.0);
+
+namespace {
+class WorksGrowthCoefficientParameter
+    : public ExportedServerParameter<double, ServerParameterType::kStartupAndRuntime> {
+public:
+    WorksGrowthCoefficientParameter()
+        : ExportedServerParameter<double, ServerParameterType::kStartupAndRuntime>(
+              ServerParameterSet::getGlobal(),
+              "internalQueryCacheWorksGrowthCoefficient",
+              &internalQueryCacheWorksGrowthCoefficient) {}
+
+    Status validate(const double& potentialNewValue) final {
+        if (!(potentialNewValue >= 1.0 &&
+              potentialNewValue <= kMaxQueryCacheWorksGrowthCoefficient)) {
+            return Status(ErrorCodes::BadValue,
+                          str::stream() << "internalQueryCacheWorksGrowthCoefficient must be "
+                                           "between 1 and "
+                                        << kMaxQueryCacheWorksGrowthCoefficient);
+        }
+        return Status::OK();
+    }
+} worksGrowthCoefficientParameter;
+}  // namespace
+
 MONGO_EXPORT_SERVER_PARAMETER(internalQueryPlannerMaxIndexedSolutions, int, 64);
 
 MONGO_EXPORT_SERVER_PARAMETER(internalQueryEnumerationMaxOrSolutions, int, 10);
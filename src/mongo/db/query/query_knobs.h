@@ -73,6 +73,12 @@ extern std::atomic<int> internalQueryCacheFeedbacksStored;  // NOLINT
 // and replanning?
 extern AtomicDouble internalQueryCacheEvictionRatio;  // NOLINT
 
+// When replanning a query picks the same plan that was cached before, by how much do we multiply
+// the works the cached plan is measured against, so that it is not replanned again as readily?
+// Must be between 1 and kMaxQueryCacheWorksGrowthCoefficient.
+extern AtomicDouble internalQueryCacheWorksGrowthCoefficient;  // NOLINT
+const double kMaxQueryCacheWorksGrowthCoefficient = 10.0;
+
 //
 // Planning and enumeration.
 //
@@ -93,18 +93,24 @@ BSONObj BaseClonerTest::createListIndexesResponse(CursorId cursorId, const BSONA
 }
 
 BaseClonerTest::BaseClonerTest()
-    : _mutex(), _setStatusCondition(), _status(getDetectableErrorStatus()) {}
+    : _oldCollectionRangeBytes(0),
+      _mutex(),
+      _setStatusCondition(),
+      _status(getDetectableErrorStatus()) {}
 
 void BaseClonerTest::setUp() {
     ReplicationExecutorTest::setUp();
     clear();
     launchExecutorThread();
     storageInterface.reset(new ClonerStorageInterfaceMock());
+    _oldCollectionRangeBytes = internalInitialSyncCollectionRangeBytes.load();
+    internalInitialSyncCollectionRangeBytes.store(0);
 }
 
 void BaseClonerTest::tearDown() {
     ReplicationExecutorTest::tearDown();
     storageInterface.reset();
+    internalInitialSyncCollectionRangeBytes.store(_oldCollectionRangeBytes);
 }
 
 void BaseClonerTest::clear() {
@@ -122,6 +122,10 @@ protected:
     std::unique_ptr<ClonerStorageInterfaceMock> storageInterface;
 
 private:
+    // Tests copy collections with a single find unless they set
+    // internalInitialSyncCollectionRangeBytes.
+    long long _oldCollectionRangeBytes;
+
     // Protects member data of this base cloner fixture.
     mutable stdx::mutex _mutex;
 
@@ -54,6 +54,7 @@
 #include "mongo/db/repl/rs_sync.h"
 #include "mongo/db/stats/timer_stats.h"
 #include "mongo/executor/network_interface_factory.h"
+#include "mongo/platform/atomic_word.h"
 #include "mongo/rpc/metadata/repl_set_metadata.h"
 #include "mongo/stdx/memory.h"
 #include "mongo/util/concurrency/thread_pool.h"
@@ -63,6 +64,7 @@
 #include "mongo/util/mongoutils/str.h"
 #include "mongo/util/scopeguard.h"
 #include "mongo/util/time_support.h"
+#include "mongo/util/timer.h"
 
 namespace mongo {
 
@@ -144,6 +146,66 @@ static int bufferMaxSizeGauge = 256 * 1024 * 1024;
 static ServerStatusMetricField<int> displayBufferMaxSize("repl.buffer.maxSizeBytes",
                                                          &bufferMaxSizeGauge);
 
+// The number and time of waits by the fetcher for the previous batch to be queued, during which
+// no getMore is in flight
+static TimerStats fetchStallStats;
+static ServerStatusMetricField<TimerStats> displayFetchStalls("repl.buffer.fetchStalls",
+                                                              &fetchStallStats);
+
+namespace {
+
+/**
+ * Bytes queued in the buffer during the last full second. Written by the producer thread only.
+ */
+class BufferThroughput {
+public:
+    void record(long long bytes) {
+        const long long second = curTimeMillis64() / 1000;
+        const long long lastSecond = _second.load();
+        if (second != lastSecond) {
+            _lastSecondBytes.store(second == lastSecond + 1 ? _currentSecondBytes.load() : 0);
+            _currentSecondBytes.store(0);
+            _second.store(second);
+        }
+        _currentSecondBytes.fetchAndAdd(bytes);
+    }
+
+    long long bytesPerSecond() const {
+        const long long second = curTimeMillis64() / 1000;
+        const long long lastSecond = _second.load();
+        if (second == lastSecond) {
+            return _lastSecondBytes.load();
+        }
+        return second == lastSecond + 1 ? _currentSecondBytes.load() : 0;
+    }
+
+private:
+    AtomicInt64 _second;
+    AtomicInt64 _currentSecondBytes;
+    AtomicInt64 _lastSecondBytes;
+};
+
+BufferThroughput bufferThroughput;
+
+class BufferFillRatioSSM : public ServerStatusMetric {
+public:
+    BufferFillRatioSSM() : ServerStatusMetric("repl.buffer.fillRatio") {}
+    virtual void appendAtLeaf(BSONObjBuilder& b) const {
+        const double sizeBytes = static_cast<double>(bufferSizeGauge.get());
+        b.append(_leafName, sizeBytes / bufferMaxSizeGauge);
+    }
+} bufferFillRatioSSM;
+
+class BufferBytesPerSecondSSM : public ServerStatusMetric {
+public:
+    BufferBytesPerSecondSSM() : ServerStatusMetric("repl.buffer.bytesPerSecond") {}
+    virtual void appendAtLeaf(BSONObjBuilder& b) const {
+        b.append(_leafName, bufferThroughput.bytesPerSecond());
+    }
+} bufferBytesPerSecondSSM;
+
+}  // namespace
+
 
 BackgroundSyncInterface::~BackgroundSyncInterface() {}
 
@@ -162,6 +224,8 @@ BackgroundSync::BackgroundSync()
                          std::numeric_limits<long long>::max()),
       _lastFetchedHash(0),
       _stopped(true),
+      _fetchedBatchBytes(0),
+      _fetcherDone(true),
       _replCoord(getGlobalReplicationCoordinator()),
       _initialSyncRequestedFlag(false),
       _indexPrefetchConfig(PREFETCH_ALL) {}
@@ -181,6 +245,7 @@ void BackgroundSync::shutdown() {
     invariant(inShutdown());
     clearBuffer();
     _stopped = true;
+    _fetchedBatchCondition.notify_all();
 }
 
 void BackgroundSync::producerThread() {
@@ -325,15 +390,27 @@ void BackgroundSync::_produce(OperationContext* txn) {
     // no more references to oplog reader from here on.
 
     Status fetcherReturnStatus = Status::OK();
-    auto fetcherCallback = stdx::bind(&BackgroundSync::_fetcherCallback,
-                                      this,
-                                      stdx::placeholders::_1,
-                                      stdx::placeholders::_3,
-                                      stdx::cref(source),
-                                      lastOpTimeFetched,
-                                      lastHashFetched,
-                                      fetcherMaxTimeMS,
-                                      &fetcherReturnStatus);
+    auto fetcherCallback = [&, lastOpTimeFetched, lastHashFetched](
+        const StatusWith<Fetcher::QueryResponse>& result,
+        Fetcher::NextAction* nextAction,
+        BSONObjBuilder* bob) {
+        _fetcherCallback(result,
+                         bob,
+                         source,
+                         lastOpTimeFetched,
+                         lastHashFetched,
+                         fetcherMaxTimeMS,
+                         &fetcherReturnStatus);
+
+        // The fetcher stops unless the callback filled in a getMore command.
+        if (!bob || bob->asTempObj().isEmpty()) {
+            {
+                stdx::lock_guard<stdx::mutex> lock(_mutex);
+                _fetcherDone = true;
+            }
+            _fetchedBatchCondition.notify_all();
+        }
+    };
 
 
     BSONObjBuilder cmdBob;
@@ -363,12 +440,18 @@ void BackgroundSync::_produce(OperationContext* txn) {
 
     LOG(1) << "scheduling fetcher to read remote oplog on " << source << " starting at "
            << cmdObj["filter"];
+    {
+        stdx::lock_guard<stdx::mutex> lock(_mutex);
+        _fetchedBatch.clear();
+        _fetcherDone = false;
+    }
     auto scheduleStatus = fetcher.schedule();
     if (!scheduleStatus.isOK()) {
         warning() << "unable to schedule fetcher to read remote oplog on " << source << ": "
                   << scheduleStatus;
         return;
     }
+    _queueFetchedBatches();
     fetcher.wait();
     LOG(1) << "fetcher stopped reading remote oplog on " << source;
 
@@ -566,44 +649,47 @@ void BackgroundSync::_fetcherCallback(const StatusWith<Fetcher::QueryResponse>&
         lastTS = docTS;
     }
 
-    // These numbers are for the documents we will apply.
-    auto toApplyDocumentCount = documents.size();
+    // This number is for the documents we will apply.
     auto toApplyDocumentBytes = networkDocumentBytes;
     if (queryResponse.first) {
-        // The count is one less since the first document found was already applied ($gte $ts query)
-        // and we will not apply it again. We just needed to check it so we didn't rollback, or
-        // error above.
-        --toApplyDocumentCount;
+        // The first document found was already applied ($gte $ts query) and we will not apply it
+        // again. We just needed to check it so we didn't rollback, or error above.
         const auto alreadyAppliedDocument = documents.cbegin();
         toApplyDocumentBytes -= alreadyAppliedDocument->objsize();
     }
 
     if (toApplyDocumentBytes > 0) {
-        // Wait for enough space.
-        _buffer.waitForSpace(toApplyDocumentBytes);
-
-        OCCASIONALLY {
-            LOG(2) << "bgsync buffer has " << _buffer.size() << " bytes";
-        }
-
-        // Buffer docs for later application.
+        // The documents share the buffer of the reply they were read from, so handing them off
+        // does not copy them.
         std::vector<BSONObj> objs{firstDocToApply, lastDocToApply};
-        _buffer.pushAllNonBlocking(objs);
-
-        // Inc stats.
-        opsReadStats.increment(documents.size());  // we read all of the docs in the query.
-        networkByteStats.increment(networkDocumentBytes);
-        bufferCountGauge.increment(toApplyDocumentCount);
-        bufferSizeGauge.increment(toApplyDocumentBytes);
-
-        // Update last fetched info.
-        auto lastDoc = objs.back();
+        const BSONObj lastDoc = objs.back();
         {
             stdx::unique_lock<stdx::mutex> lock(_mutex);
+            if (!_fetchedBatch.empty() && !_stopped) {
+                Timer stallTimer;
+                _fetchedBatchCondition.wait(lock,
+                                            [this]() { return _fetchedBatch.empty() || _stopped; });
+                fetchStallStats.recordMillis(stallTimer.millis());
+            }
+            if (_stopped) {
+                LOG(2) << "Interrupted by stop request while querying the oplog. 3";  // 3rd.
+                return;
+            }
+
+            // Hand the batch to the producer thread, which queues it for application.
+            _fetchedBatch = std::move(objs);
+            _fetchedBatchBytes = toApplyDocumentBytes;
+
+            // Update last fetched info.
             _lastFetchedHash = lastDoc["h"].numberLong();
             _lastOpTimeFetched = fassertStatusOK(28770, OpTime::parseFromOplogEntry(lastDoc));
             LOG(3) << "batch resetting _lastOpTimeFetched: " << _lastOpTimeFetched;
         }
+        _fetchedBatchCondition.notify_all();
+
+        // Inc stats.
+        opsReadStats.increment(documents.size());  // we read all of the docs in the query.
+        networkByteStats.increment(networkDocumentBytes);
     }
 
     // record time for each batch
@@ -664,6 +750,48 @@ void BackgroundSync::_fetcherCallback(const StatusWith<Fetcher::QueryResponse>&
     }
 }
 
+void BackgroundSync::_queueFetchedBatches() {
+    while (true) {
+        std::vector<BSONObj> batch;
+        int batchBytes = 0;
+        {
+            stdx::unique_lock<stdx::mutex> lock(_mutex);
+            _fetchedBatchCondition.wait(
+                lock, [this]() { return !_fetchedBatch.empty() || _fetcherDone; });
+            if (_fetchedBatch.empty()) {
+                return;
+            }
+            batch.swap(_fetchedBatch);
+            batchBytes = _fetchedBatchBytes;
+        }
+        // The fetcher may hand off the next batch, and so send the getMore after it, while this
+        // one waits for room in the buffer.
+        _fetchedBatchCondition.notify_all();
+
+        // Wait for enough space.
+        _buffer.waitForSpace(batchBytes);
+
+        // Drop the batch if we were stopped while it was in flight; stop() has reset the last
+        // fetched optime.
+        if (isStopped()) {
+            LOG(2) << "Interrupted by stop request while queueing fetched oplog entries.";
+            continue;
+        }
+
+        OCCASIONALLY {
+            LOG(2) << "bgsync buffer has " << _buffer.size() << " bytes";
+        }
+
+        // Buffer docs for later application.
+        _buffer.pushAllNonBlocking(batch);
+
+        // Inc stats.
+        bufferCountGauge.increment(batch.size());
+        bufferSizeGauge.increment(batchBytes);
+        bufferThroughput.record(batchBytes);
+    }
+}
+
 bool BackgroundSync::peek(BSONObj* op) {
     return _buffer.peek(*op);
 }
@@ -723,6 +851,7 @@ void BackgroundSync::stop() {
     _syncSourceHost = HostAndPort();
     _lastOpTimeFetched = OpTime();
     _lastFetchedHash = 0;
+    _fetchedBatchCondition.notify_all();
 }
 
 void BackgroundSync::start(OperationContext* txn) {
@@ -28,6 +28,8 @@
 
 #pragma once
 
+#include <vector>
+
 #include "mongo/base/status_with.h"
 #include "mongo/client/fetcher.h"
 #include "mongo/db/jsobj.h"
@@ -160,6 +162,18 @@ private:
     // if producer thread should not be running
     bool _stopped;
 
+    // The fetcher callback hands each batch it reads to the producer thread, which queues it in
+    // _buffer. This lets the next getMore be in flight while the producer waits for room in the
+    // buffer. The callback only waits when the previous batch has not been taken yet.
+    std::vector<BSONObj> _fetchedBatch;
+    int _fetchedBatchBytes;
+
+    // Set by the fetcher callback when it will not hand off any more batches.
+    bool _fetcherDone;
+
+    // Signaled when _fetchedBatch is filled or emptied, when _fetcherDone is set and on stop.
+    stdx::condition_variable _fetchedBatchCondition;
+
     HostAndPort _syncSourceHost;
 
     BackgroundSync();
@@ -178,6 +192,12 @@ private:
      */
     void _signalNoNewDataForApplier();
 
+    /**
+     * Queues the batches handed off by the fetcher callback in _buffer until the fetcher is done.
+     * Runs on the producer thread.
+     */
+    void _queueFetchedBatches();
+
     /**
      * Processes query responses from fetcher.
      */
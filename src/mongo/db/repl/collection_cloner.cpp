@@ -32,6 +32,10 @@
 
 #include "mongo/db/repl/collection_cloner.h"
 
+#include <algorithm>
+
+#include "mongo/db/server_parameters.h"
+#include "mongo/rpc/get_status_from_command_result.h"
 #include "mongo/util/assert_util.h"
 #include "mongo/util/log.h"
 #include "mongo/util/mongoutils/str.h"
@@ -39,6 +43,48 @@
 namespace mongo {
 namespace repl {
 
+using executor::RemoteCommandRequest;
+
+MONGO_EXPORT_SERVER_PARAMETER(internalInitialSyncCollectionRangeBytes,
+                              long long,
+                              512 * 1024 * 1024);
+
+MONGO_EXPORT_SERVER_PARAMETER(internalInitialSyncMaxConcurrentRangeFetches, int, 4);
+
+namespace {
+
+bool hasIdIndex(const std::vector<BSONObj>& indexSpecs) {
+    for (auto&& spec : indexSpecs) {
+        if (spec["name"].str() == "_id_") {
+            return true;
+        }
+    }
+    return false;
+}
+
+}  // namespace
+
+void CollectionCloner::Stats::append(BSONObjBuilder* builder, Date_t now) const {
+    builder->appendNumber("ranges", ranges);
+    builder->appendNumber("fetchedBatches", fetchedBatches);
+    builder->appendNumber("documentsCopied", documentsCopied);
+    builder->appendNumber("bytesCopied", bytesCopied);
+    if (start == Date_t()) {
+        return;
+    }
+    builder->appendDate("start", start);
+    if (end != Date_t()) {
+        builder->appendDate("end", end);
+        now = end;
+    }
+    const long long elapsedMillis = durationCount<Milliseconds>(now - start);
+    builder->appendNumber("elapsedMillis", elapsedMillis);
+    if (elapsedMillis > 0) {
+        builder->append("documentsPerSecond", documentsCopied * 1000.0 / elapsedMillis);
+        builder->append("bytesPerSecond", bytesCopied * 1000.0 / elapsedMillis);
+    }
+}
+
 CollectionCloner::CollectionCloner(ReplicationExecutor* executor,
                                    const HostAndPort& source,
                                    const NamespaceString& sourceNss,
@@ -62,17 +108,7 @@ CollectionCloner::CollectionCloner(ReplicationExecutor* executor,
                                      stdx::placeholders::_1,
                                      stdx::placeholders::_2,
                                      stdx::placeholders::_3)),
-      _findFetcher(_executor,
-                   _source,
-                   _sourceNss.db().toString(),
-                   BSON("find" << _sourceNss.coll() << "noCursorTimeout" << true),  // SERVER-1387
-                   stdx::bind(&CollectionCloner::_findCallback,
-                              this,
-                              stdx::placeholders::_1,
-                              stdx::placeholders::_2,
-                              stdx::placeholders::_3)),
       _indexSpecs(),
-      _documents(),
       _dbWorkCallbackHandle(),
       _scheduleDbWorkFn([this](const ReplicationExecutor::CallbackFn& work) {
           return _executor->scheduleDBWork(work);
@@ -94,6 +130,11 @@ const NamespaceString& CollectionCloner::getSourceNamespace() const {
     return _sourceNss;
 }
 
+CollectionCloner::Stats CollectionCloner::getStats() const {
+    stdx::lock_guard<stdx::mutex> lk(_mutex);
+    return _stats;
+}
+
 std::string CollectionCloner::getDiagnosticString() const {
     stdx::lock_guard<stdx::mutex> lk(_mutex);
     str::stream output;
@@ -105,7 +146,8 @@ std::string CollectionCloner::getDiagnosticString() const {
     output << " collection options: " << _options.toBSON();
     output << " active: " << _active;
     output << " listIndexes fetcher: " << _listIndexesFetcher.getDiagnosticString();
-    output << " find fetcher: " << _findFetcher.getDiagnosticString();
+    output << " find ranges: " << _findRanges.size();
+    output << " active find ranges: " << _activeFindRanges;
     output << " database worked callback handle: " << (_dbWorkCallbackHandle.isValid() ? "valid"
                                                                                        : "invalid");
     return output;
@@ -129,12 +171,15 @@ Status CollectionCloner::start() {
     }
 
     _active = true;
+    _stats.start = _executor->now();
 
     return Status::OK();
 }
 
 void CollectionCloner::cancel() {
     ReplicationExecutor::CallbackHandle dbWorkCallbackHandle;
+    ReplicationExecutor::CallbackHandle splitVectorCallbackHandle;
+    std::vector<Fetcher*> findFetchers;
     {
         stdx::lock_guard<stdx::mutex> lk(_mutex);
 
@@ -143,10 +188,21 @@ void CollectionCloner::cancel() {
         }
 
         dbWorkCallbackHandle = _dbWorkCallbackHandle;
+        splitVectorCallbackHandle = _splitVectorCallbackHandle;
+        for (auto&& range : _findRanges) {
+            findFetchers.push_back(range.fetcher.get());
+        }
     }
 
     _listIndexesFetcher.cancel();
-    _findFetcher.cancel();
+
+    if (splitVectorCallbackHandle.isValid()) {
+        _executor->cancel(splitVectorCallbackHandle);
+    }
+
+    for (auto&& fetcher : findFetchers) {
+        fetcher->cancel();
+    }
 
     if (dbWorkCallbackHandle.isValid()) {
         _executor->cancel(dbWorkCallbackHandle);
@@ -222,20 +278,40 @@ void CollectionCloner::_listIndexesCallback(const Fetcher::QueryResponseStatus&
 
 void CollectionCloner::_findCallback(const StatusWith<Fetcher::QueryResponse>& fetchResult,
                                      Fetcher::NextAction* nextAction,
-                                     BSONObjBuilder* getMoreBob) {
+                                     BSONObjBuilder* getMoreBob,
+                                     size_t rangeIndex) {
     if (!fetchResult.isOK()) {
-        _finishCallback(nullptr, fetchResult.getStatus());
+        _finishRange(nullptr, rangeIndex, fetchResult.getStatus());
+        return;
+    }
+
+    bool otherRangeFailed;
+    {
+        stdx::lock_guard<stdx::mutex> lk(_mutex);
+        otherRangeFailed = !_findStatus.isOK();
+        if (!otherRangeFailed) {
+            ++_stats.fetchedBatches;
+        }
+    }
+
+    if (otherRangeFailed) {
+        // Leaving getMoreBob empty stops the fetcher.
+        _finishRange(nullptr, rangeIndex, Status::OK());
         return;
     }
 
     auto batchData(fetchResult.getValue());
-    _documents = batchData.documents;
 
     bool lastBatch = *nextAction == Fetcher::NextAction::kNoAction;
-    auto&& scheduleResult = _scheduleDbWorkFn(stdx::bind(
-        &CollectionCloner::_insertDocumentsCallback, this, stdx::placeholders::_1, lastBatch));
+    auto&& scheduleResult =
+        _scheduleDbWorkFn(stdx::bind(&CollectionCloner::_insertDocumentsCallback,
+                                     this,
+                                     stdx::placeholders::_1,
+                                     batchData.documents,
+                                     rangeIndex,
+                                     lastBatch));
     if (!scheduleResult.isOK()) {
-        _finishCallback(nullptr, scheduleResult.getStatus());
+        _finishRange(nullptr, rangeIndex, scheduleResult.getStatus());
         return;
     }
 
@@ -245,6 +321,7 @@ void CollectionCloner::_findCallback(const StatusWith<Fetcher::QueryResponse>& f
         getMoreBob->append("collection", batchData.nss.coll());
     }
 
+    stdx::lock_guard<stdx::mutex> lk(_mutex);
     _dbWorkCallbackHandle = scheduleResult.getValue();
 }
 
@@ -261,32 +338,206 @@ void CollectionCloner::_beginCollectionCallback(const ReplicationExecutor::Callb
         return;
     }
 
-    Status scheduleStatus = _findFetcher.schedule();
+    // Capped collections are copied in natural order, and the ranges are scanned on the _id index.
+    const long long rangeBytes = internalInitialSyncCollectionRangeBytes.load();
+    if (rangeBytes <= 0 || _options.capped || !hasIdIndex(_indexSpecs)) {
+        _startFindRanges(txn, std::vector<BSONObj>());
+        return;
+    }
+
+    Status scheduleStatus = _scheduleSplitVector(rangeBytes);
     if (!scheduleStatus.isOK()) {
         _finishCallback(txn, scheduleStatus);
         return;
     }
 }
 
+Status CollectionCloner::_scheduleSplitVector(long long rangeBytes) {
+    // splitVector splits at half of maxChunkSizeBytes. A maxChunkObjects of 0 lifts its default
+    // limit on the number of documents between split points.
+    const BSONObj cmdObj = BSON("splitVector" << _sourceNss.ns() << "keyPattern" << BSON("_id" << 1)
+                                              << "maxChunkSizeBytes" << 2 * rangeBytes
+                                              << "maxChunkObjects" << 0);
+    auto scheduleResult = _executor->scheduleRemoteCommand(
+        RemoteCommandRequest(_source, "admin", cmdObj),
+        stdx::bind(&CollectionCloner::_splitVectorCallback, this, stdx::placeholders::_1));
+    if (!scheduleResult.isOK()) {
+        return scheduleResult.getStatus();
+    }
+
+    stdx::lock_guard<stdx::mutex> lk(_mutex);
+    _splitVectorCallbackHandle = scheduleResult.getValue();
+    return Status::OK();
+}
+
+void CollectionCloner::_splitVectorCallback(
+    const ReplicationExecutor::RemoteCommandCallbackArgs& rcbd) {
+    if (!rcbd.response.isOK()) {
+        _finishCallback(nullptr, rcbd.response.getStatus());
+        return;
+    }
+
+    const BSONObj& result = rcbd.response.getValue().data;
+    std::vector<BSONObj> splitKeys;
+    Status status = getStatusFromCommandResult(result);
+    if (status.isOK() && result["splitKeys"].type() != Array) {
+        status = Status(ErrorCodes::FailedToParse, "splitVector response has no splitKeys array");
+    }
+    if (status.isOK()) {
+        for (auto&& splitKey : result["splitKeys"].Array()) {
+            if (splitKey.type() != Object) {
+                status = Status(ErrorCodes::FailedToParse,
+                                str::stream() << "invalid split key in splitVector response: "
+                                              << splitKey);
+                break;
+            }
+            splitKeys.push_back(splitKey.Obj().getOwned());
+        }
+    }
+
+    if (!status.isOK()) {
+        // For example if the sync source doesn't let us run splitVector.
+        warning() << "Failed to split collection " << _sourceNss.ns() << " into _id ranges, "
+                  << "copying it with a single query: " << status;
+        splitKeys.clear();
+    }
+
+    _startFindRanges(nullptr, splitKeys);
+}
+
+void CollectionCloner::_startFindRanges(OperationContext* txn,
+                                        const std::vector<BSONObj>& splitKeys) {
+    stdx::unique_lock<stdx::mutex> lk(_mutex);
+    invariant(_findRanges.empty());
+
+    const size_t numRanges = splitKeys.size() + 1;
+    _findRanges.resize(numRanges);
+    for (size_t i = 0; i < numRanges; ++i) {
+        BSONObjBuilder cmdBob;
+        cmdBob.append("find", _sourceNss.coll());
+        if (!splitKeys.empty()) {
+            // min and max bound the scan of the _id index in index order, so that the ranges
+            // cover _id values of every type.
+            cmdBob.append("hint", BSON("_id" << 1));
+            if (i > 0) {
+                cmdBob.append("min", splitKeys[i - 1]);
+            }
+            if (i < splitKeys.size()) {
+                cmdBob.append("max", splitKeys[i]);
+            }
+        }
+        cmdBob.append("noCursorTimeout", true);  // SERVER-1387
+
+        _findRanges[i].fetcher.reset(new Fetcher(_executor,
+                                                 _source,
+                                                 _sourceNss.db().toString(),
+                                                 cmdBob.obj(),
+                                                 stdx::bind(&CollectionCloner::_findCallback,
+                                                            this,
+                                                            stdx::placeholders::_1,
+                                                            stdx::placeholders::_2,
+                                                            stdx::placeholders::_3,
+                                                            i)));
+    }
+    _stats.ranges = numRanges;
+
+    if (numRanges > 1) {
+        LOG(1) << "    cloning collection " << _sourceNss << " in " << numRanges << " _id ranges";
+    }
+
+    _advanceFindRanges(txn, std::move(lk));
+}
+
+void CollectionCloner::_finishRange(OperationContext* txn,
+                                    size_t rangeIndex,
+                                    const Status& status) {
+    stdx::unique_lock<stdx::mutex> lk(_mutex);
+    FindRange& range = _findRanges[rangeIndex];
+    if (range.finished) {
+        return;
+    }
+
+    range.finished = true;
+    --_activeFindRanges;
+    if (!status.isOK() && _findStatus.isOK()) {
+        _findStatus = status;
+    }
+
+    _advanceFindRanges(txn, std::move(lk));
+}
+
+void CollectionCloner::_advanceFindRanges(OperationContext* txn,
+                                          stdx::unique_lock<stdx::mutex> lk) {
+    const size_t maxActive = std::max(1, internalInitialSyncMaxConcurrentRangeFetches.load());
+    while (_findStatus.isOK() && _nextFindRange < _findRanges.size() &&
+           _activeFindRanges < maxActive) {
+        Status scheduleStatus = _findRanges[_nextFindRange].fetcher->schedule();
+        if (!scheduleStatus.isOK()) {
+            _findStatus = scheduleStatus;
+            break;
+        }
+        ++_nextFindRange;
+        ++_activeFindRanges;
+    }
+
+    std::vector<Fetcher*> fetchersToCancel;
+    if (!_findStatus.isOK()) {
+        for (size_t i = 0; i < _nextFindRange; ++i) {
+            if (!_findRanges[i].finished) {
+                fetchersToCancel.push_back(_findRanges[i].fetcher.get());
+            }
+        }
+    }
+
+    const bool done = _activeFindRanges == 0 &&
+        (!_findStatus.isOK() || _nextFindRange == _findRanges.size());
+    const Status status = _findStatus;
+    lk.unlock();
+
+    for (auto&& fetcher : fetchersToCancel) {
+        fetcher->cancel();
+    }
+
+    if (done) {
+        _finishCallback(txn, status);
+    }
+}
+
 void CollectionCloner::_insertDocumentsCallback(const ReplicationExecutor::CallbackArgs& cbd,
+                                                const std::vector<BSONObj>& documents,
+                                                size_t rangeIndex,
                                                 bool lastBatch) {
     OperationContext* txn = cbd.txn;
     if (!cbd.status.isOK()) {
-        _finishCallback(txn, cbd.status);
+        _finishRange(txn, rangeIndex, cbd.status);
         return;
     }
 
-    Status status = _storageInterface->insertDocuments(txn, _destNss, _documents);
-    if (!status.isOK()) {
-        _finishCallback(txn, status);
-        return;
+    bool otherRangeFailed;
+    {
+        stdx::lock_guard<stdx::mutex> lk(_mutex);
+        otherRangeFailed = !_findStatus.isOK();
+    }
+
+    if (!otherRangeFailed) {
+        Status status = _storageInterface->insertDocuments(txn, _destNss, documents);
+        if (!status.isOK()) {
+            _finishRange(txn, rangeIndex, status);
+            return;
+        }
+
+        stdx::lock_guard<stdx::mutex> lk(_mutex);
+        _stats.documentsCopied += documents.size();
+        for (auto&& doc : documents) {
+            _stats.bytesCopied += doc.objsize();
+        }
     }
 
     if (!lastBatch) {
         return;
     }
 
-    _finishCallback(txn, Status::OK());
+    _finishRange(txn, rangeIndex, Status::OK());
 }
 
 void CollectionCloner::_finishCallback(OperationContext* txn, const Status& status) {
@@ -300,6 +551,7 @@ void CollectionCloner::_finishCallback(OperationContext* txn, const Status& stat
     _onCompletion(status);
     stdx::lock_guard<stdx::mutex> lk(_mutex);
     _active = false;
+    _stats.end = _executor->now();
     _condition.notify_all();
 }
 
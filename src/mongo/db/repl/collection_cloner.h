@@ -28,6 +28,7 @@
 
 #pragma once
 
+#include <atomic>
 #include <memory>
 #include <string>
 #include <vector>
@@ -44,10 +45,18 @@
 #include "mongo/stdx/condition_variable.h"
 #include "mongo/stdx/mutex.h"
 #include "mongo/util/net/hostandport.h"
+#include "mongo/util/time_support.h"
 
 namespace mongo {
 namespace repl {
 
+// Collections larger than this are copied in _id ranges of about this many bytes, fetched in
+// parallel. 0 copies every collection with a single find.
+extern std::atomic<long long> internalInitialSyncCollectionRangeBytes;  // NOLINT
+
+// Maximum number of _id ranges of a collection that are fetched at the same time.
+extern std::atomic<int> internalInitialSyncMaxConcurrentRangeFetches;  // NOLINT
+
 class CollectionCloner : public BaseCloner {
     MONGO_DISALLOW_COPYING(CollectionCloner);
 
@@ -69,6 +78,24 @@ public:
     using ScheduleDbWorkFn = stdx::function<StatusWith<ReplicationExecutor::CallbackHandle>(
         const ReplicationExecutor::CallbackFn&)>;
 
+    /**
+     * Progress of a collection cloner.
+     */
+    struct Stats {
+        Date_t start;
+        Date_t end;
+        size_t ranges{0};
+        size_t fetchedBatches{0};
+        size_t documentsCopied{0};
+        long long bytesCopied{0};
+
+        /**
+         * Appends the counters, the elapsed time and the throughput of the copy so far.
+         * 'now' is used as the end of the copy if the cloner has not finished.
+         */
+        void append(BSONObjBuilder* builder, Date_t now) const;
+    };
+
     /**
      * Creates CollectionCloner task in inactive state. Use start() to activate cloner.
      *
@@ -89,6 +116,8 @@ public:
 
     const NamespaceString& getSourceNamespace() const;
 
+    Stats getStats() const;
+
     std::string getDiagnosticString() const override;
 
     bool isActive() const override;
@@ -127,11 +156,43 @@ private:
                               BSONObjBuilder* getMoreBob);
 
     /**
-     * Read collection documents from find result.
+     * Read collection documents from find result of the range at 'rangeIndex'.
      */
     void _findCallback(const StatusWith<Fetcher::QueryResponse>& fetchResult,
                        Fetcher::NextAction* nextAction,
-                       BSONObjBuilder* getMoreBob);
+                       BSONObjBuilder* getMoreBob,
+                       size_t rangeIndex);
+
+    /**
+     * Asks the sync source for the points splitting the collection into _id ranges of about
+     * 'rangeBytes' bytes.
+     */
+    Status _scheduleSplitVector(long long rangeBytes);
+
+    /**
+     * Starts copying the collection in the ranges delimited by the split points returned by the
+     * splitVector command, or with a single find if the command failed.
+     */
+    void _splitVectorCallback(const ReplicationExecutor::RemoteCommandCallbackArgs& rcbd);
+
+    /**
+     * Creates a find fetcher for each _id range delimited by 'splitKeys', or a single one for the
+     * whole collection if 'splitKeys' is empty, and starts fetching.
+     */
+    void _startFindRanges(OperationContext* txn, const std::vector<BSONObj>& splitKeys);
+
+    /**
+     * Records that the range at 'rangeIndex' has been copied, or has failed with 'status'.
+     * Has no effect if the range has already finished.
+     */
+    void _finishRange(OperationContext* txn, size_t rangeIndex, const Status& status);
+
+    /**
+     * Starts fetching ranges until internalInitialSyncMaxConcurrentRangeFetches are active. After
+     * a failure, cancels the active ranges instead. Finishes the cloner once no range is active
+     * and either all have been copied or one has failed.
+     */
+    void _advanceFindRanges(OperationContext* txn, stdx::unique_lock<stdx::mutex> lk);
 
     /**
      * Request storage interface to create collection.
@@ -152,6 +213,8 @@ private:
      * interface.
      */
     void _insertDocumentsCallback(const ReplicationExecutor::CallbackArgs& callbackData,
+                                  const std::vector<BSONObj>& documents,
+                                  size_t rangeIndex,
                                   bool lastBatch);
 
     /**
@@ -183,18 +246,32 @@ private:
     // _active is true when Collection Cloner is started.
     bool _active;
 
-    // Fetcher instances for running listIndexes and find commands.
+    // Fetcher instance for running the listIndexes command.
     Fetcher _listIndexesFetcher;
-    Fetcher _findFetcher;
 
     std::vector<BSONObj> _indexSpecs;
 
-    // Current batch of documents read from fetcher to insert into collection.
-    std::vector<BSONObj> _documents;
+    // Callback handle for the splitVector command.
+    ReplicationExecutor::CallbackHandle _splitVectorCallbackHandle;
+
+    // A find fetcher for each _id range of the collection, in _id order, and whether the range
+    // has been copied or has failed. Ranges are started in order.
+    struct FindRange {
+        std::unique_ptr<Fetcher> fetcher;
+        bool finished{false};
+    };
+    std::vector<FindRange> _findRanges;
+    size_t _nextFindRange{0};
+    size_t _activeFindRanges{0};
+
+    // The first failure of a range.
+    Status _findStatus{Status::OK()};
 
     // Callback handle for database worker.
     ReplicationExecutor::CallbackHandle _dbWorkCallbackHandle;
 
+    Stats _stats;
+
     // Function for scheduling database work using the executor.
     ScheduleDbWorkFn _scheduleDbWorkFn;
 };
@@ -216,6 +293,13 @@ public:
     /**
      * Creates a collection with the provided indexes.
      *
+     * The index specs are known before any document is inserted, so implementations should
+     * build the indexes as the documents arrive through insertDocuments() rather than after
+     * the data has been copied.
+     *
+     * Collections are cloned concurrently, so the functions of the storage interface may be
+     * called at the same time for different namespaces.
+     *
      * Assume that no database locks have been acquired prior to calling this
      * function.
      */
@@ -52,10 +52,14 @@ protected:
 
     CollectionOptions options;
     std::unique_ptr<CollectionCloner> collectionCloner;
+
+private:
+    int _oldMaxConcurrentRangeFetches = 0;
 };
 
 void CollectionClonerTest::setUp() {
     BaseClonerTest::setUp();
+    _oldMaxConcurrentRangeFetches = internalInitialSyncMaxConcurrentRangeFetches.load();
     options.reset();
     options.storageEngine = BSON("storageEngine1" << BSONObj());
     collectionCloner.reset(new CollectionCloner(
@@ -72,6 +76,7 @@ void CollectionClonerTest::tearDown() {
     // Executor may still invoke collection cloner's callback before shutting down.
     collectionCloner.reset();
     options.reset();
+    internalInitialSyncMaxConcurrentRangeFetches.store(_oldMaxConcurrentRangeFetches);
 }
 
 BaseCloner* CollectionClonerTest::getCloner() const {
@@ -489,4 +494,214 @@ TEST_F(CollectionClonerTest, InsertDocumentsMultipleBatches) {
     ASSERT_FALSE(collectionCloner->isActive());
 }
 
+TEST_F(CollectionClonerTest, StatsCountInsertedDocuments) {
+    ASSERT_EQUALS(Date_t(), collectionCloner->getStats().start);
+    ASSERT_OK(collectionCloner->start());
+    ASSERT_NOT_EQUALS(Date_t(), collectionCloner->getStats().start);
+
+    processNetworkResponse(createListIndexesResponse(0, BSON_ARRAY(idIndexSpec)));
+    collectionCloner->waitForDbWorker();
+
+    const BSONObj doc = BSON("_id" << 1);
+    const BSONObj doc2 = BSON("_id" << 2 << "a" << 1);
+    processNetworkResponse(createCursorResponse(1, BSON_ARRAY(doc)));
+    collectionCloner->waitForDbWorker();
+
+    auto stats = collectionCloner->getStats();
+    ASSERT_EQUALS(1U, stats.fetchedBatches);
+    ASSERT_EQUALS(1U, stats.documentsCopied);
+    ASSERT_EQUALS(doc.objsize(), stats.bytesCopied);
+    ASSERT_EQUALS(Date_t(), stats.end);
+
+    processNetworkResponse(createCursorResponse(0, BSON_ARRAY(doc2), "nextBatch"));
+    collectionCloner->waitForDbWorker();
+
+    ASSERT_OK(getStatus());
+    ASSERT_FALSE(collectionCloner->isActive());
+
+    stats = collectionCloner->getStats();
+    ASSERT_EQUALS(2U, stats.fetchedBatches);
+    ASSERT_EQUALS(2U, stats.documentsCopied);
+    ASSERT_EQUALS(doc.objsize() + doc2.objsize(), stats.bytesCopied);
+    ASSERT_NOT_EQUALS(Date_t(), stats.end);
+
+    BSONObjBuilder bob;
+    stats.append(&bob, getNet()->now());
+    const BSONObj statsObj = bob.obj();
+    ASSERT_EQUALS(2, statsObj["documentsCopied"].numberLong());
+    ASSERT_EQUALS(stats.end, statsObj["end"].Date());
+    ASSERT_TRUE(statsObj.hasField("elapsedMillis"));
+}
+
+TEST_F(CollectionClonerTest, CopiesLargeCollectionInIdRanges) {
+    internalInitialSyncCollectionRangeBytes.store(1024);
+    internalInitialSyncMaxConcurrentRangeFetches.store(2);
+
+    std::vector<BSONObj> insertedDocuments;
+    storageInterface->insertDocumentsFn = [&](OperationContext* txn,
+                                              const NamespaceString& theNss,
+                                              const std::vector<BSONObj>& theDocuments) {
+        insertedDocuments.insert(insertedDocuments.end(), theDocuments.begin(), theDocuments.end());
+        return Status::OK();
+    };
+
+    ASSERT_OK(collectionCloner->start());
+
+    processNetworkResponse(createListIndexesResponse(0, BSON_ARRAY(idIndexSpec)));
+    collectionCloner->waitForDbWorker();
+
+    // The split points are requested once the collection has been created.
+    auto net = getNet();
+    ASSERT_TRUE(net->hasReadyRequests());
+    NetworkOperationIterator noi = net->getNextReadyRequest();
+    {
+        auto&& noiRequest = noi->getRequest();
+        ASSERT_EQUALS("admin", noiRequest.dbname);
+        ASSERT_EQUALS("splitVector", std::string(noiRequest.cmdObj.firstElementFieldName()));
+        ASSERT_EQUALS(nss.ns(), noiRequest.cmdObj.firstElement().str());
+        ASSERT_EQUALS(BSON("_id" << 1), noiRequest.cmdObj.getObjectField("keyPattern"));
+        ASSERT_EQUALS(2048, noiRequest.cmdObj["maxChunkSizeBytes"].numberLong());
+    }
+    scheduleNetworkResponse(noi,
+                            BSON("splitKeys" << BSON_ARRAY(BSON("_id" << 10) << BSON("_id" << 20))
+                                             << "ok" << 1));
+    finishProcessingNetworkResponse();
+
+    // Two of the three ranges are fetched at once.
+    ASSERT_TRUE(net->hasReadyRequests());
+    NetworkOperationIterator firstRange = net->getNextReadyRequest();
+    ASSERT_TRUE(net->hasReadyRequests());
+    NetworkOperationIterator secondRange = net->getNextReadyRequest();
+    ASSERT_FALSE(net->hasReadyRequests());
+    {
+        auto&& cmdObj = firstRange->getRequest().cmdObj;
+        ASSERT_EQUALS("find", std::string(cmdObj.firstElementFieldName()));
+        ASSERT_EQUALS(BSON("_id" << 1), cmdObj.getObjectField("hint"));
+        ASSERT_FALSE(cmdObj.hasField("min"));
+        ASSERT_EQUALS(BSON("_id" << 10), cmdObj.getObjectField("max"));
+        ASSERT_TRUE(cmdObj.getField("noCursorTimeout").trueValue());
+    }
+    {
+        auto&& cmdObj = secondRange->getRequest().cmdObj;
+        ASSERT_EQUALS(BSON("_id" << 10), cmdObj.getObjectField("min"));
+        ASSERT_EQUALS(BSON("_id" << 20), cmdObj.getObjectField("max"));
+    }
+
+    scheduleNetworkResponse(firstRange, createCursorResponse(0, BSON_ARRAY(BSON("_id" << 1))));
+    finishProcessingNetworkResponse();
+    collectionCloner->waitForDbWorker();
+    ASSERT_TRUE(collectionCloner->isActive());
+
+    // The last range starts once the first has been copied.
+    ASSERT_TRUE(net->hasReadyRequests());
+    NetworkOperationIterator thirdRange = net->getNextReadyRequest();
+    {
+        auto&& cmdObj = thirdRange->getRequest().cmdObj;
+        ASSERT_EQUALS(BSON("_id" << 20), cmdObj.getObjectField("min"));
+        ASSERT_FALSE(cmdObj.hasField("max"));
+    }
+
+    scheduleNetworkResponse(secondRange, createCursorResponse(0, BSON_ARRAY(BSON("_id" << 15))));
+    finishProcessingNetworkResponse();
+    collectionCloner->waitForDbWorker();
+    ASSERT_TRUE(collectionCloner->isActive());
+
+    scheduleNetworkResponse(thirdRange, createCursorResponse(0, BSON_ARRAY(BSON("_id" << 25))));
+    finishProcessingNetworkResponse();
+    collectionCloner->waitForDbWorker();
+
+    ASSERT_OK(getStatus());
+    ASSERT_FALSE(collectionCloner->isActive());
+    ASSERT_EQUALS(3U, insertedDocuments.size());
+
+    auto stats = collectionCloner->getStats();
+    ASSERT_EQUALS(3U, stats.ranges);
+    ASSERT_EQUALS(3U, stats.documentsCopied);
+}
+
+TEST_F(CollectionClonerTest, CopiesWithSingleFindIfSplitVectorFails) {
+    internalInitialSyncCollectionRangeBytes.store(1024);
+
+    ASSERT_OK(collectionCloner->start());
+
+    processNetworkResponse(createListIndexesResponse(0, BSON_ARRAY(idIndexSpec)));
+    collectionCloner->waitForDbWorker();
+
+    processNetworkResponse(BSON("ok" << 0 << "errmsg"
+                                     << "not authorized"
+                                     << "code" << ErrorCodes::Unauthorized));
+
+    auto net = getNet();
+    ASSERT_TRUE(net->hasReadyRequests());
+    NetworkOperationIterator noi = net->getNextReadyRequest();
+    {
+        auto&& cmdObj = noi->getRequest().cmdObj;
+        ASSERT_EQUALS("find", std::string(cmdObj.firstElementFieldName()));
+        ASSERT_FALSE(cmdObj.hasField("min"));
+        ASSERT_FALSE(cmdObj.hasField("max"));
+    }
+    ASSERT_FALSE(net->hasReadyRequests());
+
+    scheduleNetworkResponse(noi, createCursorResponse(0, BSON_ARRAY(BSON("_id" << 1))));
+    finishProcessingNetworkResponse();
+    collectionCloner->waitForDbWorker();
+
+    ASSERT_OK(getStatus());
+    ASSERT_FALSE(collectionCloner->isActive());
+    ASSERT_EQUALS(1U, collectionCloner->getStats().ranges);
+}
+
+TEST_F(CollectionClonerTest, DoesNotSplitCollectionWithoutIdIndex) {
+    internalInitialSyncCollectionRangeBytes.store(1024);
+
+    ASSERT_OK(collectionCloner->start());
+
+    processNetworkResponse(createListIndexesResponse(0, BSONArray()));
+    collectionCloner->waitForDbWorker();
+
+    auto net = getNet();
+    ASSERT_TRUE(net->hasReadyRequests());
+    NetworkOperationIterator noi = net->getNextReadyRequest();
+    ASSERT_EQUALS("find", std::string(noi->getRequest().cmdObj.firstElementFieldName()));
+}
+
+TEST_F(CollectionClonerTest, RangeFailureCancelsOtherRanges) {
+    internalInitialSyncCollectionRangeBytes.store(1024);
+
+    bool insertDocumentsCalled = false;
+    storageInterface->insertDocumentsFn = [&](OperationContext* txn,
+                                              const NamespaceString& theNss,
+                                              const std::vector<BSONObj>& theDocuments) {
+        insertDocumentsCalled = true;
+        return Status::OK();
+    };
+
+    ASSERT_OK(collectionCloner->start());
+
+    processNetworkResponse(createListIndexesResponse(0, BSON_ARRAY(idIndexSpec)));
+    collectionCloner->waitForDbWorker();
+
+    processNetworkResponse(
+        BSON("splitKeys" << BSON_ARRAY(BSON("_id" << 10) << BSON("_id" << 20)) << "ok" << 1));
+
+    auto net = getNet();
+    ASSERT_TRUE(net->hasReadyRequests());
+    NetworkOperationIterator firstRange = net->getNextReadyRequest();
+    ASSERT_TRUE(net->hasReadyRequests());
+    NetworkOperationIterator secondRange = net->getNextReadyRequest();
+
+    scheduleNetworkResponse(firstRange, ErrorCodes::OperationFailed, "");
+    finishProcessingNetworkResponse();
+
+    // The failure is reported once the other ranges have been canceled.
+    scheduleNetworkResponse(secondRange, createCursorResponse(0, BSON_ARRAY(BSON("_id" << 15))));
+    finishProcessingNetworkResponse();
+    net->runReadyNetworkOperations();
+    collectionCloner->waitForDbWorker();
+
+    ASSERT_EQUALS(ErrorCodes::OperationFailed, getStatus().code());
+    ASSERT_FALSE(collectionCloner->isActive());
+    ASSERT_FALSE(insertDocumentsCalled);
+}
+
 }  // namespace
@@ -237,6 +237,20 @@ public:
                              << " db count:" << _databaseCloners.size();
     }
 
+    /**
+     * Appends the progress of each collection cloned so far, keyed by namespace.
+     * Must be called from a callback in the executor.
+     */
+    void appendStats(BSONObjBuilder* builder) {
+        builder->append("source", _source.toString());
+        builder->append("databaseClonersActive", _clonersActive);
+        builder->appendNumber("databases", _databaseCloners.size());
+        BSONObjBuilder collectionsBuilder(builder->subobjStart("collections"));
+        for (auto&& dbCloner : _databaseCloners) {
+            dbCloner->appendStats(&collectionsBuilder);
+        }
+    }
+
 
     // For testing
     void setStorageInterface(CollectionCloner::StorageInterface* si) {
@@ -616,6 +630,14 @@ std::string DataReplicator::getDiagnosticString() const {
     return out;
 }
 
+void DataReplicator::appendInitialSyncProgress(BSONObjBuilder* builder) const {
+    stdx::lock_guard<stdx::mutex> lk(_initialSyncStateMutex);
+    if (!_initialSyncState || !_initialSyncState->dbsCloner.isActive()) {
+        return;
+    }
+    _initialSyncState->dbsCloner.appendStats(builder);
+}
+
 Status DataReplicator::resume(bool wait) {
     CBHStatus handle = _exec->scheduleWork(
         stdx::bind(&DataReplicator::_resumeFinish, this, stdx::placeholders::_1));
@@ -753,12 +775,16 @@ TimestampStatus DataReplicator::initialSync() {
 
         if (attemptErrorStatus.isOK()) {
             invariant(initialSyncFinishEvent.isValid());
-            _initialSyncState.reset(new InitialSyncState(
+            std::unique_ptr<InitialSyncState> initialSyncState(new InitialSyncState(
                 DatabasesCloner(
                     _exec,
                     _syncSource,
                     stdx::bind(&DataReplicator::_onDataClonerFinish, this, stdx::placeholders::_1)),
                 initialSyncFinishEvent));
+            {
+                stdx::lock_guard<stdx::mutex> stateLock(_initialSyncStateMutex);
+                _initialSyncState = std::move(initialSyncState);
+            }
 
             _initialSyncState->dbsCloner.setStorageInterface(_storage);
             const NamespaceString ns(_opts.remoteOplogNS);
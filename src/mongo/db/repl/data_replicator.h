@@ -203,6 +203,14 @@ public:
 
     std::string getDiagnosticString() const;
 
+    /**
+     * Appends the progress of the initial sync in progress, if any, including the progress and
+     * throughput of each collection being cloned.
+     *
+     * Must be called from a callback in the executor, which serializes it with the cloners.
+     */
+    void appendInitialSyncProgress(BSONObjBuilder* builder) const;
+
     // For testing only
 
     void _resetState_inlock(Timestamp lastAppliedOpTime);
@@ -286,6 +294,10 @@ private:
     stdx::condition_variable _stateCondition;
     DataReplicatorState _state;  // (MX)
 
+    // Held, in addition to _mutex, when _initialSyncState is replaced so that the progress of
+    // initial sync may be reported without waiting for _mutex.
+    mutable stdx::mutex _initialSyncStateMutex;  // (S)
+
     // initial sync state
     std::unique_ptr<InitialSyncState> _initialSyncState;  // (M)
     CollectionCloner::StorageInterface* _storage;         // (M)
@@ -167,6 +167,10 @@ protected:
         ReplicationExecutorTest::setUp();
         reset();
 
+        // The initial sync tests expect each collection to be copied with a single find.
+        _oldCollectionRangeBytes = internalInitialSyncCollectionRangeBytes.load();
+        internalInitialSyncCollectionRangeBytes.store(0);
+
         launchExecutorThread();
         DataReplicatorOptions options;
         options.initialSyncRetryWait = Milliseconds(0);
@@ -199,6 +203,7 @@ protected:
         ReplicationExecutorTest::tearDown();
         _dr.reset();
         // Executor may still invoke callback before shutting down.
+        internalInitialSyncCollectionRangeBytes.store(_oldCollectionRangeBytes);
     }
 
     Applier::ApplyOperationFn _applierFn;
@@ -210,6 +215,7 @@ protected:
 
 private:
     std::unique_ptr<DataReplicator> _dr;
+    long long _oldCollectionRangeBytes = 0;
 };
 
 TEST_F(DataReplicatorTest, CreateDestroy) {}
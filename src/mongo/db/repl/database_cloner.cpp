@@ -37,6 +37,7 @@
 #include <set>
 
 #include "mongo/db/catalog/collection_options.h"
+#include "mongo/db/server_parameters.h"
 #include "mongo/stdx/functional.h"
 #include "mongo/util/assert_util.h"
 #include "mongo/util/log.h"
@@ -45,6 +46,8 @@
 namespace mongo {
 namespace repl {
 
+MONGO_EXPORT_SERVER_PARAMETER(internalInitialSyncMaxConcurrentCollectionClones, int, 4);
+
 namespace {
 
 const char* kNameFieldName = "name";
@@ -88,6 +91,8 @@ DatabaseCloner::DatabaseCloner(ReplicationExecutor* executor,
       _collectionWork(collWork),
       _onCompletion(onCompletion),
       _active(false),
+      _activeCollectionCloners(0),
+      _startCollectionClonersStatus(Status::OK()),
       _listCollectionsFetcher(_executor,
                               _source,
                               _dbname,
@@ -117,6 +122,20 @@ const std::vector<BSONObj>& DatabaseCloner::getCollectionInfos() const {
     return _collectionInfos;
 }
 
+void DatabaseCloner::appendStats(BSONObjBuilder* builder) const {
+    stdx::lock_guard<stdx::mutex> lk(_mutex);
+    const Date_t now = _executor->now();
+    for (auto&& collectionCloner : _collectionCloners) {
+        const CollectionCloner::Stats stats = collectionCloner.getStats();
+        if (stats.start == Date_t()) {
+            continue;
+        }
+        BSONObjBuilder collectionBuilder(
+            builder->subobjStart(collectionCloner.getSourceNamespace().ns()));
+        stats.append(&collectionBuilder, now);
+    }
+}
+
 std::string DatabaseCloner::getDiagnosticString() const {
     stdx::lock_guard<stdx::mutex> lk(_mutex);
     str::stream output;
@@ -128,6 +147,7 @@ std::string DatabaseCloner::getDiagnosticString() const {
     output << " active: " << _active;
     output << " collection info objects (empty if listCollections is in progress): "
            << _collectionInfos.size();
+    output << " active collection cloners: " << _activeCollectionCloners;
     return output;
 }
 
@@ -266,6 +286,7 @@ void DatabaseCloner::_listCollectionsCallback(const StatusWith<Fetcher::QueryRes
         auto&& nss = *_collectionNamespaces.crbegin();
 
         try {
+            stdx::lock_guard<stdx::mutex> lk(_mutex);
             _collectionCloners.emplace_back(
                 _executor,
                 _source,
@@ -284,18 +305,17 @@ void DatabaseCloner::_listCollectionsCallback(const StatusWith<Fetcher::QueryRes
         collectionCloner.setScheduleDbWorkFn(_scheduleDbWorkFn);
     }
 
-    // Start first collection cloner.
-    _currentCollectionClonerIter = _collectionCloners.begin();
-
-    LOG(1) << "    cloning collection " << _currentCollectionClonerIter->getSourceNamespace();
-
-    Status startStatus = _startCollectionCloner(*_currentCollectionClonerIter);
-    if (!startStatus.isOK()) {
-        LOG(1) << "    failed to start collection cloning on "
-               << _currentCollectionClonerIter->getSourceNamespace() << ": " << startStatus;
-        _finishCallback(startStatus);
+    stdx::unique_lock<stdx::mutex> lk(_mutex);
+    _nextCollectionClonerIter = _collectionCloners.begin();
+    _startCollectionCloners_inlock();
+    if (_activeCollectionCloners > 0) {
         return;
     }
+
+    // The first collection cloner failed to start.
+    const Status startStatus = _startCollectionClonersStatus;
+    lk.unlock();
+    _finishCallback(startStatus);
 }
 
 void DatabaseCloner::_collectionClonerCallback(const Status& status, const NamespaceString& nss) {
@@ -304,22 +324,38 @@ void DatabaseCloner::_collectionClonerCallback(const Status& status, const Names
     // from cloning the rest of the collections in the listCollections result.
     _collectionWork(status, nss);
 
-    _currentCollectionClonerIter++;
+    stdx::unique_lock<stdx::mutex> lk(_mutex);
+    invariant(_activeCollectionCloners > 0);
+    --_activeCollectionCloners;
+    _startCollectionCloners_inlock();
+    if (_activeCollectionCloners > 0) {
+        return;
+    }
 
-    LOG(1) << "    cloning collection " << _currentCollectionClonerIter->getSourceNamespace();
+    // Every collection cloner has completed, or the cloners still running have completed after
+    // another one failed to start.
+    const Status finishStatus = _startCollectionClonersStatus;
+    lk.unlock();
+    _finishCallback(finishStatus);
+}
 
-    if (_currentCollectionClonerIter != _collectionCloners.end()) {
-        Status startStatus = _startCollectionCloner(*_currentCollectionClonerIter);
+void DatabaseCloner::_startCollectionCloners_inlock() {
+    const int maxActive = std::max(1, internalInitialSyncMaxConcurrentCollectionClones.load());
+    while (_startCollectionClonersStatus.isOK() && _activeCollectionCloners < maxActive &&
+           _nextCollectionClonerIter != _collectionCloners.end()) {
+        auto&& collectionCloner = *_nextCollectionClonerIter++;
+
+        LOG(1) << "    cloning collection " << collectionCloner.getSourceNamespace();
+
+        Status startStatus = _startCollectionCloner(collectionCloner);
         if (!startStatus.isOK()) {
             LOG(1) << "    failed to start collection cloning on "
-                   << _currentCollectionClonerIter->getSourceNamespace() << ": " << startStatus;
-            _finishCallback(startStatus);
+                   << collectionCloner.getSourceNamespace() << ": " << startStatus;
+            _startCollectionClonersStatus = startStatus;
             return;
         }
-        return;
+        ++_activeCollectionCloners;
     }
-
-    _finishCallback(Status::OK());
 }
 
 void DatabaseCloner::_finishCallback(const Status& status) {
@@ -28,6 +28,7 @@
 
 #pragma once
 
+#include <atomic>
 #include <list>
 #include <string>
 #include <vector>
@@ -47,6 +48,9 @@
 namespace mongo {
 namespace repl {
 
+// Maximum number of collections of a database that are cloned at the same time.
+extern std::atomic<int> internalInitialSyncMaxConcurrentCollectionClones;  // NOLINT
+
 class DatabaseCloner : public BaseCloner {
     MONGO_DISALLOW_COPYING(DatabaseCloner);
 
@@ -70,6 +74,7 @@ public:
      *     - source namespace of the collection cloner that completed (or failed).
      *
      * Called exactly once for every collection cloner started by the the database cloner.
+     * Collections are cloned concurrently, so this may be called from several threads at once.
      */
     using CollectionCallbackFn = stdx::function<void(const Status&, const NamespaceString&)>;
 
@@ -105,6 +110,11 @@ public:
      */
     const std::vector<BSONObj>& getCollectionInfos() const;
 
+    /**
+     * Appends the progress of every collection cloner started so far, keyed by namespace.
+     */
+    void appendStats(BSONObjBuilder* builder) const;
+
     std::string getDiagnosticString() const override;
 
     bool isActive() const override;
@@ -147,6 +157,12 @@ private:
      */
     void _collectionClonerCallback(const Status& status, const NamespaceString& nss);
 
+    /**
+     * Starts collection cloners until internalInitialSyncMaxConcurrentCollectionClones are
+     * active, there are no more collections to clone or a cloner fails to start.
+     */
+    void _startCollectionCloners_inlock();
+
     /**
      * Reports completion status.
      * Sets cloner to inactive.
@@ -191,7 +207,16 @@ private:
     std::vector<NamespaceString> _collectionNamespaces;
 
     std::list<CollectionCloner> _collectionCloners;
-    std::list<CollectionCloner>::iterator _currentCollectionClonerIter;
+
+    // Next collection cloner to start.
+    std::list<CollectionCloner>::iterator _nextCollectionClonerIter;
+
+    // Number of collection cloners started that have not yet completed.
+    int _activeCollectionCloners;
+
+    // First error returned when starting a collection cloner. No further cloners are started
+    // once this is set.
+    Status _startCollectionClonersStatus;
 
     // Function for scheduling database work using the executor.
     CollectionCloner::ScheduleDbWorkFn _scheduleDbWorkFn;
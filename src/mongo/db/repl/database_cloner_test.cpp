@@ -57,9 +57,13 @@ protected:
 
     std::list<std::pair<Status, NamespaceString>> collectionWorkResults;
     std::unique_ptr<DatabaseCloner> databaseCloner;
+
+private:
+    int _oldMaxConcurrentCollectionClones;
 };
 
-DatabaseClonerTest::DatabaseClonerTest() : collectionWorkResults(), databaseCloner() {}
+DatabaseClonerTest::DatabaseClonerTest()
+    : collectionWorkResults(), databaseCloner(), _oldMaxConcurrentCollectionClones(0) {}
 
 void DatabaseClonerTest::collectionWork(const Status& status, const NamespaceString& srcNss) {
     collectionWorkResults.emplace_back(status, srcNss);
@@ -67,6 +71,7 @@ void DatabaseClonerTest::collectionWork(const Status& status, const NamespaceStr
 
 void DatabaseClonerTest::setUp() {
     BaseClonerTest::setUp();
+    _oldMaxConcurrentCollectionClones = internalInitialSyncMaxConcurrentCollectionClones.load();
     collectionWorkResults.clear();
     databaseCloner.reset(new DatabaseCloner(
         &getReplExecutor(),
@@ -86,6 +91,7 @@ void DatabaseClonerTest::tearDown() {
     BaseClonerTest::tearDown();
     databaseCloner.reset();
     collectionWorkResults.clear();
+    internalInitialSyncMaxConcurrentCollectionClones.store(_oldMaxConcurrentCollectionClones);
 }
 
 void DatabaseClonerTest::clear() {}
@@ -408,6 +414,7 @@ TEST_F(DatabaseClonerTest, StartFirstCollectionClonerFailed) {
 }
 
 TEST_F(DatabaseClonerTest, StartSecondCollectionClonerFailed) {
+    internalInitialSyncMaxConcurrentCollectionClones.store(1);
     ASSERT_OK(databaseCloner->start());
 
     // Replace scheduleDbWork function so that all callbacks (including exclusive tasks)
@@ -441,6 +448,8 @@ TEST_F(DatabaseClonerTest, StartSecondCollectionClonerFailed) {
 }
 
 TEST_F(DatabaseClonerTest, FirstCollectionListIndexesFailed) {
+    // Clone one collection at a time so that the order of the network requests is fixed.
+    internalInitialSyncMaxConcurrentCollectionClones.store(1);
     ASSERT_OK(databaseCloner->start());
 
     // Replace scheduleDbWork function so that all callbacks (including exclusive tasks)
@@ -462,7 +471,7 @@ TEST_F(DatabaseClonerTest, FirstCollectionListIndexesFailed) {
     ASSERT_EQUALS(getDetectableErrorStatus(), getStatus());
     ASSERT_TRUE(databaseCloner->isActive());
 
-    // Collection cloners are run serially for now.
+    // Collection cloners are run serially.
     // This affects the order of the network responses.
     processNetworkResponse(BSON("ok" << 0 << "errmsg"
                                      << ""
@@ -486,6 +495,7 @@ TEST_F(DatabaseClonerTest, FirstCollectionListIndexesFailed) {
 }
 
 TEST_F(DatabaseClonerTest, CreateCollections) {
+    internalInitialSyncMaxConcurrentCollectionClones.store(1);
     ASSERT_OK(databaseCloner->start());
 
     // Replace scheduleDbWork function so that all callbacks (including exclusive tasks)
@@ -507,7 +517,7 @@ TEST_F(DatabaseClonerTest, CreateCollections) {
     ASSERT_EQUALS(getDetectableErrorStatus(), getStatus());
     ASSERT_TRUE(databaseCloner->isActive());
 
-    // Collection cloners are run serially for now.
+    // Collection cloners are run serially.
     // This affects the order of the network responses.
     processNetworkResponse(createListIndexesResponse(0, BSON_ARRAY(idIndexSpec)));
     processNetworkResponse(createCursorResponse(0, BSONArray()));
@@ -529,4 +539,109 @@ TEST_F(DatabaseClonerTest, CreateCollections) {
     }
 }
 
+TEST_F(DatabaseClonerTest, StartSecondConcurrentCollectionClonerFailed) {
+    internalInitialSyncMaxConcurrentCollectionClones.store(2);
+    ASSERT_OK(databaseCloner->start());
+
+    auto&& executor = getReplExecutor();
+    databaseCloner->setScheduleDbWorkFn([&](const ReplicationExecutor::CallbackFn& workFn) {
+        return executor.scheduleWork(workFn);
+    });
+
+    databaseCloner->setStartCollectionClonerFn([](CollectionCloner& cloner) {
+        if (cloner.getSourceNamespace().coll() == "b") {
+            return Status(ErrorCodes::OperationFailed, "");
+        }
+        return cloner.start();
+    });
+
+    processNetworkResponse(
+        createListCollectionsResponse(0,
+                                      BSON_ARRAY(BSON("name"
+                                                      << "a"
+                                                      << "options" << BSONObj())
+                                                 << BSON("name"
+                                                         << "b"
+                                                         << "options" << BSONObj()))));
+
+    // The database cloner waits for the cloner started on 'a' before reporting the failure.
+    ASSERT_EQUALS(getDetectableErrorStatus(), getStatus());
+    ASSERT_TRUE(databaseCloner->isActive());
+
+    processNetworkResponse(createListIndexesResponse(0, BSON_ARRAY(idIndexSpec)));
+    processNetworkResponse(createCursorResponse(0, BSONArray()));
+
+    ASSERT_EQUALS(ErrorCodes::OperationFailed, getStatus().code());
+    ASSERT_FALSE(databaseCloner->isActive());
+    ASSERT_EQUALS(1U, collectionWorkResults.size());
+}
+
+TEST_F(DatabaseClonerTest, CreateCollectionsConcurrently) {
+    internalInitialSyncMaxConcurrentCollectionClones.store(2);
+    ASSERT_OK(databaseCloner->start());
+
+    auto&& executor = getReplExecutor();
+    databaseCloner->setScheduleDbWorkFn([&](const ReplicationExecutor::CallbackFn& workFn) {
+        return executor.scheduleWork(workFn);
+    });
+
+    processNetworkResponse(createListCollectionsResponse(0,
+                                                         BSON_ARRAY(BSON("name"
+                                                                         << "a"
+                                                                         << "options" << BSONObj())
+                                                                    << BSON("name"
+                                                                            << "b"
+                                                                            << "options"
+                                                                            << BSONObj())
+                                                                    << BSON("name"
+                                                                            << "c"
+                                                                            << "options"
+                                                                            << BSONObj()))));
+
+    // Cloners on 'a' and 'b' are started together. 'c' waits for one of them to complete.
+    auto net = getNet();
+    ASSERT_TRUE(net->hasReadyRequests());
+    auto noi = net->getNextReadyRequest();
+    ASSERT_EQUALS("a", noi->getRequest().cmdObj.getStringField("listIndexes"));
+    scheduleNetworkResponse(noi, createListIndexesResponse(0, BSON_ARRAY(idIndexSpec)));
+    ASSERT_TRUE(net->hasReadyRequests());
+    noi = net->getNextReadyRequest();
+    ASSERT_EQUALS("b", noi->getRequest().cmdObj.getStringField("listIndexes"));
+    scheduleNetworkResponse(noi, createListIndexesResponse(0, BSON_ARRAY(idIndexSpec)));
+    finishProcessingNetworkResponse();
+
+    // Both collections have been created. Complete the copy of 'b' first.
+    noi = net->getNextReadyRequest();
+    ASSERT_EQUALS("a", noi->getRequest().cmdObj.getStringField("find"));
+    auto findA = noi;
+    noi = net->getNextReadyRequest();
+    ASSERT_EQUALS("b", noi->getRequest().cmdObj.getStringField("find"));
+    scheduleNetworkResponse(noi, createCursorResponse(0, BSON_ARRAY(BSON("_id" << 1))));
+    finishProcessingNetworkResponse();
+
+    ASSERT_EQUALS(1U, collectionWorkResults.size());
+    ASSERT_EQUALS(NamespaceString(dbname, "b").ns(), collectionWorkResults.front().second.ns());
+
+    BSONObjBuilder statsBuilder;
+    databaseCloner->appendStats(&statsBuilder);
+    const BSONObj stats = statsBuilder.obj();
+    ASSERT_EQUALS(0, stats.getObjectField(NamespaceString(dbname, "a").ns()).getIntField(
+                         "documentsCopied"));
+    ASSERT_EQUALS(1, stats.getObjectField(NamespaceString(dbname, "b").ns()).getIntField(
+                         "documentsCopied"));
+
+    // The cloner on 'c' has started in place of 'b'.
+    ASSERT_TRUE(net->hasReadyRequests());
+    noi = net->getNextReadyRequest();
+    ASSERT_EQUALS("c", noi->getRequest().cmdObj.getStringField("listIndexes"));
+    scheduleNetworkResponse(noi, createListIndexesResponse(0, BSON_ARRAY(idIndexSpec)));
+    scheduleNetworkResponse(findA, createCursorResponse(0, BSONArray()));
+    finishProcessingNetworkResponse();
+    processNetworkResponse(createCursorResponse(0, BSONArray()));
+
+    ASSERT_OK(getStatus());
+    ASSERT_FALSE(databaseCloner->isActive());
+    ASSERT_EQUALS(3U, collectionWorkResults.size());
+}
+
 }  // namespace
@@ -38,6 +38,8 @@
 #include <set>
 #include <vector>
 
+#include "mongo/base/counter.h"
+#include "mongo/bson/mutable/document.h"
 #include "mongo/bson/util/bson_extract.h"
 #include "mongo/db/auth/action_set.h"
 #include "mongo/db/auth/action_type.h"
@@ -57,6 +59,7 @@
 #include "mongo/db/catalog/rename_collection.h"
 #include "mongo/db/commands.h"
 #include "mongo/db/commands/dbhash.h"
+#include "mongo/db/commands/server_status_metric.h"
 #include "mongo/db/concurrency/write_conflict_exception.h"
 #include "mongo/db/db_raii.h"
 #include "mongo/db/dbdirectclient.h"
@@ -69,6 +72,7 @@
 #include "mongo/db/op_observer.h"
 #include "mongo/db/operation_context_impl.h"
 #include "mongo/db/ops/delete.h"
+#include "mongo/db/ops/update_driver.h"
 #include "mongo/db/ops/update_lifecycle_impl.h"
 #include "mongo/db/ops/update.h"
 #include "mongo/db/repl/bgsync.h"
@@ -135,23 +139,27 @@ struct OplogSlot {
 };
 
 /**
- * Allocates an optime for a new entry in the oplog, and updates the replication coordinator to
- * reflect that new optime.  Returns the new optime and the correct value of the "h" field for
- * the new oplog entry.
+ * Allocates optimes for 'count' new entries in the oplog, and updates the replication coordinator
+ * to reflect them. Fills 'slots' with the new optimes, which are consecutive, and the correct
+ * values of the "h" field for the new oplog entries.
  *
- * NOTE: From the time this function returns to the time that the new oplog entry is written
+ * The timestamps are reserved as one range and registered with the storage system together, so
+ * that the entries of a batch take newOpMutex once rather than once each.
+ *
+ * NOTE: From the time this function returns to the time that the new oplog entries are written
  * to the storage system, all errors must be considered fatal.  This is because the this
- * function registers the new optime with the storage system and the replication coordinator,
+ * function registers the new optimes with the storage system and the replication coordinator,
  * and provides no facility to revert those registrations on rollback.
  */
-OplogSlot getNextOpTime(OperationContext* txn,
-                        Collection* oplog,
-                        ReplicationCoordinator* replCoord,
-                        ReplicationCoordinator::Mode replicationMode) {
+void getNextOpTimes(OperationContext* txn,
+                    Collection* oplog,
+                    ReplicationCoordinator* replCoord,
+                    ReplicationCoordinator::Mode replicationMode,
+                    size_t count,
+                    OplogSlot* slots) {
+    invariant(count > 0);
     synchronizeOnCappedInFlightResource(txn->lockState(), oplog->ns());
 
-    OplogSlot slot;
-    slot.hash = 0;
     long long term = OpTime::kUninitializedTerm;
 
     // Fetch term out of the newOpMutex.
@@ -161,19 +169,28 @@ OplogSlot getNextOpTime(OperationContext* txn,
         term = replCoord->getTerm();
     }
 
-    stdx::lock_guard<stdx::mutex> lk(newOpMutex);
-    Timestamp ts = getNextGlobalTimestamp();
-    newTimestampNotifier.notify_all();
+    Timestamp first;
+    {
+        stdx::lock_guard<stdx::mutex> lk(newOpMutex);
+        first = getNextGlobalTimestamps(count);
+        newTimestampNotifier.notify_all();
 
-    fassert(28560, oplog->getRecordStore()->oplogDiskLocRegister(txn, ts));
+        // Readers of the oplog stop before the earliest registered entry which is not committed
+        // yet. The rest of the range is after the first timestamp and is committed with it, so
+        // registering the first timestamp hides the whole range.
+        fassert(28560, oplog->getRecordStore()->oplogDiskLocRegister(txn, first));
 
-    // Set hash if we're in replset mode, otherwise it remains 0 in master/slave.
-    if (replicationMode == ReplicationCoordinator::modeReplSet) {
-        slot.hash = hashGenerator.nextInt64();
+        // Set hash if we're in replset mode, otherwise it remains 0 in master/slave.
+        for (size_t i = 0; i < count; ++i) {
+            slots[i].hash = (replicationMode == ReplicationCoordinator::modeReplSet)
+                ? hashGenerator.nextInt64()
+                : 0;
+        }
     }
 
-    slot.opTime = OpTime(ts, term);
-    return slot;
+    for (size_t i = 0; i < count; ++i) {
+        slots[i].opTime = OpTime(Timestamp(first.asULL() + i), term);
+    }
 }
 
 /**
@@ -421,7 +438,8 @@ void _logOp(OperationContext* txn,
     Collection* oplog = getLocalOplogCollection(txn, oplogName);
     Lock::DBLock lk(txn->lockState(), "local", MODE_IX);
     Lock::CollectionLock lock(txn->lockState(), oplogName, MODE_IX);
-    auto slot = getNextOpTime(txn, oplog, replCoord, replMode);
+    OplogSlot slot;
+    getNextOpTimes(txn, oplog, replCoord, replMode, 1, &slot);
     auto writer = _logOpWriter(txn, opstr, nss, obj, o2, fromMigrate, slot.opTime, slot.hash);
     writers.emplace_back(std::move(writer));
     _logOpsInner(txn, opstr, nss, writers, fromMigrate, oplog, replMode, updateOpTime, slot.opTime);
@@ -439,19 +457,24 @@ void logOps(OperationContext* txn,
     if (oplogDisabled(txn, replMode, nss))
         return;
 
+    const size_t count = end - begin;
     vector<unique_ptr<OplogDocWriter>> writers;
-    writers.reserve(end - begin);
-    OpTime finalOpTime;
+    writers.reserve(count);
     ReplicationCoordinator* replCoord = getGlobalReplicationCoordinator();
     Collection* oplog = getLocalOplogCollection(txn, _oplogCollectionName);
     Lock::DBLock lk(txn->lockState(), "local", MODE_IX);
     Lock::CollectionLock lock(txn->lockState(), _oplogCollectionName, MODE_IX);
-    for (auto it = begin; it != end; it++) {
-        auto slot = getNextOpTime(txn, oplog, replCoord, replMode);
-        finalOpTime = slot.opTime;
-        auto writer = _logOpWriter(txn, opstr, nss, *it, NULL, fromMigrate, slot.opTime, slot.hash);
+
+    // Reserve the slots of every entry at once, then build the entries outside of newOpMutex.
+    std::unique_ptr<OplogSlot[]> slots(new OplogSlot[count]);
+    getNextOpTimes(txn, oplog, replCoord, replMode, count, slots.get());
+    for (size_t i = 0; i < count; i++) {
+        const OplogSlot& slot = slots[i];
+        auto writer =
+            _logOpWriter(txn, opstr, nss, begin[i], NULL, fromMigrate, slot.opTime, slot.hash);
         writers.emplace_back(std::move(writer));
     }
+    const OpTime finalOpTime = slots[count - 1].opTime;
     _logOpsInner(txn, opstr, nss, writers, fromMigrate, oplog, replMode, true, finalOpTime);
 }
 
@@ -588,6 +611,131 @@ void createOplog(OperationContext* txn) {
 // -------------------------------------
 
 namespace {
+// Updates and deletes applied by _id without going through the query and update machinery.
+Counter64 idUpdatesApplied;
+ServerStatusMetricField<Counter64> displayIdUpdatesApplied("repl.apply.idUpdates",
+                                                           &idUpdatesApplied);
+Counter64 idDeletesApplied;
+ServerStatusMetricField<Counter64> displayIdDeletesApplied("repl.apply.idDeletes",
+                                                           &idDeletesApplied);
+
+/**
+ * Returns true if 'query' is exactly {_id: <value>} and 'collection' can look documents up by
+ * _id. Capped collections are left to the general path, which handles their missing _id index
+ * and the restrictions on document growth.
+ *
+ * Only operations replicated from another node qualify, which is the case when this node cannot
+ * accept writes for the collection itself. The applyOps command also turns off replicated writes,
+ * but on a primary it keeps going through the general path, so that its behavior is unchanged.
+ */
+bool canApplyById(OperationContext* txn, Collection* collection, const BSONObj& query) {
+    return !txn->writesAreReplicated() && collection &&
+        !ReplicationCoordinator::get(txn)->canAcceptWritesFor(collection->ns()) &&
+        !collection->isCapped() && query.nFields() == 1 &&
+        query.firstElementFieldName() == StringData("_id") &&
+        collection->getIndexCatalog()->findIdIndex(txn);
+}
+
+/**
+ * Applies the update 'o' to the document with the _id in 'o2', seeking to it through the _id
+ * index and writing the driver's damages in place when the storage engine supports it. This is
+ * what UpdateStage::transformAndUpdate does for a single document, minus the canonical query,
+ * plan executor and validation that replicated updates do not need.
+ *
+ * Returns false, having written nothing, if the update has to go through the general path: the
+ * document is missing (the caller reports the failure or upserts), or the update is one the
+ * general path treats specially.
+ */
+bool applyUpdateById(OperationContext* txn,
+                     Collection* collection,
+                     const BSONObj& o,
+                     const BSONObj& o2) {
+    if (!canApplyById(txn, collection, o2)) {
+        return false;
+    }
+
+    const RecordId rid = Helpers::findById(txn, collection, o2);
+    if (rid.isNull()) {
+        return false;
+    }
+
+    UpdateDriver driver{UpdateDriver::Options()};
+    driver.setLogOp(true);
+    driver.setModOptions(ModifierInterface::Options::fromRepl());
+    if (!driver.parse(o).isOK() || driver.needMatchDetails()) {
+        return false;
+    }
+    driver.refreshIndexKeys(&collection->infoCache()->getIndexKeys(txn));
+    driver.setContext(ModifierInterface::ExecInfo::UPDATE_CONTEXT);
+
+    const Snapshotted<BSONObj> oldObj = collection->docFor(txn, rid);
+    mutablebson::Document doc(oldObj.value(),
+                              collection->updateWithDamagesSupported()
+                                  ? mutablebson::Document::kInPlaceEnabled
+                                  : mutablebson::Document::kInPlaceDisabled);
+
+    BSONObj logObj;
+    bool docWasModified = false;
+    uassertStatusOK(driver.update(StringData(), &doc, &logObj, nullptr, &docWasModified));
+
+    mutablebson::DamageVector damages;
+    const char* source = nullptr;
+    const bool inPlace = doc.getInPlaceUpdates(&damages, &source);
+    if (!docWasModified || (inPlace && damages.empty())) {
+        // Replaying an update that has already been applied.
+        return true;
+    }
+
+    BSONObj newObj;
+    if (!inPlace) {
+        newObj = doc.getObject();
+        if (newObj.firstElementFieldName() != StringData("_id") ||
+            newObj.objsize() > BSONObjMaxUserSize) {
+            // The general path reorders _id and reports oversized documents.
+            return false;
+        }
+    }
+
+    OplogUpdateEntryArgs args;
+    args.ns = collection->ns().ns();
+    args.update = logObj;
+
+    WriteUnitOfWork wuow(txn);
+    if (inPlace) {
+        args.criteria = driver.makeOplogEntryQuery(oldObj.value(), false);
+        const RecordData oldRec(oldObj.value().objdata(), oldObj.value().objsize());
+        const Snapshotted<RecordData> oldSnapshot(oldObj.snapshotId(), oldRec);
+        uassertStatusOK(
+            collection->updateDocumentWithDamages(txn, rid, oldSnapshot, source, damages, &args));
+    } else {
+        args.criteria = driver.makeOplogEntryQuery(newObj, false);
+        OpDebug debug;
+        uassertStatusOK(collection->updateDocument(
+            txn, rid, oldObj, newObj, true, driver.modsAffectIndices(), &debug, &args));
+    }
+    wuow.commit();
+    return true;
+}
+
+/**
+ * Deletes the document matching 'o', if 'o' is an _id query, through the _id index rather than a
+ * delete plan. Returns false if the delete has to go through the general path. A document that
+ * is already gone counts as applied, as it does for deleteObjects().
+ */
+bool applyDeleteById(OperationContext* txn, Collection* collection, const BSONObj& o) {
+    if (!canApplyById(txn, collection, o)) {
+        return false;
+    }
+
+    const RecordId rid = Helpers::findById(txn, collection, o);
+    if (!rid.isNull()) {
+        WriteUnitOfWork wuow(txn);
+        collection->deleteDocument(txn, rid, false);
+        wuow.commit();
+    }
+    return true;
+}
+
 NamespaceString parseNs(const string& ns, const BSONObj& cmdObj) {
     BSONElement first = cmdObj.firstElement();
     uassert(28635,
@@ -882,52 +1030,56 @@ Status applyOperation_inlock(OperationContext* txn,
                 str::stream() << "Failed to apply update due to missing _id: " << op.toString(),
                 updateCriteria.hasField("_id"));
 
-        const NamespaceString requestNs(ns);
-        UpdateRequest request(requestNs);
-
-        request.setQuery(updateCriteria);
-        request.setUpdates(o);
-        request.setUpsert(upsert);
-        UpdateLifecycleImpl updateLifecycle(true, requestNs);
-        request.setLifecycle(&updateLifecycle);
-
-        UpdateResult ur = update(txn, db, request, &debug);
-
-        if (ur.numMatched == 0 && ur.upserted.isEmpty()) {
-            if (ur.modifiers) {
-                if (updateCriteria.nFields() == 1) {
-                    // was a simple { _id : ... } update criteria
-                    string msg = str::stream() << "failed to apply update: " << op.toString();
-                    error() << msg;
-                    return Status(ErrorCodes::OperationFailed, msg);
-                }
-                // Need to check to see if it isn't present so we can exit early with a
-                // failure. Note that adds some overhead for this extra check in some cases,
-                // such as an updateCriteria
-                // of the form
-                //   { _id:..., { x : {$size:...} }
-                // thus this is not ideal.
-                if (collection == NULL ||
-                    (indexCatalog->haveIdIndex(txn) &&
-                     Helpers::findById(txn, collection, updateCriteria).isNull()) ||
-                    // capped collections won't have an _id index
-                    (!indexCatalog->haveIdIndex(txn) &&
-                     Helpers::findOne(txn, collection, updateCriteria, false).isNull())) {
-                    string msg = str::stream() << "couldn't find doc: " << op.toString();
-                    error() << msg;
-                    return Status(ErrorCodes::OperationFailed, msg);
-                }
-
-                // Otherwise, it's present; zero objects were updated because of additional
-                // specifiers in the query for idempotence
-            } else {
-                // this could happen benignly on an oplog duplicate replay of an upsert
-                // (because we are idempotent),
-                // if an regular non-mod update fails the item is (presumably) missing.
-                if (!upsert) {
-                    string msg = str::stream() << "update of non-mod failed: " << op.toString();
-                    error() << msg;
-                    return Status(ErrorCodes::OperationFailed, msg);
+        if (applyUpdateById(txn, collection, o, updateCriteria)) {
+            idUpdatesApplied.increment();
+        } else {
+            const NamespaceString requestNs(ns);
+            UpdateRequest request(requestNs);
+
+            request.setQuery(updateCriteria);
+            request.setUpdates(o);
+            request.setUpsert(upsert);
+            UpdateLifecycleImpl updateLifecycle(true, requestNs);
+            request.setLifecycle(&updateLifecycle);
+
+            UpdateResult ur = update(txn, db, request, &debug);
+
+            if (ur.numMatched == 0 && ur.upserted.isEmpty()) {
+                if (ur.modifiers) {
+                    if (updateCriteria.nFields() == 1) {
+                        // was a simple { _id : ... } update criteria
+                        string msg = str::stream() << "failed to apply update: " << op.toString();
+                        error() << msg;
+                        return Status(ErrorCodes::OperationFailed, msg);
+                    }
+                    // Need to check to see if it isn't present so we can exit early with a
+                    // failure. Note that adds some overhead for this extra check in some cases,
+                    // such as an updateCriteria
+                    // of the form
+                    //   { _id:..., { x : {$size:...} }
+                    // thus this is not ideal.
+                    if (collection == NULL ||
+                        (indexCatalog->haveIdIndex(txn) &&
+                         Helpers::findById(txn, collection, updateCriteria).isNull()) ||
+                        // capped collections won't have an _id index
+                        (!indexCatalog->haveIdIndex(txn) &&
+                         Helpers::findOne(txn, collection, updateCriteria, false).isNull())) {
+                        string msg = str::stream() << "couldn't find doc: " << op.toString();
+                        error() << msg;
+                        return Status(ErrorCodes::OperationFailed, msg);
+                    }
+
+                    // Otherwise, it's present; zero objects were updated because of additional
+                    // specifiers in the query for idempotence
+                } else {
+                    // this could happen benignly on an oplog duplicate replay of an upsert
+                    // (because we are idempotent),
+                    // if an regular non-mod update fails the item is (presumably) missing.
+                    if (!upsert) {
+                        string msg = str::stream() << "update of non-mod failed: " << op.toString();
+                        error() << msg;
+                        return Status(ErrorCodes::OperationFailed, msg);
+                    }
                 }
             }
         }
@@ -942,7 +1094,12 @@ Status applyOperation_inlock(OperationContext* txn,
                 o.hasField("_id"));
 
         if (opType[1] == 0) {
-            deleteObjects(txn, collection, ns, o, PlanExecutor::YIELD_MANUAL, /*justOne*/ valueB);
+            if (applyDeleteById(txn, collection, o)) {
+                idDeletesApplied.increment();
+            } else {
+                deleteObjects(
+                    txn, collection, ns, o, PlanExecutor::YIELD_MANUAL, /*justOne*/ valueB);
+            }
         } else
             verify(opType[1] == 'b');  // "db" advertisement
         if (incrementOpsAppliedStats) {
@@ -59,6 +59,11 @@ protected:
         return false;
     }
 
+    TicketQueueClass getTicketQueueClass(const std::string& dbname,
+                                         const BSONObj& cmdObj) const override {
+        return TicketQueueClass::kInternal;
+    }
+
     Status checkAuthForCommand(ClientBasic* client,
                                const std::string& dbname,
                                const BSONObj& cmdObj) override;
@@ -1871,18 +1871,26 @@ bool ReplicationCoordinatorImpl::prepareOldReplSetUpdatePositionCommand(
 
 Status ReplicationCoordinatorImpl::processReplSetGetStatus(BSONObjBuilder* response) {
     Status result(ErrorCodes::InternalError, "didn't set status in prepareStatusResponse");
-    _scheduleWorkAndWaitForCompletion(
-        stdx::bind(&TopologyCoordinator::prepareStatusResponse,
-                   _topCoord.get(),
-                   stdx::placeholders::_1,
-                   TopologyCoordinator::ReplSetStatusArgs{
-                       _replExecutor.now(),
-                       static_cast<unsigned>(time(0) - serverGlobalParams.started),
-                       getMyLastAppliedOpTime(),
-                       getLastCommittedOpTime(),
-                       getCurrentCommittedSnapshotOpTime()},
-                   response,
-                   &result));
+    const TopologyCoordinator::ReplSetStatusArgs args{
+        _replExecutor.now(),
+        static_cast<unsigned>(time(0) - serverGlobalParams.started),
+        getMyLastAppliedOpTime(),
+        getLastCommittedOpTime(),
+        getCurrentCommittedSnapshotOpTime()};
+    _scheduleWorkAndWaitForCompletion([&](const ReplicationExecutor::CallbackArgs& cbData) {
+        _topCoord->prepareStatusResponse(cbData, args, response, &result);
+        if (!result.isOK()) {
+            return;
+        }
+
+        // The data replicator's cloners run on this executor, so their progress can be read here.
+        BSONObjBuilder initialSyncBuilder;
+        _dr.appendInitialSyncProgress(&initialSyncBuilder);
+        BSONObj initialSyncStatus = initialSyncBuilder.obj();
+        if (!initialSyncStatus.isEmpty()) {
+            response->append("initialSyncStatus", initialSyncStatus);
+        }
+    });
     return result;
 }
 
@@ -64,11 +64,13 @@
 #include "mongo/db/server_parameters.h"
 #include "mongo/db/service_context.h"
 #include "mongo/db/stats/timer_stats.h"
+#include "mongo/platform/unordered_map.h"
 #include "mongo/util/exit.h"
 #include "mongo/util/fail_point_service.h"
 #include "mongo/util/log.h"
 #include "mongo/util/mongoutils/str.h"
 #include "mongo/util/scopeguard.h"
+#include "mongo/util/timer.h"
 
 namespace mongo {
 
@@ -116,6 +118,33 @@ MONGO_FP_DECLARE(rsSyncApplyStop);
 static TimerStats applyBatchStats;
 static ServerStatusMetricField<TimerStats> displayOpBatchesApplied("repl.apply.batches",
                                                                    &applyBatchStats);
+
+// Number of batches which have been fetched and are waiting for the applier
+static Counter64 pipelineDepthGauge;
+static ServerStatusMetricField<Counter64> displayPipelineDepth("repl.apply.pipeline.depth",
+                                                               &pipelineDepthGauge);
+
+// Number and time of waits by the applier for the slowest writer at the end of each batch
+static TimerStats barrierWaitStats;
+static ServerStatusMetricField<TimerStats> displayBarrierWait("repl.apply.barrierWait",
+                                                              &barrierWaitStats);
+
+// Time each writer has spent idle while other writers were still applying their part of a batch.
+// Indexed by writer; replWriterThreadCount can be at most 256.
+static AtomicUInt64 writerIdleMicros[256];
+
+class WriterIdleSSM : public ServerStatusMetric {
+public:
+    WriterIdleSSM() : ServerStatusMetric("repl.apply.writerIdleMillis") {}
+    virtual void appendAtLeaf(BSONObjBuilder& b) const {
+        BSONArrayBuilder idle(b.subarrayStart(_leafName));
+        for (int i = 0; i < SyncTail::replWriterThreadCount; ++i) {
+            idle.append(static_cast<long long>(writerIdleMicros[i].load() / 1000));
+        }
+        idle.done();
+    }
+} writerIdleSSM;
+
 void initializePrefetchThread() {
     if (!ClientBasic::getCurrent()) {
         Client::initThreadIfNotAlready();
@@ -426,17 +455,23 @@ void prefetchOps(const std::deque<SyncTail::OplogEntry>& ops, OldThreadPool* pre
     prefetcherPool->join();
 }
 
-// Doles out all the work to the writer pool threads and waits for them to complete
+// Doles out all the work to the writer pool threads. The time each writer spends applying its ops
+// is stored in 'busyMicros', which must outlive the pool's next join().
 void applyOps(const std::vector<std::vector<SyncTail::OplogEntry>>& writerVectors,
               OldThreadPool* writerPool,
               SyncTail::MultiSyncApplyFunc func,
-              SyncTail* sync) {
+              SyncTail* sync,
+              std::vector<long long>* busyMicros) {
     TimerHolder timer(&applyBatchStats);
-    for (std::vector<std::vector<SyncTail::OplogEntry>>::const_iterator it = writerVectors.begin();
-         it != writerVectors.end();
-         ++it) {
-        if (!it->empty()) {
-            writerPool->schedule(func, stdx::cref(*it), sync);
+    for (size_t i = 0; i < writerVectors.size(); ++i) {
+        if (!writerVectors[i].empty()) {
+            const auto& ops = writerVectors[i];
+            long long* busy = &(*busyMicros)[i];
+            writerPool->schedule([&ops, busy, func, sync] {
+                Timer writerTimer;
+                func(ops, sync);
+                *busy = writerTimer.micros();
+            });
         }
     }
 }
@@ -482,8 +517,14 @@ void fillWriterVectors(OperationContext* txn,
 
     CachingCappedChecker isCapped;
 
+    // Ops which must be applied in order share a key, and all ops with the same key go to the same
+    // writer. Each new key goes to the writer with the fewest bytes of ops so far, so that writers
+    // reach the end of the batch at about the same time. Colliding keys only cost parallelism.
+    unordered_map<uint32_t, uint32_t> writerForKey;
+    std::vector<size_t> writerBytes(numWriters, 0);
+
     for (auto&& op : ops) {
-        StringMapTraits::HashedKey hashedNs(op.ns);
+        StringMapTraits::HashedKey hashedNs(op.ns, op.nsHash);
         uint32_t hash = hashedNs.hash();
 
         const char* opType = op.opType.rawData();
@@ -493,29 +534,25 @@ void fillWriterVectors(OperationContext* txn,
         // collections because the order of inserts is a guaranteed property, unlike for normal
         // collections.
         if (supportsDocLocking && isCrudOpType(opType) && !isCapped(txn, hashedNs)) {
-            BSONElement id;
-            switch (opType[0]) {
-                case 'u':
-                    id = op.o2.Obj()["_id"];
-                    break;
-                case 'd':
-                case 'i':
-                    id = op.o.Obj()["_id"];
-                    break;
-            }
+            MurmurHash3_x86_32(&op.idHash, sizeof(op.idHash), hash, &hash);
+        }
 
-            const size_t idHash = BSONElement::Hasher()(id);
-            MurmurHash3_x86_32(&idHash, sizeof(idHash), hash, &hash);
+        auto assigned = writerForKey.insert(std::make_pair(hash, 0));
+        if (assigned.second) {
+            assigned.first->second =
+                std::min_element(writerBytes.begin(), writerBytes.end()) - writerBytes.begin();
         }
+        const uint32_t writer = assigned.first->second;
+        writerBytes[writer] += op.raw.objsize();
 
         if (op.opType == "i" && isCapped(txn, hashedNs)) {
             // Mark capped collection ops before storing them to ensure we do not attempt to bulk
             // insert them.
             SyncTail::OplogEntry modifiedOp = op;
             modifiedOp.isForCappedCollection = true;
-            (*writerVectors)[hash % numWriters].push_back(modifiedOp);
+            (*writerVectors)[writer].push_back(modifiedOp);
         } else {
-            (*writerVectors)[hash % numWriters].push_back(op);
+            (*writerVectors)[writer].push_back(op);
         }
     }
 }
@@ -550,11 +587,22 @@ OpTime SyncTail::multiApply(OperationContext* txn, const OpQueue& ops) {
         fassertFailed(28527);
     }
 
-    applyOps(writerVectors, &_writerPool, _applyFunc, this);
+    Timer batchTimer;
+    std::vector<long long> busyMicros(writerVectors.size(), 0);
+    applyOps(writerVectors, &_writerPool, _applyFunc, this, &busyMicros);
 
     OpTime lastOpTime;
     {
-        ON_BLOCK_EXIT([&] { _writerPool.join(); });
+        ON_BLOCK_EXIT([&] {
+            Timer barrierTimer;
+            _writerPool.join();
+            barrierWaitStats.record(barrierTimer);
+
+            const long long batchMicros = batchTimer.micros();
+            for (size_t i = 0; i < busyMicros.size(); ++i) {
+                writerIdleMicros[i].fetchAndAdd(std::max(0LL, batchMicros - busyMicros[i]));
+            }
+        });
         std::vector<BSONObj> raws;
         raws.reserve(ops.getDeque().size());
         for (auto&& op : ops.getDeque()) {
@@ -635,6 +683,9 @@ public:
 
         OpQueue ops = std::move(_ops);
         _ops = {};
+        if (!ops.empty()) {
+            pipelineDepthGauge.decrement();
+        }
         _cv.notify_all();
 
         return ops;
@@ -696,6 +747,11 @@ private:
                     return;
                 _cv.wait(lk);
             }
+            // Idle and interrupted batches are handed off empty, and don't count towards the
+            // depth, as getNextBatch() doesn't count them when taking them.
+            if (!ops.empty()) {
+                pipelineDepthGauge.increment();
+            }
             _ops = std::move(ops);
             _cv.notify_all();
         }
@@ -830,6 +886,14 @@ SyncTail::OplogEntry::OplogEntry(const BSONObj& rawInput) : raw(rawInput.getOwne
             o = elem;
         }
     }
+
+    nsHash = StringMapTraits::HashedKey(ns).hash();
+    if (isCrudOpType(opType.rawData())) {
+        const BSONElement& doc = opType[0] == 'u' ? o2 : o;
+        if (doc.type() == Object) {
+            idHash = BSONElement::Hasher()(doc.Obj()["_id"]);
+        }
+    }
 }
 
 // Copies ops out of the bgsync queue into the deque passed in as a parameter.
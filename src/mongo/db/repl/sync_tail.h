@@ -66,6 +66,11 @@ public:
         // This member is not parsed from the BSON and is instead populated by fillWriterVectors.
         bool isForCappedCollection = false;
 
+        // Hashes of 'ns' and, for CRUD ops, of the document's _id. These are computed as the op is
+        // added to a batch so that the applier only has to assign ops to writers.
+        uint32_t nsHash = 0;
+        size_t idHash = 0;
+
         BSONObj raw;  // Owned.
 
         StringData ns = "";
@@ -696,7 +696,8 @@ void CollectionMetadata::fillRanges() {
         return;
 
     // Load the chunk information, coallesceing their ranges.  The version for this shard
-    // would be the highest version for any of the chunks.
+    // would be the highest version for any of the chunks. The ranges are found in order, so
+    // each one is appended without comparing keys.
     RangeMap::const_iterator it = _chunksMap.begin();
     BSONObj min, max;
     while (it != _chunksMap.end()) {
@@ -715,14 +716,14 @@ void CollectionMetadata::fillRanges() {
             continue;
         }
 
-        _rangesMap.insert(make_pair(min, max));
+        _rangesMap.emplace_hint(_rangesMap.end(), min, max);
 
         min = currMin;
         max = currMax;
     }
     dassert(!min.isEmpty());
 
-    _rangesMap.insert(make_pair(min, max));
+    _rangesMap.emplace_hint(_rangesMap.end(), min, max);
 }
 
 void CollectionMetadata::fillKeyPatternFields() {
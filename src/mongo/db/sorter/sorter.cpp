@@ -59,6 +59,7 @@
 #include "mongo/db/storage/wiredtiger/wiredtiger_customization_hooks.h"
 #include "mongo/platform/atomic_word.h"
 #include "mongo/s/mongos_options.h"
+#include "mongo/stdx/thread.h"
 #include "mongo/util/assert_util.h"
 #include "mongo/util/bufreader.h"
 #include "mongo/util/mongoutils/str.h"
@@ -169,23 +170,13 @@ public:
                       typename Value::SorterDeserializeSettings> Settings;
     typedef std::pair<Key, Value> Data;
 
+    // The file is only opened when it is first read, and closed once it has been read to the end,
+    // so that callers which hold many runs but read them one after the other do not keep a file
+    // descriptor open for each of them.
     FileIterator(const std::string& fileName,
                  const Settings& settings,
                  std::shared_ptr<FileDeleter> fileDeleter)
-        : _settings(settings),
-          _done(false),
-          _fileName(fileName),
-          _fileDeleter(fileDeleter),
-          _file(_fileName.c_str(), std::ios::in | std::ios::binary) {
-        massert(16814,
-                str::stream() << "error opening file \"" << _fileName
-                              << "\": " << myErrnoWithDescription(),
-                _file.good());
-
-        massert(16815,
-                str::stream() << "unexpected empty file: " << _fileName,
-                boost::filesystem::file_size(_fileName) != 0);
-    }
+        : _settings(settings), _done(false), _fileName(fileName), _fileDeleter(fileDeleter) {}
 
     bool more() {
         if (!_done)
@@ -212,7 +203,22 @@ private:
             fill();
     }
 
+    void open() {
+        _file.open(_fileName.c_str(), std::ios::in | std::ios::binary);
+        massert(16814,
+                str::stream() << "error opening file \"" << _fileName
+                              << "\": " << myErrnoWithDescription(),
+                _file.good());
+
+        massert(16815,
+                str::stream() << "unexpected empty file: " << _fileName,
+                boost::filesystem::file_size(_fileName) != 0);
+    }
+
     void fill() {
+        if (!_file.is_open())
+            open();
+
         int32_t rawSize;
         read(&rawSize, sizeof(rawSize));
         if (_done)
@@ -270,6 +276,7 @@ private:
         if (!_file.good()) {
             if (_file.eof()) {
                 _done = true;
+                _file.close();
                 return;
             }
 
@@ -289,7 +296,15 @@ private:
     std::ifstream _file;
 };
 
-/** Merge-sorts results from 0 or more FileIterators */
+/**
+ * Merge-sorts results from 0 or more FileIterators.
+ *
+ * The streams are kept in a loser tree (tournament tree): each internal node holds the stream that
+ * lost the match played there, and _winner is the overall winner. Replacing the winner's value
+ * only replays the matches on the path from its leaf to the root, which costs one comparison per
+ * level rather than the two per level a binary heap's sift-down needs. This matters when merging
+ * the many runs of a large external sort.
+ */
 template <typename Key, typename Value, typename Comparator>
 class MergeIterator : public SortIteratorInterface<Key, Value> {
 public:
@@ -303,32 +318,31 @@ public:
         : _opts(opts),
           _remaining(opts.limit ? opts.limit : std::numeric_limits<unsigned long long>::max()),
           _first(true),
-          _greater(comp) {
+          _comp(comp) {
         for (size_t i = 0; i < iters.size(); i++) {
             if (iters[i]->more()) {
-                _heap.push_back(std::make_shared<Stream>(i, iters[i]->next(), iters[i]));
+                _streams.push_back(std::make_shared<Stream>(iters[i]->next(), iters[i]));
             }
         }
 
-        if (_heap.empty()) {
+        if (_streams.empty()) {
             _remaining = 0;
             return;
         }
 
-        std::make_heap(_heap.begin(), _heap.end(), _greater);
-        std::pop_heap(_heap.begin(), _heap.end(), _greater);
-        _current = _heap.back();
-        _heap.pop_back();
+        _numActive = _streams.size();
+        _tree.resize(_streams.size());
+        _winner = buildTree(1);
     }
 
     bool more() {
-        if (_remaining > 0 && (_first || !_heap.empty() || _current->more()))
+        if (_remaining > 0 && (_first || _numActive > 1 || _streams[_winner]->more()))
             return true;
 
         // We are done so clean up resources.
         // Can't do this in next() due to lifetime guarantees of unowned Data.
-        _heap.clear();
-        _current.reset();
+        _streams.clear();
+        _tree.clear();
         _remaining = 0;
 
         return false;
@@ -341,30 +355,32 @@ public:
 
         if (_first) {
             _first = false;
-            return _current->current();
+            return _streams[_winner]->current();
         }
 
-        if (!_current->advance()) {
-            verify(!_heap.empty());
+        if (!_streams[_winner]->advance()) {
+            verify(_numActive > 1);
+            _numActive--;
+        }
 
-            std::pop_heap(_heap.begin(), _heap.end(), _greater);
-            _current = _heap.back();
-            _heap.pop_back();
-        } else if (!_heap.empty() && _greater(_current, _heap.front())) {
-            std::pop_heap(_heap.begin(), _heap.end(), _greater);
-            std::swap(_current, _heap.back());
-            std::push_heap(_heap.begin(), _heap.end(), _greater);
+        // Replay the matches from the winner's leaf up to the root.
+        size_t winner = _winner;
+        for (size_t node = (winner + _streams.size()) / 2; node > 0; node /= 2) {
+            if (beats(_tree[node], winner)) {
+                std::swap(_tree[node], winner);
+            }
         }
+        _winner = winner;
 
-        return _current->current();
+        return _streams[_winner]->current();
     }
 
 
 private:
     class Stream {  // Data + Iterator
     public:
-        Stream(size_t fileNum, const Data& first, std::shared_ptr<Input> rest)
-            : fileNum(fileNum), _current(first), _rest(rest) {}
+        Stream(const Data& first, std::shared_ptr<Input> rest)
+            : _current(first), _rest(rest), _exhausted(false) {}
 
         const Data& current() const {
             return _current;
@@ -373,44 +389,68 @@ private:
             return _rest->more();
         }
         bool advance() {
-            if (!_rest->more())
+            if (!_rest->more()) {
+                _exhausted = true;
                 return false;
+            }
 
             _current = _rest->next();
             return true;
         }
-
-        const size_t fileNum;
+        bool exhausted() const {
+            return _exhausted;
+        }
 
     private:
         Data _current;
         std::shared_ptr<Input> _rest;
+        bool _exhausted;
     };
 
-    class STLComparator {  // uses greater rather than less-than to maintain a MinHeap
-    public:
-        explicit STLComparator(const Comparator& comp) : _comp(comp) {}
-        bool operator()(unowned_ptr<const Stream> lhs, unowned_ptr<const Stream> rhs) const {
-            // first compare data
-            dassertCompIsSane(_comp, lhs->current(), rhs->current());
-            int ret = _comp(lhs->current(), rhs->current());
-            if (ret)
-                return ret > 0;
-
-            // then compare fileNums to ensure stability
-            return lhs->fileNum > rhs->fileNum;
-        }
+    /**
+     * Returns true if stream 'lhs' should be returned before stream 'rhs'. Exhausted streams lose
+     * to all others, and ties go to the stream that was passed in first to keep the merge stable.
+     */
+    bool beats(size_t lhs, size_t rhs) const {
+        if (_streams[lhs]->exhausted())
+            return false;
+        if (_streams[rhs]->exhausted())
+            return true;
 
-    private:
-        const Comparator _comp;
-    };
+        dassertCompIsSane(_comp, _streams[lhs]->current(), _streams[rhs]->current());
+        int ret = _comp(_streams[lhs]->current(), _streams[rhs]->current());
+        if (ret)
+            return ret < 0;
+
+        return lhs < rhs;
+    }
+
+    /**
+     * Plays the matches below 'node' and returns the winner. The leaves, one per stream, are
+     * nodes [_streams.size(), 2 * _streams.size()), and node n's children are 2n and 2n + 1.
+     */
+    size_t buildTree(size_t node) {
+        if (node >= _streams.size())
+            return node - _streams.size();
+
+        const size_t left = buildTree(2 * node);
+        const size_t right = buildTree(2 * node + 1);
+        if (beats(right, left)) {
+            _tree[node] = left;
+            return right;
+        }
+        _tree[node] = right;
+        return left;
+    }
 
     SortOptions _opts;
     unsigned long long _remaining;
     bool _first;
-    std::shared_ptr<Stream> _current;
-    std::vector<std::shared_ptr<Stream>> _heap;  // MinHeap
-    STLComparator _greater;                      // named so calls make sense
+    const Comparator _comp;
+    std::vector<std::shared_ptr<Stream>> _streams;
+    std::vector<size_t> _tree;  // The loser of the match at each internal node. _tree[0] is unused.
+    size_t _winner = 0;         // The stream whose value was last returned.
+    size_t _numActive = 0;      // Number of streams which are not exhausted.
 };
 
 template <typename Key, typename Value, typename Comparator>
@@ -424,10 +464,18 @@ public:
     NoLimitSorter(const SortOptions& opts,
                   const Comparator& comp,
                   const Settings& settings = Settings())
-        : _comp(comp), _settings(settings), _opts(opts), _memUsed(0) {
+        : _comp(comp),
+          _settings(settings),
+          _opts(opts),
+          _memUsed(0) {
         verify(_opts.limit == 0);
     }
 
+    ~NoLimitSorter() {
+        if (_spillThread.joinable())
+            _spillThread.join();
+    }
+
     void add(const Key& key, const Value& val) {
         _data.push_back(std::make_pair(key, val));
 
@@ -439,21 +487,22 @@ public:
     }
 
     Iterator* done() {
-        if (_iters.empty()) {
-            sort();
+        if (_iters.empty() && !_spillThread.joinable()) {
+            sort(&_data);
             return new InMemIterator<Key, Value>(_data);
         }
 
         spill();
+        waitForBackgroundSpill();
         return Iterator::merge(_iters, _opts, _comp);
     }
 
     // TEMP these are here for compatibility. Will be replaced with a general stats API
     int numFiles() const {
-        return _iters.size();
+        return _iters.size() + (_spillThread.joinable() ? 1 : 0);
     }
     size_t memUsed() const {
-        return _memUsed;
+        return _memUsed + _spillingMemUsed;
     }
 
 private:
@@ -469,13 +518,42 @@ private:
         const Comparator& _comp;
     };
 
-    void sort() {
+    void sort(std::deque<Data>* data) const {
         STLComparator less(_comp);
-        std::stable_sort(_data.begin(), _data.end(), less);
+        std::stable_sort(data->begin(), data->end(), less);
 
         // Does 2x more compares than stable_sort
         // TODO test on windows
-        // std::sort(_data.begin(), _data.end(), comp);
+        // std::sort(data->begin(), data->end(), comp);
+    }
+
+    /**
+     * Sorts 'data' and writes it to a new file, leaving 'data' empty.
+     */
+    std::shared_ptr<Iterator> sortAndWriteRun(std::deque<Data>* data) const {
+        sort(data);
+
+        SortedFileWriter<Key, Value> writer(_opts, _settings);
+        for (; !data->empty(); data->pop_front()) {
+            writer.addAlreadySorted(data->front().first, data->front().second);
+        }
+
+        return std::shared_ptr<Iterator>(writer.done());
+    }
+
+    /**
+     * Waits for the run being spilled on _spillThread, if any, and adds it to _iters.
+     */
+    void waitForBackgroundSpill() {
+        if (!_spillThread.joinable())
+            return;
+
+        _spillThread.join();
+        _spillingData.clear();
+        _spillingMemUsed = 0;
+        uassertStatusOK(_spillStatus);
+
+        _iters.push_back(std::move(_spilledRun));
     }
 
     void spill() {
@@ -494,24 +572,45 @@ private:
                           << " Pass allowDiskUse:true to opt in.");
         }
 
-        sort();
-
-        SortedFileWriter<Key, Value> writer(_opts, _settings);
-        for (; !_data.empty(); _data.pop_front()) {
-            writer.addAlreadySorted(_data.front().first, _data.front().second);
+        if (!_opts.spillInBackground) {
+            _iters.push_back(sortAndWriteRun(&_data));
+            _memUsed = 0;
+            return;
         }
 
-        _iters.push_back(std::shared_ptr<Iterator>(writer.done()));
+        // Runs must be added to _iters in order to keep the sort stable, so only one may be
+        // spilling at a time.
+        waitForBackgroundSpill();
 
+        _spillingData.swap(_data);
+        _spillingMemUsed = _memUsed;
         _memUsed = 0;
+        _spillStatus = Status::OK();
+        _spillThread = stdx::thread([this] {
+            try {
+                _spilledRun = sortAndWriteRun(&_spillingData);
+            } catch (const DBException& ex) {
+                _spillStatus = ex.toStatus();
+            } catch (const std::exception& ex) {
+                _spillStatus = Status(ErrorCodes::InternalError, ex.what());
+            }
+        });
     }
 
     const Comparator _comp;
     const Settings _settings;
     SortOptions _opts;
-    size_t _memUsed;
+    size_t _memUsed;  // the "current" data only, not the run being spilled in the background
     std::deque<Data> _data;                         // the "current" data
     std::vector<std::shared_ptr<Iterator>> _iters;  // data that has already been spilled
+
+    // Only used with SortOptions::spillInBackground. While _spillThread is joinable, it owns
+    // _spillingData, _spilledRun and _spillStatus.
+    stdx::thread _spillThread;
+    std::deque<Data> _spillingData;
+    size_t _spillingMemUsed = 0;
+    std::shared_ptr<Iterator> _spilledRun;
+    Status _spillStatus = Status::OK();
 };
 
 template <typename Key, typename Value, typename Comparator>
@@ -97,8 +97,17 @@ struct SortOptions {
     bool extSortAllowed;         /// If false, uassert if more mem needed than allowed.
     std::string tempDir;         /// Directory to directly place files in.
                                  /// Must be explicitly set if extSortAllowed is true.
-
-    SortOptions() : limit(0), maxMemoryUsageBytes(64 * 1024 * 1024), extSortAllowed(false) {}
+    bool spillInBackground;      /// If true, sort and write each spilled run on a separate
+                                 /// thread while the next run accumulates. Only used without
+                                 /// a limit. Key, Value and Comparator must be thread-safe.
+                                 /// Runs still spill at maxMemoryUsageBytes, so up to twice
+                                 /// that is in use while a run is being written.
+
+    SortOptions()
+        : limit(0),
+          maxMemoryUsageBytes(64 * 1024 * 1024),
+          extSortAllowed(false),
+          spillInBackground(false) {}
 
     /// Fluent API to support expressions like SortOptions().Limit(1000).ExtSortAllowed(true)
 
@@ -121,6 +130,11 @@ struct SortOptions {
         tempDir = newTempDir;
         return *this;
     }
+
+    SortOptions& SpillInBackground(bool newSpillInBackground = true) {
+        spillInBackground = newSpillInBackground;
+        return *this;
+    }
 };
 
 /// This is the output from the sorting framework
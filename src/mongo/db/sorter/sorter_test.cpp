@@ -331,6 +331,27 @@ public:
                 mergeIterators(iterators, ASC, SortOptions().Limit(10)),
                 make_shared<LimitIterator>(10, make_shared<IntIterator>(0, 20, 1)));
         }
+        {  // test many inputs with equal keys, which must be returned in input order
+            typedef sorter::InMemIterator<IntWrapper, IntWrapper> IWInMemIterator;
+            const int kNumInputs = 37;
+            const int kNumKeys = 10;
+            std::vector<std::shared_ptr<IWIterator>> vec;
+            std::vector<IWPair> expected;
+            for (int i = 0; i < kNumInputs; i++) {
+                std::vector<IWPair> input;
+                for (int key = 0; key < kNumKeys; key++)
+                    input.push_back(IWPair(key, i));
+                vec.push_back(std::make_shared<IWInMemIterator>(input));
+            }
+            for (int key = 0; key < kNumKeys; key++) {
+                for (int i = 0; i < kNumInputs; i++)
+                    expected.push_back(IWPair(key, i));
+            }
+
+            std::shared_ptr<IWIterator> mergeIter(
+                IWIterator::merge(vec, SortOptions(), IWComparator()));
+            ASSERT_ITERATORS_EQUIVALENT(mergeIter, std::make_shared<IWInMemIterator>(expected));
+        }
     }
 };
 
@@ -520,6 +541,22 @@ public:
     std::unique_ptr<int[]> _array;
 };
 
+template <bool Random = true>
+class LotsOfDataSpillInBackground : public LotsOfDataLittleMemory<Random> {
+    typedef LotsOfDataLittleMemory<Random> Parent;
+    SortOptions adjustSortOptions(SortOptions opts) {
+        return Parent::adjustSortOptions(opts).SpillInBackground();
+    }
+
+    void addData(unowned_ptr<IWSorter> sorter) {
+        Parent::addData(sorter);
+
+        // Spilling in the background does not make the runs any smaller.
+        const size_t runs = (Parent::NUM_ITEMS * sizeof(IWPair)) / Parent::MEM_LIMIT;
+        ASSERT_GREATER_THAN_OR_EQUALS(static_cast<size_t>(sorter->numFiles()), runs);
+        ASSERT_LESS_THAN_OR_EQUALS(static_cast<size_t>(sorter->numFiles()), runs + 1);
+    }
+};
 
 template <long long Limit, bool Random = true>
 class LotsOfDataWithLimit : public LotsOfDataLittleMemory<Random> {
@@ -563,6 +600,8 @@ public:
         add<SorterTests::Dupes>();
         add<SorterTests::LotsOfDataLittleMemory</*random=*/false>>();
         add<SorterTests::LotsOfDataLittleMemory</*random=*/true>>();
+        add<SorterTests::LotsOfDataSpillInBackground</*random=*/false>>();
+        add<SorterTests::LotsOfDataSpillInBackground</*random=*/true>>();
         add<SorterTests::LotsOfDataWithLimit<1, /*random=*/false>>();     // limit=1 is special case
         add<SorterTests::LotsOfDataWithLimit<1, /*random=*/true>>();      // limit=1 is special case
         add<SorterTests::LotsOfDataWithLimit<100, /*random=*/false>>();   // fits in mem
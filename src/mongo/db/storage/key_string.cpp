@@ -39,6 +39,7 @@
 #include "mongo/base/data_view.h"
 #include "mongo/platform/bits.h"
 #include "mongo/platform/strnlen.h"
+#include "mongo/util/fail_point_service.h"
 #include "mongo/util/hex.h"
 #include "mongo/util/log.h"
 
@@ -46,6 +47,9 @@ namespace mongo {
 
 using std::string;
 
+// Forces every value through the generic per-type encoder. Used to compare the encoders.
+MONGO_FP_DECLARE(keyStringSkipFastPath);
+
 namespace {
 typedef KeyString::TypeBits TypeBits;
 
@@ -187,6 +191,16 @@ void memcpy_flipBits(void* dst, const void* src, size_t bytes) {
     const char* input = static_cast<const char*>(src);
     char* output = static_cast<char*>(dst);
     const char* const end = input + bytes;
+
+    // Flip a word at a time, then the remaining bytes. 'dst' and 'src' may be the same.
+    while (end - input >= static_cast<ptrdiff_t>(sizeof(uint64_t))) {
+        uint64_t word;
+        memcpy(&word, input, sizeof(word));
+        word = ~word;
+        memcpy(output, &word, sizeof(word));
+        input += sizeof(word);
+        output += sizeof(word);
+    }
     while (input != end) {
         *output++ = ~(*input++);
     }
@@ -291,13 +305,17 @@ void KeyString::resetToKey(const BSONObj& obj, Ordering ord, Discriminator discr
 void KeyString::_appendAllElementsForIndexing(const BSONObj& obj,
                                               Ordering ord,
                                               Discriminator discriminator) {
+    const bool useFastPath = !MONGO_FAIL_POINT(keyStringSkipFastPath);
+
     int elemCount = 0;
     BSONObjIterator it(obj);
     while (auto elem = it.next()) {
         const int elemIdx = elemCount++;
         const bool invert = (ord.get(elemIdx) == -1);
 
-        _appendBsonValue(elem, invert, NULL);
+        if (!useFastPath || !_appendCommonValue(elem, invert)) {
+            _appendBsonValue(elem, invert, NULL);
+        }
 
         dassert(elem.fieldNameSize() < 3);  // fieldNameSize includes the NUL
 
@@ -628,6 +646,51 @@ void KeyString::_appendBsonValue(const BSONElement& elem, bool invert, const Str
 }
 
 
+bool KeyString::_appendCommonValue(const BSONElement& elem, bool invert) {
+    // Each case produces exactly the bytes and TypeBits that _appendBsonValue() would, but reserves
+    // the space for the whole value at once rather than once per byte run.
+    switch (elem.type()) {
+        case NumberInt:
+            _appendNumberInt(elem._numberInt(), invert);
+            return true;
+
+        case NumberLong:
+            _appendNumberLong(elem._numberLong(), invert);
+            return true;
+
+        case jstOID: {
+            char* const out = _buffer.skip(1 + OID::kOIDSize);
+            out[0] = CType::kOID;
+            memcpy(out + 1, elem.value(), OID::kOIDSize);
+            if (invert) {
+                memcpy_flipBits(out, out, 1 + OID::kOIDSize);
+            }
+            return true;
+        }
+
+        case String: {
+            const StringData str = elem.valueStringData();
+            if (memchr(str.rawData(), 0, str.size())) {
+                // Embedded NULs must be escaped.
+                return false;
+            }
+
+            _typeBits.appendString();
+            char* const out = _buffer.skip(str.size() + 2);
+            out[0] = CType::kStringLike;
+            memcpy(out + 1, str.rawData(), str.size());
+            out[str.size() + 1] = 0;
+            if (invert) {
+                memcpy_flipBits(out, out, str.size() + 2);
+            }
+            return true;
+        }
+
+        default:
+            return false;
+    }
+}
+
 /// -- lowest level
 
 void KeyString::_appendStringLike(StringData str, bool invert) {
@@ -715,16 +778,21 @@ void KeyString::_appendPreshiftedIntegerPortion(uint64_t value, bool isNegative,
 
     const size_t bytesNeeded = (64 - countLeadingZeros64(value) + 7) / 8;
 
-    // Append the low bytes of value in big endian order.
+    // Append the ctype byte followed by the low bytes of value in big endian order.
     value = endian::nativeToBig(value);
     const void* firstUsedByte = reinterpret_cast<const char*>((&value) + 1) - bytesNeeded;
 
-    if (isNegative) {
-        _append(uint8_t(CType::kNumericNegative1ByteInt - (bytesNeeded - 1)), invert);
-        _appendBytes(firstUsedByte, bytesNeeded, !invert);
+    char* const out = _buffer.skip(1 + bytesNeeded);
+    out[0] = isNegative ? uint8_t(CType::kNumericNegative1ByteInt - (bytesNeeded - 1))
+                        : uint8_t(CType::kNumericPositive1ByteInt + (bytesNeeded - 1));
+    if (invert) {
+        out[0] = ~out[0];
+    }
+
+    if (isNegative != invert) {
+        memcpy_flipBits(out + 1, firstUsedByte, bytesNeeded);
     } else {
-        _append(uint8_t(CType::kNumericPositive1ByteInt + (bytesNeeded - 1)), invert);
-        _appendBytes(firstUsedByte, bytesNeeded, invert);
+        memcpy(out + 1, firstUsedByte, bytesNeeded);
     }
 }
 
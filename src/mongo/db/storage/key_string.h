@@ -307,6 +307,13 @@ private:
      */
     void _appendBsonValue(const BSONElement& elem, bool invert, const StringData* name);
 
+    /**
+     * Appends 'elem' if it is one of the types most common in index keys (ints, longs, ObjectIds
+     * and strings without embedded NULs) and returns true. Returns false, having appended nothing,
+     * for any other value.
+     */
+    bool _appendCommonValue(const BSONElement& elem, bool invert);
+
     void _appendStringLike(StringData str, bool invert);
     void _appendBson(const BSONObj& obj, bool invert);
     void _appendSmallDouble(double value, bool invert);
@@ -36,6 +36,7 @@
 #include "mongo/config.h"
 #include "mongo/db/storage/key_string.h"
 #include "mongo/unittest/unittest.h"
+#include "mongo/util/fail_point_service.h"
 #include "mongo/util/hex.h"
 #include "mongo/util/log.h"
 #include "mongo/base/owned_pointer_vector.h"
@@ -623,6 +624,41 @@ TEST(KeyStringTest, AllPermCompare) {
     testPermutation(elements, orderings, false);
 }
 
+TEST(KeyStringTest, FastPathMatchesGenericEncoding) {
+    std::vector<BSONObj> keys = getInterestingElements();
+    keys.push_back(BSON("" << OID::gen()));
+    keys.push_back(BSON("" << std::string("a\0b\0", 4)));
+    keys.push_back(BSON("" << (1 << 20) << ""
+                           << "abc"
+                           << "" << -12345678901LL << "" << OID::gen()));
+
+    FailPoint* skipFastPath =
+        getGlobalFailPointRegistry()->getFailPoint("keyStringSkipFastPath");
+    ASSERT(skipFastPath);
+
+    const Ordering orderings[] = {
+        ALL_ASCENDING, Ordering::make(BSON("a" << -1 << "b" << 1 << "c" << -1 << "d" << 1))};
+
+    for (auto&& ord : orderings) {
+        for (auto&& key : keys) {
+            const KeyString fast(key, ord, RecordId(7));
+
+            skipFastPath->setMode(FailPoint::alwaysOn);
+            const KeyString generic(key, ord, RecordId(7));
+            skipFastPath->setMode(FailPoint::off);
+
+            ASSERT_EQ(fast, generic) << key;
+            ASSERT_EQ(fast.getTypeBits().getSize(), generic.getTypeBits().getSize()) << key;
+            ASSERT_EQ(0,
+                      memcmp(fast.getTypeBits().getBuffer(),
+                             generic.getTypeBits().getBuffer(),
+                             fast.getTypeBits().getSize()))
+                << key;
+            ASSERT_EQ(key, toBson(fast, ord)) << key;
+        }
+    }
+}
+
 TEST(KeyStringTest, AllPerm2Compare) {
 // This test can take over a minute without optimizations. Re-enable if you need to debug it.
 #if !defined(MONGO_CONFIG_OPTIMIZED_BUILD)
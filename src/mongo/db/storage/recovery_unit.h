@@ -36,6 +36,7 @@
 #include "mongo/base/status.h"
 #include "mongo/db/storage/snapshot.h"
 #include "mongo/db/storage/snapshot_name.h"
+#include "mongo/platform/atomic_word.h"
 
 namespace mongo {
 
@@ -253,8 +254,36 @@ public:
      */
     virtual void setRollbackWritesDisabled() = 0;
 
+    //
+    // Resource accounting. Storage engines charge the bytes of record data they read and write
+    // on behalf of the operation that owns this RecoveryUnit; CurOp reports the totals.
+    //
+
+    // Only the thread running the operation charges bytes, so these do not need an atomic
+    // read-modify-write. The counters are atomic because currentOp reads them from another thread.
+
+    void recordBytesRead(long long bytes) {
+        _bytesRead.store(_bytesRead.load() + bytes);
+    }
+
+    void recordBytesWritten(long long bytes) {
+        _bytesWritten.store(_bytesWritten.load() + bytes);
+    }
+
+    long long getBytesRead() const {
+        return _bytesRead.load();
+    }
+
+    long long getBytesWritten() const {
+        return _bytesWritten.load();
+    }
+
 protected:
     RecoveryUnit() {}
+
+private:
+    AtomicInt64 _bytesRead{0};
+    AtomicInt64 _bytesWritten{0};
 };
 
 }  // namespace mongo
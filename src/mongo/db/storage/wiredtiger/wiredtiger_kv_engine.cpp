@@ -59,6 +59,7 @@
 #include "mongo/db/storage/wiredtiger/wiredtiger_recovery_unit.h"
 #include "mongo/db/storage/wiredtiger/wiredtiger_session_cache.h"
 #include "mongo/db/storage/wiredtiger/wiredtiger_size_storer.h"
+#include "mongo/db/storage/wiredtiger/wiredtiger_ticket_controller.h"
 #include "mongo/db/storage/wiredtiger/wiredtiger_util.h"
 #include "mongo/db/storage/storage_options.h"
 #include "mongo/util/log.h"
@@ -265,6 +266,10 @@ WiredTigerKVEngine::WiredTigerKVEngine(const std::string& canonicalName,
     }
 
     Locker::setGlobalThrottling(&openReadTransaction, &openWriteTransaction);
+
+    _ticketController = stdx::make_unique<WiredTigerTicketController>(
+        _conn, &openReadTransaction, &openWriteTransaction);
+    _ticketController->go();
 }
 
 
@@ -283,6 +288,10 @@ void WiredTigerKVEngine::appendGlobalStats(BSONObjBuilder& b) {
         bbb.append("out", openWriteTransaction.used());
         bbb.append("available", openWriteTransaction.available());
         bbb.append("totalTickets", openWriteTransaction.outof());
+        {
+            BSONObjBuilder queues(bbb.subobjStart("queues"));
+            openWriteTransaction.appendQueueStats(&queues);
+        }
         bbb.done();
     }
     {
@@ -290,8 +299,15 @@ void WiredTigerKVEngine::appendGlobalStats(BSONObjBuilder& b) {
         bbb.append("out", openReadTransaction.used());
         bbb.append("available", openReadTransaction.available());
         bbb.append("totalTickets", openReadTransaction.outof());
+        {
+            BSONObjBuilder queues(bbb.subobjStart("queues"));
+            openReadTransaction.appendQueueStats(&queues);
+        }
         bbb.done();
     }
+    if (_ticketController) {
+        _ticketController->appendStats(&bb);
+    }
     bb.done();
 }
 
@@ -303,6 +319,8 @@ void WiredTigerKVEngine::cleanShutdown() {
         _sizeStorer.reset(NULL);
         if (_journalFlusher)
             _journalFlusher->shutdown();
+        if (_ticketController)
+            _ticketController->shutdown();
         _sessionCache->shuttingDown();
 
 // We want WiredTiger to leak memory for faster shutdown except when we are running tools to
@@ -47,6 +47,7 @@ namespace mongo {
 class JournalListener;
 class WiredTigerSessionCache;
 class WiredTigerSizeStorer;
+class WiredTigerTicketController;
 
 class WiredTigerKVEngine final : public KVEngine {
 public:
@@ -145,7 +146,7 @@ public:
      */
     static bool initRsOplogBackgroundThread(StringData ns);
 
-    static void appendGlobalStats(BSONObjBuilder& b);
+    void appendGlobalStats(BSONObjBuilder& b);
 
 private:
     class WiredTigerJournalFlusher;
@@ -167,6 +168,7 @@ private:
     bool _durable;
     bool _ephemeral;
     std::unique_ptr<WiredTigerJournalFlusher> _journalFlusher;
+    std::unique_ptr<WiredTigerTicketController> _ticketController;
 
     std::string _rsOptions;
     std::string _indexOptions;
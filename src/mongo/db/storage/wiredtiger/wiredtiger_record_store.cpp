@@ -509,6 +509,7 @@ public:
 
         WT_ITEM value;
         invariantWTOK(c->get_value(c, &value));
+        _txn->recoveryUnit()->recordBytesRead(value.size);
 
         _lastReturnedId = id;
         return {{id, {static_cast<const char*>(value.data), static_cast<int>(value.size)}}};
@@ -528,6 +529,7 @@ public:
 
         WT_ITEM value;
         invariantWTOK(c->get_value(c, &value));
+        _txn->recoveryUnit()->recordBytesRead(value.size);
 
         _lastReturnedId = id;
         _eof = false;
@@ -679,6 +681,7 @@ public:
 
         WT_ITEM value;
         invariantWTOK(_cursor->get_value(_cursor, &value));
+        _txn->recoveryUnit()->recordBytesRead(value.size);
 
         return {{id, {static_cast<const char*>(value.data), static_cast<int>(value.size)}}};
     }
@@ -952,7 +955,9 @@ RecordData WiredTigerRecordStore::dataFor(OperationContext* txn, const RecordId&
     int ret = WT_OP_CHECK(c->search(c));
     massert(28556, "Didn't find RecordId in WiredTigerRecordStore", ret != WT_NOTFOUND);
     invariantWTOK(ret);
-    return _getData(curwrap);
+    RecordData data = _getData(curwrap);
+    txn->recoveryUnit()->recordBytesRead(data.size());
+    return data;
 }
 
 bool WiredTigerRecordStore::findRecord(OperationContext* txn,
@@ -968,6 +973,7 @@ bool WiredTigerRecordStore::findRecord(OperationContext* txn,
     }
     invariantWTOK(ret);
     *out = _getData(curwrap);
+    txn->recoveryUnit()->recordBytesRead(out->size());
     return true;
 }
 
@@ -1307,6 +1313,7 @@ Status WiredTigerRecordStore::insertRecords(OperationContext* txn,
 
     _changeNumRecords(txn, records->size());
     _increaseDataSize(txn, totalLength);
+    txn->recoveryUnit()->recordBytesWritten(totalLength);
 
     if (_oplogStones) {
         _oplogStones->updateCurrentStoneAfterInsertOnCommit(
@@ -1392,6 +1399,8 @@ StatusWith<RecordId> WiredTigerRecordStore::updateRecord(OperationContext* txn,
     invariantWTOK(ret);
 
     _increaseDataSize(txn, len - old_length);
+    txn->recoveryUnit()->recordBytesRead(old_length);
+    txn->recoveryUnit()->recordBytesWritten(len);
     if (!_oplogStones) {
         cappedDeleteAsNeeded(txn, id);
     }
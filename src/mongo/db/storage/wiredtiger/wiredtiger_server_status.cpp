@@ -74,7 +74,7 @@ BSONObj WiredTigerServerStatusSection::generateSection(OperationContext* txn,
         bob.append("reason", status.reason());
     }
 
-    WiredTigerKVEngine::appendGlobalStats(bob);
+    _engine->appendGlobalStats(bob);
 
     return bob.obj();
 }
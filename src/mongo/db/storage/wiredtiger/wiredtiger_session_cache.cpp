@@ -39,6 +39,7 @@
 #include "mongo/db/storage/wiredtiger/wiredtiger_util.h"
 #include "mongo/stdx/memory.h"
 #include "mongo/stdx/thread.h"
+#include "mongo/util/concurrency/threadlocal.h"
 #include "mongo/util/log.h"
 #include "mongo/util/scopeguard.h"
 
@@ -124,6 +125,10 @@ void WiredTigerSession::closeAllCursors() {
 
 namespace {
 AtomicUInt64 nextTableId(1);
+
+// Hands out session cache shards to threads round-robin
+AtomicUInt32 nextShard;
+MONGO_TRIVIALLY_CONSTRUCTIBLE_THREAD_LOCAL int threadShard = -1;
 }
 // static
 uint64_t WiredTigerSession::genTableId() {
@@ -225,6 +230,17 @@ void WiredTigerSessionCache::closeAll() {
         stdx::lock_guard<stdx::mutex> lock(_cacheLock);
         _epoch.fetchAndAdd(1);
         _sessions.swap(swap);
+        _overflowCount.store(0);
+    }
+
+    // Sessions released into a slot after it was emptied here are taken back out by the thread
+    // which released them, because that thread sees the new epoch.
+    for (auto&& shard : _shards) {
+        for (auto&& slot : shard.slots) {
+            if (WiredTigerSession* session = slot.exchange(nullptr)) {
+                swap.push_back(session);
+            }
+        }
     }
 
     for (SessionCache::iterator i = swap.begin(); i != swap.end(); i++) {
@@ -241,19 +257,49 @@ UniqueWiredTigerSession WiredTigerSessionCache::getSession() {
     // operations should be allowed to start.
     invariant(!(_shuttingDown.loadRelaxed() & kShuttingDownMask));
 
-    {
+    Shard* shard = _getShard();
+    while (WiredTigerSession* cachedSession = _popCachedSession(shard)) {
+        if (cachedSession->_getEpoch() == _epoch.load()) {
+            return UniqueWiredTigerSession(cachedSession);
+        }
+
+        // The session was cached by a release which raced with closeAll
+        delete cachedSession;
+    }
+
+    // Not cached, but on release will be put back on the cache
+    return UniqueWiredTigerSession(new WiredTigerSession(_conn, this, _epoch.load()));
+}
+
+WiredTigerSessionCache::Shard* WiredTigerSessionCache::_getShard() {
+    if (threadShard < 0) {
+        threadShard = nextShard.fetchAndAdd(1) % kNumShards;
+    }
+    return &_shards[threadShard];
+}
+
+WiredTigerSession* WiredTigerSessionCache::_popCachedSession(Shard* shard) {
+    // Sessions are released into the first free slot, so the first taken slot tends to hold the
+    // most recently used session, and if we discard sessions, we're discarding older ones.
+    for (auto&& slot : shard->slots) {
+        if (slot.load(std::memory_order_relaxed)) {
+            if (WiredTigerSession* session = slot.exchange(nullptr)) {
+                return session;
+            }
+        }
+    }
+
+    if (_overflowCount.load()) {
         stdx::lock_guard<stdx::mutex> lock(_cacheLock);
         if (!_sessions.empty()) {
-            // Get the most recently used session so that if we discard sessions, we're
-            // discarding older ones
-            WiredTigerSession* cachedSession = _sessions.back();
+            WiredTigerSession* session = _sessions.back();
             _sessions.pop_back();
-            return UniqueWiredTigerSession(cachedSession);
+            _overflowCount.subtractAndFetch(1);
+            return session;
         }
     }
 
-    // Outside of the cache partition lock, but on release will be put back on the cache
-    return UniqueWiredTigerSession(new WiredTigerSession(_conn, this, _epoch.load()));
+    return NULL;
 }
 
 void WiredTigerSessionCache::releaseSession(WiredTigerSession* session) {
@@ -282,15 +328,38 @@ void WiredTigerSessionCache::releaseSession(WiredTigerSession* session) {
 
     bool returnedToCache = false;
     uint64_t currentEpoch = _epoch.load();
-
-    if (session->_getEpoch() == currentEpoch) {  // check outside of lock to reduce contention
-        stdx::lock_guard<stdx::mutex> lock(_cacheLock);
-        if (session->_getEpoch() == _epoch.load()) {  // recheck inside the lock for correctness
+    const uint64_t sessionEpoch = session->_getEpoch();
+
+    if (sessionEpoch == currentEpoch) {
+        for (auto&& slot : _getShard()->slots) {
+            WiredTigerSession* expected = nullptr;
+            if (!slot.compare_exchange_strong(expected, session)) {
+                continue;
+            }
+
+            // Once in the slot the session may be taken by another thread at any time, so it
+            // must not be touched any more. If closeAll ran before the session went in, take it
+            // back out, unless some other thread has already taken it and will free it.
+            if (sessionEpoch != _epoch.load()) {
+                WiredTigerSession* cached = session;
+                if (slot.compare_exchange_strong(cached, nullptr)) {
+                    delete session;
+                }
+            }
             returnedToCache = true;
-            _sessions.push_back(session);
+            break;
+        }
+
+        if (!returnedToCache) {
+            stdx::lock_guard<stdx::mutex> lock(_cacheLock);
+            if (sessionEpoch == _epoch.load()) {  // recheck inside the lock for correctness
+                returnedToCache = true;
+                _sessions.push_back(session);
+                _overflowCount.addAndFetch(1);
+            }
         }
     } else
-        invariant(session->_getEpoch() < currentEpoch);
+        invariant(sessionEpoch < currentEpoch);
 
     if (!returnedToCache)
         delete session;
@@ -31,8 +31,10 @@
 
 #pragma once
 
+#include <atomic>
 #include <list>
 #include <string>
+#include <vector>
 
 #include <boost/thread/shared_mutex.hpp>
 #include <wiredtiger.h>
@@ -40,6 +42,7 @@
 #include "mongo/db/storage/journal_listener.h"
 #include "mongo/db/storage/wiredtiger/wiredtiger_snapshot_manager.h"
 #include "mongo/platform/atomic_word.h"
+#include "mongo/platform/compiler.h"
 #include "mongo/stdx/mutex.h"
 #include "mongo/util/concurrency/spin_lock.h"
 
@@ -131,6 +134,11 @@ private:
 /**
  *  This cache implements a shared pool of WiredTiger sessions with the goal to amortize the
  *  cost of session creation and destruction over multiple uses.
+ *
+ *  Released sessions go to a shard of lock-free slots. Each thread is assigned a shard for its
+ *  lifetime, so threads on different shards don't touch the same cache lines and a thread tends
+ *  to get back the sessions it released, along with the cursors they cache. Sessions which don't
+ *  fit in the slots of a shard are kept in a list under a mutex.
  */
 class WiredTigerSessionCache {
 public:
@@ -198,9 +206,29 @@ private:
     AtomicUInt32 _shuttingDown;
     static const uint32_t kShuttingDownMask = 1 << 31;
 
+    static const int kNumShards = 16;
+    static const int kSlotsPerShard = 8;
+
+    struct MONGO_COMPILER_ALIGN_TYPE(64) Shard {
+        // Null or a cached session, owned by the slot. Sessions are taken out by swapping in
+        // null, so only one thread can ever get a particular session.
+        std::atomic<WiredTigerSession*> slots[kSlotsPerShard];  // NOLINT
+
+        Shard() {
+            for (auto&& slot : slots) {
+                slot.store(nullptr);
+            }
+        }
+    };
+
+    Shard _shards[kNumShards];
+
+    // The sessions which didn't fit in their shard. _overflowCount is only changed under
+    // _cacheLock, but read without it to skip taking the lock when the list is empty.
     stdx::mutex _cacheLock;
     typedef std::vector<WiredTigerSession*> SessionCache;
     SessionCache _sessions;
+    AtomicUInt32 _overflowCount;
 
     // Bumped when all open sessions need to be closed
     AtomicUInt64 _epoch;  // atomic so we can check it outside of the lock
@@ -219,6 +247,17 @@ private:
      * session and releasing it, the session is directly released. This method is thread safe.
      */
     void releaseSession(WiredTigerSession* session);
+
+    /**
+     * Returns the shard assigned to the calling thread.
+     */
+    Shard* _getShard();
+
+    /**
+     * Takes a session out of the given shard or the overflow list, or returns NULL if neither
+     * has one. The session may be from a previous epoch.
+     */
+    WiredTigerSession* _popCachedSession(Shard* shard);
 };
 
 /**
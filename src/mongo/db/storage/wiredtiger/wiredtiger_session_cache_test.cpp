@@ -0,0 +1,181 @@
+/*    Copyright 2016 10gen Inc.
+ *
+ *    This program is free software: you can redistribute it and/or  modify
+ *    it under the terms of the GNU Affero General Public License, version 3,
+ *    as published by the Free Software Foundation.
+ *
+ *    This program is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *    GNU Affero General Public License for more details.
+ *
+ *    You should have received a copy of the GNU Affero General Public License
+ *    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ *    As a special exception, the copyright holders give permission to link the
+ *    code of portions of this program with the OpenSSL library under certain
+ *    conditions as described in each individual source file and distribute
+ *    linked combinations including the program with the OpenSSL library. You
+ *    must comply with the GNU Affero General Public License in all respects
+ *    for all of the code used other than as permitted herein. If you modify
+ *    file(s) with this exception, you may extend this exception to your
+ *    version of the file(s), but you are not obligated to do so. If you do not
+ *    wish to do so, delete this exception statement from your version. If you
+ *    delete this exception statement from all source files in the program,
+ *    then also delete it in the license file.
+ */
+
+
+#define MONGO_LOG_DEFAULT_COMPONENT ::mongo::logger::LogComponent::kStorage
+
+#include "mongo/platform/basic.h"
+
+#include <algorithm>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "mongo/db/storage/wiredtiger/wiredtiger_session_cache.h"
+#include "mongo/db/storage/wiredtiger/wiredtiger_util.h"
+#include "mongo/platform/atomic_word.h"
+#include "mongo/stdx/memory.h"
+#include "mongo/stdx/thread.h"
+#include "mongo/unittest/temp_dir.h"
+#include "mongo/unittest/unittest.h"
+#include "mongo/util/log.h"
+#include "mongo/util/timer.h"
+
+namespace mongo {
+namespace {
+
+const char* const kUri = "table:session_cache_test";
+
+class WiredTigerSessionCacheTest : public unittest::Test {
+public:
+    WiredTigerSessionCacheTest() : _dbpath("wt_session_cache_test"), _conn(NULL) {
+        ASSERT_OK(wtRCToStatus(wiredtiger_open(_dbpath.path().c_str(), NULL, "create", &_conn)));
+        _sessionCache = stdx::make_unique<WiredTigerSessionCache>(_conn);
+
+        UniqueWiredTigerSession session = _sessionCache->getSession();
+        WT_SESSION* s = session->getSession();
+        ASSERT_OK(wtRCToStatus(s->create(s, kUri, "key_format=q,value_format=u")));
+    }
+
+    ~WiredTigerSessionCacheTest() {
+        _sessionCache.reset();
+        _conn->close(_conn, NULL);
+    }
+
+protected:
+    /**
+     * Opens a cursor on the test table through the session's cursor cache and returns it to
+     * the cache.
+     */
+    void cacheCursor(WiredTigerSession* session) {
+        WT_CURSOR* cursor = session->getCursor(kUri, _tableId, false);
+        ASSERT(cursor);
+        session->releaseCursor(_tableId, cursor);
+    }
+
+    /**
+     * Drops the test table, which fails with EBUSY while any session has a cursor on it.
+     */
+    int dropTable() {
+        WiredTigerSession session(_conn);
+        WT_SESSION* s = session.getSession();
+        return s->drop(s, kUri, NULL);
+    }
+
+    unittest::TempDir _dbpath;
+    WT_CONNECTION* _conn;
+    std::unique_ptr<WiredTigerSessionCache> _sessionCache;
+    const uint64_t _tableId = WiredTigerSession::genTableId();
+};
+
+TEST_F(WiredTigerSessionCacheTest, ReleasedSessionIsReused) {
+    WiredTigerSession* first;
+    {
+        UniqueWiredTigerSession session = _sessionCache->getSession();
+        first = session.get();
+    }
+
+    UniqueWiredTigerSession session = _sessionCache->getSession();
+    ASSERT_EQUALS(first, session.get());
+}
+
+TEST_F(WiredTigerSessionCacheTest, OverflowingSessionsAreCached) {
+    // More sessions than fit in the slots of a shard
+    const size_t numSessions = 64;
+    std::vector<WiredTigerSession*> released;
+    {
+        std::vector<UniqueWiredTigerSession> sessions;
+        for (size_t i = 0; i < numSessions; i++) {
+            sessions.push_back(_sessionCache->getSession());
+            released.push_back(sessions.back().get());
+        }
+    }
+
+    std::vector<UniqueWiredTigerSession> sessions;
+    for (size_t i = 0; i < numSessions; i++) {
+        sessions.push_back(_sessionCache->getSession());
+        ASSERT(std::find(released.begin(), released.end(), sessions.back().get()) !=
+               released.end());
+    }
+}
+
+TEST_F(WiredTigerSessionCacheTest, CloseAllFreesCachedSessions) {
+    {
+        UniqueWiredTigerSession session = _sessionCache->getSession();
+        cacheCursor(session.get());
+    }
+    ASSERT_EQUALS(EBUSY, dropTable());
+
+    _sessionCache->closeAll();
+    ASSERT_EQUALS(0, dropTable());
+}
+
+TEST_F(WiredTigerSessionCacheTest, SessionFromBeforeCloseAllIsFreedOnRelease) {
+    {
+        UniqueWiredTigerSession session = _sessionCache->getSession();
+        cacheCursor(session.get());
+        _sessionCache->closeAll();
+    }
+    ASSERT_EQUALS(0, dropTable());
+}
+
+// Checks out sessions and a cursor from many threads at once, as every operation does, and reports
+// the rate at which they do it.
+TEST_F(WiredTigerSessionCacheTest, ConcurrentCheckoutThroughput) {
+    const int numThreads = 16;
+    const int iterations = 20000;
+
+    AtomicInt64 checkouts;
+    std::vector<stdx::thread> threads;
+
+    Timer timer;
+    for (int i = 0; i < numThreads; i++) {
+        threads.emplace_back([&] {
+            for (int j = 0; j < iterations; j++) {
+                UniqueWiredTigerSession session = _sessionCache->getSession();
+                cacheCursor(session.get());
+                checkouts.fetchAndAdd(1);
+            }
+        });
+    }
+    for (auto&& thread : threads) {
+        thread.join();
+    }
+    const long long micros = std::max(timer.micros(), 1LL);
+
+    ASSERT_EQUALS(static_cast<long long>(numThreads) * iterations, checkouts.load());
+    log() << "session cache: " << numThreads << " threads checked out " << checkouts.load()
+          << " sessions in " << micros / 1000 << "ms, "
+          << checkouts.load() * 1000 * 1000 / micros << " checkouts/s";
+
+    // Every session was returned, so closing them all lets the table go
+    _sessionCache->closeAll();
+    ASSERT_EQUALS(0, dropTable());
+}
+
+}  // namespace
+}  // namespace mongo
@@ -0,0 +1,261 @@
+/*    Copyright 2016 10gen Inc.
+ *
+ *    This program is free software: you can redistribute it and/or  modify
+ *    it under the terms of the GNU Affero General Public License, version 3,
+ *    as published by the Free Software Foundation.
+ *
+ *    This program is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *    GNU Affero General Public License for more details.
+ *
+ *    You should have received a copy of the GNU Affero General Public License
+ *    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ *    As a special exception, the copyright holders give permission to link the
+ *    code of portions of this program with the OpenSSL library under certain
+ *    conditions as described in each individual source file and distribute
+ *    linked combinations including the program with the OpenSSL library. You
+ *    must comply with the GNU Affero General Public License in all respects
+ *    for all of the code used other than as permitted herein. If you modify
+ *    file(s) with this exception, you may extend this exception to your
+ *    version of the file(s), but you are not obligated to do so. If you do not
+ *    wish to do so, delete this exception statement from your version. If you
+ *    delete this exception statement from all source files in the program,
+ *    then also delete it in the license file.
+ */
+
+
+#define MONGO_LOG_DEFAULT_COMPONENT ::mongo::logger::LogComponent::kStorage
+
+#include "mongo/platform/basic.h"
+
+#include "mongo/db/storage/wiredtiger/wiredtiger_ticket_controller.h"
+
+#include <algorithm>
+
+#include "mongo/bson/bsonobjbuilder.h"
+#include "mongo/db/client.h"
+#include "mongo/db/server_parameters.h"
+#include "mongo/db/storage/wiredtiger/wiredtiger_session_cache.h"
+#include "mongo/db/storage/wiredtiger/wiredtiger_util.h"
+#include "mongo/util/concurrency/ticketholder.h"
+#include "mongo/util/log.h"
+#include "mongo/util/time_support.h"
+#include "mongo/util/timer.h"
+
+namespace mongo {
+
+namespace {
+
+MONGO_EXPORT_SERVER_PARAMETER(wiredTigerTicketControllerEnabled, bool, false);
+MONGO_EXPORT_SERVER_PARAMETER(wiredTigerTicketControllerIntervalMillis, int, 1000);
+
+// The controller never sizes a holder outside these bounds. The floor can't be below the
+// minimum size of a TicketHolder.
+MONGO_EXPORT_SERVER_PARAMETER(wiredTigerTicketControllerMinTickets, int, 16);
+MONGO_EXPORT_SERVER_PARAMETER(wiredTigerTicketControllerMaxTickets, int, 512);
+
+// The cache is under pressure above these percentages of its size. The defaults are the points
+// at which WiredTiger makes application threads evict pages.
+MONGO_EXPORT_SERVER_PARAMETER(wiredTigerTicketControllerCacheUsedHighPct, int, 95);
+MONGO_EXPORT_SERVER_PARAMETER(wiredTigerTicketControllerCacheDirtyHighPct, int, 80);
+
+const int kMinTickets = 5;
+
+// A growth step is undone if throughput falls by more than this fraction in the next interval.
+const double kThroughputDropFraction = 0.1;
+
+}  // namespace
+
+int WiredTigerTicketController::computeNewSize(const Limits& limits,
+                                               bool forWrites,
+                                               int currentSize,
+                                               const Sample& sample,
+                                               const Sample& previous,
+                                               Reason lastReason,
+                                               Reason* reason) {
+    const bool cachePressure = sample.cacheUsedPct >= limits.cacheUsedHighPct ||
+        (forWrites && sample.cacheDirtyPct >= limits.cacheDirtyHighPct);
+    const int step = std::max(1, currentSize / 8);
+
+    int newSize = currentSize;
+    *reason = Reason::kNone;
+    if (cachePressure) {
+        newSize = currentSize - std::max(1, currentSize / 4);
+        *reason = Reason::kCachePressure;
+    } else if (lastReason == Reason::kQueued && sample.waits > 0 &&
+               sample.throughput < previous.throughput * (1 - kThroughputDropFraction)) {
+        // Operations are still queueing, so the drop isn't for want of work.
+        newSize = currentSize - step;
+        *reason = Reason::kThroughputDropped;
+    } else if (sample.waits > 0 && lastReason != Reason::kThroughputDropped) {
+        newSize = currentSize + step;
+        *reason = Reason::kQueued;
+    }
+
+    const int floor = std::max(kMinTickets, limits.floor);
+    const int ceiling = std::max(floor, limits.ceiling);
+    newSize = std::min(std::max(newSize, floor), ceiling);
+    if (newSize == currentSize) {
+        *reason = Reason::kNone;
+    }
+    return newSize;
+}
+
+const char* WiredTigerTicketController::reasonToString(Reason reason) {
+    switch (reason) {
+        case Reason::kNone:
+            return "none";
+        case Reason::kCachePressure:
+            return "cachePressure";
+        case Reason::kQueued:
+            return "queued";
+        case Reason::kThroughputDropped:
+            return "throughputDropped";
+    }
+    MONGO_UNREACHABLE;
+}
+
+WiredTigerTicketController::WiredTigerTicketController(WT_CONNECTION* conn,
+                                                       TicketHolder* read,
+                                                       TicketHolder* write)
+    : BackgroundJob(false /* deleteSelf */), _conn(conn), _read(read, false), _write(write, true) {}
+
+std::string WiredTigerTicketController::name() const {
+    return "WTTicketController";
+}
+
+void WiredTigerTicketController::run() {
+    Client::initThread(name().c_str());
+
+    LOG(1) << "starting " << name() << " thread";
+
+    WiredTigerSession session(_conn);
+    WT_SESSION* s = session.getSession();
+
+    auto getStat = [s](int key) {
+        return WiredTigerUtil::getStatisticsValueAs<long long>(
+            s, "statistics:", "statistics=(fast)", key);
+    };
+
+    bool haveBaseline = false;
+    long long lastBegins = 0;
+    Timer timer;
+
+    while (!_shuttingDown.load()) {
+        sleepmillis(
+            std::min(std::max(wiredTigerTicketControllerIntervalMillis.load(), 100), 60000));
+
+        if (!wiredTigerTicketControllerEnabled.load()) {
+            haveBaseline = false;
+            continue;
+        }
+
+        auto swUsed = getStat(WT_STAT_CONN_CACHE_BYTES_INUSE);
+        auto swDirty = getStat(WT_STAT_CONN_CACHE_BYTES_DIRTY);
+        auto swMax = getStat(WT_STAT_CONN_CACHE_BYTES_MAX);
+        auto swBegins = getStat(WT_STAT_CONN_TXN_BEGIN);
+        if (!swUsed.isOK() || !swDirty.isOK() || !swMax.isOK() || !swBegins.isOK()) {
+            LOG(1) << name() << " failed to read cache statistics";
+            haveBaseline = false;
+            continue;
+        }
+
+        const long long begins = swBegins.getValue();
+        const double seconds = timer.micros() / 1000000.0;
+        timer.reset();
+
+        Sample sample;
+        if (const long long cacheSize = swMax.getValue()) {
+            sample.cacheUsedPct = static_cast<int>(swUsed.getValue() * 100 / cacheSize);
+            sample.cacheDirtyPct = static_cast<int>(swDirty.getValue() * 100 / cacheSize);
+        }
+        sample.throughput = seconds > 0 ? (begins - lastBegins) / seconds : 0;
+        lastBegins = begins;
+
+        if (!haveBaseline) {
+            for (Tuner* tuner : {&_read, &_write}) {
+                tuner->lastWaits = tuner->holder->numWaits();
+                tuner->lastWaitMicros = tuner->holder->totalWaitMicros();
+                tuner->previous = sample;
+                tuner->lastReason = Reason::kNone;
+            }
+            haveBaseline = true;
+            continue;
+        }
+
+        const Limits limits{wiredTigerTicketControllerMinTickets.load(),
+                            wiredTigerTicketControllerMaxTickets.load(),
+                            wiredTigerTicketControllerCacheUsedHighPct.load(),
+                            wiredTigerTicketControllerCacheDirtyHighPct.load()};
+        _adjust(&_write, limits, sample);
+        _adjust(&_read, limits, sample);
+    }
+
+    LOG(1) << "stopping " << name() << " thread";
+}
+
+void WiredTigerTicketController::_adjust(Tuner* tuner, const Limits& limits, Sample sample) {
+    const long long waits = tuner->holder->numWaits();
+    const long long waitMicros = tuner->holder->totalWaitMicros();
+    sample.waits = waits - tuner->lastWaits;
+    sample.meanWaitMicros =
+        sample.waits > 0 ? static_cast<double>(waitMicros - tuner->lastWaitMicros) / sample.waits
+                         : 0;
+    tuner->lastWaits = waits;
+    tuner->lastWaitMicros = waitMicros;
+
+    const int currentSize = tuner->holder->outof();
+    Reason reason;
+    const int newSize = computeNewSize(
+        limits, tuner->forWrites, currentSize, sample, tuner->previous, tuner->lastReason, &reason);
+    tuner->previous = sample;
+    tuner->lastReason = reason;
+
+    if (reason == Reason::kNone) {
+        return;
+    }
+
+    // Shrinking waits for the tickets it removes to be released.
+    Status status = tuner->holder->resize(newSize);
+    if (!status.isOK()) {
+        warning() << name() << " failed to resize " << (tuner->forWrites ? "write" : "read")
+                  << " tickets to " << newSize << ": " << status;
+        return;
+    }
+
+    LOG(1) << name() << " resized " << (tuner->forWrites ? "write" : "read") << " tickets from "
+           << currentSize << " to " << newSize << " (" << reasonToString(reason)
+           << "): cache used " << sample.cacheUsedPct << "%, dirty " << sample.cacheDirtyPct
+           << "%, " << sample.throughput << " transactions/s, " << sample.waits
+           << " waits averaging " << sample.meanWaitMicros << "us";
+
+    if (newSize > currentSize) {
+        tuner->increases.fetchAndAdd(1);
+    } else {
+        tuner->decreases.fetchAndAdd(1);
+    }
+    tuner->lastResizeReason.store(static_cast<int>(reason));
+}
+
+void WiredTigerTicketController::shutdown() {
+    _shuttingDown.store(true);
+    wait();
+}
+
+void WiredTigerTicketController::appendStats(BSONObjBuilder* builder) const {
+    BSONObjBuilder sub(builder->subobjStart("controller"));
+    sub.append("enabled", wiredTigerTicketControllerEnabled.load());
+    for (const Tuner* tuner : {&_write, &_read}) {
+        BSONObjBuilder holderBuilder(sub.subobjStart(tuner->forWrites ? "write" : "read"));
+        holderBuilder.append("increases", tuner->increases.load());
+        holderBuilder.append("decreases", tuner->decreases.load());
+        holderBuilder.append("lastResizeReason",
+                             reasonToString(static_cast<Reason>(tuner->lastResizeReason.load())));
+        holderBuilder.append("queuedAcquisitions", tuner->holder->numWaits());
+        holderBuilder.append("queuedMicros", tuner->holder->totalWaitMicros());
+    }
+}
+
+}  // namespace mongo
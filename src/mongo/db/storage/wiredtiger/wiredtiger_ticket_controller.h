@@ -0,0 +1,131 @@
+/*    Copyright 2016 10gen Inc.
+ *
+ *    This program is free software: you can redistribute it and/or  modify
+ *    it under the terms of the GNU Affero General Public License, version 3,
+ *    as published by the Free Software Foundation.
+ *
+ *    This program is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *    GNU Affero General Public License for more details.
+ *
+ *    You should have received a copy of the GNU Affero General Public License
+ *    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ *    As a special exception, the copyright holders give permission to link the
+ *    code of portions of this program with the OpenSSL library under certain
+ *    conditions as described in each individual source file and distribute
+ *    linked combinations including the program with the OpenSSL library. You
+ *    must comply with the GNU Affero General Public License in all respects
+ *    for all of the code used other than as permitted herein. If you modify
+ *    file(s) with this exception, you may extend this exception to your
+ *    version of the file(s), but you are not obligated to do so. If you do not
+ *    wish to do so, delete this exception statement from your version. If you
+ *    delete this exception statement from all source files in the program,
+ *    then also delete it in the license file.
+ */
+
+
+#pragma once
+
+#include <atomic>
+#include <wiredtiger.h>
+
+#include "mongo/platform/atomic_word.h"
+#include "mongo/util/background.h"
+
+namespace mongo {
+
+class BSONObjBuilder;
+class TicketHolder;
+
+/**
+ * Resizes the TicketHolders which limit the number of concurrent read and write transactions,
+ * when enabled through the wiredTigerTicketControllerEnabled server parameter.
+ *
+ * At each interval the controller samples how full and how dirty the cache is, how many
+ * transactions began, and how long operations queued for tickets. A holder is shrunk while the
+ * cache is under eviction pressure, since more concurrent transactions would only add to the
+ * stalls, and grown while operations queue for its tickets. A growth step which is followed by a
+ * drop in throughput is undone. Sizes are kept within the configured floor and ceiling.
+ */
+class WiredTigerTicketController : public BackgroundJob {
+public:
+    /**
+     * What the controller observed over one interval.
+     */
+    struct Sample {
+        int cacheUsedPct = 0;
+        int cacheDirtyPct = 0;
+
+        // Transactions begun per second.
+        double throughput = 0;
+
+        // Acquisitions of this holder's tickets which had to wait, and their mean wait.
+        long long waits = 0;
+        double meanWaitMicros = 0;
+    };
+
+    enum class Reason { kNone, kCachePressure, kQueued, kThroughputDropped };
+
+    struct Limits {
+        int floor;
+        int ceiling;
+        int cacheUsedHighPct;
+        int cacheDirtyHighPct;
+    };
+
+    /**
+     * Returns the new size for a holder of "currentSize" tickets, and why it changes. "previous"
+     * is the sample of the previous interval and "lastReason" the reason of the previous
+     * adjustment. Write tickets also respond to dirty cache pressure.
+     */
+    static int computeNewSize(const Limits& limits,
+                              bool forWrites,
+                              int currentSize,
+                              const Sample& sample,
+                              const Sample& previous,
+                              Reason lastReason,
+                              Reason* reason);
+
+    static const char* reasonToString(Reason reason);
+
+    WiredTigerTicketController(WT_CONNECTION* conn, TicketHolder* read, TicketHolder* write);
+
+    virtual std::string name() const;
+
+    virtual void run();
+
+    void shutdown();
+
+    /**
+     * Appends the number of resizes of each holder and the last reason, for serverStatus.
+     */
+    void appendStats(BSONObjBuilder* builder) const;
+
+private:
+    struct Tuner {
+        Tuner(TicketHolder* holder, bool forWrites) : holder(holder), forWrites(forWrites) {}
+
+        TicketHolder* const holder;
+        const bool forWrites;
+
+        Sample previous;
+        long long lastWaits = 0;
+        long long lastWaitMicros = 0;
+        Reason lastReason = Reason::kNone;
+
+        AtomicInt64 increases;
+        AtomicInt64 decreases;
+        AtomicInt32 lastResizeReason{static_cast<int>(Reason::kNone)};
+    };
+
+    void _adjust(Tuner* tuner, const Limits& limits, Sample sample);
+
+    WT_CONNECTION* const _conn;
+    Tuner _read;
+    Tuner _write;
+    std::atomic<bool> _shuttingDown{false};  // NOLINT
+};
+
+}  // namespace mongo
@@ -0,0 +1,140 @@
+/*    Copyright 2016 10gen Inc.
+ *
+ *    This program is free software: you can redistribute it and/or  modify
+ *    it under the terms of the GNU Affero General Public License, version 3,
+ *    as published by the Free Software Foundation.
+ *
+ *    This program is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *    GNU Affero General Public License for more details.
+ *
+ *    You should have received a copy of the GNU Affero General Public License
+ *    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ *    As a special exception, the copyright holders give permission to link the
+ *    code of portions of this program with the OpenSSL library under certain
+ *    conditions as described in each individual source file and distribute
+ *    linked combinations including the program with the OpenSSL library. You
+ *    must comply with the GNU Affero General Public License in all respects
+ *    for all of the code used other than as permitted herein. If you modify
+ *    file(s) with this exception, you may extend this exception to your
+ *    version of the file(s), but you are not obligated to do so. If you do not
+ *    wish to do so, delete this exception statement from your version. If you
+ *    delete this exception statement from all source files in the program,
+ *    then also delete it in the license file.
+ */
+
+
+#include "mongo/platform/basic.h"
+
+#include "mongo/db/storage/wiredtiger/wiredtiger_ticket_controller.h"
+#include "mongo/unittest/unittest.h"
+
+namespace mongo {
+namespace {
+
+using Reason = WiredTigerTicketController::Reason;
+using Sample = WiredTigerTicketController::Sample;
+
+const WiredTigerTicketController::Limits kLimits{16, 256, 95, 80};
+
+Sample makeSample(int cacheUsedPct, int cacheDirtyPct, double throughput, long long waits) {
+    Sample sample;
+    sample.cacheUsedPct = cacheUsedPct;
+    sample.cacheDirtyPct = cacheDirtyPct;
+    sample.throughput = throughput;
+    sample.waits = waits;
+    return sample;
+}
+
+TEST(WiredTigerTicketController, HealthyIdleCacheKeepsSize) {
+    Reason reason;
+    const Sample sample = makeSample(50, 10, 1000, 0);
+    ASSERT_EQUALS(128,
+                  WiredTigerTicketController::computeNewSize(
+                      kLimits, true, 128, sample, sample, Reason::kNone, &reason));
+    ASSERT(reason == Reason::kNone);
+}
+
+TEST(WiredTigerTicketController, GrowsWhileQueued) {
+    Reason reason;
+    const Sample sample = makeSample(50, 10, 1000, 20);
+    ASSERT_EQUALS(144,
+                  WiredTigerTicketController::computeNewSize(
+                      kLimits, true, 128, sample, sample, Reason::kNone, &reason));
+    ASSERT(reason == Reason::kQueued);
+
+    // Growth stops at the ceiling.
+    ASSERT_EQUALS(256,
+                  WiredTigerTicketController::computeNewSize(
+                      kLimits, true, 250, sample, sample, Reason::kQueued, &reason));
+    ASSERT_EQUALS(256,
+                  WiredTigerTicketController::computeNewSize(
+                      kLimits, true, 256, sample, sample, Reason::kQueued, &reason));
+    ASSERT(reason == Reason::kNone);
+}
+
+TEST(WiredTigerTicketController, ShrinksUnderCachePressure) {
+    Reason reason;
+    const Sample full = makeSample(96, 10, 1000, 20);
+    ASSERT_EQUALS(96,
+                  WiredTigerTicketController::computeNewSize(
+                      kLimits, false, 128, full, full, Reason::kNone, &reason));
+    ASSERT(reason == Reason::kCachePressure);
+
+    // Only write tickets respond to dirty pages.
+    const Sample dirty = makeSample(85, 85, 1000, 20);
+    ASSERT_EQUALS(96,
+                  WiredTigerTicketController::computeNewSize(
+                      kLimits, true, 128, dirty, dirty, Reason::kNone, &reason));
+    ASSERT(reason == Reason::kCachePressure);
+    ASSERT_EQUALS(144,
+                  WiredTigerTicketController::computeNewSize(
+                      kLimits, false, 128, dirty, dirty, Reason::kNone, &reason));
+    ASSERT(reason == Reason::kQueued);
+
+    // Shrinking stops at the floor.
+    ASSERT_EQUALS(16,
+                  WiredTigerTicketController::computeNewSize(
+                      kLimits, true, 18, full, full, Reason::kCachePressure, &reason));
+    ASSERT_EQUALS(16,
+                  WiredTigerTicketController::computeNewSize(
+                      kLimits, true, 16, full, full, Reason::kCachePressure, &reason));
+    ASSERT(reason == Reason::kNone);
+}
+
+TEST(WiredTigerTicketController, UndoesGrowthWhichLowersThroughput) {
+    Reason reason;
+    const Sample before = makeSample(50, 10, 1000, 20);
+    const Sample after = makeSample(50, 10, 800, 20);
+    ASSERT_EQUALS(126,
+                  WiredTigerTicketController::computeNewSize(
+                      kLimits, true, 144, after, before, Reason::kQueued, &reason));
+    ASSERT(reason == Reason::kThroughputDropped);
+
+    // The controller holds its size for an interval before growing again.
+    ASSERT_EQUALS(126,
+                  WiredTigerTicketController::computeNewSize(
+                      kLimits, true, 126, after, after, Reason::kThroughputDropped, &reason));
+    ASSERT(reason == Reason::kNone);
+
+    // A drop without queueing is a drop in demand.
+    const Sample idle = makeSample(50, 10, 800, 0);
+    ASSERT_EQUALS(144,
+                  WiredTigerTicketController::computeNewSize(
+                      kLimits, true, 144, idle, before, Reason::kQueued, &reason));
+    ASSERT(reason == Reason::kNone);
+}
+
+TEST(WiredTigerTicketController, FloorIsAtLeastTheTicketHolderMinimum) {
+    Reason reason;
+    const WiredTigerTicketController::Limits limits{1, 2, 95, 80};
+    const Sample full = makeSample(99, 99, 1000, 0);
+    ASSERT_EQUALS(5,
+                  WiredTigerTicketController::computeNewSize(
+                      limits, true, 8, full, full, Reason::kNone, &reason));
+}
+
+}  // namespace
+}  // namespace mongo
@@ -62,6 +62,12 @@ public:
         }
 
         _chunkRanges.reloadAll(_chunkMap);
+        _routingTable.reloadAll(_chunkMap);
+    }
+
+    void refreshRoutingTable(const TestableChunkManager& previous,
+                             const ConfigDiffTrackerBase::ChangedRanges& changedRanges) {
+        _routingTable.reloadChanged(previous._routingTable, _chunkMap, changedRanges);
     }
 };
 
@@ -334,6 +340,142 @@ class InMultiShard : public CompoundKeyBase {
     }
 };
 
+/**
+ * The routing table finds the same chunk as a lookup in the chunk map, for single keys and for
+ * batches of keys, including keys of mixed numeric types and keys equal to chunk bounds.
+ */
+class RoutingTableMatchesChunkMap {
+public:
+    void run() {
+        auto opCtx = stdx::make_unique<OperationContextNoop>();
+
+        ShardKeyPattern shardKeyPattern(BSON("a" << 1 << "b" << 1));
+        TestableChunkManager chunkManager("", shardKeyPattern, false);
+
+        vector<BSONObj> splitPoints;
+        for (int i = 0; i < 100; ++i) {
+            splitPoints.push_back(BSON("a" << i << "b" << 0));
+            splitPoints.push_back(BSON("a" << i << "b"
+                                           << "m"));
+        }
+        splitPoints.push_back(BSON("a"
+                                   << "k"
+                                   << "b" << MINKEY));
+        splitPoints.push_back(BSON("a"
+                                   << "t"
+                                   << "b" << 5));
+        chunkManager.setSingleChunkForShards(splitPoints);
+
+        vector<BSONObj> keys;
+        for (int i = -2; i < 103; ++i) {
+            keys.push_back(BSON("a" << i << "b" << 0));
+            keys.push_back(BSON("a" << i + 0.5 << "b" << 1));
+            keys.push_back(BSON("a" << static_cast<long long>(i) << "b"
+                                    << "z"));
+            keys.push_back(BSON("a" << static_cast<double>(i) << "b" << MAXKEY));
+        }
+        keys.push_back(BSON("a"
+                            << "k"
+                            << "b" << MINKEY));
+        keys.push_back(BSON("a"
+                            << "p"
+                            << "b" << 1));
+        keys.push_back(BSON("a"
+                            << "z"
+                            << "b" << BSONNULL));
+        keys.push_back(BSON("a" << MINKEY << "b" << MINKEY));
+        keys.push_back(BSON("a" << BSON("x" << 1) << "b" << 1));
+
+        const ChunkMap& chunkMap = chunkManager.getChunkMap();
+        vector<ChunkPtr> expected;
+        for (const auto& key : keys) {
+            ChunkMap::const_iterator it = chunkMap.upper_bound(key);
+            ASSERT(it != chunkMap.end());
+            expected.push_back(it->second);
+            ASSERT(expected.back() == chunkManager.findIntersectingChunk(opCtx.get(), key));
+        }
+
+        // Resolve the keys as one batch, in an order unlike their sorted order.
+        std::reverse(keys.begin(), keys.end());
+        std::reverse(expected.begin(), expected.end());
+        vector<ChunkPtr> chunks;
+        chunkManager.findIntersectingChunks(opCtx.get(), keys, &chunks);
+        ASSERT_EQUALS(keys.size(), chunks.size());
+        for (size_t i = 0; i < keys.size(); ++i) {
+            ASSERT(expected[i] == chunks[i]);
+        }
+    }
+};
+
+/**
+ * A routing table refreshed from the previous table and the ranges of the diffs finds the same
+ * chunk as a lookup in the new chunk map, for diffs at the ends of the key space and for diffs
+ * which span several blocks of the table.
+ */
+class RoutingTableRefreshMatchesChunkMap {
+public:
+    void run() {
+        auto opCtx = stdx::make_unique<OperationContextNoop>();
+
+        ShardKeyPattern shardKeyPattern(BSON("a" << 1));
+        TestableChunkManager previous("", shardKeyPattern, false);
+
+        vector<BSONObj> splitPoints;
+        for (int i = 0; i < 1000; ++i) {
+            splitPoints.push_back(BSON("a" << i));
+        }
+        previous.setSingleChunkForShards(splitPoints);
+
+        // Split the first and the last chunks and the chunk (700, 701], merge the chunks from 300
+        // to 600 and migrate the chunk (850, 851].
+        vector<BSONObj> newSplitPoints;
+        newSplitPoints.push_back(BSON("a" << -5));
+        for (int i = 0; i < 1000; ++i) {
+            if (i > 300 && i < 600) {
+                continue;
+            }
+            newSplitPoints.push_back(BSON("a" << i));
+            if (i == 700) {
+                newSplitPoints.push_back(BSON("a" << 700.5));
+            }
+        }
+        newSplitPoints.push_back(BSON("a" << 2000));
+
+        ConfigDiffTrackerBase::ChangedRanges changedRanges;
+        const auto addChangedRange = [&](const BSONObj& min, const BSONObj& max) {
+            changedRanges.push_back(std::make_pair(min, max));
+        };
+        addChangedRange(BSON("a" << MINKEY), BSON("a" << -5));
+        addChangedRange(BSON("a" << -5), BSON("a" << 0));
+        addChangedRange(BSON("a" << 300), BSON("a" << 600));
+        addChangedRange(BSON("a" << 700), BSON("a" << 700.5));
+        addChangedRange(BSON("a" << 700.5), BSON("a" << 701));
+        addChangedRange(BSON("a" << 850), BSON("a" << 851));
+        addChangedRange(BSON("a" << 999), BSON("a" << 2000));
+        addChangedRange(BSON("a" << 2000), BSON("a" << MAXKEY));
+
+        TestableChunkManager current("", shardKeyPattern, false);
+        current.setSingleChunkForShards(newSplitPoints);
+
+        const auto assertRoutesLikeChunkMap = [&] {
+            const ChunkMap& chunkMap = current.getChunkMap();
+            for (int i = -20; i < 4100; ++i) {
+                const BSONObj key = BSON("a" << i / 2.0);
+                ChunkMap::const_iterator it = chunkMap.upper_bound(key);
+                ASSERT(it != chunkMap.end());
+                ASSERT(it->second == current.findIntersectingChunk(opCtx.get(), key));
+            }
+        };
+
+        current.refreshRoutingTable(previous, changedRanges);
+        assertRoutesLikeChunkMap();
+
+        // Diffs which do not account for the changes make the table encode every chunk instead.
+        current.refreshRoutingTable(previous, ConfigDiffTrackerBase::ChangedRanges());
+        assertRoutesLikeChunkMap();
+    }
+};
+
 class All : public Suite {
 public:
     All() : Suite("chunk") {}
@@ -358,6 +500,8 @@ public:
         add<InequalityThenUnsatisfiable>();
         add<OrEqualityUnsatisfiableInequality>();
         add<InMultiShard>();
+        add<RoutingTableMatchesChunkMap>();
+        add<RoutingTableRefreshMatchesChunkMap>();
     }
 };
 
@@ -52,13 +52,16 @@
 #include "mongo/db/dbdirectclient.h"
 #include "mongo/db/lasterror.h"
 #include "mongo/db/operation_context_impl.h"
+#include "mongo/db/storage/key_string.h"
 #include "mongo/db/storage/mmap_v1/dur_stats.h"
 #include "mongo/db/storage/mmap_v1/mmap.h"
 #include "mongo/db/storage/storage_options.h"
 #include "mongo/dbtests/dbtests.h"
 #include "mongo/dbtests/framework_options.h"
+#include "mongo/s/chunk_manager.h"
 #include "mongo/stdx/condition_variable.h"
 #include "mongo/stdx/thread.h"
+#include "mongo/util/fail_point_service.h"
 #include "mongo/util/log.h"
 #include "mongo/util/timer.h"
 #include "mongo/util/version.h"
@@ -444,6 +447,178 @@ public:
     }
 };
 
+/**
+ * Encodes an index key into a KeyString, as index key generation does for every key of every
+ * document. 'GenericOnly' forces the generic per-type encoder instead of the fast path for common
+ * types.
+ */
+template <bool GenericOnly>
+class KeyStringEncodeBase : public B {
+public:
+    KeyStringEncodeBase(const std::string& shape, const BSONObj& key)
+        : _shape(shape), _key(key), _ord(Ordering::make(BSONObj())) {}
+
+    string name() {
+        return str::stream() << "KeyString encode " << _shape
+                             << (GenericOnly ? " (generic)" : "");
+    }
+    virtual int howLongMillis() {
+        return 500;
+    }
+    virtual bool showDurStats() {
+        return false;
+    }
+    void prep() {
+        _setSkipFastPath(GenericOnly);
+    }
+    void timed() {
+        KeyString ks(_key, _ord, RecordId(1));
+        _totalBytes += ks.getSize();
+    }
+    void post() {
+        _setSkipFastPath(false);
+    }
+
+private:
+    static void _setSkipFastPath(bool on) {
+        getGlobalFailPointRegistry()
+            ->getFailPoint("keyStringSkipFastPath")
+            ->setMode(on ? FailPoint::alwaysOn : FailPoint::off);
+    }
+
+    const std::string _shape;
+    const BSONObj _key;
+    const Ordering _ord;
+    size_t _totalBytes = 0;
+};
+
+template <bool GenericOnly>
+class KeyStringEncodeInt : public KeyStringEncodeBase<GenericOnly> {
+public:
+    KeyStringEncodeInt() : KeyStringEncodeBase<GenericOnly>("{int}", BSON("" << 123456)) {}
+};
+
+template <bool GenericOnly>
+class KeyStringEncodeCompound : public KeyStringEncodeBase<GenericOnly> {
+public:
+    KeyStringEncodeCompound()
+        : KeyStringEncodeBase<GenericOnly>("{int, string, long}",
+                                           BSON("" << 42 << ""
+                                                   << "customer-000123"
+                                                   << "" << 1234567890123LL)) {}
+};
+
+template <bool GenericOnly>
+class KeyStringEncodeOID : public KeyStringEncodeBase<GenericOnly> {
+public:
+    KeyStringEncodeOID() : KeyStringEncodeBase<GenericOnly>("{oid}", BSON("" << OID::gen())) {}
+};
+
+template <bool GenericOnly>
+class KeyStringEncodeString : public KeyStringEncodeBase<GenericOnly> {
+public:
+    KeyStringEncodeString()
+        : KeyStringEncodeBase<GenericOnly>("{string64}", BSON("" << std::string(64, 'x'))) {}
+};
+
+template <bool GenericOnly>
+class KeyStringEncodeDouble : public KeyStringEncodeBase<GenericOnly> {
+public:
+    KeyStringEncodeDouble() : KeyStringEncodeBase<GenericOnly>("{double}", BSON("" << 3.25)) {}
+};
+
+class KeyStringCompare : public B {
+public:
+    KeyStringCompare()
+        : _a(BSON("" << 42 << ""
+                     << "customer-000123"),
+             Ordering::make(BSONObj()),
+             RecordId(1)),
+          _b(BSON("" << 42 << ""
+                     << "customer-000124"),
+             Ordering::make(BSONObj()),
+             RecordId(1)) {}
+
+    string name() {
+        return "KeyString compare";
+    }
+    virtual int howLongMillis() {
+        return 500;
+    }
+    virtual bool showDurStats() {
+        return false;
+    }
+    void timed() {
+        _result += _a.compare(_b);
+    }
+
+private:
+    const KeyString _a;
+    const KeyString _b;
+    int _result = 0;
+};
+
+/**
+ * Refreshes the routing table of a collection with 'NumChunks' chunks after one of its chunks is
+ * split, either by encoding every chunk again or by encoding only the blocks the split changed.
+ */
+template <int NumChunks, bool Incremental>
+class ChunkRoutingTableRefresh : public B {
+public:
+    ChunkRoutingTableRefresh()
+        : _manager("perftest.chunks", ShardKeyPattern(BSON("a" << 1)), false) {}
+
+    string name() {
+        return str::stream() << "chunk routing refresh " << NumChunks
+                             << (Incremental ? " (incremental)" : " (full)");
+    }
+    virtual int howLongMillis() {
+        return 500;
+    }
+    virtual bool showDurStats() {
+        return false;
+    }
+    void prep() {
+        BSONObj min = BSON("a" << MINKEY);
+        for (int i = 0; i < NumChunks; ++i) {
+            BSONObj max = (i == NumChunks - 1) ? BSON("a" << MAXKEY) : BSON("a" << i);
+            _addChunk(&_oldChunks, min, max);
+            min = max;
+        }
+        _oldTable.reloadAll(_oldChunks);
+
+        // The diff of a split replaces the chunk with the two halves.
+        const BSONObj splitMin = BSON("a" << NumChunks / 2 - 1);
+        const BSONObj splitPoint = BSON("a" << NumChunks / 2 - 0.5);
+        const BSONObj splitMax = BSON("a" << NumChunks / 2);
+
+        _newChunks = _oldChunks;
+        _newChunks.erase(splitMax);
+        _addChunk(&_newChunks, splitMin, splitPoint);
+        _addChunk(&_newChunks, splitPoint, splitMax);
+        _changedRanges.push_back(std::make_pair(splitMin, splitPoint));
+        _changedRanges.push_back(std::make_pair(splitPoint, splitMax));
+    }
+    void timed() {
+        ChunkRoutingTable table;
+        if (Incremental) {
+            table.reloadChanged(_oldTable, _newChunks, _changedRanges);
+        } else {
+            table.reloadAll(_newChunks);
+        }
+    }
+
+private:
+    void _addChunk(ChunkMap* chunks, const BSONObj& min, const BSONObj& max) {
+        (*chunks)[max] = std::make_shared<Chunk>(&_manager, min, max, "shard0000");
+    }
+
+    const ChunkManager _manager;
+    ChunkMap _oldChunks;
+    ChunkRoutingTable _oldTable;
+    ChunkMap _newChunks;
+    ConfigDiffTrackerBase::ChangedRanges _changedRanges;
+};
 
 class All : public Suite {
 public:
@@ -457,6 +632,23 @@ public:
         add<boosttimed_mutexspeed>();
         add<stdmutexspeed>();
         add<stdtimed_mutexspeed>();
+        add<KeyStringEncodeInt<false>>();
+        add<KeyStringEncodeInt<true>>();
+        add<KeyStringEncodeCompound<false>>();
+        add<KeyStringEncodeCompound<true>>();
+        add<KeyStringEncodeOID<false>>();
+        add<KeyStringEncodeOID<true>>();
+        add<KeyStringEncodeString<false>>();
+        add<KeyStringEncodeString<true>>();
+        add<KeyStringEncodeDouble<false>>();
+        add<KeyStringEncodeDouble<true>>();
+        add<KeyStringCompare>();
+        add<ChunkRoutingTableRefresh<10000, false>>();
+        add<ChunkRoutingTableRefresh<10000, true>>();
+        add<ChunkRoutingTableRefresh<100000, false>>();
+        add<ChunkRoutingTableRefresh<100000, true>>();
+        add<ChunkRoutingTableRefresh<1000000, false>>();
+        add<ChunkRoutingTableRefresh<1000000, true>>();
     }
 } myall;
 }
@@ -244,6 +244,68 @@ private:
     }
 };
 
+// Measures the rate of uncontended intent lock acquisitions on the global and database resources,
+// which the lock manager grants on its fast path, and checks that an occasional exclusive lock
+// still excludes them.
+class IntentLockThroughput : public ThreadedTest<16> {
+#if defined(MONGO_CONFIG_DEBUG_BUILD)
+    enum { N = 20000 };
+#else
+    enum { N = 200000 };
+#endif
+    enum { NumDbs = 4, ExclusiveEvery = 1000 };
+
+public:
+    void run() {
+        Timer t;
+        ThreadedTest<16>::run();
+        const long long millis = std::max(t.millis(), 1);
+        mongo::unittest::log() << "IntentLockThroughput " << nthreads << " threads: " << millis
+                               << "ms, " << (_acquisitions.load() * 1000 / millis)
+                               << " acquisitions/s";
+    }
+
+private:
+    static string dbName(int i) {
+        return str::stream() << "intentlockthroughput" << (i % NumDbs);
+    }
+
+    virtual void subthread(int tnumber) {
+        DefaultLockerImpl locker;
+
+        for (int i = 0; i < N; i++) {
+            if (tnumber == 1 && i % ExclusiveEvery == 0) {
+                Lock::DBLock x(&locker, dbName(0), MODE_X);
+                // Give the intent lock holders time to show up while X is held.
+                for (int spin = 0; spin < 100; spin++) {
+                    ASSERT_EQUALS(0, _inFirstDb.load());
+                    stdx::this_thread::yield();
+                }
+                continue;
+            }
+
+            const int db = tnumber + i;
+            Lock::DBLock lk(&locker, dbName(db), (i % 2) ? MODE_IS : MODE_IX);
+            if (db % NumDbs == 0) {
+                // Stay counted across a yield, so that the X holder can see a granted intent lock.
+                _inFirstDb.fetchAndAdd(1);
+                stdx::this_thread::yield();
+                _inFirstDb.fetchAndSubtract(1);
+            }
+            _acquisitions.fetchAndAdd(1);
+        }
+    }
+
+    virtual void validate() {
+        ASSERT_EQUALS(0, _inFirstDb.load());
+        ASSERT_EQUALS(static_cast<long long>(nthreads) * N - N / ExclusiveEvery,
+                      _acquisitions.load());
+    }
+
+    AtomicInt32 _inFirstDb;
+    AtomicInt64 _acquisitions;
+};
+
 template <typename _AtomicUInt>
 class IsAtomicWordAtomic : public ThreadedTest<> {
     static const int iterations = 1000000;
@@ -792,6 +854,7 @@ public:
         add<RWLockTest4>();
 
         add<MongoMutexTest>();
+        add<IntentLockThroughput>();
         add<TicketHolderWaits>();
     }
 };
@@ -56,6 +56,7 @@
 #include "mongo/stdx/mutex.h"
 #include "mongo/stdx/thread.h"
 #include "mongo/util/net/message.h"
+#include "mongo/util/net/message_compressor_manager.h"
 
 namespace mongo {
 
@@ -145,6 +146,8 @@ private:
         rpc::ProtocolSet clientProtocols() const;
         void setServerProtocols(rpc::ProtocolSet protocols);
 
+        MessageCompressorManager& compressorManager();
+
 // Explicit move construction and assignment to support MSVC
 #if defined(_MSC_VER) && _MSC_VER < 1900
         AsyncConnection(AsyncConnection&&);
@@ -162,6 +165,9 @@ private:
         // Dynamically initialized from [min max]WireVersionOutgoing.
         // Its expected that isMaster response is checked only on the caller.
         rpc::ProtocolSet _clientProtocols{rpc::supports::kNone};
+
+        // Negotiated by the isMaster command which begins every connection.
+        MessageCompressorManager _compressorManager;
     };
 
     /**
@@ -197,6 +203,8 @@ private:
 
         NetworkInterfaceASIO::AsyncConnection& conn();
 
+        CommandType type() const;
+
         Message& toSend();
         Message& toRecv();
         MSGHEADER::Value& header();
@@ -182,6 +182,10 @@ NetworkInterfaceASIO::AsyncConnection& NetworkInterfaceASIO::AsyncCommand::conn(
     return *_conn;
 }
 
+NetworkInterfaceASIO::AsyncCommand::CommandType NetworkInterfaceASIO::AsyncCommand::type() const {
+    return _type;
+}
+
 Message& NetworkInterfaceASIO::AsyncCommand::toSend() {
     return _toSend;
 }
@@ -351,6 +355,13 @@ void NetworkInterfaceASIO::_asyncRunCommand(AsyncOp* op, NetworkOpHandler handle
 
     // Step 4
     auto recvMessageCallback = [this, cmd, handler, op](std::error_code ec, size_t bytes) {
+        if (!ec) {
+            auto status = cmd->conn().compressorManager().decompressMessage(&cmd->toRecv());
+            if (!status.isOK()) {
+                return handler(make_error_code(status.code()), bytes);
+            }
+        }
+
         // We don't call _validateAndRun here as we assume the caller will.
         handler(ec, bytes);
     };
@@ -395,6 +406,19 @@ void NetworkInterfaceASIO::_asyncRunCommand(AsyncOp* op, NetworkOpHandler handle
         };
 
     // Step 1
+    // Downconverted commands keep their uncompressed request, which is needed to upconvert the
+    // reply.
+    auto& compressorManager = cmd->conn().compressorManager();
+    if (cmd->type() == AsyncCommand::CommandType::kRPC &&
+        compressorManager.shouldCompress(cmd->toSend())) {
+        cmd->toSend().concat();
+        auto swCompressed = compressorManager.compressMessage(cmd->toSend());
+        if (!swCompressed.isOK()) {
+            return _completeOperation(op, swCompressed.getStatus());
+        }
+        cmd->toSend() = std::move(swCompressed.getValue());
+    }
+
     asyncSendMessage(cmd->conn().stream(), &cmd->toSend(), std::move(sendMessageCallback));
 }
 
@@ -118,6 +118,7 @@ int ConfigDiffTracker<ValType>::calculateConfigDiff(OperationContext* txn,
     OID currEpoch = _maxVersion->epoch();
 
     _validDiffs = 0;
+    _changedRanges.clear();
 
     for (const ChunkType& chunk : chunks) {
         ChunkVersion chunkVersion =
@@ -134,6 +135,7 @@ int ConfigDiffTracker<ValType>::calculateConfigDiff(OperationContext* txn,
         }
 
         _validDiffs++;
+        _changedRanges.push_back(std::make_pair(chunk.getMin(), chunk.getMax()));
 
         // Get max changed version and chunk version
         if (chunkVersion > *_maxVersion) {
@@ -29,6 +29,8 @@
 #pragma once
 
 #include <string>
+#include <utility>
+#include <vector>
 
 #include "mongo/bson/bsonmisc.h"
 #include "mongo/bson/bsonobj.h"
@@ -53,6 +55,9 @@ public:
         const BSONObj query;
         const BSONObj sort;
     };
+
+    // The [min, max) bounds of chunks, in the order the diffs were applied
+    typedef std::vector<std::pair<BSONObj, BSONObj>> ChangedRanges;
 };
 
 /**
@@ -102,6 +107,15 @@ public:
         return _validDiffs;
     }
 
+    /**
+     * Call after load for the bounds of every valid diff. Only the ranges which overlap these
+     * bounds were changed, so copies of the ranges made before the load are still accurate
+     * everywhere else.
+     */
+    const ChangedRanges& changedRanges() const {
+        return _changedRanges;
+    }
+
     // Applies changes to the config data from a vector of chunks passed in. Also includes minor
     // version changes for particular major-version chunks if explicitly specified.
     // Returns the number of diffs processed, or -1 if the diffs were inconsistent.
@@ -146,6 +160,7 @@ private:
 
     // Store for later use
     int _validDiffs;
+    ChangedRanges _changedRanges;
 };
 
 }  // namespace mongo
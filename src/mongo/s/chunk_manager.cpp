@@ -32,7 +32,9 @@
 
 #include "mongo/s/chunk_manager.h"
 
+#include <algorithm>
 #include <boost/next_prior.hpp>
+#include <cstring>
 #include <map>
 #include <set>
 
@@ -44,6 +46,7 @@
 #include "mongo/db/query/index_bounds_builder.h"
 #include "mongo/db/query/query_planner.h"
 #include "mongo/db/query/query_planner_common.h"
+#include "mongo/db/storage/key_string.h"
 #include "mongo/s/catalog/catalog_cache.h"
 #include "mongo/s/catalog/catalog_manager.h"
 #include "mongo/s/catalog/type_chunk.h"
@@ -62,6 +65,7 @@ namespace mongo {
 using std::make_pair;
 using std::map;
 using std::max;
+using std::min;
 using std::pair;
 using std::set;
 using std::shared_ptr;
@@ -71,6 +75,12 @@ using std::vector;
 
 namespace {
 
+// Chunk bounds are ordered by BSONObjCmp, which compares every field in ascending order.
+const Ordering kChunkBoundOrdering = Ordering::make(BSONObj());
+
+// The number of chunks whose maxes a block of the routing table holds when it is first encoded.
+const size_t kRoutingTableBlockSize = 128;
+
 /**
  * This is an adapter so we can use config diffs - mongos and mongod do them slightly
  * differently
@@ -116,7 +126,34 @@ bool allOfType(BSONType type, const BSONObj& o) {
     return true;
 }
 
-bool isChunkMapValid(const ChunkMap& chunkMap) {
+// Checks that each chunk in [begin, end) starts where the chunk before it in 'chunkMap' ends.
+bool areChunksContiguous(const ChunkMap& chunkMap,
+                         ChunkMap::const_iterator begin,
+                         const ChunkMap::const_iterator end) {
+    for (ChunkMap::const_iterator it = begin; it != end; ++it) {
+        if (it == chunkMap.begin()) {
+            continue;
+        }
+
+        ChunkMap::const_iterator last = boost::prior(it);
+        if (!(it->second->getMin() == last->second->getMax())) {
+            log() << last->second->toString();
+            log() << it->second->toString();
+            log() << it->second->getMin();
+            log() << last->second->getMax();
+            return false;
+        }
+    }
+
+    return true;
+}
+
+/**
+ * If 'changedRanges' is not null, 'chunkMap' must be a copy of a valid map with the diffs of
+ * 'changedRanges' applied, and only the chunks around those ranges are checked.
+ */
+bool isChunkMapValid(const ChunkMap& chunkMap,
+                     const ConfigDiffTrackerBase::ChangedRanges* changedRanges) {
 #define ENSURE(x)                                          \
     do {                                                   \
         if (!(x)) {                                        \
@@ -134,19 +171,17 @@ bool isChunkMapValid(const ChunkMap& chunkMap) {
     ENSURE(allOfType(MaxKey, boost::prior(chunkMap.end())->second->getMax()));
 
     // Make sure there are no gaps or overlaps
-    for (ChunkMap::const_iterator it = boost::next(chunkMap.begin()), end = chunkMap.end();
-         it != end;
-         ++it) {
-        ChunkMap::const_iterator last = boost::prior(it);
+    if (!changedRanges) {
+        ENSURE(areChunksContiguous(chunkMap, chunkMap.begin(), chunkMap.end()));
+        return true;
+    }
 
-        if (!(it->second->getMin() == last->second->getMax())) {
-            log() << last->second->toString();
-            log() << it->second->toString();
-            log() << it->second->getMin();
-            log() << last->second->getMax();
+    for (const auto& range : *changedRanges) {
+        ChunkMap::const_iterator end = chunkMap.upper_bound(range.second);
+        if (end != chunkMap.end()) {
+            ++end;
         }
-
-        ENSURE(it->second->getMin() == last->second->getMax());
+        ENSURE(areChunksContiguous(chunkMap, chunkMap.upper_bound(range.first), end));
     }
 
     return true;
@@ -182,23 +217,37 @@ void ChunkManager::loadExistingRanges(OperationContext* txn, const ChunkManager*
         ChunkMap chunkMap;
         set<ShardId> shardIds;
         ShardVersionMap shardVersions;
+        ConfigDiffTrackerBase::ChangedRanges changedRanges;
 
         Timer t;
 
-        bool success = _load(txn, chunkMap, shardIds, &shardVersions, oldManager);
+        bool success =
+            _load(txn, chunkMap, shardIds, &shardVersions, oldManager, &changedRanges);
         if (success) {
             log() << "ChunkManager: time to load chunks for " << _ns << ": " << t.millis() << "ms"
                   << " sequenceNumber: " << _sequenceNumber << " version: " << _version.toString()
                   << " based on: "
                   << (oldManager ? oldManager->getVersion().toString() : "(empty)");
 
+            // Chunks loaded on top of a copy of the old manager's chunks only changed within the
+            // diffs, so only those parts need to be validated and re-encoded for routing.
+            const bool incremental = oldManager && oldManager->getVersion().isSet() &&
+                !chunkMap.empty() && !oldManager->_chunkMap.empty();
+
             // TODO: Merge into diff code above, so we validate in one place
-            if (isChunkMapValid(chunkMap)) {
+            if (isChunkMapValid(chunkMap, incremental ? &changedRanges : nullptr)) {
                 _chunkMap.swap(chunkMap);
                 _shardIds.swap(shardIds);
                 _shardVersions.swap(shardVersions);
                 _chunkRanges.reloadAll(_chunkMap);
 
+                if (incremental) {
+                    _routingTable.reloadChanged(
+                        oldManager->_routingTable, _chunkMap, changedRanges);
+                } else {
+                    _routingTable.reloadAll(_chunkMap);
+                }
+
                 return;
             }
         }
@@ -222,7 +271,8 @@ bool ChunkManager::_load(OperationContext* txn,
                          ChunkMap& chunkMap,
                          set<ShardId>& shardIds,
                          ShardVersionMap* shardVersions,
-                         const ChunkManager* oldManager) {
+                         const ChunkManager* oldManager,
+                         ConfigDiffTrackerBase::ChangedRanges* changedRanges) {
     // Reset the max version, but not the epoch, when we aren't loading from the oldManager
     _version = ChunkVersion(0, 0, _version.epoch());
 
@@ -241,6 +291,8 @@ bool ChunkManager::_load(OperationContext* txn,
         // Could be v.expensive
         // TODO: If chunks were immutable and didn't reference the manager, we could do more
         // interesting things here
+        //
+        // The old chunks are visited in order, so each one is appended without comparing keys.
         for (const auto& oldChunkMapEntry : oldChunkMap) {
             shared_ptr<Chunk> oldC = oldChunkMapEntry.second;
             shared_ptr<Chunk> newC(new Chunk(
@@ -248,7 +300,7 @@ bool ChunkManager::_load(OperationContext* txn,
 
             newC->setBytesWritten(oldC->getBytesWritten());
 
-            chunkMap.insert(make_pair(oldC->getMax(), newC));
+            chunkMap.emplace_hint(chunkMap.end(), oldC->getMax(), std::move(newC));
         }
 
         LOG(2) << "loading chunk manager for collection " << _ns
@@ -277,6 +329,8 @@ bool ChunkManager::_load(OperationContext* txn,
         LOG(2) << "loaded " << diffsApplied << " chunks into new chunk manager for " << _ns
                << " with version " << _version;
 
+        *changedRanges = differ.changedRanges();
+
         // Add all existing shards we find to the shards set
         for (ShardVersionMap::iterator it = shardVersions->begin(); it != shardVersions->end();) {
             shared_ptr<Shard> shard = grid.shardRegistry()->getShard(txn, it->first);
@@ -446,22 +500,14 @@ Status ChunkManager::createFirstChunks(OperationContext* txn,
 
 ChunkPtr ChunkManager::findIntersectingChunk(OperationContext* txn, const BSONObj& shardKey) const {
     {
-        BSONObj chunkMin;
-        ChunkPtr chunk;
-        {
-            ChunkMap::const_iterator it = _chunkMap.upper_bound(shardKey);
-            if (it != _chunkMap.end()) {
-                chunkMin = it->first;
-                chunk = it->second;
-            }
-        }
+        ChunkPtr chunk = _routingTable.upperBound(shardKey);
 
         if (chunk) {
             if (chunk->containsKey(shardKey)) {
                 return chunk;
             }
 
-            log() << chunkMin;
+            log() << chunk->getMax();
             log() << *chunk;
             log() << shardKey;
 
@@ -476,6 +522,20 @@ ChunkPtr ChunkManager::findIntersectingChunk(OperationContext* txn, const BSONOb
                               << ", number of chunks: " << _chunkMap.size());
 }
 
+void ChunkManager::findIntersectingChunks(OperationContext* txn,
+                                          const vector<BSONObj>& shardKeys,
+                                          vector<ChunkPtr>* chunks) const {
+    _routingTable.upperBounds(shardKeys, chunks);
+
+    for (size_t i = 0; i < shardKeys.size(); ++i) {
+        const ChunkPtr& chunk = (*chunks)[i];
+        if (!chunk || !chunk->containsKey(shardKeys[i])) {
+            // Report the failure exactly as a single lookup would.
+            (*chunks)[i] = findIntersectingChunk(txn, shardKeys[i]);
+        }
+    }
+}
+
 void ChunkManager::getShardIdsForQuery(OperationContext* txn,
                                        const BSONObj& query,
                                        set<ShardId>* shardIds) const {
@@ -803,8 +863,231 @@ void ChunkRangeManager::_insertRange(ChunkMap::const_iterator begin,
             ++begin;
 
         shared_ptr<ChunkRange> cr(new ChunkRange(first, begin));
-        _ranges[cr->getMax()] = cr;
+        _ranges.emplace_hint(_ranges.end(), cr->getMax(), cr);
+    }
+}
+
+void ChunkRoutingTable::clear() {
+    _blocks.clear();
+    _blockStarts.assign(1, 0);
+    _chunks.clear();
+}
+
+void ChunkRoutingTable::reloadAll(const ChunkMap& chunks) {
+    clear();
+    _chunks.reserve(chunks.size());
+
+    ChunkMap::const_iterator it = chunks.begin();
+    _encodeChunks(&it, chunks.end(), nullptr);
+}
+
+void ChunkRoutingTable::reloadChanged(const ChunkRoutingTable& previous,
+                                      const ChunkMap& chunks,
+                                      const ConfigDiffTrackerBase::ChangedRanges& changedRanges) {
+    invariant(this != &previous);
+
+    // A diff replaces the chunks whose max is in (min, max] with chunks whose max is in the same
+    // interval. All of them are in the blocks from the first whose last max is greater than min
+    // to the first whose last max is greater than max, so every other block is unchanged.
+    const size_t numBlocks = previous._blocks.size();
+    vector<bool> changed(numBlocks, false);
+
+    KeyString encoded;
+    for (const auto& range : changedRanges) {
+        encoded.resetToKey(range.first, kChunkBoundOrdering);
+        const size_t first =
+            previous._findBlock(encoded.getBuffer(), encoded.getSize(), 0, numBlocks);
+
+        encoded.resetToKey(range.second, kChunkBoundOrdering);
+        const size_t last =
+            previous._findBlock(encoded.getBuffer(), encoded.getSize(), first, numBlocks);
+
+        for (size_t i = first; i <= last && i < numBlocks; ++i) {
+            changed[i] = true;
+        }
+    }
+
+    clear();
+    _chunks.reserve(chunks.size());
+
+    ChunkMap::const_iterator it = chunks.begin();
+    for (size_t i = 0; i < numBlocks; ++i) {
+        if (!changed[i]) {
+            if (!_appendBlock(previous._blocks[i], &it, chunks.end())) {
+                break;
+            }
+            continue;
+        }
+
+        // Re-encode the run of changed blocks as a whole, since its number of chunks may differ.
+        size_t last = i;
+        while (last + 1 < numBlocks && changed[last + 1]) {
+            ++last;
+        }
+
+        _encodeChunks(
+            &it, chunks.end(), last + 1 < numBlocks ? previous._blocks[last].get() : nullptr);
+        i = last;
+    }
+
+    if (it != chunks.end() || _chunks.size() != chunks.size()) {
+        // The chunks did not change only where the diffs said, which is unexpected but harmless.
+        warning() << "routing table for " << chunks.size() << " chunks could not be refreshed "
+                  << "from " << changedRanges.size() << " diffs, reloading all chunks";
+        reloadAll(chunks);
+    }
+}
+
+ChunkPtr ChunkRoutingTable::upperBound(const BSONObj& shardKey) const {
+    const KeyString key(shardKey, kChunkBoundOrdering);
+    const size_t i = _findBlock(key.getBuffer(), key.getSize(), 0, _blocks.size());
+    return i < _blocks.size() ? _upperBoundInBlock(i, key.getBuffer(), key.getSize())
+                              : ChunkPtr();
+}
+
+void ChunkRoutingTable::upperBounds(const vector<BSONObj>& shardKeys,
+                                    vector<ChunkPtr>* chunks) const {
+    chunks->assign(shardKeys.size(), ChunkPtr());
+
+    // Encode every key up front so that sorting them compares bytes too.
+    string keys;
+    vector<size_t> keyOffsets;
+    keyOffsets.reserve(shardKeys.size() + 1);
+    keyOffsets.push_back(0);
+    KeyString encoded;
+    for (const auto& shardKey : shardKeys) {
+        encoded.resetToKey(shardKey, kChunkBoundOrdering);
+        keys.append(encoded.getBuffer(), encoded.getSize());
+        keyOffsets.push_back(keys.size());
+    }
+
+    vector<size_t> order(shardKeys.size());
+    for (size_t i = 0; i < order.size(); ++i) {
+        order[i] = i;
+    }
+    std::sort(order.begin(), order.end(), [&](size_t lhs, size_t rhs) {
+        const size_t lhsSize = keyOffsets[lhs + 1] - keyOffsets[lhs];
+        const size_t rhsSize = keyOffsets[rhs + 1] - keyOffsets[rhs];
+        const int cmp = memcmp(
+            keys.data() + keyOffsets[lhs], keys.data() + keyOffsets[rhs], min(lhsSize, rhsSize));
+        return cmp < 0 || (cmp == 0 && lhsSize < rhsSize);
+    });
+
+    // The keys are visited in increasing order, so each one's block is at or after the previous
+    // one's. Gallop forward from there to bracket it, then binary search within the bracket, so
+    // that both dense and sparse batches take few comparisons.
+    size_t pos = 0;
+    const size_t numBlocks = _blocks.size();
+    for (size_t i : order) {
+        const char* key = keys.data() + keyOffsets[i];
+        const size_t size = keyOffsets[i + 1] - keyOffsets[i];
+
+        size_t begin = pos;
+        size_t end = pos;
+        size_t step = 1;
+        while (end < numBlocks &&
+               _blocks[end]->compareMax(_blocks[end]->size() - 1, key, size) <= 0) {
+            begin = end + 1;
+            end = begin + step;
+            step *= 2;
+        }
+
+        pos = _findBlock(key, size, begin, min(end + 1, numBlocks));
+        if (pos < numBlocks) {
+            (*chunks)[i] = _upperBoundInBlock(pos, key, size);
+        }
+    }
+}
+
+bool ChunkRoutingTable::_appendBlock(const shared_ptr<const Block>& block,
+                                     ChunkMap::const_iterator* it,
+                                     const ChunkMap::const_iterator end) {
+    for (size_t i = 0; i < block->size(); ++i, ++*it) {
+        if (*it == end) {
+            return false;
+        }
+        _chunks.push_back((*it)->second);
+    }
+
+    _blocks.push_back(block);
+    _blockStarts.push_back(_chunks.size());
+    return true;
+}
+
+void ChunkRoutingTable::_encodeChunks(ChunkMap::const_iterator* it,
+                                      const ChunkMap::const_iterator end,
+                                      const Block* last) {
+    auto block = std::make_shared<Block>();
+    const auto finishBlock = [&] {
+        _blocks.push_back(std::move(block));
+        _blockStarts.push_back(_chunks.size());
+        block = std::make_shared<Block>();
+    };
+
+    KeyString encoded;
+    for (; *it != end; ++*it) {
+        encoded.resetToKey((*it)->first, kChunkBoundOrdering);
+        if (last &&
+            last->compareMax(last->size() - 1, encoded.getBuffer(), encoded.getSize()) < 0) {
+            break;
+        }
+
+        if (block->size() == kRoutingTableBlockSize) {
+            finishBlock();
+        }
+
+        block->keys.append(encoded.getBuffer(), encoded.getSize());
+        block->offsets.push_back(block->keys.size());
+        _chunks.push_back((*it)->second);
+    }
+
+    if (block->size() > 0) {
+        finishBlock();
+    }
+}
+
+size_t ChunkRoutingTable::_findBlock(const char* key,
+                                     size_t size,
+                                     size_t begin,
+                                     size_t end) const {
+    while (begin < end) {
+        const size_t mid = begin + (end - begin) / 2;
+        const Block& block = *_blocks[mid];
+        if (block.compareMax(block.size() - 1, key, size) <= 0) {
+            begin = mid + 1;
+        } else {
+            end = mid;
+        }
+    }
+    return begin;
+}
+
+ChunkPtr ChunkRoutingTable::_upperBoundInBlock(size_t i, const char* key, size_t size) const {
+    return _chunks[_blockStarts[i] + _blocks[i]->upperBound(key, size)];
+}
+
+int ChunkRoutingTable::Block::compareMax(size_t i, const char* key, size_t size) const {
+    const char* maxKey = keys.data() + offsets[i];
+    const size_t maxSize = offsets[i + 1] - offsets[i];
+    const int cmp = memcmp(maxKey, key, min(maxSize, size));
+    if (cmp != 0) {
+        return cmp;
+    }
+    return maxSize < size ? -1 : maxSize > size ? 1 : 0;
+}
+
+size_t ChunkRoutingTable::Block::upperBound(const char* key, size_t size) const {
+    size_t begin = 0;
+    size_t end = this->size();
+    while (begin < end) {
+        const size_t mid = begin + (end - begin) / 2;
+        if (compareMax(mid, key, size) <= 0) {
+            begin = mid + 1;
+        } else {
+            end = mid;
+        }
     }
+    return begin;
 }
 
 int ChunkManager::getCurrentDesiredChunkSize() const {
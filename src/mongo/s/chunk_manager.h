@@ -34,6 +34,7 @@
 
 #include "mongo/db/repl/optime.h"
 #include "mongo/s/chunk.h"
+#include "mongo/s/chunk_diff.h"
 #include "mongo/s/shard_key_pattern.h"
 #include "mongo/util/concurrency/ticketholder.h"
 
@@ -120,6 +121,88 @@ private:
     ChunkRangeMap _ranges;
 };
 
+/**
+ * The chunks of a collection ordered by their max key, for routing shard keys. The max keys are
+ * encoded as KeyStrings and stored back to back in blocks of contiguous memory, so that a lookup
+ * is a binary search of memcmp() comparisons rather than a walk of a ChunkMap comparing BSON.
+ *
+ * The blocks are immutable and shared between the routing tables of successive ChunkManagers, so
+ * refreshing a table after a diff re-encodes only the blocks the diff touched.
+ */
+class ChunkRoutingTable {
+public:
+    void clear();
+
+    void reloadAll(const ChunkMap& chunks);
+
+    /**
+     * Like reloadAll(), for 'chunks' which differ from the chunks 'previous' was loaded from only
+     * within 'changedRanges'. Blocks of 'previous' outside of those ranges are shared rather than
+     * re-encoded.
+     */
+    void reloadChanged(const ChunkRoutingTable& previous,
+                       const ChunkMap& chunks,
+                       const ConfigDiffTrackerBase::ChangedRanges& changedRanges);
+
+    /**
+     * Returns the first chunk whose max is greater than 'shardKey', or an empty pointer if there
+     * is none. If the chunks are valid this is the chunk which contains 'shardKey'.
+     */
+    ChunkPtr upperBound(const BSONObj& shardKey) const;
+
+    /**
+     * Like upperBound() for each of 'shardKeys', filling 'chunks' in the same order. The keys are
+     * encoded and sorted, then resolved in a single forward pass over the table.
+     */
+    void upperBounds(const std::vector<BSONObj>& shardKeys, std::vector<ChunkPtr>* chunks) const;
+
+private:
+    // The encoded max keys of a run of consecutive chunks. The max of the i-th chunk of the run
+    // is keys[offsets[i], offsets[i + 1]).
+    struct Block {
+        size_t size() const {
+            return offsets.size() - 1;
+        }
+
+        // Compares the max of chunk 'i' of the run with the encoded key 'key' of 'size' bytes,
+        // like memcmp().
+        int compareMax(size_t i, const char* key, size_t size) const;
+
+        // Returns the index of the first chunk of the run whose max is greater than the encoded
+        // key 'key' of 'size' bytes.
+        size_t upperBound(const char* key, size_t size) const;
+
+        std::string keys;
+        std::vector<uint32_t> offsets{0};
+    };
+
+    // Appends 'block', which holds the maxes of the next block->size() chunks from 'it' onwards,
+    // and advances 'it' past those chunks. Returns false if there are fewer chunks than that.
+    bool _appendBlock(const std::shared_ptr<const Block>& block,
+                      ChunkMap::const_iterator* it,
+                      const ChunkMap::const_iterator end);
+
+    // Encodes the chunks from 'it' onwards into new blocks, up to and including the chunk whose
+    // max is the last max of 'last', or up to 'end' if 'last' is null.
+    void _encodeChunks(ChunkMap::const_iterator* it,
+                       const ChunkMap::const_iterator end,
+                       const Block* last);
+
+    // Returns the index of the first block in [begin, end) whose last max is greater than the
+    // encoded key 'key' of 'size' bytes, or 'end' if there is none.
+    size_t _findBlock(const char* key, size_t size, size_t begin, size_t end) const;
+
+    // Returns the chunk of block 'i' which is the first whose max is greater than the encoded key
+    // 'key' of 'size' bytes. The last max of the block must be greater than the key.
+    ChunkPtr _upperBoundInBlock(size_t i, const char* key, size_t size) const;
+
+    std::vector<std::shared_ptr<const Block>> _blocks;
+
+    // The chunks of _blocks[i] are _chunks[_blockStarts[i], _blockStarts[i + 1]).
+    std::vector<size_t> _blockStarts{0};
+    std::vector<ChunkPtr> _chunks;
+};
+
 
 /* config.sharding
      { ns: 'alleyinsider.fs.chunks' ,
@@ -196,6 +279,14 @@ public:
      */
     ChunkPtr findIntersectingChunk(OperationContext* txn, const BSONObj& shardKey) const;
 
+    /**
+     * Like findIntersectingChunk() for each of 'shardKeys', filling 'chunks' in the same order.
+     * Resolving many keys together is cheaper than resolving them one at a time.
+     */
+    void findIntersectingChunks(OperationContext* txn,
+                                const std::vector<BSONObj>& shardKeys,
+                                std::vector<ChunkPtr>* chunks) const;
+
     void getShardIdsForQuery(OperationContext* txn,
                              const BSONObj& query,
                              std::set<ShardId>* shardIds) const;
@@ -260,7 +351,8 @@ private:
                ChunkMap& chunks,
                std::set<ShardId>& shardIds,
                ShardVersionMap* shardVersions,
-               const ChunkManager* oldManager);
+               const ChunkManager* oldManager,
+               ConfigDiffTrackerBase::ChangedRanges* changedRanges);
 
 
     // All members should be const for thread-safety
@@ -275,6 +367,7 @@ private:
 
     ChunkMap _chunkMap;
     ChunkRangeManager _chunkRanges;
+    ChunkRoutingTable _routingTable;
 
     std::set<ShardId> _shardIds;
 
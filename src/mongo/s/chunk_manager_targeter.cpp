@@ -289,24 +289,7 @@ Status ChunkManagerTargeter::targetInsert(OperationContext* txn,
     BSONObj shardKey;
 
     if (_manager) {
-        //
-        // Sharded collections have the following requirements for targeting:
-        //
-        // Inserts must contain the exact shard key.
-        //
-
-        shardKey = _manager->getShardKeyPattern().extractShardKeyFromDoc(doc);
-
-        // Check shard key exists
-        if (shardKey.isEmpty()) {
-            return Status(ErrorCodes::ShardKeyNotFound,
-                          stream() << "document " << doc
-                                   << " does not contain shard key for pattern "
-                                   << _manager->getShardKeyPattern().toString());
-        }
-
-        // Check shard key size on insert
-        Status status = ShardKeyPattern::checkShardKeySize(shardKey);
+        Status status = extractInsertShardKey(doc, &shardKey);
         if (!status.isOK())
             return status;
     }
@@ -326,6 +309,57 @@ Status ChunkManagerTargeter::targetInsert(OperationContext* txn,
     }
 }
 
+void ChunkManagerTargeter::targetInserts(OperationContext* txn,
+                                         const vector<BSONObj>& docs,
+                                         vector<ShardEndpoint*>* endpoints,
+                                         vector<Status>* statuses) const {
+    _targetedInserts.clear();
+    if (!_manager) {
+        NSTargeter::targetInserts(txn, docs, endpoints, statuses);
+        return;
+    }
+
+    endpoints->assign(docs.size(), NULL);
+    statuses->assign(docs.size(), Status::OK());
+    _targetedInserts.assign(docs.size(), std::make_pair(BSONObj(), 0));
+
+    vector<BSONObj> shardKeys;
+    vector<size_t> docIndexes;
+    shardKeys.reserve(docs.size());
+    docIndexes.reserve(docs.size());
+    for (size_t i = 0; i < docs.size(); ++i) {
+        BSONObj shardKey;
+        Status status = extractInsertShardKey(docs[i], &shardKey);
+        if (!status.isOK()) {
+            (*statuses)[i] = status;
+            continue;
+        }
+        shardKeys.push_back(shardKey);
+        docIndexes.push_back(i);
+    }
+
+    vector<ChunkPtr> chunks;
+    _manager->findIntersectingChunks(txn, shardKeys, &chunks);
+
+    for (size_t i = 0; i < chunks.size(); ++i) {
+        const ChunkPtr& chunk = chunks[i];
+        const size_t docIndex = docIndexes[i];
+
+        _targetedInserts[docIndex] = std::make_pair(chunk->getMin(), docs[docIndex].objsize());
+
+        (*endpoints)[docIndex] =
+            new ShardEndpoint(chunk->getShardId(), _manager->getVersion(chunk->getShardId()));
+    }
+}
+
+void ChunkManagerTargeter::noteInsertDispatched(size_t index) const {
+    if (index >= _targetedInserts.size() || _targetedInserts[index].first.isEmpty())
+        return;
+
+    // Track autosplit stats, as targetShardKey() does.
+    _stats->chunkSizeDelta[_targetedInserts[index].first] += _targetedInserts[index].second;
+}
+
 Status ChunkManagerTargeter::targetUpdate(OperationContext* txn,
                                           const BatchedUpdateDocument& updateDoc,
                                           vector<ShardEndpoint*>* endpoints) const {
@@ -505,6 +539,28 @@ Status ChunkManagerTargeter::targetQuery(OperationContext* txn,
     return Status::OK();
 }
 
+Status ChunkManagerTargeter::extractInsertShardKey(const BSONObj& doc, BSONObj* shardKey) const {
+    invariant(NULL != _manager);
+
+    //
+    // Sharded collections have the following requirements for targeting:
+    //
+    // Inserts must contain the exact shard key.
+    //
+
+    *shardKey = _manager->getShardKeyPattern().extractShardKeyFromDoc(doc);
+
+    // Check shard key exists
+    if (shardKey->isEmpty()) {
+        return Status(ErrorCodes::ShardKeyNotFound,
+                      stream() << "document " << doc << " does not contain shard key for pattern "
+                               << _manager->getShardKeyPattern().toString());
+    }
+
+    // Check shard key size on insert
+    return ShardKeyPattern::checkShardKeySize(*shardKey);
+}
+
 Status ChunkManagerTargeter::targetShardKey(OperationContext* txn,
                                             const BSONObj& shardKey,
                                             long long estDataSize,
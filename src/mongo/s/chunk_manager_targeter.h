@@ -70,6 +70,15 @@ public:
     // Returns ShardKeyNotFound if document does not have a full shard key.
     Status targetInsert(OperationContext* txn, const BSONObj& doc, ShardEndpoint** endpoint) const;
 
+    // Finds the chunks of all of the documents' shard keys at once. The documents are only
+    // counted towards their chunk's size once noteInsertDispatched() is called for them.
+    void targetInserts(OperationContext* txn,
+                       const std::vector<BSONObj>& docs,
+                       std::vector<ShardEndpoint*>* endpoints,
+                       std::vector<Status>* statuses) const;
+
+    void noteInsertDispatched(size_t index) const;
+
     // Returns ShardKeyNotFound if the update can't be targeted without a shard key.
     Status targetUpdate(OperationContext* txn,
                         const BatchedUpdateDocument& updateDoc,
@@ -147,6 +156,12 @@ private:
                           long long estDataSize,
                           ShardEndpoint** endpoint) const;
 
+    /**
+     * Extracts the shard key of a document to be inserted into a sharded collection, checking
+     * that it is complete and not too large.
+     */
+    Status extractInsertShardKey(const BSONObj& doc, BSONObj* shardKey) const;
+
     // Full namespace of the collection for this targeter
     const NamespaceString _nss;
 
@@ -156,6 +171,11 @@ private:
     // Represents only the view and not really part of the targeter state. This is not owned here.
     TargeterStats* _stats;
 
+    // The chunk min key and size of each document targeted by the last call to targetInserts(),
+    // or an empty key if the document could not be targeted. Added to _stats when the document
+    // is dispatched.
+    mutable std::vector<std::pair<BSONObj, int>> _targetedInserts;
+
     // Zero or one of these are filled at all times
     // If sharded, _manager, if unsharded, _primary, on error, neither
     std::shared_ptr<ChunkManager> _manager;
@@ -30,6 +30,7 @@
 
 #include "mongo/db/commands/server_status_metric.h"
 #include "mongo/s/grid.h"
+#include "mongo/s/query/async_results_merger.h"
 
 namespace mongo {
 namespace {
@@ -55,5 +56,25 @@ public:
     }
 } clusterCursorStats;
 
+//
+// ServerStatus metric for how well getMores to the shards are overlapped with returning results.
+//
+
+class ClusterCursorPrefetchStats final : public ServerStatusMetric {
+public:
+    ClusterCursorPrefetchStats() : ServerStatusMetric("cursor.prefetch") {}
+
+    void appendAtLeaf(BSONObjBuilder& b) const final {
+        BSONObjBuilder prefetchBob(b.subobjStart(_leafName));
+        auto stats = AsyncResultsMerger::getPrefetchStats();
+
+        prefetchBob.append("requests", stats.requests);
+        prefetchBob.append("hits", stats.hits);
+        prefetchBob.append("stalls", stats.stalls);
+        prefetchBob.append("stallMicros", stats.stallMicros);
+        prefetchBob.done();
+    }
+} clusterCursorPrefetchStats;
+
 }  // namespace
 }  // namespace mongo
@@ -29,6 +29,7 @@
 #pragma once
 
 #include <string>
+#include <vector>
 
 #include "mongo/bson/bsonobj.h"
 #include "mongo/base/status.h"
@@ -86,6 +87,32 @@ public:
                                 const BSONObj& doc,
                                 ShardEndpoint** endpoint) const = 0;
 
+    /**
+     * Targets the insert of each of 'docs' as targetInsert() would, filling 'endpoints' and
+     * 'statuses' in the same order. The endpoint of a document which could not be targeted is
+     * NULL. The caller owns the returned endpoints.
+     *
+     * Targeters which can target many documents more cheaply together than one at a time should
+     * override this.
+     */
+    virtual void targetInserts(OperationContext* txn,
+                               const std::vector<BSONObj>& docs,
+                               std::vector<ShardEndpoint*>* endpoints,
+                               std::vector<Status>* statuses) const {
+        for (const auto& doc : docs) {
+            ShardEndpoint* endpoint = NULL;
+            statuses->push_back(targetInsert(txn, doc, &endpoint));
+            endpoints->push_back(endpoint);
+        }
+    }
+
+    /**
+     * Notes that the document at 'index' in the last call to targetInserts() is being sent to its
+     * endpoint. Documents which are not sent in this round are targeted again in a later one, so
+     * targeters which keep statistics about the targeted documents should count them here.
+     */
+    virtual void noteInsertDispatched(size_t index) const {}
+
     /**
      * Returns a vector of ShardEndpoints for a potentially multi-shard update.
      *
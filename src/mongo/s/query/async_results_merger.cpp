@@ -32,12 +32,16 @@
 
 #include "mongo/s/query/async_results_merger.h"
 
+#include <algorithm>
+
 #include "mongo/client/remote_command_targeter.h"
 #include "mongo/db/query/cursor_response.h"
 #include "mongo/db/query/getmore_request.h"
 #include "mongo/db/query/killcursors_request.h"
+#include "mongo/db/server_parameters.h"
 #include "mongo/executor/remote_command_request.h"
 #include "mongo/executor/remote_command_response.h"
+#include "mongo/platform/atomic_word.h"
 #include "mongo/rpc/metadata/server_selection_metadata.h"
 #include "mongo/s/client/shard_registry.h"
 #include "mongo/s/grid.h"
@@ -46,13 +50,39 @@
 #include "mongo/util/scopeguard.h"
 
 namespace mongo {
+
+MONGO_EXPORT_SERVER_PARAMETER(internalQueryMongosPrefetchResults, bool, true);
+MONGO_EXPORT_SERVER_PARAMETER(internalQueryMongosPrefetchMaxBytes, int, 32 * 1024 * 1024);
+
 namespace {
 
 // Maximum number of retries for network and replication notMaster errors (per host).
 const int kMaxNumFailedHostRetryAttempts = 3;
 
+AtomicInt64 prefetchRequests;
+AtomicInt64 prefetchHits;
+AtomicInt64 stalls;
+AtomicInt64 stallMicros;
+
+/**
+ * Folds 'sample' into the moving average '*average', which weighs recent samples more heavily.
+ */
+void updateMovingAverage(long long* average, long long sample) {
+    sample = std::max(sample, 1LL);
+    *average = *average ? (*average * 7 + sample) / 8 : sample;
+}
+
 }  // namespace
 
+AsyncResultsMerger::PrefetchStats AsyncResultsMerger::getPrefetchStats() {
+    PrefetchStats stats;
+    stats.requests = prefetchRequests.load();
+    stats.hits = prefetchHits.load();
+    stats.stalls = stalls.load();
+    stats.stallMicros = stallMicros.load();
+    return stats;
+}
+
 AsyncResultsMerger::AsyncResultsMerger(executor::TaskExecutor* executor,
                                        ClusterClientCursorParams&& params)
     : _executor(executor),
@@ -220,6 +250,7 @@ boost::optional<BSONObj> AsyncResultsMerger::nextReadySorted() {
         _mergeQueue.push(smallestRemote);
     }
 
+    resultConsumed_inlock(smallestRemote, front);
     return front;
 }
 
@@ -240,6 +271,7 @@ boost::optional<BSONObj> AsyncResultsMerger::nextReadyUnsorted() {
                 _eofNext = true;
             }
 
+            resultConsumed_inlock(_gettingFromRemote, front);
             return front;
         }
 
@@ -253,6 +285,58 @@ boost::optional<BSONObj> AsyncResultsMerger::nextReadyUnsorted() {
     return boost::none;
 }
 
+void AsyncResultsMerger::resultConsumed_inlock(size_t remoteIndex, const BSONObj& obj) {
+    auto& remote = _remotes[remoteIndex];
+
+    remote.bufferedBytes -= obj.objsize();
+    _bufferedBytes -= obj.objsize();
+
+    const auto now = curTimeMicros64();
+    if (remote.lastConsumedMicros) {
+        updateMovingAverage(&remote.consumeIntervalMicros, now - remote.lastConsumedMicros);
+    }
+    remote.lastConsumedMicros = now;
+
+    if (!shouldPrefetch_inlock(remoteIndex)) {
+        return;
+    }
+
+    // If the request can't be scheduled, nextEvent() will try again once the buffer is drained and
+    // report the error then.
+    if (askForNextBatch_inlock(remoteIndex).isOK()) {
+        remote.prefetching = true;
+        prefetchRequests.fetchAndAdd(1);
+    }
+}
+
+bool AsyncResultsMerger::shouldPrefetch_inlock(size_t remoteIndex) {
+    const auto& remote = _remotes[remoteIndex];
+
+    // Batches from tailable cursors are passed through to the client as they arrive.
+    if (!internalQueryMongosPrefetchResults.load() || _params.isTailable) {
+        return false;
+    }
+
+    // An empty buffer is refilled by nextEvent().
+    if (!remote.hasNext() || !remote.cursorId || remote.exhausted() ||
+        remote.cbHandle.isValid() || !remote.status.isOK()) {
+        return false;
+    }
+
+    if (_bufferedBytes >= internalQueryMongosPrefetchMaxBytes.load()) {
+        return false;
+    }
+
+    // Wait until there are timings to go by.
+    if (!remote.roundTripMicros || !remote.consumeIntervalMicros) {
+        return false;
+    }
+
+    const long long drainMicros =
+        static_cast<long long>(remote.docBuffer.size()) * remote.consumeIntervalMicros;
+    return drainMicros <= remote.roundTripMicros;
+}
+
 Status AsyncResultsMerger::askForNextBatch_inlock(size_t remoteIndex) {
     auto& remote = _remotes[remoteIndex];
 
@@ -301,6 +385,7 @@ Status AsyncResultsMerger::askForNextBatch_inlock(size_t remoteIndex) {
     }
 
     remote.cbHandle = callbackStatus.getValue();
+    remote.requestSentMicros = curTimeMicros64();
     return Status::OK();
 }
 
@@ -350,6 +435,11 @@ StatusWith<executor::TaskExecutor::EventHandle> AsyncResultsMerger::nextEvent()
     // away so that the caller will not block.
     signalCurrentEventIfReady_inlock();
 
+    // Tailable cursors are expected to wait for results, so only time the waits of other cursors.
+    if (_currentEvent.isValid() && !_params.isTailable) {
+        _stallStartMicros = curTimeMicros64();
+    }
+
     return eventToReturn;
 }
 
@@ -384,6 +474,9 @@ void AsyncResultsMerger::handleBatchResponse(
     // 'remote'.
     remote.cbHandle = executor::TaskExecutor::CallbackHandle();
 
+    const bool wasPrefetch = remote.prefetching;
+    remote.prefetching = false;
+
     // If we're in the process of shutting down then there's no need to process the batch.
     if (_lifecycleState != kAlive) {
         invariant(_lifecycleState == kKillStarted);
@@ -468,9 +561,8 @@ void AsyncResultsMerger::handleBatchResponse(
         if (_params.isAllowPartialResults) {
             remote.status = Status::OK();
 
-            // Clear the results buffer and cursor id.
-            std::queue<BSONObj> emptyBuffer;
-            std::swap(remote.docBuffer, emptyBuffer);
+            // Results buffered before a failed prefetch are still returned, but the cursor id is
+            // cleared so that the remote is not asked for any more.
             remote.cursorId = 0;
         }
 
@@ -481,6 +573,13 @@ void AsyncResultsMerger::handleBatchResponse(
     auto cursorResponse = std::move(cursorResponseStatus.getValue());
     remote.cursorId = cursorResponse.getCursorId();
     remote.initialCmdObj = boost::none;
+    updateMovingAverage(&remote.roundTripMicros, curTimeMicros64() - remote.requestSentMicros);
+
+    // If the remote still has results buffered, it is already on the merge queue.
+    const bool hadBufferedResults = remote.hasNext();
+    if (wasPrefetch && hadBufferedResults) {
+        prefetchHits.fetchAndAdd(1);
+    }
 
     for (const auto& obj : cursorResponse.getBatch()) {
         // If there's a sort, we're expecting the remote node to give us back a sort key.
@@ -495,11 +594,13 @@ void AsyncResultsMerger::handleBatchResponse(
 
         remote.docBuffer.push(obj);
         ++remote.fetchedCount;
+        remote.bufferedBytes += obj.objsize();
+        _bufferedBytes += obj.objsize();
     }
 
     // If we're doing a sorted merge, then we have to make sure to put this remote onto the
     // merge queue.
-    if (!_params.sort.isEmpty() && !cursorResponse.getBatch().empty()) {
+    if (!_params.sort.isEmpty() && !hadBufferedResults && !cursorResponse.getBatch().empty()) {
         _mergeQueue.push(remoteIndex);
     }
 
@@ -533,6 +634,12 @@ void AsyncResultsMerger::signalCurrentEventIfReady_inlock() {
         // invalid after signalling it.
         _executor->signalEvent(_currentEvent);
         _currentEvent = executor::TaskExecutor::EventHandle();
+
+        if (_stallStartMicros) {
+            stalls.fetchAndAdd(1);
+            stallMicros.fetchAndAdd(curTimeMicros64() - _stallStartMicros);
+            _stallStartMicros = 0;
+        }
     }
 }
 
@@ -28,6 +28,7 @@
 
 #pragma once
 
+#include <atomic>
 #include <boost/optional.hpp>
 #include <queue>
 #include <vector>
@@ -46,6 +47,11 @@ namespace mongo {
 
 class CursorResponse;
 
+// Whether the ARM asks a remote for its next batch while results from the previous one are still
+// buffered, and the most bytes of results a single ARM may buffer before it stops doing so.
+extern std::atomic<bool> internalQueryMongosPrefetchResults;  // NOLINT
+extern std::atomic<int> internalQueryMongosPrefetchMaxBytes;  // NOLINT
+
 /**
  * AsyncResultsMerger is used to generate results from cursor-generating commands on one or more
  * remote hosts. A cursor-generating command (e.g. the find command) is one that establishes a
@@ -64,6 +70,11 @@ class CursorResponse;
  * This requires waiting until we have a response from every remote before returning results.
  * Without a sort, we are ready to return results as soon as we have *any* response from a remote.
  *
+ * Unless the cursor is tailable, the ARM also requests a remote's next batch before its buffered
+ * results run out. The request is sent once the time the consumer is expected to take to drain the
+ * buffer, judging by how quickly it has been consuming this remote's results, falls below the time
+ * this remote has been taking to answer requests.
+ *
  * On any error, the caller is responsible for shutting down the ARM using the kill() method.
  *
  * Does not throw exceptions.
@@ -72,6 +83,25 @@ class AsyncResultsMerger {
     MONGO_DISALLOW_COPYING(AsyncResultsMerger);
 
 public:
+    /**
+     * Process-wide counters of the ARMs' prefetching, reported by serverStatus on mongos.
+     */
+    struct PrefetchStats {
+        // Requests sent for a remote's next batch while it still had results buffered.
+        long long requests = 0;
+
+        // Prefetched batches which arrived before the consumer had drained the results buffered
+        // ahead of them.
+        long long hits = 0;
+
+        // Number of times, and total time, a non-tailable consumer waited on an event from
+        // nextEvent() for results to arrive.
+        long long stalls = 0;
+        long long stallMicros = 0;
+    };
+
+    static PrefetchStats getPrefetchStats();
+
     /**
      * Constructs a new AsyncResultsMerger. The TaskExecutor* must remain valid for the lifetime of
      * the ARM.
@@ -234,6 +264,22 @@ private:
         // batchSize in getMore when mongod returned less docs than the requested batchSize.
         long long fetchedCount = 0;
 
+        // Total size of the documents in 'docBuffer'.
+        long long bufferedBytes = 0;
+
+        // When the outstanding request was sent, and a moving average of the time this remote
+        // takes to answer requests.
+        unsigned long long requestSentMicros = 0;
+        long long roundTripMicros = 0;
+
+        // When a result from this remote was last returned, and a moving average of the time
+        // between the results returned from it.
+        unsigned long long lastConsumedMicros = 0;
+        long long consumeIntervalMicros = 0;
+
+        // Whether the outstanding request was sent while results were still buffered.
+        bool prefetching = false;
+
     private:
         // For a cursor, which has shard id associated contains the exact host on which the remote
         // cursor resides.
@@ -299,6 +345,19 @@ private:
     boost::optional<BSONObj> nextReadySorted();
     boost::optional<BSONObj> nextReadyUnsorted();
 
+    /**
+     * Accounts for 'obj' having been taken from the front of the buffer of the remote at
+     * 'remoteIndex', and asks that remote for its next batch if the rest of the buffer is likely to
+     * be drained before the batch could arrive.
+     */
+    void resultConsumed_inlock(size_t remoteIndex, const BSONObj& obj);
+
+    /**
+     * Returns true if the remote at 'remoteIndex' should be asked for its next batch now, while it
+     * still has buffered results.
+     */
+    bool shouldPrefetch_inlock(size_t remoteIndex);
+
     /**
      * When nextEvent() schedules remote work, it passes this method as a callback. The TaskExecutor
      * will call this function, passing the response from the remote.
@@ -363,6 +422,12 @@ private:
 
     boost::optional<Milliseconds> _awaitDataTimeout;
 
+    // Total size of the results buffered for all remotes.
+    long long _bufferedBytes = 0;
+
+    // When the consumer started waiting on '_currentEvent', or zero if it is not being timed.
+    unsigned long long _stallStartMicros = 0;
+
     //
     // Killing
     //
@@ -45,6 +45,7 @@
 #include "mongo/s/sharding_test_fixture.h"
 #include "mongo/stdx/memory.h"
 #include "mongo/unittest/unittest.h"
+#include "mongo/util/time_support.h"
 
 namespace mongo {
 
@@ -91,6 +92,16 @@ public:
         }
 
         setupShards(shards);
+
+        // Most tests script the exact sequence of requests, so prefetching is only enabled by the
+        // tests which exercise it.
+        internalQueryMongosPrefetchResults.store(false);
+    }
+
+    void tearDown() override {
+        internalQueryMongosPrefetchResults.store(true);
+        internalQueryMongosPrefetchMaxBytes.store(32 * 1024 * 1024);
+        ShardingTestFixture::tearDown();
     }
 
 protected:
@@ -190,6 +201,14 @@ protected:
         net->exitNetwork();
     }
 
+    bool networkHasReadyRequests() {
+        executor::NetworkInterfaceMock* net = network();
+        net->enterNetwork();
+        bool hasReadyRequests = net->hasReadyRequests();
+        net->exitNetwork();
+        return hasReadyRequests;
+    }
+
     void blackHoleNextRequest() {
         executor::NetworkInterfaceMock* net = network();
         net->enterNetwork();
@@ -1367,6 +1386,131 @@ TEST_F(AsyncResultsMergerTest, GetMoreRequestWithoutAwaitDataCantHaveMaxTime) {
     executor->waitForEvent(killEvent);
 }
 
+TEST_F(AsyncResultsMergerTest, PrefetchNextBatchBeforeBufferDrains) {
+    internalQueryMongosPrefetchResults.store(true);
+    const auto statsBefore = AsyncResultsMerger::getPrefetchStats();
+
+    BSONObj findCmd = fromjson("{find: 'testcoll'}");
+    makeCursorFromFindCmd(findCmd, {kTestShardIds[0]});
+
+    ASSERT_FALSE(arm->ready());
+    auto readyEvent = unittest::assertGet(arm->nextEvent());
+
+    // Make the remote look slow compared to the consumer.
+    sleepmillis(50);
+
+    std::vector<CursorResponse> responses;
+    std::vector<BSONObj> batch1 = {
+        fromjson("{_id: 1}"), fromjson("{_id: 2}"), fromjson("{_id: 3}"), fromjson("{_id: 4}")};
+    responses.emplace_back(_nss, CursorId(123), batch1);
+    scheduleNetworkResponses(std::move(responses), CursorResponse::ResponseType::InitialResponse);
+    executor->waitForEvent(readyEvent);
+
+    ASSERT_TRUE(arm->ready());
+    ASSERT_EQ(fromjson("{_id: 1}"), *unittest::assertGet(arm->nextReady()));
+    ASSERT_FALSE(networkHasReadyRequests());
+
+    // Once the consumer's pace is known, the getMore is sent while results remain buffered.
+    ASSERT_TRUE(arm->ready());
+    ASSERT_EQ(fromjson("{_id: 2}"), *unittest::assertGet(arm->nextReady()));
+    ASSERT_TRUE(networkHasReadyRequests());
+    ASSERT_EQ(std::string("getMore"), getFirstPendingRequest().cmdObj.firstElementFieldName());
+
+    responses.clear();
+    std::vector<BSONObj> batch2 = {fromjson("{_id: 5}"), fromjson("{_id: 6}")};
+    responses.emplace_back(_nss, CursorId(0), batch2);
+    scheduleNetworkResponses(std::move(responses),
+                             CursorResponse::ResponseType::SubsequentResponse);
+
+    for (int i = 3; i <= 6; ++i) {
+        ASSERT_TRUE(arm->ready());
+        ASSERT_EQ(BSON("_id" << i), *unittest::assertGet(arm->nextReady()));
+    }
+    ASSERT_TRUE(arm->ready());
+    ASSERT(!unittest::assertGet(arm->nextReady()));
+    ASSERT_TRUE(arm->remotesExhausted());
+
+    const auto statsAfter = AsyncResultsMerger::getPrefetchStats();
+    ASSERT_EQ(statsBefore.requests + 1, statsAfter.requests);
+    ASSERT_EQ(statsBefore.hits + 1, statsAfter.hits);
+    ASSERT_EQ(statsBefore.stalls + 1, statsAfter.stalls);
+    ASSERT_GTE(statsAfter.stallMicros - statsBefore.stallMicros, 50 * 1000);
+}
+
+TEST_F(AsyncResultsMergerTest, PrefetchPreservesSortOrder) {
+    internalQueryMongosPrefetchResults.store(true);
+
+    BSONObj findCmd = fromjson("{find: 'testcoll', sort: {_id: 1}}");
+    makeCursorFromFindCmd(findCmd, {kTestShardIds[0], kTestShardIds[1]});
+
+    ASSERT_FALSE(arm->ready());
+    auto readyEvent = unittest::assertGet(arm->nextEvent());
+    sleepmillis(50);
+
+    std::vector<CursorResponse> responses;
+    std::vector<BSONObj> batch1 = {fromjson("{$sortKey: {'': 1}}"),
+                                   fromjson("{$sortKey: {'': 2}}"),
+                                   fromjson("{$sortKey: {'': 3}}"),
+                                   fromjson("{$sortKey: {'': 6}}")};
+    responses.emplace_back(_nss, CursorId(1), batch1);
+    std::vector<BSONObj> batch2 = {fromjson("{$sortKey: {'': 4}}")};
+    responses.emplace_back(_nss, CursorId(0), batch2);
+    scheduleNetworkResponses(std::move(responses), CursorResponse::ResponseType::InitialResponse);
+    executor->waitForEvent(readyEvent);
+
+    ASSERT_TRUE(arm->ready());
+    ASSERT_EQ(fromjson("{$sortKey: {'': 1}}"), *unittest::assertGet(arm->nextReady()));
+    ASSERT_TRUE(arm->ready());
+    ASSERT_EQ(fromjson("{$sortKey: {'': 2}}"), *unittest::assertGet(arm->nextReady()));
+    ASSERT_TRUE(networkHasReadyRequests());
+
+    // The prefetched batch is appended behind the results the first shard already has buffered.
+    responses.clear();
+    std::vector<BSONObj> batch3 = {fromjson("{$sortKey: {'': 7}}")};
+    responses.emplace_back(_nss, CursorId(0), batch3);
+    scheduleNetworkResponses(std::move(responses),
+                             CursorResponse::ResponseType::SubsequentResponse);
+
+    for (int i : {3, 4, 6, 7}) {
+        ASSERT_TRUE(arm->ready());
+        ASSERT_EQ(BSON("$sortKey" << BSON("" << i)), *unittest::assertGet(arm->nextReady()));
+    }
+    ASSERT_TRUE(arm->ready());
+    ASSERT(!unittest::assertGet(arm->nextReady()));
+}
+
+TEST_F(AsyncResultsMergerTest, NoPrefetchBeyondMaxBufferedBytes) {
+    internalQueryMongosPrefetchResults.store(true);
+    internalQueryMongosPrefetchMaxBytes.store(1);
+
+    BSONObj findCmd = fromjson("{find: 'testcoll'}");
+    makeCursorFromFindCmd(findCmd, {kTestShardIds[0]});
+
+    ASSERT_FALSE(arm->ready());
+    auto readyEvent = unittest::assertGet(arm->nextEvent());
+    sleepmillis(50);
+
+    std::vector<CursorResponse> responses;
+    std::vector<BSONObj> batch1 = {
+        fromjson("{_id: 1}"), fromjson("{_id: 2}"), fromjson("{_id: 3}")};
+    responses.emplace_back(_nss, CursorId(123), batch1);
+    scheduleNetworkResponses(std::move(responses), CursorResponse::ResponseType::InitialResponse);
+    executor->waitForEvent(readyEvent);
+
+    ASSERT_TRUE(arm->ready());
+    ASSERT_EQ(fromjson("{_id: 1}"), *unittest::assertGet(arm->nextReady()));
+    ASSERT_TRUE(arm->ready());
+    ASSERT_EQ(fromjson("{_id: 2}"), *unittest::assertGet(arm->nextReady()));
+    ASSERT_FALSE(networkHasReadyRequests());
+
+    ASSERT_TRUE(arm->ready());
+    ASSERT_EQ(fromjson("{_id: 3}"), *unittest::assertGet(arm->nextReady()));
+    ASSERT_FALSE(arm->ready());
+
+    auto killEvent = arm->kill();
+    executor->waitForEvent(killEvent);
+}
+
 }  // namespace
 
 }  // namespace mongo
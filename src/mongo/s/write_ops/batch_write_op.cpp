@@ -273,6 +273,31 @@ Status BatchWriteOp::targetBatch(OperationContext* txn,
     int numTargetErrors = 0;
 
     size_t numWriteOps = _clientRequest->sizeWriteOps();
+
+    //
+    // The documents of an unordered insert batch are all targeted up front, so that the targeter
+    // can resolve their shard keys together. Ordered batches often stop at the first write which
+    // goes to a different shard, so their writes are targeted one at a time as they are reached.
+    //
+
+    OwnedPointerVector<ShardEndpoint> insertEndpointsOwned;
+    vector<ShardEndpoint*>& insertEndpoints = insertEndpointsOwned.mutableVector();
+    vector<Status> insertStatuses;
+    vector<size_t> insertIndexes;
+
+    if (!ordered && _clientRequest->getBatchType() == BatchedCommandRequest::BatchType_Insert &&
+        !_clientRequest->isInsertIndexRequest()) {
+        vector<BSONObj> docs;
+        insertIndexes.resize(numWriteOps);
+        for (size_t i = 0; i < numWriteOps; ++i) {
+            if (_writeOps[i].getWriteState() != WriteOpState_Ready)
+                continue;
+            insertIndexes[i] = docs.size();
+            docs.push_back(_writeOps[i].getWriteItem().getDocument());
+        }
+        targeter.targetInserts(txn, docs, &insertEndpoints, &insertStatuses);
+    }
+
     for (size_t i = 0; i < numWriteOps; ++i) {
         WriteOp& writeOp = _writeOps[i];
 
@@ -288,7 +313,16 @@ Status BatchWriteOp::targetBatch(OperationContext* txn,
         OwnedPointerVector<TargetedWrite> writesOwned;
         vector<TargetedWrite*>& writes = writesOwned.mutableVector();
 
-        Status targetStatus = writeOp.targetWrites(txn, targeter, &writes);
+        Status targetStatus = Status::OK();
+        if (!insertIndexes.empty()) {
+            // The write op takes ownership of the endpoint.
+            ShardEndpoint*& endpoint = insertEndpoints[insertIndexes[i]];
+            targetStatus =
+                writeOp.addTargetedInsert(insertStatuses[insertIndexes[i]], endpoint, &writes);
+            endpoint = NULL;
+        } else {
+            targetStatus = writeOp.targetWrites(txn, targeter, &writes);
+        }
 
         if (!targetStatus.isOK()) {
             WriteErrorDetail targetError;
@@ -373,6 +407,10 @@ Status BatchWriteOp::targetBatch(OperationContext* txn,
         // Relinquish ownership of TargetedWrites, now the TargetedBatches own them
         writesOwned.mutableVector().clear();
 
+        if (!insertIndexes.empty()) {
+            targeter.noteInsertDispatched(insertIndexes[i]);
+        }
+
         //
         // Break if we're ordered and we have more than one endpoint - later writes cannot be
         // enforced as ordered across multiple shard endpoints.
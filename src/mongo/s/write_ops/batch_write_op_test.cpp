@@ -1737,6 +1737,66 @@ TEST(WriteOpLimitTests, TooManyOps) {
     ASSERT(batchOp.isFinished());
 }
 
+/**
+ * Counts the pre-targeted inserts the batch reports as dispatched.
+ */
+class DispatchCountingTargeter : public MockNSTargeter {
+public:
+    void noteInsertDispatched(size_t index) const {
+        ++numDispatched;
+    }
+
+    mutable size_t numDispatched = 0;
+};
+
+TEST(WriteOpLimitTests, TooManyUnorderedInsertsOnlyDispatchedAreNoted) {
+    //
+    // Unordered batch of 1002 inserts, only the documents sent in each round are noted
+    //
+
+    OperationContextNoop txn;
+    NamespaceString nss("foo.bar");
+    ShardEndpoint endpoint("shard", ChunkVersion::IGNORED());
+    DispatchCountingTargeter targeter;
+    initTargeterFullRange(nss, endpoint, &targeter);
+
+    BatchedCommandRequest request(BatchedCommandRequest::BatchType_Insert);
+    request.setNS(nss);
+    request.setOrdered(false);
+
+    // Add 2 more than the maximum to the batch
+    for (size_t i = 0; i < BatchedCommandRequest::kMaxWriteBatchSize + 2u; ++i) {
+        request.getInsertRequest()->addToDocuments(BSON("x" << 2));
+    }
+
+    BatchWriteOp batchOp;
+    batchOp.initClientRequest(&request);
+
+    OwnedPointerVector<TargetedWriteBatch> targetedOwned;
+    vector<TargetedWriteBatch*>& targeted = targetedOwned.mutableVector();
+    Status status = batchOp.targetBatch(&txn, targeter, false, &targeted);
+    ASSERT(status.isOK());
+    ASSERT_EQUALS(targeted.size(), 1u);
+    ASSERT_EQUALS(targeted.front()->getWrites().size(), 1000u);
+    ASSERT_EQUALS(targeter.numDispatched, 1000u);
+
+    BatchedCommandResponse response;
+    buildResponse(1000, &response);
+
+    batchOp.noteBatchResponse(*targeted.front(), response, NULL);
+    ASSERT(!batchOp.isFinished());
+
+    targetedOwned.clear();
+    status = batchOp.targetBatch(&txn, targeter, false, &targeted);
+    ASSERT(status.isOK());
+    ASSERT_EQUALS(targeted.size(), 1u);
+    ASSERT_EQUALS(targeted.front()->getWrites().size(), 2u);
+    ASSERT_EQUALS(targeter.numDispatched, 1002u);
+
+    batchOp.noteBatchResponse(*targeted.front(), response, NULL);
+    ASSERT(batchOp.isFinished());
+}
+
 TEST(WriteOpLimitTests, UpdateOverheadIncluded) {
     //
     // Tests that the overhead of the extra fields in an update x 1000 is included in our size
@@ -116,7 +116,33 @@ Status WriteOp::targetWrites(OperationContext* txn,
     if (!targetStatus.isOK())
         return targetStatus;
 
-    for (vector<ShardEndpoint*>::iterator it = endpoints.begin(); it != endpoints.end(); ++it) {
+    addTargetedWrites(endpoints, targetedWrites);
+    return Status::OK();
+}
+
+Status WriteOp::addTargetedInsert(const Status& targetStatus,
+                                  ShardEndpoint* endpoint,
+                                  std::vector<TargetedWrite*>* targetedWrites) {
+    dassert(_itemRef.getOpType() == BatchedCommandRequest::BatchType_Insert);
+    dassert(!_itemRef.getRequest()->isInsertIndexRequest());
+
+    OwnedPointerVector<ShardEndpoint> endpointsOwned;
+    if (endpoint)
+        endpointsOwned.mutableVector().push_back(endpoint);
+
+    if (!targetStatus.isOK()) {
+        dassert(NULL == endpoint);
+        return targetStatus;
+    }
+
+    addTargetedWrites(endpointsOwned.vector(), targetedWrites);
+    return Status::OK();
+}
+
+void WriteOp::addTargetedWrites(const vector<ShardEndpoint*>& endpoints,
+                                vector<TargetedWrite*>* targetedWrites) {
+    for (vector<ShardEndpoint*>::const_iterator it = endpoints.begin(); it != endpoints.end();
+         ++it) {
         ShardEndpoint* endpoint = *it;
 
         _childOps.push_back(new ChildWriteOp(this));
@@ -136,7 +162,6 @@ Status WriteOp::targetWrites(OperationContext* txn,
     }
 
     _state = WriteOpState_Pending;
-    return Status::OK();
 }
 
 size_t WriteOp::getNumTargeted() {
@@ -126,6 +126,15 @@ public:
                         const NSTargeter& targeter,
                         std::vector<TargetedWrite*>* targetedWrites);
 
+    /**
+     * Like targetWrites(), for an insert which has already been targeted by
+     * NSTargeter::targetInserts() with the result 'targetStatus' and 'endpoint'. Takes ownership
+     * of 'endpoint'.
+     */
+    Status addTargetedInsert(const Status& targetStatus,
+                             ShardEndpoint* endpoint,
+                             std::vector<TargetedWrite*>* targetedWrites);
+
     /**
      * Returns the number of child writes that were last targeted.
      */
@@ -164,6 +173,12 @@ public:
     void setOpError(const WriteErrorDetail& error);
 
 private:
+    /**
+     * Creates a child write and a TargetedWrite for each of 'endpoints', and moves to _Pending.
+     */
+    void addTargetedWrites(const std::vector<ShardEndpoint*>& endpoints,
+                           std::vector<TargetedWrite*>* targetedWrites);
+
     /**
      * Updates the op state after new information is received.
      */
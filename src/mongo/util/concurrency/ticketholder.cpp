@@ -31,10 +31,13 @@
 
 #include "mongo/util/concurrency/ticketholder.h"
 
+#include <algorithm>
 #include <iostream>
 
+#include "mongo/bson/bsonobjbuilder.h"
 #include "mongo/util/log.h"
 #include "mongo/util/mongoutils/str.h"
+#include "mongo/util/time_support.h"
 
 namespace mongo {
 
@@ -198,4 +201,121 @@ bool TicketHolder::_tryAcquire() {
     return true;
 }
 #endif
+
+namespace {
+
+// The share of turns each queue takes while all of them have callers waiting. Replication and
+// administrative commands are cheap and must not be starved.
+const uint64_t kQueueWeights[] = {
+    4,  // kPointRead
+    1,  // kScan
+    2,  // kWrite
+    8,  // kInternal
+    8,  // kAdmin
+};
+
+const uint64_t kStride = 1 << 20;
+
+const char* const kWaitBucketNames[] = {"lt100us", "lt1ms", "lt10ms", "lt100ms", "lt1s", "ge1s"};
+
+}  // namespace
+
+const char* ticketQueueClassToString(TicketQueueClass queueClass) {
+    switch (queueClass) {
+        case TicketQueueClass::kPointRead:
+            return "pointRead";
+        case TicketQueueClass::kScan:
+            return "scan";
+        case TicketQueueClass::kWrite:
+            return "write";
+        case TicketQueueClass::kInternal:
+            return "internal";
+        case TicketQueueClass::kAdmin:
+            return "admin";
+    }
+    MONGO_UNREACHABLE;
 }
+
+void TicketHolder::waitForTicket(TicketQueueClass queueClass) {
+    const uint64_t start = curTimeMicros64();
+    Queue& queue = _queues[static_cast<int>(queueClass)];
+
+    {
+        stdx::unique_lock<stdx::mutex> lk(_queueMutex);
+        _numQueued.fetchAndAdd(1);
+        ++queue.queued;
+
+        if (queue.waiters.empty()) {
+            // The queue was idle, so it doesn't get credit for the turns it didn't take.
+            queue.pass = std::max(queue.pass, _virtualTime);
+        }
+
+        stdx::condition_variable turn;
+        queue.waiters.push_back(&turn);
+
+        turn.wait(lk, [&] {
+            return !_turnTaken && queue.waiters.front() == &turn && _nextQueue_inlock() == &queue;
+        });
+
+        _turnTaken = true;
+        queue.waiters.pop_front();
+        _virtualTime = queue.pass;
+        queue.pass += kStride / kQueueWeights[static_cast<int>(queueClass)];
+    }
+
+    waitForTicket();
+
+    const uint64_t waitMicros = curTimeMicros64() - start;
+    int bucket = 0;
+    for (uint64_t bound = 100; bucket < kNumWaitBuckets - 1 && waitMicros >= bound; bound *= 10) {
+        ++bucket;
+    }
+
+    stdx::lock_guard<stdx::mutex> lk(_queueMutex);
+    _turnTaken = false;
+    --queue.queued;
+    ++queue.waits;
+    queue.waitMicros += waitMicros;
+    ++queue.waitBuckets[bucket];
+    _numQueued.subtractAndFetch(1);
+    _numWaits.fetchAndAdd(1);
+    _totalWaitMicros.fetchAndAdd(waitMicros);
+
+    if (Queue* next = _nextQueue_inlock()) {
+        next->waiters.front()->notify_one();
+    }
+}
+
+TicketHolder::Queue* TicketHolder::_nextQueue_inlock() {
+    Queue* next = nullptr;
+    for (int i = 0; i < kNumQueueClasses; ++i) {
+        Queue& queue = _queues[i];
+        if (queue.waiters.empty()) {
+            continue;
+        }
+        if (!next || queue.pass < next->pass ||
+            (queue.pass == next->pass && kQueueWeights[i] > kQueueWeights[next - &_queues[0]])) {
+            next = &queue;
+        }
+    }
+    return next;
+}
+
+void TicketHolder::appendQueueStats(BSONObjBuilder* builder) const {
+    stdx::lock_guard<stdx::mutex> lk(_queueMutex);
+    for (int i = 0; i < kNumQueueClasses; ++i) {
+        const Queue& queue = _queues[i];
+        BSONObjBuilder queueBuilder(
+            builder->subobjStart(ticketQueueClassToString(static_cast<TicketQueueClass>(i))));
+        queueBuilder.append("queued", queue.queued);
+        queueBuilder.append("waits", queue.waits);
+        queueBuilder.append("waitMicros", queue.waitMicros);
+
+        BSONObjBuilder histogramBuilder(queueBuilder.subobjStart("waitHistogram"));
+        for (int bucket = 0; bucket < kNumWaitBuckets; ++bucket) {
+            histogramBuilder.append(kWaitBucketNames[bucket], queue.waitBuckets[bucket]);
+        }
+    }
+}
+
+}  // namespace mongo
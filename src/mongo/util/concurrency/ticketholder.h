@@ -30,13 +30,27 @@
 #include <semaphore.h>
 #endif
 
+#include <array>
+#include <deque>
+
 #include "mongo/base/disallow_copying.h"
+#include "mongo/platform/atomic_word.h"
 #include "mongo/stdx/condition_variable.h"
 #include "mongo/stdx/mutex.h"
 #include "mongo/util/concurrency/mutex.h"
 
 namespace mongo {
 
+class BSONObjBuilder;
+
+/**
+ * The classes of operations which queue separately for tickets. See
+ * TicketHolder::waitForTicket(TicketQueueClass).
+ */
+enum class TicketQueueClass { kPointRead, kScan, kWrite, kInternal, kAdmin };
+
+const char* ticketQueueClassToString(TicketQueueClass queueClass);
+
 class TicketHolder {
     MONGO_DISALLOW_COPYING(TicketHolder);
 
@@ -48,6 +62,22 @@ public:
 
     void waitForTicket();
 
+    /**
+     * Waits for a ticket in the queue of "queueClass". While callers are queued, the queues take
+     * turns by weighted fair queueing, so that a flood of operations of one class, such as
+     * collection scans, can't take every ticket from the others. Callers are served in arrival
+     * order within a queue. Only the caller whose turn it is waits for the ticket count itself.
+     */
+    void waitForTicket(TicketQueueClass queueClass);
+
+    /**
+     * Returns true if callers are queued in waitForTicket(TicketQueueClass). New callers should
+     * then queue behind them rather than take a released ticket with tryAcquire().
+     */
+    bool hasQueuedWaiters() const {
+        return _numQueued.load() > 0;
+    }
+
     void release();
 
     Status resize(int newSize);
@@ -58,7 +88,51 @@ public:
 
     int outof() const;
 
+    /**
+     * The number of callers which waited in waitForTicket(TicketQueueClass), and the total time
+     * they waited.
+     */
+    long long numWaits() const {
+        return _numWaits.load();
+    }
+
+    long long totalWaitMicros() const {
+        return _totalWaitMicros.load();
+    }
+
+    /**
+     * Appends, for each queue, the number of callers queued and a histogram of their waits.
+     */
+    void appendQueueStats(BSONObjBuilder* builder) const;
+
 private:
+    // Waits are counted in buckets of under 100us, 1ms, 10ms, 100ms and 1s, and of 1s or more.
+    static const int kNumWaitBuckets = 6;
+    static const int kNumQueueClasses = 5;
+
+    struct Queue {
+        // The callers waiting for a turn, in arrival order, by the condition variable each one
+        // waits on. Only the caller at the front is woken when the queue gets a turn.
+        std::deque<stdx::condition_variable*> waiters;
+
+        // The virtual time at which this queue's next turn finishes. The queue with the earliest
+        // finish time takes the next turn.
+        uint64_t pass = 0;
+
+        // Callers in the queue, including one whose turn it is.
+        int queued = 0;
+
+        long long waits = 0;
+        long long waitMicros = 0;
+        std::array<long long, kNumWaitBuckets> waitBuckets{};
+    };
+
+    /**
+     * Returns the queue which takes the next turn, or nullptr if none has callers waiting for a
+     * turn.
+     */
+    Queue* _nextQueue_inlock();
+
 #if defined(__linux__)
     mutable sem_t _sem;
 
@@ -73,6 +147,19 @@ private:
     stdx::mutex _mutex;
     stdx::condition_variable _newTicket;
 #endif
+
+    mutable stdx::mutex _queueMutex;
+    std::array<Queue, kNumQueueClasses> _queues;
+
+    // The virtual time of the last turn taken.
+    uint64_t _virtualTime = 0;
+
+    // Whether a caller has been given its turn and is waiting for the ticket count.
+    bool _turnTaken = false;
+
+    AtomicInt32 _numQueued;
+    AtomicInt64 _numWaits;
+    AtomicInt64 _totalWaitMicros;
 };
 
 class ScopedTicket {
@@ -0,0 +1,127 @@
+/*    Copyright 2016 10gen Inc.
+ *
+ *    This program is free software: you can redistribute it and/or  modify
+ *    it under the terms of the GNU Affero General Public License, version 3,
+ *    as published by the Free Software Foundation.
+ *
+ *    This program is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *    GNU Affero General Public License for more details.
+ *
+ *    You should have received a copy of the GNU Affero General Public License
+ *    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ *    As a special exception, the copyright holders give permission to link the
+ *    code of portions of this program with the OpenSSL library under certain
+ *    conditions as described in each individual source file and distribute
+ *    linked combinations including the program with the OpenSSL library. You
+ *    must comply with the GNU Affero General Public License in all respects
+ *    for all of the code used other than as permitted herein. If you modify
+ *    file(s) with this exception, you may extend this exception to your
+ *    version of the file(s), but you are not obligated to do so. If you do not
+ *    wish to do so, delete this exception statement from your version. If you
+ *    delete this exception statement from all source files in the program,
+ *    then also delete it in the license file.
+ */
+
+
+#include "mongo/platform/basic.h"
+
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "mongo/bson/bsonobjbuilder.h"
+#include "mongo/stdx/memory.h"
+#include "mongo/stdx/mutex.h"
+#include "mongo/stdx/thread.h"
+#include "mongo/unittest/unittest.h"
+#include "mongo/util/concurrency/ticketholder.h"
+#include "mongo/util/time_support.h"
+
+namespace mongo {
+namespace {
+
+BSONObj queueStats(const TicketHolder& holder) {
+    BSONObjBuilder builder;
+    holder.appendQueueStats(&builder);
+    return builder.obj();
+}
+
+int numQueued(const TicketHolder& holder, TicketQueueClass queueClass) {
+    return queueStats(holder)[ticketQueueClassToString(queueClass)]["queued"].numberInt();
+}
+
+void waitUntilQueued(const TicketHolder& holder, TicketQueueClass queueClass, int expected) {
+    while (numQueued(holder, queueClass) < expected) {
+        sleepmillis(1);
+    }
+}
+
+TEST(TicketHolderTest, UncontendedWaitIsCounted) {
+    TicketHolder holder(1);
+    ASSERT_FALSE(holder.hasQueuedWaiters());
+
+    holder.waitForTicket(TicketQueueClass::kWrite);
+    ASSERT_EQUALS(0, holder.available());
+    ASSERT_FALSE(holder.hasQueuedWaiters());
+    ASSERT_EQUALS(1, holder.numWaits());
+    holder.release();
+
+    BSONObj write = queueStats(holder)["write"].Obj();
+    ASSERT_EQUALS(0, write["queued"].numberInt());
+    ASSERT_EQUALS(1, write["waits"].numberLong());
+
+    long long histogramTotal = 0;
+    for (auto&& bucket : write["waitHistogram"].Obj()) {
+        histogramTotal += bucket.numberLong();
+    }
+    ASSERT_EQUALS(1, histogramTotal);
+
+    ASSERT_EQUALS(0, queueStats(holder)["scan"]["waits"].numberLong());
+}
+
+TEST(TicketHolderTest, PointReadIsNotQueuedBehindScans) {
+    TicketHolder holder(1);
+    holder.waitForTicket();
+
+    stdx::mutex mutex;
+    std::vector<std::string> order;
+
+    auto waiter = [&](TicketQueueClass queueClass) {
+        holder.waitForTicket(queueClass);
+        {
+            stdx::lock_guard<stdx::mutex> lk(mutex);
+            order.push_back(ticketQueueClassToString(queueClass));
+        }
+        holder.release();
+    };
+
+    const int numScans = 4;
+    std::vector<std::unique_ptr<stdx::thread>> threads;
+    for (int i = 0; i < numScans; ++i) {
+        threads.push_back(stdx::make_unique<stdx::thread>(waiter, TicketQueueClass::kScan));
+        waitUntilQueued(holder, TicketQueueClass::kScan, i + 1);
+    }
+    threads.push_back(stdx::make_unique<stdx::thread>(waiter, TicketQueueClass::kPointRead));
+    waitUntilQueued(holder, TicketQueueClass::kPointRead, 1);
+    ASSERT_TRUE(holder.hasQueuedWaiters());
+
+    holder.release();
+    for (auto&& thread : threads) {
+        thread->join();
+    }
+
+    // The first scan had already taken its turn when the point read arrived. The point read goes
+    // ahead of the other scans.
+    ASSERT_EQUALS(static_cast<size_t>(numScans + 1), order.size());
+    ASSERT_EQUALS("scan", order[0]);
+    ASSERT_EQUALS("pointRead", order[1]);
+    ASSERT_FALSE(holder.hasQueuedWaiters());
+    ASSERT_EQUALS(1, holder.available());
+    ASSERT_EQUALS(numScans, queueStats(holder)["scan"]["waits"].numberLong());
+}
+
+}  // namespace
+}  // namespace mongo
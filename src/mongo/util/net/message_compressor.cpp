@@ -0,0 +1,219 @@
+/*    Copyright 2016 10gen Inc.
+ *
+ *    This program is free software: you can redistribute it and/or  modify
+ *    it under the terms of the GNU Affero General Public License, version 3,
+ *    as published by the Free Software Foundation.
+ *
+ *    This program is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *    GNU Affero General Public License for more details.
+ *
+ *    You should have received a copy of the GNU Affero General Public License
+ *    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ *    As a special exception, the copyright holders give permission to link the
+ *    code of portions of this program with the OpenSSL library under certain
+ *    conditions as described in each individual source file and distribute
+ *    linked combinations including the program with the OpenSSL library. You
+ *    must comply with the GNU Affero General Public License in all respects
+ *    for all of the code used other than as permitted herein. If you modify
+ *    file(s) with this exception, you may extend this exception to your
+ *    version of the file(s), but you are not obligated to do so. If you do not
+ *    wish to do so, delete this exception statement from your version. If you
+ *    delete this exception statement from all source files in the program,
+ *    then also delete it in the license file.
+ */
+
+
+#include "mongo/platform/basic.h"
+
+#include "mongo/util/net/message_compressor.h"
+
+#include <algorithm>
+#include <snappy.h>
+#include <zlib.h>
+
+#include "mongo/bson/bsonobjbuilder.h"
+#include "mongo/db/server_parameters.h"
+#include "mongo/util/mongoutils/str.h"
+#include "mongo/util/stringutils.h"
+
+namespace mongo {
+
+namespace {
+
+class SnappyMessageCompressor final : public MessageCompressorBase {
+public:
+    SnappyMessageCompressor() : MessageCompressorBase(MessageCompressorId::kSnappy, "snappy") {}
+
+    std::size_t getMaxCompressedSize(std::size_t inputSize) final {
+        return snappy::MaxCompressedLength(inputSize);
+    }
+
+    StatusWith<std::size_t> compressData(ConstDataRange input, DataRange output) final {
+        invariant(output.length() >= getMaxCompressedSize(input.length()));
+        std::size_t outLength;
+        snappy::RawCompress(
+            input.data(), input.length(), const_cast<char*>(output.data()), &outLength);
+        return outLength;
+    }
+
+    StatusWith<std::size_t> decompressData(ConstDataRange input, DataRange output) final {
+        std::size_t expectedLength;
+        if (!snappy::GetUncompressedLength(input.data(), input.length(), &expectedLength) ||
+            expectedLength > output.length()) {
+            return Status(ErrorCodes::BadValue, "Compressed message was invalid or too large");
+        }
+        if (!snappy::RawUncompress(
+                input.data(), input.length(), const_cast<char*>(output.data()))) {
+            return Status(ErrorCodes::BadValue, "Compressed message was invalid");
+        }
+        return expectedLength;
+    }
+};
+
+class ZlibMessageCompressor final : public MessageCompressorBase {
+public:
+    ZlibMessageCompressor() : MessageCompressorBase(MessageCompressorId::kZlib, "zlib") {}
+
+    std::size_t getMaxCompressedSize(std::size_t inputSize) final {
+        return ::compressBound(inputSize);
+    }
+
+    StatusWith<std::size_t> compressData(ConstDataRange input, DataRange output) final {
+        uLongf outLength = output.length();
+        int ret = ::compress2(reinterpret_cast<Bytef*>(const_cast<char*>(output.data())),
+                              &outLength,
+                              reinterpret_cast<const Bytef*>(input.data()),
+                              input.length(),
+                              Z_DEFAULT_COMPRESSION);
+        if (ret != Z_OK) {
+            return Status(ErrorCodes::ZLibError, str::stream() << "compress2 failed with " << ret);
+        }
+        return static_cast<std::size_t>(outLength);
+    }
+
+    StatusWith<std::size_t> decompressData(ConstDataRange input, DataRange output) final {
+        uLongf outLength = output.length();
+        int ret = ::uncompress(reinterpret_cast<Bytef*>(const_cast<char*>(output.data())),
+                               &outLength,
+                               reinterpret_cast<const Bytef*>(input.data()),
+                               input.length());
+        if (ret != Z_OK) {
+            return Status(ErrorCodes::ZLibError, str::stream() << "uncompress failed with " << ret);
+        }
+        return static_cast<std::size_t>(outLength);
+    }
+};
+
+class ExportedMessageCompressorsParameter
+    : public ExportedServerParameter<std::string, ServerParameterType::kStartupOnly> {
+public:
+    ExportedMessageCompressorsParameter(std::string* value)
+        : ExportedServerParameter<std::string, ServerParameterType::kStartupOnly>(
+              ServerParameterSet::getGlobal(), "networkMessageCompressors", value) {}
+
+    virtual Status set(const std::string& newValue) {
+        Status status = MessageCompressorRegistry::get().setEnabledCompressors(newValue);
+        if (!status.isOK()) {
+            return status;
+        }
+        *_value = newValue;
+        return Status::OK();
+    }
+};
+
+// The compressors to offer and accept during the isMaster handshake, in order of preference, for
+// example "snappy,zlib".
+std::string networkMessageCompressors = "disabled";
+ExportedMessageCompressorsParameter networkMessageCompressorsParam(&networkMessageCompressors);
+
+}  // namespace
+
+void MessageCompressorBase::recordCompression(std::size_t bytesIn,
+                                              std::size_t bytesOut,
+                                              uint64_t micros) {
+    _compressor.bytesIn.addAndFetch(bytesIn);
+    _compressor.bytesOut.addAndFetch(bytesOut);
+    _compressor.micros.addAndFetch(micros);
+}
+
+void MessageCompressorBase::recordDecompression(std::size_t bytesIn,
+                                                std::size_t bytesOut,
+                                                uint64_t micros) {
+    _decompressor.bytesIn.addAndFetch(bytesIn);
+    _decompressor.bytesOut.addAndFetch(bytesOut);
+    _decompressor.micros.addAndFetch(micros);
+}
+
+void MessageCompressorBase::appendStats(BSONObjBuilder* builder) const {
+    const auto appendCounters = [builder](StringData name, const Counters& counters) {
+        BSONObjBuilder sub(builder->subobjStart(name));
+        sub.append("bytesIn", counters.bytesIn.load());
+        sub.append("bytesOut", counters.bytesOut.load());
+        sub.append("micros", counters.micros.load());
+    };
+    appendCounters("compressor", _compressor);
+    appendCounters("decompressor", _decompressor);
+}
+
+MessageCompressorRegistry::MessageCompressorRegistry() {
+    _compressors.emplace_back(new SnappyMessageCompressor());
+    _compressors.emplace_back(new ZlibMessageCompressor());
+}
+
+MessageCompressorRegistry& MessageCompressorRegistry::get() {
+    static MessageCompressorRegistry registry;
+    return registry;
+}
+
+MessageCompressorBase* MessageCompressorRegistry::getCompressor(StringData name) const {
+    for (auto&& compressor : _compressors) {
+        if (compressor->getName() == name) {
+            return compressor.get();
+        }
+    }
+    return nullptr;
+}
+
+MessageCompressorBase* MessageCompressorRegistry::getCompressor(MessageCompressorId id) const {
+    for (auto&& compressor : _compressors) {
+        if (compressor->getId() == id) {
+            return compressor.get();
+        }
+    }
+    return nullptr;
+}
+
+Status MessageCompressorRegistry::setEnabledCompressors(StringData names) {
+    std::vector<MessageCompressorBase*> enabled;
+    if (names != "disabled") {
+        std::vector<std::string> parts;
+        splitStringDelim(names.toString(), &parts, ',');
+        for (auto&& name : parts) {
+            if (name.empty()) {
+                continue;
+            }
+            auto compressor = getCompressor(name);
+            if (!compressor) {
+                return Status(ErrorCodes::BadValue,
+                              str::stream() << "Unsupported network message compressor: " << name);
+            }
+            if (std::find(enabled.begin(), enabled.end(), compressor) == enabled.end()) {
+                enabled.push_back(compressor);
+            }
+        }
+    }
+    _enabled = std::move(enabled);
+    return Status::OK();
+}
+
+void MessageCompressorRegistry::appendStats(BSONObjBuilder* builder) const {
+    for (auto&& compressor : _compressors) {
+        BSONObjBuilder sub(builder->subobjStart(compressor->getName()));
+        compressor->appendStats(&sub);
+    }
+}
+
+}  // namespace mongo
@@ -0,0 +1,163 @@
+/*    Copyright 2016 10gen Inc.
+ *
+ *    This program is free software: you can redistribute it and/or  modify
+ *    it under the terms of the GNU Affero General Public License, version 3,
+ *    as published by the Free Software Foundation.
+ *
+ *    This program is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *    GNU Affero General Public License for more details.
+ *
+ *    You should have received a copy of the GNU Affero General Public License
+ *    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ *    As a special exception, the copyright holders give permission to link the
+ *    code of portions of this program with the OpenSSL library under certain
+ *    conditions as described in each individual source file and distribute
+ *    linked combinations including the program with the OpenSSL library. You
+ *    must comply with the GNU Affero General Public License in all respects
+ *    for all of the code used other than as permitted herein. If you modify
+ *    file(s) with this exception, you may extend this exception to your
+ *    version of the file(s), but you are not obligated to do so. If you do not
+ *    wish to do so, delete this exception statement from your version. If you
+ *    delete this exception statement from all source files in the program,
+ *    then also delete it in the license file.
+ */
+
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "mongo/base/data_range.h"
+#include "mongo/base/disallow_copying.h"
+#include "mongo/base/status_with.h"
+#include "mongo/base/string_data.h"
+#include "mongo/platform/atomic_word.h"
+
+namespace mongo {
+
+class BSONObjBuilder;
+
+/**
+ * Identifies the compressor used for the body of an OP_COMPRESSED message. These values are sent
+ * on the wire and must not change.
+ */
+enum class MessageCompressorId : uint8_t {
+    kNoop = 0,
+    kSnappy = 1,
+    kZlib = 2,
+};
+
+/**
+ * Compresses and decompresses the bodies of wire protocol messages.
+ *
+ * A single instance of each compressor is shared by all connections, so implementations must be
+ * thread safe.
+ */
+class MessageCompressorBase {
+    MONGO_DISALLOW_COPYING(MessageCompressorBase);
+
+public:
+    virtual ~MessageCompressorBase() = default;
+
+    const std::string& getName() const {
+        return _name;
+    }
+
+    MessageCompressorId getId() const {
+        return _id;
+    }
+
+    /**
+     * Returns an upper bound on the size of "inputSize" bytes once compressed.
+     */
+    virtual std::size_t getMaxCompressedSize(std::size_t inputSize) = 0;
+
+    /**
+     * Compresses "input" into "output", which must be at least getMaxCompressedSize() bytes long.
+     * Returns the number of bytes written.
+     */
+    virtual StatusWith<std::size_t> compressData(ConstDataRange input, DataRange output) = 0;
+
+    /**
+     * Decompresses "input" into "output". Returns the number of bytes written, which the caller
+     * must check against the size it expected.
+     */
+    virtual StatusWith<std::size_t> decompressData(ConstDataRange input, DataRange output) = 0;
+
+    void recordCompression(std::size_t bytesIn, std::size_t bytesOut, uint64_t micros);
+    void recordDecompression(std::size_t bytesIn, std::size_t bytesOut, uint64_t micros);
+
+    /**
+     * Appends the number of bytes which went in and came out of this compressor in each
+     * direction, and the time it spent, for serverStatus.
+     */
+    void appendStats(BSONObjBuilder* builder) const;
+
+protected:
+    MessageCompressorBase(MessageCompressorId id, std::string name)
+        : _id(id), _name(std::move(name)) {}
+
+private:
+    struct Counters {
+        AtomicInt64 bytesIn;
+        AtomicInt64 bytesOut;
+        AtomicInt64 micros;
+    };
+
+    const MessageCompressorId _id;
+    const std::string _name;
+
+    Counters _compressor;
+    Counters _decompressor;
+};
+
+/**
+ * Holds the message compressors this process supports, and which of them it will negotiate.
+ *
+ * The enabled compressors are set at startup through the networkMessageCompressors server
+ * parameter, a comma separated list in order of preference. No compressors are enabled by
+ * default.
+ */
+class MessageCompressorRegistry {
+    MONGO_DISALLOW_COPYING(MessageCompressorRegistry);
+
+public:
+    MessageCompressorRegistry();
+
+    static MessageCompressorRegistry& get();
+
+    /**
+     * Returns the compressor with the given name or id, or nullptr if this process doesn't
+     * support it.
+     */
+    MessageCompressorBase* getCompressor(StringData name) const;
+    MessageCompressorBase* getCompressor(MessageCompressorId id) const;
+
+    /**
+     * Sets the compressors this process will negotiate from a comma separated list of names.
+     * "disabled" and the empty string enable none.
+     */
+    Status setEnabledCompressors(StringData names);
+
+    const std::vector<MessageCompressorBase*>& getEnabledCompressors() const {
+        return _enabled;
+    }
+
+    /**
+     * Appends the statistics of every supported compressor, keyed by name.
+     */
+    void appendStats(BSONObjBuilder* builder) const;
+
+private:
+    std::vector<std::unique_ptr<MessageCompressorBase>> _compressors;
+    std::vector<MessageCompressorBase*> _enabled;
+};
+
+}  // namespace mongo
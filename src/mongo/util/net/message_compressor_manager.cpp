@@ -0,0 +1,340 @@
+/*    Copyright 2016 10gen Inc.
+ *
+ *    This program is free software: you can redistribute it and/or  modify
+ *    it under the terms of the GNU Affero General Public License, version 3,
+ *    as published by the Free Software Foundation.
+ *
+ *    This program is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *    GNU Affero General Public License for more details.
+ *
+ *    You should have received a copy of the GNU Affero General Public License
+ *    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ *    As a special exception, the copyright holders give permission to link the
+ *    code of portions of this program with the OpenSSL library under certain
+ *    conditions as described in each individual source file and distribute
+ *    linked combinations including the program with the OpenSSL library. You
+ *    must comply with the GNU Affero General Public License in all respects
+ *    for all of the code used other than as permitted herein. If you modify
+ *    file(s) with this exception, you may extend this exception to your
+ *    version of the file(s), but you are not obligated to do so. If you do not
+ *    wish to do so, delete this exception statement from your version. If you
+ *    delete this exception statement from all source files in the program,
+ *    then also delete it in the license file.
+ */
+
+
+#include "mongo/platform/basic.h"
+
+#include "mongo/util/net/message_compressor_manager.h"
+
+#include <algorithm>
+
+#include "mongo/base/data_view.h"
+#include "mongo/bson/bsonobj.h"
+#include "mongo/bson/bsonobjbuilder.h"
+#include "mongo/util/allocator.h"
+#include "mongo/util/mongoutils/str.h"
+#include "mongo/util/timer.h"
+
+namespace mongo {
+
+namespace {
+
+const char kCompressionField[] = "compression";
+
+// Size of the fields which precede the compressed body of an OP_COMPRESSED message.
+const std::size_t kCompressedHeaderSize = sizeof(int32_t) + sizeof(int32_t) + sizeof(uint8_t);
+
+// Commands which carry credentials are never compressed, so that the size of the messages which
+// hold them reveals nothing about their contents. isMaster is sent before compression is
+// negotiated.
+const StringData kUncompressedCommands[] = {"isMaster",
+                                            "ismaster",
+                                            "saslStart",
+                                            "saslContinue",
+                                            "getnonce",
+                                            "authenticate",
+                                            "createUser",
+                                            "updateUser",
+                                            "copydbSaslStart",
+                                            "copydbgetnonce",
+                                            "copydb"};
+
+/**
+ * Returns true if "op" may be the original opcode of an OP_COMPRESSED message. Compressed messages
+ * cannot be nested.
+ */
+bool isCompressibleOp(int32_t op) {
+    switch (op) {
+        case opReply:
+        case dbMsg:
+        case dbUpdate:
+        case dbInsert:
+        case dbQuery:
+        case dbGetMore:
+        case dbDelete:
+        case dbKillCursors:
+        case dbCommand:
+        case dbCommandReply:
+            return true;
+        default:
+            return false;
+    }
+}
+
+/**
+ * Returns the name of the command "msg" runs, or the empty string if it isn't a command.
+ */
+StringData getCommandName(const Message& msg) {
+    const char* body = msg.header().data();
+    switch (msg.operation()) {
+        case dbQuery: {
+            // flags, ns, numberToSkip, numberToReturn, query
+            StringData ns(body + sizeof(int32_t));
+            if (!ns.endsWith(".$cmd")) {
+                return StringData();
+            }
+            BSONObj query(body + sizeof(int32_t) + ns.size() + 1 + 2 * sizeof(int32_t));
+            BSONElement first = query.firstElement();
+            const StringData firstName = first.fieldNameStringData();
+            if (first.type() == Object && (firstName == "$query" || firstName == "query")) {
+                first = first.Obj().firstElement();
+            }
+            return first.fieldNameStringData();
+        }
+        case dbCommand: {
+            // database, commandName
+            StringData database(body);
+            return StringData(body + database.size() + 1);
+        }
+        default:
+            return StringData();
+    }
+}
+
+}  // namespace
+
+MessageCompressorManager::MessageCompressorManager()
+    : MessageCompressorManager(&MessageCompressorRegistry::get()) {}
+
+MessageCompressorManager::MessageCompressorManager(MessageCompressorRegistry* registry)
+    : _registry(registry) {}
+
+MessageCompressorManager::MessageCompressorManager(const MessageCompressorManager& other)
+    : _registry(other._registry),
+      _negotiated(other._negotiated.load()),
+      _lastReceived(other._lastReceived.load()),
+      _uncompressedBytes(other._uncompressedBytes.load()),
+      _compressedBytes(other._compressedBytes.load()) {}
+
+MessageCompressorManager& MessageCompressorManager::operator=(
+    const MessageCompressorManager& other) {
+    _registry = other._registry;
+    _negotiated.store(other._negotiated.load());
+    _lastReceived.store(other._lastReceived.load());
+    _uncompressedBytes.store(other._uncompressedBytes.load());
+    _compressedBytes.store(other._compressedBytes.load());
+    return *this;
+}
+
+void MessageCompressorManager::clientBegin(BSONObjBuilder* isMasterCmd) const {
+    const auto& enabled = _registry->getEnabledCompressors();
+    if (enabled.empty()) {
+        return;
+    }
+
+    BSONArrayBuilder names(isMasterCmd->subarrayStart(kCompressionField));
+    for (auto&& compressor : enabled) {
+        names.append(compressor->getName());
+    }
+}
+
+void MessageCompressorManager::clientFinish(const BSONObj& isMasterReply) {
+    _negotiated = nullptr;
+
+    BSONElement names = isMasterReply[kCompressionField];
+    if (names.type() != Array) {
+        return;
+    }
+
+    const auto& enabled = _registry->getEnabledCompressors();
+    for (auto&& name : names.Obj()) {
+        if (name.type() != String) {
+            continue;
+        }
+        auto compressor = _registry->getCompressor(name.valueStringData());
+        if (compressor && std::find(enabled.begin(), enabled.end(), compressor) != enabled.end()) {
+            _negotiated = compressor;
+            return;
+        }
+    }
+}
+
+void MessageCompressorManager::serverNegotiate(const BSONObj& isMasterCmd,
+                                               BSONObjBuilder* isMasterReply) const {
+    BSONElement names = isMasterCmd[kCompressionField];
+    if (names.type() != Array) {
+        return;
+    }
+
+    // Keep the client's order of preference.
+    const auto& enabled = _registry->getEnabledCompressors();
+    BSONArrayBuilder accepted(isMasterReply->subarrayStart(kCompressionField));
+    for (auto&& name : names.Obj()) {
+        if (name.type() != String) {
+            continue;
+        }
+        auto compressor = _registry->getCompressor(name.valueStringData());
+        if (compressor && std::find(enabled.begin(), enabled.end(), compressor) != enabled.end()) {
+            accepted.append(compressor->getName());
+        }
+    }
+}
+
+MessageCompressorBase* MessageCompressorManager::_getOutgoingCompressor() const {
+    MessageCompressorBase* negotiated = _negotiated.load();
+    return negotiated ? negotiated : _lastReceived.load();
+}
+
+bool MessageCompressorManager::shouldCompress(const Message& msg) const {
+    if (!_getOutgoingCompressor() || msg.operation() == dbCompressed) {
+        return false;
+    }
+
+    const StringData commandName = getCommandName(msg);
+    return std::find(std::begin(kUncompressedCommands),
+                     std::end(kUncompressedCommands),
+                     commandName) == std::end(kUncompressedCommands);
+}
+
+StatusWith<Message> MessageCompressorManager::compressMessage(const Message& msg) {
+    MessageCompressorBase* compressor = _getOutgoingCompressor();
+    invariant(compressor);
+
+    const MsgData::ConstView input = msg.singleData();
+    const std::size_t inputSize = input.dataLen();
+    const std::size_t bufferSize = MsgData::MsgDataHeaderSize + kCompressedHeaderSize +
+        compressor->getMaxCompressedSize(inputSize);
+
+    Message output(mongoMalloc(bufferSize), true);
+    MsgData::View outputView = output.buf();
+    outputView.setId(input.getId());
+    outputView.setResponseTo(input.getResponseTo());
+    outputView.setOperation(dbCompressed);
+
+    DataView outputBody(outputView.data());
+    outputBody.write(tagLittleEndian(static_cast<int32_t>(input.getNetworkOp())));
+    outputBody.write(tagLittleEndian(static_cast<int32_t>(inputSize)), sizeof(int32_t));
+    outputBody.write(tagLittleEndian(static_cast<uint8_t>(compressor->getId())),
+                     2 * sizeof(int32_t));
+
+    Timer timer;
+    char* compressedBody = outputView.data() + kCompressedHeaderSize;
+    auto swCompressedSize = compressor->compressData(
+        ConstDataRange(input.data(), inputSize),
+        DataRange(compressedBody,
+                  bufferSize - MsgData::MsgDataHeaderSize - kCompressedHeaderSize));
+    if (!swCompressedSize.isOK()) {
+        return swCompressedSize.getStatus();
+    }
+    const std::size_t compressedSize = swCompressedSize.getValue();
+    compressor->recordCompression(inputSize, compressedSize, timer.micros());
+
+    outputView.setLen(MsgData::MsgDataHeaderSize + kCompressedHeaderSize + compressedSize);
+
+    _recordBytes(inputSize, compressedSize);
+    return std::move(output);
+}
+
+Status MessageCompressorManager::decompressMessage(Message* msg) {
+    if (msg->operation() != dbCompressed) {
+        _lastReceived = nullptr;
+        return Status::OK();
+    }
+
+    const MsgData::ConstView input = msg->singleData();
+    if (static_cast<std::size_t>(input.dataLen()) < kCompressedHeaderSize) {
+        return Status(ErrorCodes::BadValue, "Compressed message is too short");
+    }
+
+    ConstDataView inputBody(input.data());
+    const int32_t originalOp = inputBody.read<LittleEndian<int32_t>>();
+    const int32_t uncompressedSize = inputBody.read<LittleEndian<int32_t>>(sizeof(int32_t));
+    const uint8_t compressorId = inputBody.read<LittleEndian<uint8_t>>(2 * sizeof(int32_t));
+
+    if (!isCompressibleOp(originalOp)) {
+        return Status(ErrorCodes::BadValue,
+                      str::stream() << "Compressed message has invalid original opcode "
+                                    << originalOp);
+    }
+
+    MessageCompressorBase* compressor =
+        _registry->getCompressor(static_cast<MessageCompressorId>(compressorId));
+    const auto& enabled = _registry->getEnabledCompressors();
+    if (!compressor || std::find(enabled.begin(), enabled.end(), compressor) == enabled.end()) {
+        return Status(ErrorCodes::BadValue,
+                      str::stream() << "Message was compressed with compressor "
+                                    << static_cast<int>(compressorId)
+                                    << ", which is not enabled");
+    }
+
+    if (uncompressedSize < 0 ||
+        static_cast<std::size_t>(uncompressedSize) + MsgData::MsgDataHeaderSize >
+            MaxMessageSizeBytes) {
+        return Status(ErrorCodes::BadValue,
+                      str::stream() << "Invalid uncompressed message size " << uncompressedSize);
+    }
+
+    const std::size_t compressedSize = input.dataLen() - kCompressedHeaderSize;
+    const std::size_t bufferSize = MsgData::MsgDataHeaderSize + uncompressedSize;
+
+    Message output(mongoMalloc(bufferSize), true);
+    MsgData::View outputView = output.buf();
+    outputView.setLen(bufferSize);
+    outputView.setId(input.getId());
+    outputView.setResponseTo(input.getResponseTo());
+    outputView.setOperation(originalOp);
+
+    Timer timer;
+    auto swDecompressedSize =
+        compressor->decompressData(ConstDataRange(input.data() + kCompressedHeaderSize,
+                                                  compressedSize),
+                                   DataRange(outputView.data(), uncompressedSize));
+    if (!swDecompressedSize.isOK()) {
+        return swDecompressedSize.getStatus();
+    }
+    if (swDecompressedSize.getValue() != static_cast<std::size_t>(uncompressedSize)) {
+        return Status(ErrorCodes::BadValue, "Decompressed message has the wrong size");
+    }
+    compressor->recordDecompression(compressedSize, uncompressedSize, timer.micros());
+
+    _lastReceived = compressor;
+    _recordBytes(uncompressedSize, compressedSize);
+    *msg = std::move(output);
+    return Status::OK();
+}
+
+void MessageCompressorManager::reportState(BSONObjBuilder* builder) const {
+    MessageCompressorBase* compressor = _getOutgoingCompressor();
+    const long long uncompressedBytes = _uncompressedBytes.load();
+    if (!compressor || !uncompressedBytes) {
+        return;
+    }
+
+    BSONObjBuilder sub(builder->subobjStart(kCompressionField));
+    sub.append("compressor", compressor->getName());
+    sub.append("uncompressedBytes", uncompressedBytes);
+    sub.append("compressedBytes", _compressedBytes.load());
+}
+
+void MessageCompressorManager::_recordBytes(long long uncompressedBytes,
+                                            long long compressedBytes) {
+    // Only the thread using the connection writes the counters.
+    _uncompressedBytes.store(_uncompressedBytes.load() + uncompressedBytes);
+    _compressedBytes.store(_compressedBytes.load() + compressedBytes);
+}
+
+}  // namespace mongo
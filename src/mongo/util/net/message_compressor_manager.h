@@ -0,0 +1,130 @@
+/*    Copyright 2016 10gen Inc.
+ *
+ *    This program is free software: you can redistribute it and/or  modify
+ *    it under the terms of the GNU Affero General Public License, version 3,
+ *    as published by the Free Software Foundation.
+ *
+ *    This program is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *    GNU Affero General Public License for more details.
+ *
+ *    You should have received a copy of the GNU Affero General Public License
+ *    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ *    As a special exception, the copyright holders give permission to link the
+ *    code of portions of this program with the OpenSSL library under certain
+ *    conditions as described in each individual source file and distribute
+ *    linked combinations including the program with the OpenSSL library. You
+ *    must comply with the GNU Affero General Public License in all respects
+ *    for all of the code used other than as permitted herein. If you modify
+ *    file(s) with this exception, you may extend this exception to your
+ *    version of the file(s), but you are not obligated to do so. If you do not
+ *    wish to do so, delete this exception statement from your version. If you
+ *    delete this exception statement from all source files in the program,
+ *    then also delete it in the license file.
+ */
+
+
+#pragma once
+
+#include <atomic>
+
+#include "mongo/base/status_with.h"
+#include "mongo/platform/atomic_word.h"
+#include "mongo/util/net/message.h"
+#include "mongo/util/net/message_compressor.h"
+
+namespace mongo {
+
+class BSONObj;
+class BSONObjBuilder;
+
+/**
+ * Negotiates the compression of the messages sent on one connection, and compresses and
+ * decompresses them.
+ *
+ * Compressed messages are sent as OP_COMPRESSED messages. After the standard message header,
+ * their body holds the original opcode (int32), the size of the original body (int32) and the
+ * MessageCompressorId (uint8), followed by the compressed original body. The id and responseTo of
+ * the original header are kept.
+ *
+ * A client offers the compressors it has enabled in the "compression" field of its isMaster
+ * command, and the server replies with those it has enabled too. The client then compresses the
+ * messages it sends with the first compressor in the reply. A server compresses a reply exactly
+ * when the request it answers was compressed, using the same compressor.
+ *
+ * Like the connection it belongs to, a MessageCompressorManager is used by one thread at a time.
+ */
+class MessageCompressorManager {
+public:
+    MessageCompressorManager();
+    explicit MessageCompressorManager(MessageCompressorRegistry* registry);
+
+    /**
+     * Copying a manager copies the negotiated state and the byte counts. The atomic members are
+     * not copyable themselves, and connections holding a manager by value are moved around.
+     */
+    MessageCompressorManager(const MessageCompressorManager& other);
+    MessageCompressorManager& operator=(const MessageCompressorManager& other);
+
+    /**
+     * Client side: offers the enabled compressors in the isMaster command being built.
+     */
+    void clientBegin(BSONObjBuilder* isMasterCmd) const;
+
+    /**
+     * Client side: chooses the compressor for the rest of the connection from the reply to the
+     * isMaster command built by clientBegin().
+     */
+    void clientFinish(const BSONObj& isMasterReply);
+
+    /**
+     * Server side: answers the compressors offered in an isMaster command, if any.
+     */
+    void serverNegotiate(const BSONObj& isMasterCmd, BSONObjBuilder* isMasterReply) const;
+
+    /**
+     * Returns true if "msg" should be compressed before it is sent.
+     */
+    bool shouldCompress(const Message& msg) const;
+
+    /**
+     * Returns an OP_COMPRESSED message wrapping "msg", which must be a single buffer. Only call
+     * this if shouldCompress() returned true.
+     */
+    StatusWith<Message> compressMessage(const Message& msg);
+
+    /**
+     * Must be called with every message received on the connection. Replaces an OP_COMPRESSED
+     * message with the message it wraps, and leaves other messages unchanged.
+     */
+    Status decompressMessage(Message* msg);
+
+    /**
+     * Appends the compressor in use and the bytes it has handled to the state reported for the
+     * connection, if it has compressed or decompressed any messages.
+     */
+    void reportState(BSONObjBuilder* builder) const;
+
+private:
+    MessageCompressorBase* _getOutgoingCompressor() const;
+    void _recordBytes(long long uncompressedBytes, long long compressedBytes);
+
+    MessageCompressorRegistry* _registry;
+
+    // The members below are only written by the thread using the connection, but reportState()
+    // reads them from currentOp on other threads, so they are atomic.
+
+    // The compressor chosen by clientFinish(), if this is the client side of the connection.
+    std::atomic<MessageCompressorBase*> _negotiated{nullptr};  // NOLINT
+
+    // The compressor of the last message received, or null if it wasn't compressed.
+    std::atomic<MessageCompressorBase*> _lastReceived{nullptr};  // NOLINT
+
+    // Message body sizes before and after compression, in both directions, for reporting.
+    AtomicInt64 _uncompressedBytes{0};
+    AtomicInt64 _compressedBytes{0};
+};
+
+}  // namespace mongo
@@ -0,0 +1,265 @@
+/*    Copyright 2016 10gen Inc.
+ *
+ *    This program is free software: you can redistribute it and/or  modify
+ *    it under the terms of the GNU Affero General Public License, version 3,
+ *    as published by the Free Software Foundation.
+ *
+ *    This program is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *    GNU Affero General Public License for more details.
+ *
+ *    You should have received a copy of the GNU Affero General Public License
+ *    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ *    As a special exception, the copyright holders give permission to link the
+ *    code of portions of this program with the OpenSSL library under certain
+ *    conditions as described in each individual source file and distribute
+ *    linked combinations including the program with the OpenSSL library. You
+ *    must comply with the GNU Affero General Public License in all respects
+ *    for all of the code used other than as permitted herein. If you modify
+ *    file(s) with this exception, you may extend this exception to your
+ *    version of the file(s), but you are not obligated to do so. If you do not
+ *    wish to do so, delete this exception statement from your version. If you
+ *    delete this exception statement from all source files in the program,
+ *    then also delete it in the license file.
+ */
+
+
+#include "mongo/platform/basic.h"
+
+#include <string>
+
+#include "mongo/bson/bsonobjbuilder.h"
+#include "mongo/bson/util/builder.h"
+#include "mongo/unittest/unittest.h"
+#include "mongo/util/net/message.h"
+#include "mongo/util/net/message_compressor.h"
+#include "mongo/util/net/message_compressor_manager.h"
+
+namespace mongo {
+namespace {
+
+Message buildMessage(NetworkOp op, const BufBuilder& body) {
+    Message msg;
+    msg.setData(op, body.buf(), body.len());
+    msg.header().setId(1234);
+    msg.header().setResponseTo(5678);
+    return msg;
+}
+
+Message buildQueryCommand(StringData ns, const BSONObj& cmd) {
+    BufBuilder body;
+    body.appendNum(0);  // flags
+    body.appendStr(ns);
+    body.appendNum(0);   // numberToSkip
+    body.appendNum(-1);  // numberToReturn
+    cmd.appendSelfToBufBuilder(body);
+    return buildMessage(dbQuery, body);
+}
+
+Message buildReply(int size) {
+    BufBuilder body;
+    for (int i = 0; i < size; ++i) {
+        body.appendChar(static_cast<char>('a' + i % 4));
+    }
+    return buildMessage(opReply, body);
+}
+
+/**
+ * Negotiates compression between a client and a server which enable the given compressors.
+ */
+void negotiate(MessageCompressorManager* client,
+               MessageCompressorManager* server,
+               BSONObj* reply = nullptr) {
+    BSONObjBuilder cmd;
+    cmd.append("isMaster", 1);
+    client->clientBegin(&cmd);
+
+    BSONObjBuilder replyBuilder;
+    server->serverNegotiate(cmd.obj(), &replyBuilder);
+    BSONObj replyObj = replyBuilder.obj();
+    client->clientFinish(replyObj);
+    if (reply) {
+        *reply = replyObj.getOwned();
+    }
+}
+
+void checkRoundTrip(StringData compressorName) {
+    MessageCompressorRegistry registry;
+    ASSERT_OK(registry.setEnabledCompressors(compressorName));
+
+    MessageCompressorManager client(&registry);
+    MessageCompressorManager server(&registry);
+    negotiate(&client, &server);
+
+    Message original = buildQueryCommand("test.$cmd", BSON("find"
+                                                           << "coll"));
+    ASSERT_TRUE(client.shouldCompress(original));
+    auto swCompressed = client.compressMessage(original);
+    ASSERT_OK(swCompressed.getStatus());
+    Message compressed = std::move(swCompressed.getValue());
+    ASSERT_EQUALS(dbCompressed, compressed.operation());
+    ASSERT_EQUALS(original.header().getId(), compressed.header().getId());
+    ASSERT_EQUALS(original.header().getResponseTo(), compressed.header().getResponseTo());
+
+    ASSERT_OK(server.decompressMessage(&compressed));
+    ASSERT_EQUALS(dbQuery, compressed.operation());
+    ASSERT_EQUALS(original.header().getLen(), compressed.header().getLen());
+    ASSERT_EQUALS(original.header().getId(), compressed.header().getId());
+    ASSERT_EQUALS(0,
+                  memcmp(original.singleData().data(),
+                         compressed.singleData().data(),
+                         original.singleData().dataLen()));
+
+    // The server answers a compressed request with a compressed reply.
+    Message reply = buildReply(64 * 1024);
+    ASSERT_TRUE(server.shouldCompress(reply));
+    auto swCompressedReply = server.compressMessage(reply);
+    ASSERT_OK(swCompressedReply.getStatus());
+    Message compressedReply = std::move(swCompressedReply.getValue());
+    ASSERT_LESS_THAN(compressedReply.header().getLen(), reply.header().getLen());
+
+    ASSERT_OK(client.decompressMessage(&compressedReply));
+    ASSERT_EQUALS(opReply, compressedReply.operation());
+    ASSERT_EQUALS(reply.header().getLen(), compressedReply.header().getLen());
+    ASSERT_EQUALS(0,
+                  memcmp(reply.singleData().data(),
+                         compressedReply.singleData().data(),
+                         reply.singleData().dataLen()));
+
+    // An uncompressed request gets an uncompressed reply.
+    Message uncompressed = buildQueryCommand("test.$cmd", BSON("ping" << 1));
+    ASSERT_OK(server.decompressMessage(&uncompressed));
+    ASSERT_FALSE(server.shouldCompress(reply));
+}
+
+TEST(MessageCompressorManager, SnappyRoundTrip) {
+    checkRoundTrip("snappy");
+}
+
+TEST(MessageCompressorManager, ZlibRoundTrip) {
+    checkRoundTrip("zlib");
+}
+
+TEST(MessageCompressorManager, NegotiatesFirstCommonCompressorInClientOrder) {
+    MessageCompressorRegistry clientRegistry;
+    ASSERT_OK(clientRegistry.setEnabledCompressors("zlib,snappy"));
+    MessageCompressorRegistry serverRegistry;
+    ASSERT_OK(serverRegistry.setEnabledCompressors("snappy,zlib"));
+
+    MessageCompressorManager client(&clientRegistry);
+    MessageCompressorManager server(&serverRegistry);
+    BSONObj reply;
+    negotiate(&client, &server, &reply);
+    ASSERT_EQUALS(BSON("compression" << BSON_ARRAY("zlib"
+                                                   << "snappy")),
+                  reply);
+
+    auto swCompressed = client.compressMessage(buildReply(100));
+    ASSERT_OK(swCompressed.getStatus());
+    BSONObjBuilder state;
+    client.reportState(&state);
+    ASSERT_EQUALS("zlib", state.obj()["compression"]["compressor"].String());
+}
+
+TEST(MessageCompressorManager, NoCompressionWithoutCommonCompressor) {
+    MessageCompressorRegistry clientRegistry;
+    ASSERT_OK(clientRegistry.setEnabledCompressors("snappy"));
+    MessageCompressorRegistry serverRegistry;
+    ASSERT_OK(serverRegistry.setEnabledCompressors("zlib"));
+
+    MessageCompressorManager client(&clientRegistry);
+    MessageCompressorManager server(&serverRegistry);
+    BSONObj reply;
+    negotiate(&client, &server, &reply);
+    ASSERT_EQUALS(BSON("compression" << BSONArray()), reply);
+    ASSERT_FALSE(client.shouldCompress(buildReply(100)));
+}
+
+TEST(MessageCompressorManager, ServerIgnoresClientsWhichDoNotOfferCompression) {
+    MessageCompressorRegistry clientRegistry;
+    ASSERT_OK(clientRegistry.setEnabledCompressors("disabled"));
+    MessageCompressorRegistry serverRegistry;
+    ASSERT_OK(serverRegistry.setEnabledCompressors("snappy"));
+
+    MessageCompressorManager client(&clientRegistry);
+    MessageCompressorManager server(&serverRegistry);
+    BSONObj reply;
+    negotiate(&client, &server, &reply);
+    ASSERT_TRUE(reply.isEmpty());
+    ASSERT_FALSE(client.shouldCompress(buildReply(100)));
+}
+
+TEST(MessageCompressorManager, RejectsUnknownCompressors) {
+    MessageCompressorRegistry registry;
+    ASSERT_EQUALS(ErrorCodes::BadValue, registry.setEnabledCompressors("snappy,lz4"));
+}
+
+TEST(MessageCompressorManager, DoesNotCompressHandshakeOrAuthCommands) {
+    MessageCompressorRegistry registry;
+    ASSERT_OK(registry.setEnabledCompressors("snappy"));
+    MessageCompressorManager client(&registry);
+    MessageCompressorManager server(&registry);
+    negotiate(&client, &server);
+
+    ASSERT_FALSE(client.shouldCompress(buildQueryCommand("admin.$cmd", BSON("isMaster" << 1))));
+    ASSERT_FALSE(client.shouldCompress(buildQueryCommand("admin.$cmd", BSON("saslStart" << 1))));
+    ASSERT_FALSE(
+        client.shouldCompress(buildQueryCommand("admin.$cmd", BSON("saslContinue" << 1))));
+    ASSERT_FALSE(client.shouldCompress(
+        buildQueryCommand("test.$cmd", BSON("$query" << BSON("authenticate" << 1)))));
+    ASSERT_TRUE(client.shouldCompress(buildQueryCommand("admin.$cmd", BSON("ping" << 1))));
+
+    // A collection may be named after a command.
+    ASSERT_TRUE(client.shouldCompress(buildQueryCommand("test.coll", BSON("isMaster" << 1))));
+}
+
+TEST(MessageCompressorManager, RejectsCorruptMessages) {
+    MessageCompressorRegistry registry;
+    ASSERT_OK(registry.setEnabledCompressors("snappy"));
+    MessageCompressorManager client(&registry);
+    MessageCompressorManager server(&registry);
+    negotiate(&client, &server);
+
+    auto swCompressed = client.compressMessage(buildReply(1024));
+    ASSERT_OK(swCompressed.getStatus());
+    Message& compressed = swCompressed.getValue();
+
+    // Claim the body is bigger than it is.
+    Message wrongSize;
+    wrongSize.setData(
+        dbCompressed, compressed.singleData().data(), compressed.singleData().dataLen());
+    DataView(wrongSize.singleData().data()).write(tagLittleEndian<int32_t>(2048), 4);
+    ASSERT_NOT_OK(server.decompressMessage(&wrongSize));
+
+    // Claim a compressor which isn't enabled.
+    Message wrongCompressor;
+    wrongCompressor.setData(
+        dbCompressed, compressed.singleData().data(), compressed.singleData().dataLen());
+    DataView(wrongCompressor.singleData().data())
+        .write(tagLittleEndian(static_cast<uint8_t>(MessageCompressorId::kZlib)), 8);
+    ASSERT_EQUALS(ErrorCodes::BadValue, server.decompressMessage(&wrongCompressor));
+
+    // Truncate the header.
+    Message truncated;
+    truncated.setData(dbCompressed, compressed.singleData().data(), 4);
+    ASSERT_EQUALS(ErrorCodes::BadValue, server.decompressMessage(&truncated));
+
+    // Nest a compressed message inside another.
+    Message nested;
+    nested.setData(
+        dbCompressed, compressed.singleData().data(), compressed.singleData().dataLen());
+    DataView(nested.singleData().data()).write(tagLittleEndian<int32_t>(dbCompressed));
+    ASSERT_EQUALS(ErrorCodes::BadValue, server.decompressMessage(&nested));
+
+    // Claim an opcode which doesn't exist.
+    Message unknownOp;
+    unknownOp.setData(
+        dbCompressed, compressed.singleData().data(), compressed.singleData().dataLen());
+    DataView(unknownOp.singleData().data()).write(tagLittleEndian<int32_t>(9999));
+    ASSERT_EQUALS(ErrorCodes::BadValue, server.decompressMessage(&unknownOp));
+}
+
+}  // namespace
+}  // namespace mongo
@@ -130,6 +130,10 @@ MessagingPort::~MessagingPort() {
     ports.erase(this);
 }
 
+void MessagingPort::_unregister() {
+    ports.erase(this);
+}
+
 bool MessagingPort::recv(Message& m) {
     try {
 #ifdef MONGO_CONFIG_SSL
@@ -199,6 +203,13 @@ bool MessagingPort::recv(Message& m) {
 
         guard.Dismiss();
         m.setData(md.view2ptr(), true);
+
+        Status status = compressorManager().decompressMessage(&m);
+        if (!status.isOK()) {
+            LOG(0) << "recv(): failed to decompress message from " << remote() << ": " << status;
+            m.reset();
+            return false;
+        }
         return true;
 
     } catch (const SocketException& e) {
@@ -252,6 +263,14 @@ void MessagingPort::say(Message& toSend, int responseTo) {
     mmm(log() << "*  say()  thr:" << GetCurrentThreadId() << endl;)
         toSend.header().setId(nextMessageId());
     toSend.header().setResponseTo(responseTo);
+
+    if (compressorManager().shouldCompress(toSend)) {
+        toSend.concat();
+        auto swCompressed = compressorManager().compressMessage(toSend);
+        uassertStatusOK(swCompressed.getStatus());
+        swCompressed.getValue().send(*this, "say");
+        return;
+    }
     toSend.send(*this, "say");
 }
 
@@ -55,7 +55,10 @@ public:
 
     void setSocketTimeout(double timeout);
 
-    void shutdown();
+    /**
+     * Closes the socket. closeAllSockets() calls this on every port, from its own thread.
+     */
+    virtual void shutdown();
 
     /* it's assumed if you reuse a message object, that it doesn't cross MessagingPort's.
        also, the Message data will go out of scope on the subsequent recv call.
@@ -117,6 +120,14 @@ public:
         return psock->getSockCreationMicroSec();
     }
 
+protected:
+    /**
+     * Stops closeAllSockets() from reaching this port. A subclass overriding shutdown() must call
+     * this first in its destructor, so that its shutdown() is never called on a partly destroyed
+     * port.
+     */
+    void _unregister();
+
 private:
     // this is the parsed version of remote
     HostAndPort _remoteParsed;
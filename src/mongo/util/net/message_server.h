@@ -36,8 +36,13 @@
 
 #include "mongo/platform/basic.h"
 
+#include <string>
+
 namespace mongo {
 
+class AbstractMessagingPort;
+class Message;
+
 class MessageHandler {
 public:
     virtual ~MessageHandler() {}
@@ -77,4 +82,11 @@ public:
 
 // TODO use a factory here to decide between port and asio variations
 MessageServer* createServer(const MessageServer::Options& opts, MessageHandler* handler);
+
+/**
+ * Creates a server which waits for requests on a fixed pool of I/O threads and processes them on a
+ * pool of worker threads, if the "messageServerMode" server parameter selects it and the platform
+ * and SSL configuration support it. Returns nullptr otherwise.
+ */
+MessageServer* createAsioMessageServer(const MessageServer::Options& opts, MessageHandler* handler);
 }
@@ -0,0 +1,502 @@
+/*    Copyright 2016 10gen Inc.
+ *
+ *    This program is free software: you can redistribute it and/or  modify
+ *    it under the terms of the GNU Affero General Public License, version 3,
+ *    as published by the Free Software Foundation.
+ *
+ *    This program is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *    GNU Affero General Public License for more details.
+ *
+ *    You should have received a copy of the GNU Affero General Public License
+ *    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ *    As a special exception, the copyright holders give permission to link the
+ *    code of portions of this program with the OpenSSL library under certain
+ *    conditions as described in each individual source file and distribute
+ *    linked combinations including the program with the OpenSSL library. You
+ *    must comply with the GNU Affero General Public License in all respects
+ *    for all of the code used other than as permitted herein. If you modify
+ *    file(s) with this exception, you may extend this exception to your
+ *    version of the file(s), but you are not obligated to do so. If you do not
+ *    wish to do so, delete this exception statement from your version. If you
+ *    delete this exception statement from all source files in the program,
+ *    then also delete it in the license file.
+ */
+
+#define MONGO_LOG_DEFAULT_COMPONENT ::mongo::logger::LogComponent::kNetwork
+
+#include "mongo/platform/basic.h"
+
+#include "mongo/util/net/message_server.h"
+
+#ifndef _WIN32
+#include <asio.hpp>
+#endif
+
+#include <deque>
+#include <memory>
+#include <vector>
+
+#include "mongo/base/counter.h"
+#include "mongo/base/disallow_copying.h"
+#include "mongo/config.h"
+#include "mongo/db/client.h"
+#include "mongo/db/commands/server_status_metric.h"
+#include "mongo/db/server_options.h"
+#include "mongo/db/server_parameters.h"
+#include "mongo/db/stats/counters.h"
+#include "mongo/stdx/condition_variable.h"
+#include "mongo/stdx/functional.h"
+#include "mongo/stdx/mutex.h"
+#include "mongo/stdx/thread.h"
+#include "mongo/util/concurrency/synchronization.h"
+#include "mongo/util/concurrency/thread_name.h"
+#include "mongo/util/concurrency/ticketholder.h"
+#include "mongo/util/exit.h"
+#include "mongo/util/log.h"
+#include "mongo/util/mongoutils/str.h"
+#include "mongo/util/net/listen.h"
+#include "mongo/util/net/message.h"
+#include "mongo/util/net/message_port.h"
+#include "mongo/util/net/ssl_options.h"
+#include "mongo/util/time_support.h"
+#include "mongo/util/timer.h"
+
+namespace mongo {
+
+namespace {
+
+class ExportedMessageServerModeParameter
+    : public ExportedServerParameter<std::string, ServerParameterType::kStartupOnly> {
+public:
+    ExportedMessageServerModeParameter(std::string* value)
+        : ExportedServerParameter<std::string, ServerParameterType::kStartupOnly>(
+              ServerParameterSet::getGlobal(), "messageServerMode", value) {}
+
+    virtual Status validate(const std::string& potentialNewValue) {
+        if (potentialNewValue != "threadPerConnection" && potentialNewValue != "asio") {
+            return Status(ErrorCodes::BadValue,
+                          "messageServerMode must be either 'threadPerConnection' or 'asio'");
+        }
+        return Status::OK();
+    }
+};
+
+// Selects how incoming connections are served: "threadPerConnection" dedicates a thread to each
+// connection, "asio" waits for requests on a fixed pool of I/O threads and processes them on a
+// pool of worker threads.
+std::string messageServerMode = "threadPerConnection";
+ExportedMessageServerModeParameter messageServerModeParam(&messageServerMode);
+
+// Number of threads which wait for incoming requests in "asio" mode.
+MONGO_EXPORT_STARTUP_SERVER_PARAMETER(messageServerIOThreads, int, 2);
+
+// Number of threads which process requests in "asio" mode. Requests wait in a queue while all
+// workers are busy.
+MONGO_EXPORT_STARTUP_SERVER_PARAMETER(messageServerWorkerThreads, int, 64);
+
+// If the oldest queued request has waited this long while every worker is busy, for example
+// because all of them are blocked waiting on requests that are themselves queued, another worker
+// is started. Workers beyond messageServerWorkerThreads exit once they have been idle for
+// kExtraWorkerIdleTimeout.
+MONGO_EXPORT_STARTUP_SERVER_PARAMETER(messageServerWorkerStallMillis, int, 500);
+
+// Requests read from a connection and waiting for a worker.
+Counter64 queuedRequestsGauge;
+ServerStatusMetricField<Counter64> displayQueuedRequests("network.messageServer.queued",
+                                                         &queuedRequestsGauge);
+
+// Requests being processed by a worker.
+Counter64 inFlightRequestsGauge;
+ServerStatusMetricField<Counter64> displayInFlightRequests("network.messageServer.inFlight",
+                                                           &inFlightRequestsGauge);
+
+// Worker threads, including those started because the pool stalled.
+Counter64 workersGauge;
+ServerStatusMetricField<Counter64> displayWorkers("network.messageServer.workers", &workersGauge);
+
+#ifndef _WIN32
+
+const Milliseconds kStallCheckInterval(100);
+const Milliseconds kExtraWorkerIdleTimeout(30 * 1000);
+
+/**
+ * A fixed number of threads which run tasks in FIFO order, plus extra threads started when the
+ * queue stops making progress.
+ */
+class WorkerPool {
+    MONGO_DISALLOW_COPYING(WorkerPool);
+
+public:
+    using Task = stdx::function<void()>;
+
+    explicit WorkerPool(int numWorkers) : _numCoreWorkers(numWorkers) {}
+
+    void start() {
+        stdx::lock_guard<stdx::mutex> lk(_mutex);
+        for (int i = 0; i < _numCoreWorkers; ++i) {
+            _startWorker_inlock();
+        }
+    }
+
+    void schedule(Task task) {
+        stdx::lock_guard<stdx::mutex> lk(_mutex);
+        _tasks.push_back({std::move(task), Date_t::now()});
+        queuedRequestsGauge.increment();
+        _cv.notify_one();
+    }
+
+    /**
+     * Starts another worker if the oldest task has waited longer than
+     * messageServerWorkerStallMillis while no worker was idle.
+     */
+    void checkForStall() {
+        stdx::lock_guard<stdx::mutex> lk(_mutex);
+        if (_tasks.empty() || _numIdle > 0) {
+            return;
+        }
+
+        const auto waited = Date_t::now() - _tasks.front().queuedAt;
+        if (waited < Milliseconds(messageServerWorkerStallMillis)) {
+            return;
+        }
+
+        LOG(1) << "request has waited " << waited << " for a worker, starting worker "
+               << _numWorkers + 1;
+        _startWorker_inlock();
+    }
+
+private:
+    struct QueuedTask {
+        Task task;
+        Date_t queuedAt;
+    };
+
+    void _startWorker_inlock() {
+        const int workerId = _numWorkers++;
+        workersGauge.increment();
+        stdx::thread([this, workerId] { _run(workerId); }).detach();
+    }
+
+    void _run(int workerId) {
+        setThreadName(std::string(str::stream() << "messageServerWorker" << workerId));
+
+        int64_t counter = 0;
+        stdx::unique_lock<stdx::mutex> lk(_mutex);
+        while (true) {
+            ++_numIdle;
+            const bool isExtra = _numWorkers > _numCoreWorkers;
+            if (isExtra) {
+                _cv.wait_for(lk, kExtraWorkerIdleTimeout, [&] { return !_tasks.empty(); });
+            } else {
+                _cv.wait(lk, [&] { return !_tasks.empty(); });
+            }
+            --_numIdle;
+
+            if (_tasks.empty()) {
+                invariant(isExtra);
+                --_numWorkers;
+                workersGauge.decrement();
+                return;
+            }
+
+            Task task = std::move(_tasks.front().task);
+            _tasks.pop_front();
+            queuedRequestsGauge.decrement();
+            lk.unlock();
+
+            inFlightRequestsGauge.increment();
+            task();
+            inFlightRequestsGauge.decrement();
+
+            // Occasionally we want to see if we're using too much memory.
+            if ((counter++ & 0xf) == 0) {
+                markThreadIdle();
+            }
+
+            lk.lock();
+        }
+    }
+
+    const int _numCoreWorkers;
+
+    stdx::mutex _mutex;
+    stdx::condition_variable _cv;
+    std::deque<QueuedTask> _tasks;
+    int _numWorkers = 0;
+    int _numIdle = 0;
+};
+
+/**
+ * A MessagingPort whose socket is also watched by an asio descriptor, through which the connection
+ * waits for its next request.
+ *
+ * The descriptor is released before the socket is closed. Otherwise its fd number could be reused
+ * by a newly accepted connection before the reactor deregisters it, which would then deregister
+ * the new connection instead. Releasing the descriptor also completes a pending wait, so that a
+ * connection closed by closeAllSockets() while idle is woken up and cleaned up.
+ */
+class AsioMessagingPort final : public MessagingPort {
+    MONGO_DISALLOW_COPYING(AsioMessagingPort);
+
+public:
+    using WaitHandler = stdx::function<void(const std::error_code&)>;
+
+    AsioMessagingPort(const std::shared_ptr<Socket>& socket, asio::io_service* ioService)
+        : MessagingPort(socket), _descriptor(*ioService, socket->rawFD()) {}
+
+    ~AsioMessagingPort() {
+        _unregister();
+        shutdown();
+    }
+
+    void shutdown() override {
+        stdx::lock_guard<stdx::mutex> lk(_mutex);
+        _descriptor.release();
+        MessagingPort::shutdown();
+    }
+
+    /**
+     * Calls "handler" on an I/O thread once the socket is readable. If the port is or gets closed,
+     * the wait completes with an error instead.
+     */
+    void asyncWaitReadable(WaitHandler handler) {
+        stdx::lock_guard<stdx::mutex> lk(_mutex);
+        _descriptor.async_wait(asio::posix::descriptor_base::wait_read, std::move(handler));
+    }
+
+private:
+    // Serializes the use of the descriptor by the worker and by closeAllSockets().
+    stdx::mutex _mutex;
+    asio::posix::stream_descriptor _descriptor;
+};
+
+class AsioMessageServer;
+
+/**
+ * A client connection. The connection's Client is detached from any thread while the connection
+ * waits for its next request, and is attached to the worker thread which processes it.
+ *
+ * Only one request of a connection is processed at a time: the connection waits for its socket to
+ * become readable again only once the previous request has been answered.
+ */
+class AsioConnection : public std::enable_shared_from_this<AsioConnection> {
+    MONGO_DISALLOW_COPYING(AsioConnection);
+
+public:
+    AsioConnection(AsioMessageServer* server,
+                   asio::io_service* ioService,
+                   const std::shared_ptr<Socket>& socket,
+                   long long connectionId)
+        : _server(server), _port(socket, ioService) {
+        _port.setConnectionId(connectionId);
+        _port.psock->setLogLevel(logger::LogSeverity::Debug(1));
+    }
+
+    /**
+     * Runs MessageHandler::connected() and starts waiting for requests. Must run on a worker.
+     */
+    void start();
+
+private:
+    void _waitForRequest();
+    void _processRequest();
+    void _close();
+
+    AsioMessageServer* const _server;
+    AsioMessagingPort _port;
+    ServiceContext::UniqueClient _client;
+    Message _message;
+};
+
+class AsioMessageServer : public MessageServer, public Listener {
+public:
+    AsioMessageServer(const MessageServer::Options& opts, MessageHandler* handler)
+        : Listener("", opts.ipList, opts.port),
+          _handler(handler),
+          _workers(messageServerWorkerThreads),
+          _work(_ioService),
+          _stallTimer(_ioService) {}
+
+    virtual void accepted(std::shared_ptr<Socket> psocket, long long connectionId) {
+        if (!Listener::globalTicketHolder.tryAcquire()) {
+            log() << "connection refused because too many open connections: "
+                  << Listener::globalTicketHolder.used();
+            return;
+        }
+
+        auto connection =
+            std::make_shared<AsioConnection>(this, &_ioService, psocket, connectionId);
+        _workers.schedule([connection] { connection->start(); });
+    }
+
+    virtual void setAsTimeTracker() {
+        Listener::setAsTimeTracker();
+    }
+
+    virtual bool setupSockets() {
+        return Listener::setupSockets();
+    }
+
+    void run() {
+        log() << "serving connections with " << messageServerIOThreads << " I/O threads and "
+              << messageServerWorkerThreads << " worker threads";
+
+        _workers.start();
+        _scheduleStallCheck();
+        for (int i = 0; i < messageServerIOThreads; ++i) {
+            stdx::thread([this, i] {
+                setThreadName(std::string(str::stream() << "messageServerIO" << i));
+                _ioService.run();
+            }).detach();
+        }
+
+        initAndListen();
+    }
+
+    virtual bool useUnixSockets() const {
+        return true;
+    }
+
+    MessageHandler* getHandler() const {
+        return _handler;
+    }
+
+    WorkerPool* getWorkers() {
+        return &_workers;
+    }
+
+private:
+    void _scheduleStallCheck() {
+        _stallTimer.expires_from_now(kStallCheckInterval);
+        _stallTimer.async_wait([this](const std::error_code& ec) {
+            if (ec) {
+                return;
+            }
+            _workers.checkForStall();
+            _scheduleStallCheck();
+        });
+    }
+
+    // Not owned.
+    MessageHandler* const _handler;
+
+    WorkerPool _workers;
+
+    asio::io_service _ioService;
+    // Keeps the I/O threads running while no connection is waiting.
+    asio::io_service::work _work;
+    asio::steady_timer _stallTimer;
+};
+
+void AsioConnection::start() {
+    try {
+        _server->getHandler()->connected(&_port);
+    } catch (const DBException& e) {
+        log() << "DBException accepting connection, closing client connection: " << e;
+        if (haveClient()) {
+            Client::destroy();
+        }
+        _port.shutdown();
+        Listener::globalTicketHolder.release();
+        return;
+    }
+
+    _client = Client::releaseCurrent();
+    _waitForRequest();
+}
+
+void AsioConnection::_waitForRequest() {
+    auto self = shared_from_this();
+    _port.asyncWaitReadable([self](const std::error_code& ec) {
+        // The request is read and processed on a worker, whether or not the wait failed, so that
+        // the handler closes the connection.
+        self->_server->getWorkers()->schedule([self] { self->_processRequest(); });
+    });
+}
+
+void AsioConnection::_processRequest() {
+    Client::setCurrent(std::move(_client));
+    setThreadName(cc().desc());
+
+    bool keepOpen = false;
+    try {
+        _message.reset();
+        _port.psock->clearCounters();
+
+        if (inShutdown()) {
+            // Fall through and close the connection.
+        } else if (!_port.recv(_message)) {
+            if (!serverGlobalParams.quiet) {
+                int conns = Listener::globalTicketHolder.used() - 1;
+                const char* word = (conns == 1 ? " connection" : " connections");
+                log() << "end connection " << _port.psock->remoteString() << " (" << conns << word
+                      << " now open)";
+            }
+        } else {
+            _server->getHandler()->process(_message, &_port);
+            networkCounter.hit(_port.psock->getBytesIn(), _port.psock->getBytesOut());
+            keepOpen = true;
+        }
+    } catch (AssertionException& e) {
+        log() << "AssertionException handling request, closing client connection: " << e;
+    } catch (SocketException& e) {
+        log() << "SocketException handling request, closing client connection: " << e;
+    } catch (const DBException& e) {  // must be right above std::exception to avoid catching
+                                      // subclasses
+        log() << "DBException handling request, closing client connection: " << e;
+    } catch (std::exception& e) {
+        error() << "Uncaught std::exception: " << e.what() << ", terminating";
+        dbexit(EXIT_UNCAUGHT);
+    }
+
+    if (!keepOpen) {
+        _close();
+        return;
+    }
+
+    _client = Client::releaseCurrent();
+    _waitForRequest();
+}
+
+void AsioConnection::_close() {
+    // Destroys the current thread's Client.
+    _server->getHandler()->close();
+    if (haveClient()) {
+        Client::destroy();
+    }
+
+    _port.shutdown();
+    Listener::globalTicketHolder.release();
+}
+
+#endif  // _WIN32
+
+}  // namespace
+
+MessageServer* createAsioMessageServer(const MessageServer::Options& opts,
+                                       MessageHandler* handler) {
+    if (messageServerMode != "asio") {
+        return nullptr;
+    }
+
+#ifdef _WIN32
+    warning() << "messageServerMode 'asio' is not supported on Windows, using one thread per "
+                 "connection";
+    return nullptr;
+#else
+#ifdef MONGO_CONFIG_SSL
+    if (sslGlobalParams.sslMode.load() != SSLParams::SSLMode_disabled) {
+        // An SSL connection may have buffered data while its socket is not readable.
+        warning() << "messageServerMode 'asio' is not supported with SSL, using one thread per "
+                     "connection";
+        return nullptr;
+    }
+#endif
+    return new AsioMessageServer(opts, handler);
+#endif
+}
+
+}  // namespace mongo
@@ -262,6 +262,9 @@ private:
 
 
 MessageServer* createServer(const MessageServer::Options& opts, MessageHandler* handler) {
+    if (MessageServer* server = createAsioMessageServer(opts, handler)) {
+        return server;
+    }
     return new PortMessageServer(opts, handler);
 }
 